@@ -17,7 +17,11 @@ valgrind --version || true
     --with-test-override-wide-multiply="$WIDEMUL" --with-asm="$ASM" \
     --enable-ecmult-static-precomputation="$STATICPRECOMPUTATION" --with-ecmult-gen-precision="$ECMULTGENPRECISION" \
     --enable-module-ecdh="$ECDH" --enable-module-recovery="$RECOVERY" \
-    --enable-module-schnorrsig="$SCHNORRSIG" \
+    --enable-module-schnorrsig="$SCHNORRSIG" --enable-module-batch="$BATCH" \
+    --enable-module-musig="$MUSIG" \
+    --enable-module-schnorrsig-halfagg="$HALFAGG" \
+    --enable-module-silentpayments="$SILENTPAYMENTS" \
+    --enable-module-pedersen="$PEDERSEN" \
     --with-valgrind="$WITH_VALGRIND" \
     --host="$HOST" $EXTRAFLAGS
 
@@ -64,6 +68,14 @@ then
     then
         $EXEC ./bench_schnorrsig >> bench.log 2>&1
     fi
+    if [ "$SILENTPAYMENTS" = "yes" ]
+    then
+        $EXEC ./bench_silentpayments >> bench.log 2>&1
+    fi
+    if [ "$PEDERSEN" = "yes" ]
+    then
+        $EXEC ./bench_pedersen >> bench.log 2>&1
+    fi
 fi
 if [ "$CTIMETEST" = "yes" ]
 then
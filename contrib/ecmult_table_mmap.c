@@ -0,0 +1,58 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ecmult_table_mmap.h"
+
+secp256k1_context* ecmult_table_mmap_context_create(ecmult_table_mapping *mapping, unsigned int flags, const char *path) {
+    secp256k1_context* ctx;
+    struct stat st;
+    void *addr;
+    int fd;
+
+    mapping->addr = NULL;
+    mapping->len = 0;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    /* The mapping stays valid after the descriptor is closed. */
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return NULL;
+    }
+
+    ctx = secp256k1_context_create_with_ecmult_table(flags, addr, (size_t)st.st_size);
+    if (ctx == NULL) {
+        munmap(addr, (size_t)st.st_size);
+        return NULL;
+    }
+    mapping->addr = addr;
+    mapping->len = (size_t)st.st_size;
+    return ctx;
+}
+
+void ecmult_table_mmap_context_destroy(secp256k1_context* ctx, ecmult_table_mapping *mapping) {
+    secp256k1_context_destroy(ctx);
+    if (mapping->addr != NULL) {
+        munmap(mapping->addr, mapping->len);
+        mapping->addr = NULL;
+        mapping->len = 0;
+    }
+}
@@ -0,0 +1,76 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+/****
+ * Please do not link this file directly. It is not part of the libsecp256k1
+ * project and does not promise any stability in its API, functionality or
+ * presence. Projects which use this code should instead copy this header
+ * and its accompanying .c file directly into their codebase.
+ ****/
+
+/* This file defines functions that map a precomputed table file, as written
+ * by gen_ecmult_table, read-only into memory and create a context that uses
+ * it (see secp256k1_context_create_with_ecmult_table). All processes on a
+ * host mapping the same file share one copy of the tables in the page cache.
+ *
+ * This is not a part of the library itself, because memory mapping files is
+ * not possible with standard C. The code below requires a POSIX system.
+ */
+
+#ifndef SECP256K1_CONTRIB_ECMULT_TABLE_MMAP_H
+#define SECP256K1_CONTRIB_ECMULT_TABLE_MMAP_H
+
+#include <stddef.h>
+
+/* #include secp256k1.h only when it hasn't been included yet.
+   This enables this file to be #included directly in other project
+   files (such as tests.c) without the need to set an explicit -I flag,
+   which would be necessary to locate secp256k1.h. */
+#ifndef SECP256K1_H
+#include <secp256k1.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A mapped table file. Only to be used with the functions below. */
+typedef struct {
+    void *addr;
+    size_t len;
+} ecmult_table_mapping;
+
+/** Map a table file and create a context using it.
+ *
+ *  Returns: a newly created context object, or NULL if the file could not be
+ *           mapped or does not contain a valid table image.
+ *  Out:  mapping: the mapping of the file, to be passed to
+ *                 ecmult_table_mmap_context_destroy.
+ *  In:   flags:   which parts of the context to initialize (see
+ *                 secp256k1_context_create_with_ecmult_table)
+ *        path:    the file name of the table file
+ */
+secp256k1_context* ecmult_table_mmap_context_create(
+    ecmult_table_mapping *mapping,
+    unsigned int flags,
+    const char *path
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** Destroy a context created by ecmult_table_mmap_context_create and unmap
+ *  its table file. All clones of the context must have been destroyed before.
+ *
+ *  Args: ctx:     the context to destroy
+ *        mapping: the mapping returned when creating ctx
+ */
+void ecmult_table_mmap_context_destroy(
+    secp256k1_context* ctx,
+    ecmult_table_mapping *mapping
+) SECP256K1_ARG_NONNULL(2);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_CONTRIB_ECMULT_TABLE_MMAP_H */
@@ -42,6 +42,11 @@ extern "C" {
  *
  *  Regarding randomization, either do it once at creation time (in which case
  *  you do not need any locking for the other calls), or use a read-write lock.
+ *  When the library is built with atomic operations (see
+ *  secp256k1_atomics_available), the randomization is published atomically
+ *  instead, and secp256k1_context_randomize may run while other threads use
+ *  the context without any locking. Calls of secp256k1_context_randomize must
+ *  still not overlap each other or secp256k1_context_destroy.
  */
 typedef struct secp256k1_context_struct secp256k1_context;
 
@@ -58,6 +63,49 @@ typedef struct secp256k1_context_struct secp256k1_context;
  */
 typedef struct secp256k1_scratch_space_struct secp256k1_scratch_space;
 
+/** Opaque data structure that holds the per-thread state of signing: a
+ *  blinding value and the callbacks, but no precomputed tables.
+ *
+ *  A signing session refers to a context, whose tables it uses, and occupies
+ *  about 200 bytes instead of the hundreds of kilobytes of a cloned context.
+ *  It is meant to give each of many signing threads its own randomization
+ *  while they share one context.
+ *
+ *  Functions that take a const pointer to a signing session can be called
+ *  from several threads at the same time. The others need exclusive access to
+ *  it. The context must not be destroyed before its signing sessions.
+ */
+typedef struct secp256k1_signing_session_struct secp256k1_signing_session;
+
+/** Opaque data structure that holds a cache of valid signatures.
+ *
+ *  It remembers salted digests of signatures that passed verification with
+ *  secp256k1_ecdsa_verify_cached or secp256k1_schnorrsig_verify_cached, so
+ *  that verifying them again is a hash table lookup. It has a fixed size and
+ *  drops old entries when it is full.
+ *
+ *  When the library is built with atomic operations (see
+ *  secp256k1_atomics_available), the cache can be used from several threads
+ *  at the same time without locking.
+ *  Concurrent updates can lose entries, which only costs a full verification
+ *  later. Otherwise the threads need to synchronize.
+ */
+typedef struct secp256k1_sigcache_struct secp256k1_signature_cache;
+
+/** Memory allocation functions used by a context and the scratch spaces created
+ *  from it, in place of malloc and free.
+ *
+ *  alloc:  returns a pointer to size bytes of memory, suitably aligned for any
+ *          object type (as malloc would), or NULL on failure.
+ *  free:   releases memory returned by alloc. It is never called with NULL.
+ *  data:   arbitrary data pointer that is passed through to both functions.
+ */
+typedef struct {
+    void *(*alloc)(size_t size, void *data);
+    void (*free)(void *ptr, void *data);
+    void *data;
+} secp256k1_allocator;
+
 /** Opaque data structure that holds a parsed and valid public key.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -71,6 +119,24 @@ typedef struct {
     unsigned char data[64];
 } secp256k1_pubkey;
 
+/** Opaque data structure that holds a valid public key in compressed form.
+ *
+ *  Unlike secp256k1_pubkey, it does not store the Y coordinate of the public
+ *  key, which makes it smaller and faster to parse, but the Y coordinate has to
+ *  be recomputed every time the key is used. It is therefore suitable for large
+ *  sets of public keys of which only few are used, and can be converted into a
+ *  secp256k1_pubkey with secp256k1_compressed_pubkey_decompress (or
+ *  secp256k1_compressed_pubkey_decompress_batch) before a key is used
+ *  repeatedly.
+ *
+ *  The exact representation of data inside is implementation defined and not
+ *  guaranteed to be portable between different platforms or versions. It is
+ *  however guaranteed to be 33 bytes in size, and can be safely copied/moved.
+ */
+typedef struct {
+    unsigned char data[33];
+} secp256k1_compressed_pubkey;
+
 /** Opaque data structured that holds a parsed ECDSA signature.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -84,6 +150,18 @@ typedef struct {
     unsigned char data[64];
 } secp256k1_ecdsa_signature;
 
+/** Opaque data structure that holds a secret key together with the part of
+ *  its RFC6979 nonce generation that does not depend on the message.
+ *
+ *  The exact representation of data inside is implementation defined and not
+ *  guaranteed to be portable between different platforms or versions. It is
+ *  however guaranteed to be 64 bytes in size, and can be safely copied/moved.
+ *  It is as secret as the secret key it holds.
+ */
+typedef struct {
+    unsigned char data[64];
+} secp256k1_ecdsa_signing_key;
+
 /** A pointer to a function to deterministically generate a nonce.
  *
  * Returns: 1 if a nonce was successfully generated. 0 will cause signing to fail.
@@ -173,11 +251,13 @@ typedef int (*secp256k1_nonce_function)(
 #define SECP256K1_FLAGS_TYPE_MASK ((1 << 8) - 1)
 #define SECP256K1_FLAGS_TYPE_CONTEXT (1 << 0)
 #define SECP256K1_FLAGS_TYPE_COMPRESSION (1 << 1)
+#define SECP256K1_FLAGS_TYPE_SIGNATURE_CACHE (1 << 2)
 /** The higher bits contain the actual data. Do not use directly. */
 #define SECP256K1_FLAGS_BIT_CONTEXT_VERIFY (1 << 8)
 #define SECP256K1_FLAGS_BIT_CONTEXT_SIGN (1 << 9)
 #define SECP256K1_FLAGS_BIT_CONTEXT_DECLASSIFY (1 << 10)
 #define SECP256K1_FLAGS_BIT_COMPRESSION (1 << 8)
+#define SECP256K1_FLAGS_BIT_SIGNATURE_CACHE_COUNT (1 << 8)
 
 /** Flags to pass to secp256k1_context_create, secp256k1_context_preallocated_size, and
  *  secp256k1_context_preallocated_create. */
@@ -190,6 +270,10 @@ typedef int (*secp256k1_nonce_function)(
 #define SECP256K1_EC_COMPRESSED (SECP256K1_FLAGS_TYPE_COMPRESSION | SECP256K1_FLAGS_BIT_COMPRESSION)
 #define SECP256K1_EC_UNCOMPRESSED (SECP256K1_FLAGS_TYPE_COMPRESSION)
 
+/** Flags to pass to secp256k1_signature_cache_create. */
+#define SECP256K1_SIGNATURE_CACHE_COUNT (SECP256K1_FLAGS_TYPE_SIGNATURE_CACHE | SECP256K1_FLAGS_BIT_SIGNATURE_CACHE_COUNT)
+#define SECP256K1_SIGNATURE_CACHE_NONE (SECP256K1_FLAGS_TYPE_SIGNATURE_CACHE)
+
 /** Prefix byte used to tag various encoded curvepoints for specific purposes */
 #define SECP256K1_TAG_PUBKEY_EVEN 0x02
 #define SECP256K1_TAG_PUBKEY_ODD 0x03
@@ -210,6 +294,14 @@ SECP256K1_API extern const secp256k1_context *secp256k1_context_no_precomp;
  *  called at most once for every call of this function. If you need to avoid dynamic
  *  memory allocation entirely, see the functions in secp256k1_preallocated.h.
  *
+ *  With SECP256K1_CONTEXT_VERIFY, the context holds two tables of
+ *  2^(ECMULT_WINDOW_SIZE-2) * 64 bytes each (1MB in total for the default
+ *  window size of 15, see --with-ecmult-window), and another 88kB table if the
+ *  library was built with --enable-ecmult-gen-var-table, which speeds up
+ *  public key tweaking. With SECP256K1_CONTEXT_SIGN, it holds a table of 32kB
+ *  to 512kB (see --with-ecmult-gen-precision), unless the library was built
+ *  with a static table (--enable-ecmult-static-precomputation).
+ *
  *  Returns: a newly created context object.
  *  In:      flags: which parts of the context to initialize.
  *
@@ -219,11 +311,34 @@ SECP256K1_API secp256k1_context* secp256k1_context_create(
     unsigned int flags
 ) SECP256K1_WARN_UNUSED_RESULT;
 
+/** Create a secp256k1 context object in memory obtained from a custom allocator.
+ *
+ *  Behaves like secp256k1_context_create, except that allocator->alloc is used in
+ *  place of malloc (and called at most once). The allocator is copied into the
+ *  context: clones of the context are allocated with it, scratch spaces created
+ *  with the context inherit it, and secp256k1_context_destroy and
+ *  secp256k1_scratch_space_destroy release memory through allocator->free.
+ *
+ *  Returns: a newly created context object, or NULL if allocation failed.
+ *  In:      flags:     which parts of the context to initialize.
+ *           allocator: pointer to the allocation functions to use (cannot be
+ *                      NULL, and neither alloc nor free can be NULL). The
+ *                      struct itself need not outlive this call, but the
+ *                      functions and data pointer must outlive the context,
+ *                      its clones and its scratch spaces.
+ */
+SECP256K1_API secp256k1_context* secp256k1_context_create_with_allocator(
+    unsigned int flags,
+    const secp256k1_allocator *allocator
+) SECP256K1_ARG_NONNULL(2) SECP256K1_WARN_UNUSED_RESULT;
+
 /** Copy a secp256k1 context object (into dynamically allocated memory).
  *
- *  This function uses malloc to allocate memory. It is guaranteed that malloc is
- *  called at most once for every call of this function. If you need to avoid dynamic
- *  memory allocation entirely, see the functions in secp256k1_preallocated.h.
+ *  This function uses malloc (or the allocator of ctx, if it has been created
+ *  with secp256k1_context_create_with_allocator) to allocate memory. It is
+ *  guaranteed that malloc is called at most once for every call of this function.
+ *  If you need to avoid dynamic memory allocation entirely, see the functions in
+ *  secp256k1_preallocated.h.
  *
  *  Returns: a newly created context object.
  *  Args:    ctx: an existing context to copy (cannot be NULL)
@@ -232,18 +347,48 @@ SECP256K1_API secp256k1_context* secp256k1_context_clone(
     const secp256k1_context* ctx
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_WARN_UNUSED_RESULT;
 
+/** Create a secp256k1 context object whose verification tables are read from a
+ *  precomputed table image (context itself in dynamically allocated memory).
+ *
+ *  Table images are produced by the gen_ecmult_table tool and can use a larger
+ *  window size than the one the library was configured with. The image is not
+ *  copied: it is typically a read-only memory mapping of a table file, which
+ *  lets all processes on a host share a single copy of it. The image must stay
+ *  valid and unmodified until the context and all its clones are destroyed, and
+ *  must be aligned as returned by malloc or mmap. See
+ *  contrib/ecmult_table_mmap.h for a helper that maps a table file.
+ *
+ *  Validating the image involves hashing all of it, which takes time linear in
+ *  its size.
+ *
+ *  Returns: a newly created context object, or NULL if the image is malformed or
+ *           corrupted.
+ *  In:      flags:    which parts of the context to initialize. The context can
+ *                     be used for verification regardless of whether
+ *                     SECP256K1_CONTEXT_VERIFY is set.
+ *           table:    pointer to the table image (cannot be NULL)
+ *           tablelen: the length of the table image in bytes
+ */
+SECP256K1_API secp256k1_context* secp256k1_context_create_with_ecmult_table(
+    unsigned int flags,
+    const void *table,
+    size_t tablelen
+) SECP256K1_ARG_NONNULL(2) SECP256K1_WARN_UNUSED_RESULT;
+
 /** Destroy a secp256k1 context object (created in dynamically allocated memory).
  *
  *  The context pointer may not be used afterwards.
  *
- *  The context to destroy must have been created using secp256k1_context_create
+ *  The context to destroy must have been created using secp256k1_context_create,
+ *  secp256k1_context_create_with_allocator, secp256k1_context_create_with_ecmult_table
  *  or secp256k1_context_clone. If the context has instead been created using
  *  secp256k1_context_preallocated_create or secp256k1_context_preallocated_clone, the
  *  behaviour is undefined. In that case, secp256k1_context_preallocated_destroy must
  *  be used instead.
  *
  *  Args:   ctx: an existing context to destroy, constructed using
- *               secp256k1_context_create or secp256k1_context_clone
+ *               secp256k1_context_create, secp256k1_context_create_with_allocator,
+ *               secp256k1_context_create_with_ecmult_table or secp256k1_context_clone
  */
 SECP256K1_API void secp256k1_context_destroy(
     secp256k1_context* ctx
@@ -318,6 +463,11 @@ SECP256K1_API void secp256k1_context_set_error_callback(
 ) SECP256K1_ARG_NONNULL(1);
 
 /** Create a secp256k1 scratch space object.
+ *
+ *  The memory is obtained from the allocator of ctx (see
+ *  secp256k1_context_create_with_allocator), or from malloc if it has none. The
+ *  scratch space remembers the allocator, so it is released through it even if
+ *  secp256k1_scratch_space_destroy is called with another context.
  *
  *  Returns: a newly created scratch space.
  *  Args: ctx:  an existing context object (cannot be NULL)
@@ -329,6 +479,55 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_scratch_space* secp256k1_sc
     size_t size
 ) SECP256K1_ARG_NONNULL(1);
 
+/** Create a secp256k1 scratch space object which grows on demand.
+ *
+ *  Unlike a scratch space created with secp256k1_scratch_space_create, whose size
+ *  limits how many points a multi-multiplication processes at once (splitting
+ *  it into more, slower batches if it is too small), this one allocates further
+ *  memory when an algorithm asks for more than it currently holds. Memory is
+ *  kept until the scratch space is destroyed, so repeated calls of similar size
+ *  do not allocate again. Use secp256k1_scratch_space_get_stats to find out how
+ *  much memory a workload needs.
+ *
+ *  Returns: a newly created scratch space, or NULL if initial_size > max_size.
+ *  Args: ctx:          an existing context object (cannot be NULL)
+ *  In:   initial_size: amount of memory to allocate right away.
+ *        max_size:     maximum amount of memory that can be in use at the same
+ *                      time. Algorithms size their batches to use up to this
+ *                      amount, so it should not be set much higher than the
+ *                      memory one is willing to spend.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_scratch_space* secp256k1_scratch_space_create_growable(
+    const secp256k1_context* ctx,
+    size_t initial_size,
+    size_t max_size
+) SECP256K1_ARG_NONNULL(1);
+
+/** Usage statistics of a scratch space, see secp256k1_scratch_space_get_stats. */
+typedef struct {
+    /** the highest amount of memory that was in use at the same time */
+    size_t peak_usage;
+    /** the amount of memory currently held by the scratch space */
+    size_t capacity;
+    /** the number of batches the last multi-multiplication which was given this
+     *  scratch space was split into. 0 means that the scratch space was too
+     *  small to be used at all (or that there was nothing to compute). */
+    size_t last_n_batches;
+} secp256k1_scratch_space_stats;
+
+/** Read usage statistics of a scratch space.
+ *
+ *  Returns: 1 if the statistics were written, 0 if scratch is invalid.
+ *  Args:    ctx:     a secp256k1 context object (cannot be NULL)
+ *           scratch: the scratch space to read (cannot be NULL)
+ *  Out:     stats:   pointer to the statistics (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_scratch_space_get_stats(
+    const secp256k1_context* ctx,
+    const secp256k1_scratch_space* scratch,
+    secp256k1_scratch_space_stats *stats
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Destroy a secp256k1 scratch space.
  *
  *  The pointer may not be used afterwards.
@@ -361,6 +560,118 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_parse(
     size_t inputlen
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Parse many public keys of the same length into pubkey objects.
+ *
+ *  Every key is parsed as secp256k1_ec_pubkey_parse would, but compressed keys
+ *  are decompressed several at a time, which is faster than parsing them one by
+ *  one.
+ *
+ *  Returns: 1 if all public keys were fully valid.
+ *           0 if some public key could not be parsed or is invalid.
+ *  Args: ctx:       a secp256k1 context object.
+ *  Out:  pubkeys:   pointer to an array of n_pubkeys pubkey objects. pubkeys[i]
+ *                   is set to a parsed version of the i-th key if it is valid. If
+ *                   not, its value is undefined.
+ *        results:   pointer to an array of n_pubkeys integers, which are set to
+ *                   1 for the keys that are valid and to 0 for the others (can be
+ *                   NULL).
+ *  In:   input:     pointer to n_pubkeys serialized public keys, stored back to
+ *                   back, each of length inputlen
+ *        inputlen:  length of every serialized public key
+ *        n_pubkeys: the number of public keys (can be 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_parse_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey* pubkeys,
+    int *results,
+    const unsigned char *input,
+    size_t inputlen,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1);
+
+/** Parse a variable-length public key into a compressed pubkey object.
+ *
+ *  Accepts the same encodings as secp256k1_ec_pubkey_parse. For compressed
+ *  encodings it only checks that the X coordinate is that of a point on the
+ *  curve, which is considerably faster than computing the Y coordinate.
+ *
+ *  Returns: 1 if the public key was fully valid.
+ *           0 if the public key could not be parsed or is invalid.
+ *  Args: ctx:      a secp256k1 context object.
+ *  Out:  pubkey:   pointer to a compressed pubkey object. If 1 is returned, it is
+ *                  set to a parsed version of input. If not, its value is
+ *                  undefined.
+ *  In:   input:    pointer to a serialized public key
+ *        inputlen: length of the array pointed to by input
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_compressed_pubkey_parse(
+    const secp256k1_context* ctx,
+    secp256k1_compressed_pubkey* pubkey,
+    const unsigned char *input,
+    size_t inputlen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Serialize a compressed pubkey object into the 33-byte compressed encoding.
+ *
+ *  Returns: 1 always.
+ *  Args:   ctx:        a secp256k1 context object.
+ *  Out:    output33:   a pointer to a 33-byte array to place the serialized key in.
+ *  In:     pubkey:     a pointer to a secp256k1_compressed_pubkey containing an
+ *                      initialized public key.
+ */
+SECP256K1_API int secp256k1_compressed_pubkey_serialize(
+    const secp256k1_context* ctx,
+    unsigned char *output33,
+    const secp256k1_compressed_pubkey* pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Convert a secp256k1_pubkey into a compressed pubkey object.
+ *
+ *  Returns: 1 if the public key is valid, 0 otherwise.
+ *  Args:   ctx:        a secp256k1 context object.
+ *  Out:    compressed: pointer to a compressed pubkey object.
+ *  In:     pubkey:     pointer to an initialized public key.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_compressed_pubkey_from_pubkey(
+    const secp256k1_context* ctx,
+    secp256k1_compressed_pubkey *compressed,
+    const secp256k1_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Convert a compressed pubkey object into a secp256k1_pubkey, computing its
+ *  Y coordinate.
+ *
+ *  Returns: 1 if the compressed public key is valid, 0 otherwise.
+ *  Args:   ctx:        a secp256k1 context object.
+ *  Out:    pubkey:     pointer to a pubkey object.
+ *  In:     compressed: pointer to an initialized compressed public key.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_compressed_pubkey_decompress(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkey,
+    const secp256k1_compressed_pubkey *compressed
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Convert many compressed pubkey objects into secp256k1_pubkey objects.
+ *
+ *  The result is the same as calling secp256k1_compressed_pubkey_decompress for
+ *  every key, but the Y coordinates of several keys are computed at once, which
+ *  is faster.
+ *
+ *  Returns: 1 if all compressed public keys are valid, 0 otherwise.
+ *  Args:   ctx:         a secp256k1 context object.
+ *  Out:    pubkeys:     pointer to an array of n_pubkeys pubkey objects.
+ *  In:     compressed:  pointer to an array of n_pubkeys initialized compressed
+ *                       public keys.
+ *          n_pubkeys:   the number of public keys (can be 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_compressed_pubkey_decompress_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkeys,
+    const secp256k1_compressed_pubkey *compressed,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1);
+
 /** Serialize a pubkey object into a serialized byte sequence.
  *
  *  Returns: 1 always.
@@ -399,6 +710,25 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_cmp(
     const secp256k1_pubkey* pubkey2
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Sort public keys using lexicographic (of compressed serialization) order
+ *
+ *  The order is the same as that of secp256k1_ec_pubkey_cmp. Up to 8 public keys
+ *  are sorted by comparing them directly. Larger arrays are sorted faster by
+ *  serializing every public key only once, into a temporary array of 48 bytes
+ *  per key (on 64-bit platforms), which is obtained from the allocator of ctx
+ *  (see secp256k1_context_create_with_allocator), or from malloc if it has none.
+ *
+ *  Returns: 0 if the arguments are invalid or memory could not be allocated. 1 otherwise.
+ *  Args:     ctx: a secp256k1 context object.
+ *  In/Out:   pubkeys: array of pointers to public keys to sort
+ *  In:     n_pubkeys: number of elements in the pubkeys array
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_sort(
+    const secp256k1_context* ctx,
+    const secp256k1_pubkey **pubkeys,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
 /** Parse an ECDSA signature in compact (64 bytes) format.
  *
  *  Returns: 1 when the signature could be parsed, 0 otherwise.
@@ -507,6 +837,151 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify(
     const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Verify multiple independent ECDSA signatures.
+ *
+ *  Returns: 1: all signatures are correct
+ *           0: at least one signature is incorrect or unparseable
+ *  Args:    ctx:        a secp256k1 context object, initialized for verification.
+ *  Out:     results:    pointer to an array of n ints (can be NULL). If non-NULL,
+ *                       results[i] is set to what secp256k1_ecdsa_verify would
+ *                       return for sigs[i], msghash32s[i] and pubkeys[i].
+ *  In:      sigs:       pointer to an array of n pointers to signatures (cannot be NULL)
+ *           msghash32s: pointer to an array of n pointers to 32-byte message
+ *                       hashes (cannot be NULL)
+ *           pubkeys:    pointer to an array of n pointers to initialized public
+ *                       keys (cannot be NULL)
+ *           n:          the number of signatures to verify.
+ *
+ *  Unlike batch verification, every signature is checked on its own, so the
+ *  result for each one is exactly that of secp256k1_ecdsa_verify. Verifying
+ *  several signatures in one call is faster than calling secp256k1_ecdsa_verify
+ *  for each of them, because the computations are interleaved to hide the
+ *  memory latency of the precomputed table lookups.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_multi(
+    const secp256k1_context* ctx,
+    int *results,
+    const secp256k1_ecdsa_signature * const *sigs,
+    const unsigned char * const *msghash32s,
+    const secp256k1_pubkey * const *pubkeys,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
+/** Verify an ECDSA signature with a compressed public key.
+ *
+ *  The same as secp256k1_ecdsa_verify, but takes the public key as a
+ *  secp256k1_compressed_pubkey, so that it does not need to be decompressed
+ *  first.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect or unparseable signature
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *  In:      sig:       the signature being verified (cannot be NULL)
+ *           msghash32: the 32-byte message hash being verified (cannot be NULL).
+ *           pubkey:    pointer to an initialized compressed public key to verify
+ *                      with (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_compressed(
+    const secp256k1_context* ctx,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msghash32,
+    const secp256k1_compressed_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Create a cache of valid signatures.
+ *
+ *  Every entry takes 16 bytes. The digests are salted, so that others cannot
+ *  compute which signatures collide in the cache. The memory is obtained from
+ *  the allocator of ctx, and the object remembers the allocator.
+ *
+ *  With SECP256K1_SIGNATURE_CACHE_COUNT, every lookup increments a hit or miss
+ *  counter that secp256k1_signature_cache_get_stats reports. The counters are
+ *  shared by all threads, so when several threads verify with the same cache,
+ *  each lookup waits for the cache line holding them to move between cores.
+ *  With SECP256K1_SIGNATURE_CACHE_NONE, lookups write nothing but the entries.
+ *
+ *  Returns: a newly created cache, or NULL if n_entries or flags is invalid.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  In:      n_entries: the number of signatures the cache can hold, rounded up
+ *                      to a multiple of 4 (must be between 1 and 2^34, and the
+ *                      cache must fit in the address space)
+ *           salt32:    pointer to 32 secret random bytes (cannot be NULL)
+ *           flags:     SECP256K1_SIGNATURE_CACHE_COUNT to count hits and
+ *                      misses, SECP256K1_SIGNATURE_CACHE_NONE otherwise.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_signature_cache* secp256k1_signature_cache_create(
+    const secp256k1_context* ctx,
+    size_t n_entries,
+    const unsigned char *salt32,
+    unsigned int flags
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** Destroy a cache created by secp256k1_signature_cache_create.
+ *
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  In:      cache:     cache to destroy (can be NULL, in which case nothing
+ *                      happens)
+ */
+SECP256K1_API void secp256k1_signature_cache_destroy(
+    const secp256k1_context* ctx,
+    secp256k1_signature_cache *cache
+) SECP256K1_ARG_NONNULL(1);
+
+/** Usage statistics of a signature cache, see secp256k1_signature_cache_get_stats. */
+typedef struct {
+    /** the number of signatures the cache can hold */
+    size_t n_entries;
+    /** the number of verifications that found their signature in the cache
+     *  (0 unless the cache was created with SECP256K1_SIGNATURE_CACHE_COUNT) */
+    size_t hits;
+    /** the number of verifications that did not (likewise) */
+    size_t misses;
+} secp256k1_signature_cache_stats;
+
+/** Read usage statistics of a signature cache.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:   pointer to a context object (cannot be NULL)
+ *           cache: the cache to read (cannot be NULL)
+ *  Out:     stats: pointer to the statistics (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_signature_cache_get_stats(
+    const secp256k1_context* ctx,
+    const secp256k1_signature_cache *cache,
+    secp256k1_signature_cache_stats *stats
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Verify an ECDSA signature, using a cache of valid signatures.
+ *
+ *  The same as secp256k1_ecdsa_verify, but the signature is first looked up in
+ *  the cache. If it is not found and turns out to be valid, it is added to the
+ *  cache, unless erase is set.
+ *
+ *  With erase set, a signature that is found is removed from the cache. This
+ *  suits signatures that are not expected to be verified again, such as those
+ *  of a transaction that is being included in the chain after it was accepted
+ *  to the memory pool.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect or unparseable signature
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *           cache:     pointer to a signature cache (cannot be NULL)
+ *  In:      sig:       the signature being verified (cannot be NULL)
+ *           msghash32: the 32-byte message hash being verified (cannot be NULL).
+ *           pubkey:    pointer to an initialized public key to verify with
+ *                      (cannot be NULL)
+ *           erase:     whether to remove the signature from the cache if it is
+ *                      found (and to not add it otherwise)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_cached(
+    const secp256k1_context* ctx,
+    secp256k1_signature_cache *cache,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msghash32,
+    const secp256k1_pubkey *pubkey,
+    int erase
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
 /** Convert a signature to a normalized lower-S form.
  *
  *  Returns: 1 if sigin was not normalized, 0 if it already was.
@@ -587,6 +1062,50 @@ SECP256K1_API int secp256k1_ecdsa_sign(
     const void *ndata
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Compute a signing key for signing many messages with the same secret key.
+ *
+ *  Returns: 1: secret key is valid
+ *           0: secret key is invalid
+ *  Args:    ctx:         pointer to a context object (cannot be NULL)
+ *  Out:     signing_key: pointer to the created signing key. Set to an invalid
+ *                        value if the secret key is invalid (cannot be NULL)
+ *  In:      seckey:      pointer to a 32-byte secret key (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_signing_key_create(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_signing_key *signing_key,
+    const unsigned char *seckey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Create an ECDSA signature with a signing key.
+ *
+ *  The signature is the same as the one secp256k1_ecdsa_sign creates with
+ *  secp256k1_nonce_function_rfc6979 (or NULL) and the same ndata32, but nonce
+ *  generation is faster.
+ *
+ *  Returns: 1: signature created
+ *           0: the signing key was invalid.
+ *  Args:    ctx:         pointer to a context object, initialized for signing
+ *                        (cannot be NULL)
+ *  Out:     sig:         pointer to an array where the signature will be placed
+ *                        (cannot be NULL)
+ *  In:      msghash32:   the 32-byte message hash being signed (cannot be NULL)
+ *           signing_key: pointer to a signing key created by
+ *                        secp256k1_ecdsa_signing_key_create (cannot be NULL)
+ *           ndata32:     pointer to 32 bytes of extra entropy, as used by
+ *                        secp256k1_nonce_function_rfc6979 (can be NULL)
+ *
+ * The created signature is always in lower-S form. See
+ * secp256k1_ecdsa_signature_normalize for more details.
+ */
+SECP256K1_API int secp256k1_ecdsa_sign_with_signing_key(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_signature *sig,
+    const unsigned char *msghash32,
+    const secp256k1_ecdsa_signing_key *signing_key,
+    const unsigned char *ndata32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Verify an ECDSA secret key.
  *
  *  A secret key is valid if it is not 0 and less than the secp256k1 curve order
@@ -701,6 +1220,92 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_add(
     const unsigned char *tweak32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Tweak many public keys by adding tweak times the generator to each of them.
+ *
+ *  Every output is what secp256k1_ec_pubkey_tweak_add would compute for the
+ *  corresponding input, but the results are converted to affine coordinates
+ *  together, which makes this considerably faster than tweaking the keys one by
+ *  one. The same input key may appear several times, as is common when deriving
+ *  many children of a single BIP32 parent key.
+ *
+ *  Returns: 1 if all output public keys are valid.
+ *           0 if the arguments are invalid or some tweak is invalid or the
+ *           negation of the corresponding secret key.
+ *  Args:    ctx:            pointer to a context object initialized for
+ *                           validation (cannot be NULL).
+ *  Out:     output_pubkeys: pointer to an array of n_pubkeys public keys. The
+ *                           i-th entry is set to the i-th input key tweaked with
+ *                           the i-th tweak, or to an invalid value if that fails.
+ *           results:        pointer to an array of n_pubkeys integers, which are
+ *                           set to 1 for the outputs that are valid and to 0 for
+ *                           the others (can be NULL).
+ *  In:      pubkeys:        pointer to an array of n_pubkeys pointers to public
+ *                           keys.
+ *           tweak32s:       pointer to an array of n_pubkeys pointers to 32-byte
+ *                           tweaks.
+ *           n_pubkeys:      the number of keys to tweak (can be 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_add_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *output_pubkeys,
+    int *results,
+    const secp256k1_pubkey * const *pubkeys,
+    const unsigned char * const *tweak32s,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1);
+
+/** Tweak a compressed public key by adding tweak times the generator to it.
+ *
+ *  The same as secp256k1_ec_pubkey_tweak_add, but for a compressed public key.
+ *
+ *  Returns: 0 if the arguments are invalid or the resulting public key would be
+ *           invalid (only when the tweak is the negation of the corresponding
+ *           secret key). 1 otherwise.
+ *  Args:    ctx:   pointer to a context object initialized for validation
+ *                  (cannot be NULL).
+ *  In/Out: pubkey: pointer to a compressed public key object. pubkey will be set
+ *                  to an invalid value if this function returns 0 (cannot be NULL).
+ *  In:    tweak32: pointer to a 32-byte tweak (cannot be NULL).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_compressed_pubkey_tweak_add(
+    const secp256k1_context* ctx,
+    secp256k1_compressed_pubkey *pubkey,
+    const unsigned char *tweak32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Serialize a range of consecutive public keys.
+ *
+ *  Writes the serializations of pubkey, pubkey + G, pubkey + 2*G, ..., pubkey +
+ *  (n_pubkeys-1)*G back to back into output. For the public keys of the secret
+ *  keys k, k+1, ..., pass the public key of k. Every key costs a single point
+ *  addition instead of the multiplication done by secp256k1_ec_pubkey_create
+ *  or secp256k1_ec_pubkey_tweak_add, and the keys are converted to affine
+ *  coordinates in groups, which makes scanning a range of keys tens of times
+ *  faster than computing the keys one by one.
+ *
+ *  Returns: 1 if all keys were serialized.
+ *           0 if the arguments are invalid or some key in the range is the point
+ *           at infinity (only if pubkey is -i*G for some i < n_pubkeys). The
+ *           serialization of that key is set to zeros.
+ *  Args:    ctx:       a secp256k1 context object (cannot be NULL)
+ *  Out:     output:    pointer to an array of n_pubkeys*33 bytes (if flags is
+ *                      SECP256K1_EC_COMPRESSED) or n_pubkeys*65 bytes (if flags
+ *                      is SECP256K1_EC_UNCOMPRESSED) (cannot be NULL unless
+ *                      n_pubkeys is 0)
+ *  In:      pubkey:    pointer to the first public key of the range (cannot be
+ *                      NULL)
+ *           n_pubkeys: the number of keys to serialize (can be 0).
+ *           flags:     SECP256K1_EC_COMPRESSED if serialization should be in
+ *                      compressed format, otherwise SECP256K1_EC_UNCOMPRESSED.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_scan(
+    const secp256k1_context* ctx,
+    unsigned char *output,
+    const secp256k1_pubkey *pubkey,
+    size_t n_pubkeys,
+    unsigned int flags
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
 /** Tweak a secret key by multiplying it by a tweak.
  *
  *  Returns: 0 if the arguments are invalid. 1 otherwise.
@@ -770,12 +1375,130 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_mul(
  * You should call this after secp256k1_context_create or
  * secp256k1_context_clone (and secp256k1_context_preallocated_create or
  * secp256k1_context_clone, resp.), and you may call this repeatedly afterwards.
+ *
+ * The new blinding value is computed first and then replaces the old one
+ * atomically (if secp256k1_atomics_available returns 1, see
+ * secp256k1_context). Signing calls that run at the same time in other
+ * threads use either the old or the new value and never wait, so a single
+ * background thread can rerandomize a context that is shared by many signers.
  */
 SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_context_randomize(
     secp256k1_context* ctx,
     const unsigned char *seed32
 ) SECP256K1_ARG_NONNULL(1);
 
+/** Report whether the library was built with atomic operations.
+ *
+ *  They come from the __atomic builtins of GCC 4.7 or later and Clang, or from
+ *  C11 <stdatomic.h>. Only with them may secp256k1_context_randomize run while
+ *  other threads use the context, and may a secp256k1_signature_cache be
+ *  shared between threads without locking.
+ *
+ *  Returns: 1 if atomic operations are available, 0 otherwise.
+ */
+SECP256K1_API int secp256k1_atomics_available(void);
+
+/** Create a signing session that uses the tables of a context.
+ *
+ *  The session starts with the callbacks and the current blinding value of
+ *  ctx. Call secp256k1_signing_session_randomize afterwards to give it its own
+ *  blinding value. The memory is obtained from the allocator of ctx.
+ *
+ *  Returns: a newly created signing session, or NULL if ctx is not initialized
+ *           for signing.
+ *  Args:    ctx:       pointer to a context object, initialized for signing
+ *                      (cannot be NULL). It must outlive the session.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_signing_session* secp256k1_signing_session_create(
+    const secp256k1_context* ctx
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy a signing session created by secp256k1_signing_session_create.
+ *
+ *  The context it refers to is not affected.
+ *
+ *  Args:    session:   an existing signing session (can be NULL, in which case
+ *                      nothing happens)
+ */
+SECP256K1_API void secp256k1_signing_session_destroy(
+    secp256k1_signing_session* session
+);
+
+/** Set the callback for illegal arguments passed to API calls with a signing
+ *  session, in the same way as secp256k1_context_set_illegal_callback.
+ *
+ *  Args: session: an existing signing session (cannot be NULL)
+ *  In:   fun:     a pointer to a function to call when an illegal argument is
+ *                 passed to the API (NULL restores the default handler)
+ *        data:    the opaque pointer to pass to fun above.
+ */
+SECP256K1_API void secp256k1_signing_session_set_illegal_callback(
+    secp256k1_signing_session* session,
+    void (*fun)(const char* message, void* data),
+    const void* data
+) SECP256K1_ARG_NONNULL(1);
+
+/** Set the callback for internal consistency checks failing in API calls with
+ *  a signing session, in the same way as secp256k1_context_set_error_callback.
+ *
+ *  Args: session: an existing signing session (cannot be NULL)
+ *  In:   fun:     a pointer to a function to call when an internal error
+ *                 occurs (NULL restores the default handler)
+ *        data:    the opaque pointer to pass to fun above.
+ */
+SECP256K1_API void secp256k1_signing_session_set_error_callback(
+    secp256k1_signing_session* session,
+    void (*fun)(const char* message, void* data),
+    const void* data
+) SECP256K1_ARG_NONNULL(1);
+
+/** Update the blinding value of a signing session.
+ *
+ *  This is secp256k1_context_randomize for a signing session. It only
+ *  changes the session, not the context it refers to.
+ *
+ *  Returns: 1 always.
+ *  Args:    session:   pointer to a signing session (cannot be NULL)
+ *  In:      seed32:    pointer to a 32-byte random seed (NULL resets to initial
+ *                      state)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_signing_session_randomize(
+    secp256k1_signing_session* session,
+    const unsigned char *seed32
+) SECP256K1_ARG_NONNULL(1);
+
+/** Create an ECDSA signature with a signing session.
+ *
+ *  Same as secp256k1_ecdsa_sign, but with the blinding value and the callbacks
+ *  of the session instead of those of its context.
+ *
+ *  Args:    session:   pointer to a signing session (cannot be NULL)
+ *  The other arguments and the return value are as for secp256k1_ecdsa_sign.
+ */
+SECP256K1_API int secp256k1_ecdsa_sign_with_session(
+    const secp256k1_signing_session* session,
+    secp256k1_ecdsa_signature *sig,
+    const unsigned char *msghash32,
+    const unsigned char *seckey,
+    secp256k1_nonce_function noncefp,
+    const void *ndata
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Compute the public key for a secret key with a signing session.
+ *
+ *  Same as secp256k1_ec_pubkey_create, but with the blinding value and the
+ *  callbacks of the session instead of those of its context.
+ *
+ *  Args:    session:   pointer to a signing session (cannot be NULL)
+ *  The other arguments and the return value are as for
+ *  secp256k1_ec_pubkey_create.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create_with_session(
+    const secp256k1_signing_session* session,
+    secp256k1_pubkey *pubkey,
+    const unsigned char *seckey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Add a number of public keys together.
  *
  *  Returns: 1: the sum of the public keys is valid.
@@ -0,0 +1,151 @@
+#ifndef SECP256K1_BATCH_H
+#define SECP256K1_BATCH_H
+
+#include "secp256k1.h"
+#include "secp256k1_extrakeys.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** This module implements batch verification: it checks many statements, such
+ *  as the Schnorr signatures and Taproot tweaks of a block, considerably faster
+ *  than verifying them one by one.
+ *
+ *  Every statement is an equation between points on the curve. A batch combines
+ *  the equations with random factors into a single multi-scalar multiplication
+ *  over all of them, which holds if all statements hold and fails with
+ *  overwhelming probability otherwise.
+ *
+ *  ECDSA signatures cannot be added: their signature only contains the X
+ *  coordinate of R modulo the group order, so they do not give an equation
+ *  that can be combined with others. Verify them with secp256k1_ecdsa_verify or
+ *  secp256k1_ecdsa_verify_multi.
+ */
+
+/** Opaque data structure that accumulates statements for batch verification.
+ *
+ *  Create it with secp256k1_batch_create and release it with
+ *  secp256k1_batch_destroy. A batch must not be used from several threads at
+ *  the same time.
+ */
+typedef struct secp256k1_batch_struct secp256k1_batch;
+
+/** The number of statements a batch combines into one multi-scalar
+ *  multiplication when no other number is asked for. Beyond this, combining
+ *  more statements saves little time but takes more memory. */
+#define SECP256K1_BATCH_DEFAULT_MAX_STATEMENTS 2048
+
+/** Create a batch.
+ *
+ *  The memory is obtained from the allocator of ctx (see
+ *  secp256k1_context_create_with_allocator), or from malloc if it has none. The
+ *  batch remembers the allocator, so it is released through it even if
+ *  secp256k1_batch_destroy is called with another context. It needs about
+ *  1.1 kB per statement if max_statements is at least 44, and up to 9 kB per
+ *  statement below that.
+ *
+ *  Returns: a newly created batch, or NULL if the memory could not be allocated.
+ *  Args:    ctx:            pointer to a context object (cannot be NULL)
+ *  In:      max_statements: the number of statements that are combined into one
+ *                           multi-scalar multiplication. Once that many are
+ *                           added, they are checked before more are accepted.
+ *                           If 0, SECP256K1_BATCH_DEFAULT_MAX_STATEMENTS is used.
+ *           aux_rand16:     16 bytes of fresh randomness that is mixed into the
+ *                           random factors (can be NULL). The factors are
+ *                           derived from a hash of all statements, so batch
+ *                           verification is sound without it.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_batch* secp256k1_batch_create(
+    const secp256k1_context* ctx,
+    size_t max_statements,
+    const unsigned char *aux_rand16
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy a batch created by secp256k1_batch_create
+ *
+ *  Args:    ctx:   pointer to a context object (cannot be NULL)
+ *  In:      batch: batch to destroy (can be NULL, in which case nothing happens)
+ */
+SECP256K1_API void secp256k1_batch_destroy(
+    const secp256k1_context* ctx,
+    secp256k1_batch *batch
+) SECP256K1_ARG_NONNULL(1);
+
+/** Verify all statements added to a batch since it was created or last verified.
+ *
+ *  Afterwards the batch is empty again and can be reused.
+ *
+ *  Returns: 1 if all statements hold.
+ *           0 if the arguments are invalid or some statement does not hold.
+ *  Args:    ctx:           pointer to a context object initialized for
+ *                          verification (cannot be NULL)
+ *           batch:         pointer to a batch (cannot be NULL)
+ *  Out:     first_failure: if 0 is returned because a statement does not hold,
+ *                          set to the position of the first such statement,
+ *                          counting the statements from 0 in the order they were
+ *                          added (can be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_batch_verify(
+    const secp256k1_context* ctx,
+    secp256k1_batch *batch,
+    size_t *first_failure
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Add a BIP340 Schnorr signature to a batch
+ *
+ *  The statement holds if secp256k1_schnorrsig_verify would accept the
+ *  signature.
+ *
+ *  Returns: 1 if the statement was added.
+ *           0 if the arguments are invalid or the signature is already known not
+ *           to be valid, in which case secp256k1_batch_verify will fail.
+ *  Args:    ctx:    pointer to a context object initialized for verification
+ *                   (cannot be NULL)
+ *           batch:  pointer to a batch (cannot be NULL)
+ *  In:      sig64:  pointer to the 64-byte signature to verify (cannot be NULL)
+ *           msg:    the message being verified (can only be NULL if msglen is 0)
+ *           msglen: length of the message
+ *           pubkey: pointer to an x-only public key to verify with (cannot be
+ *                   NULL)
+ */
+SECP256K1_API int secp256k1_batch_add_schnorrsig(
+    const secp256k1_context* ctx,
+    secp256k1_batch *batch,
+    const unsigned char *sig64,
+    const unsigned char *msg,
+    size_t msglen,
+    const secp256k1_xonly_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(6);
+
+/** Add a Taproot tweak check to a batch
+ *
+ *  The statement holds if secp256k1_xonly_pubkey_tweak_add_check would return
+ *  1 for the same arguments.
+ *
+ *  Returns: 1 if the statement was added.
+ *           0 if the arguments are invalid or the statement is already known
+ *           not to hold, in which case secp256k1_batch_verify will fail.
+ *  Args:            ctx: pointer to a context object initialized for
+ *                        verification (cannot be NULL)
+ *                 batch: pointer to a batch (cannot be NULL)
+ *  In: tweaked_pubkey32: pointer to a serialized xonly_pubkey (cannot be NULL)
+ *     tweaked_pk_parity: the parity of the tweaked pubkey
+ *       internal_pubkey: pointer to an x-only public key object to apply the
+ *                        tweak to (cannot be NULL)
+ *               tweak32: pointer to a 32-byte tweak (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_batch_add_xonly_pubkey_tweak_check(
+    const secp256k1_context* ctx,
+    secp256k1_batch *batch,
+    const unsigned char *tweaked_pubkey32,
+    int tweaked_pk_parity,
+    const secp256k1_xonly_pubkey *internal_pubkey,
+    const unsigned char *tweak32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_BATCH_H */
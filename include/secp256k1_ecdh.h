@@ -55,6 +55,151 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh(
   void *data
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Compute EC Diffie-Hellman secrets of one secret key with many public keys in constant time
+ *
+ *  The result is the same as calling secp256k1_ecdh for every public key, but the
+ *  scalar is only decomposed once, and the shared points are converted to affine
+ *  coordinates using a single field inversion for every group of points.
+ *
+ *  Returns: 1: all exponentiations were successful
+ *           0: scalar was invalid (zero or overflow) or hashfp returned 0 for some
+ *              public key (the contents of the outputs are unspecified then)
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     outputs:    array of n_pubkeys pointers to arrays to be filled by hashfp
+ *  In:      pubkeys:    array of n_pubkeys pointers to initialized public keys
+ *           n_pubkeys:  the number of public keys (can be 0)
+ *           seckey:     a 32-byte scalar with which to multiply the points
+ *           hashfp:     pointer to a hash function. If NULL, secp256k1_ecdh_hash_function_sha256 is used
+ *                       (in which case, 32 bytes will be written to every output)
+ *           data:       arbitrary data pointer that is passed through to hashfp
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh_batch(
+  const secp256k1_context* ctx,
+  unsigned char * const *outputs,
+  const secp256k1_pubkey * const *pubkeys,
+  size_t n_pubkeys,
+  const unsigned char *seckey,
+  secp256k1_ecdh_hash_function hashfp,
+  void *data
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(5);
+
+/** Opaque data structure that holds a public key together with precomputed
+ *  multiples of it, for computing many ECDH secrets with the same public key.
+ *
+ *  Create it with secp256k1_ecdh_precomputed_pubkey_create and release it with
+ *  secp256k1_ecdh_precomputed_pubkey_destroy. It occupies about 2 kB of memory
+ *  and is never modified after creation, so it can be used from several threads
+ *  at the same time.
+ */
+typedef struct secp256k1_ecdh_precomputed_pubkey_struct secp256k1_ecdh_precomputed_pubkey;
+
+/** Precompute multiples of a public key for use with secp256k1_ecdh_precomputed
+ *
+ *  The memory is obtained from the allocator of ctx (see
+ *  secp256k1_context_create_with_allocator), or from malloc if it has none. The
+ *  object remembers the allocator, so it is released through it even if
+ *  secp256k1_ecdh_precomputed_pubkey_destroy is called with another context.
+ *
+ *  Returns: a newly created object, or NULL if pubkey is invalid.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  In:      pubkey:     a pointer to a secp256k1_pubkey containing an
+ *                       initialized public key
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_ecdh_precomputed_pubkey* secp256k1_ecdh_precomputed_pubkey_create(
+  const secp256k1_context* ctx,
+  const secp256k1_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy an object created by secp256k1_ecdh_precomputed_pubkey_create
+ *
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  In:      pubkey:     object to destroy (can be NULL, in which case nothing happens)
+ */
+SECP256K1_API void secp256k1_ecdh_precomputed_pubkey_destroy(
+  const secp256k1_context* ctx,
+  secp256k1_ecdh_precomputed_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1);
+
+/** Compute an EC Diffie-Hellman secret in constant time, with a precomputed public key
+ *
+ *  The result is the same as that of secp256k1_ecdh with the public key the
+ *  object was created from, but it is faster as the multiples of the public key
+ *  do not need to be computed again on every call.
+ *
+ *  Returns: 1: exponentiation was successful
+ *           0: scalar was invalid (zero or overflow) or hashfp returned 0
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     output:     pointer to an array to be filled by hashfp
+ *  In:      pubkey:     a pointer to a precomputed public key
+ *           seckey:     a 32-byte scalar with which to multiply the point
+ *           hashfp:     pointer to a hash function. If NULL, secp256k1_ecdh_hash_function_sha256 is used
+ *                       (in which case, 32 bytes will be written to output)
+ *           data:       arbitrary data pointer that is passed through to hashfp
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh_precomputed(
+  const secp256k1_context* ctx,
+  unsigned char *output,
+  const secp256k1_ecdh_precomputed_pubkey *pubkey,
+  const unsigned char *seckey,
+  secp256k1_ecdh_hash_function hashfp,
+  void *data
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** A pointer to a function that hashes the X coordinate of an EC point to obtain an
+ *  x-only ECDH secret
+ *
+ *  Returns: 1 if the X coordinate was successfully hashed.
+ *           0 will cause secp256k1_ecdh_xonly to fail and return 0.
+ *           Other return values are not allowed, and the behaviour of
+ *           secp256k1_ecdh_xonly is undefined for other return values.
+ *  Out:     output:     pointer to an array to be filled by the function
+ *  In:      x32:        pointer to a 32-byte x coordinate
+ *           data:       arbitrary data pointer that is passed through
+ */
+typedef int (*secp256k1_ecdh_xonly_hash_function)(
+  unsigned char *output,
+  const unsigned char *x32,
+  void *data
+);
+
+/** An implementation of an x-only ECDH hash function that computes SHA256(x32).
+ *  Populates the output parameter with 32 bytes. */
+SECP256K1_API extern const secp256k1_ecdh_xonly_hash_function secp256k1_ecdh_xonly_hash_function_sha256;
+
+/** A default x-only ECDH hash function (currently equal to
+ *  secp256k1_ecdh_xonly_hash_function_sha256). Populates the output parameter with 32 bytes. */
+SECP256K1_API extern const secp256k1_ecdh_xonly_hash_function secp256k1_ecdh_xonly_hash_function_default;
+
+/** Compute an EC Diffie-Hellman secret in constant time, from an X coordinate
+ *
+ *  The public key is given as a 32-byte X coordinate (as in BIP340 x-only public
+ *  keys), and only the X coordinate of the shared point is computed and hashed.
+ *  As the X coordinate of the shared point does not depend on which of the two
+ *  points with the given X coordinate is meant, the Y coordinate is never needed,
+ *  which avoids computing square roots.
+ *
+ *  Returns: 1: exponentiation was successful
+ *           0: xonly_pubkey32 is not a valid X coordinate, scalar was invalid (zero
+ *              or overflow) or hashfp returned 0
+ *  Args:    ctx:            pointer to a context object (cannot be NULL)
+ *  Out:     output:         pointer to an array to be filled by hashfp
+ *  In:      xonly_pubkey32: pointer to a 32-byte big endian X coordinate of a point
+ *                           on the curve (cannot be NULL)
+ *           seckey:         a 32-byte scalar with which to multiply the point
+ *           hashfp:         pointer to a hash function. If NULL,
+ *                           secp256k1_ecdh_xonly_hash_function_sha256 is used (in
+ *                           which case, 32 bytes will be written to output)
+ *           data:           arbitrary data pointer that is passed through to hashfp
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh_xonly(
+  const secp256k1_context* ctx,
+  unsigned char *output,
+  const unsigned char *xonly_pubkey32,
+  const unsigned char *seckey,
+  secp256k1_ecdh_xonly_hash_function hashfp,
+  void *data
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 #ifdef __cplusplus
 }
 #endif
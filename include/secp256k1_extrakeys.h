@@ -102,6 +102,33 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_from_pubke
     const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4);
 
+/** Serialize the x-only public keys of a range of consecutive public keys.
+ *
+ *  Writes the 32-byte x-only serializations of pubkey, pubkey + G, pubkey +
+ *  2*G, ..., pubkey + (n_pubkeys-1)*G back to back into output, as
+ *  secp256k1_ec_pubkey_scan does for compressed keys. This is the same as
+ *  converting every key with secp256k1_xonly_pubkey_from_pubkey and serializing
+ *  it, but tens of times faster than computing the keys one by one.
+ *
+ *  Returns: 1 if all keys were serialized.
+ *           0 if the arguments are invalid or some key in the range is the point
+ *           at infinity (only if pubkey is -i*G for some i < n_pubkeys). The
+ *           serialization of that key is set to zeros.
+ *
+ *  Args:       ctx: a secp256k1 context object (cannot be NULL)
+ *  Out:     output: pointer to an array of n_pubkeys*32 bytes (cannot be NULL
+ *                   unless n_pubkeys is 0)
+ *  In:      pubkey: pointer to the first public key of the range (cannot be
+ *                   NULL)
+ *        n_pubkeys: the number of keys to serialize (can be 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_scan(
+    const secp256k1_context* ctx,
+    unsigned char *output,
+    const secp256k1_pubkey *pubkey,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
 /** Tweak an x-only public key by adding the generator multiplied with tweak32
  *  to it.
  *
@@ -133,6 +160,40 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_tweak_add(
     const unsigned char *tweak32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Tweak many x-only public keys by adding the generator multiplied with the
+ *  corresponding tweak to each of them.
+ *
+ *  Every output is what secp256k1_xonly_pubkey_tweak_add would compute for the
+ *  corresponding input, but the results are converted to affine coordinates
+ *  together, which is considerably faster than tweaking the keys one by one.
+ *
+ *  Returns: 1 if all output public keys are valid.
+ *           0 if the arguments are invalid or some tweak is invalid or the
+ *           negation of the corresponding secret key.
+ *
+ *  Args:            ctx: pointer to a context object initialized for
+ *                        verification (cannot be NULL)
+ *  Out:  output_pubkeys: pointer to an array of n_pubkeys public keys. The i-th
+ *                        entry is set to the i-th tweaked key, or to an invalid
+ *                        value if tweaking it fails.
+ *               results: pointer to an array of n_pubkeys integers, which are
+ *                        set to 1 for the outputs that are valid and to 0 for
+ *                        the others (can be NULL)
+ *  In: internal_pubkeys: pointer to an array of n_pubkeys pointers to x-only
+ *                        pubkeys to apply the tweaks to
+ *              tweak32s: pointer to an array of n_pubkeys pointers to 32-byte
+ *                        tweaks
+ *             n_pubkeys: the number of keys to tweak (can be 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_tweak_add_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *output_pubkeys,
+    int *results,
+    const secp256k1_xonly_pubkey * const *internal_pubkeys,
+    const unsigned char * const *tweak32s,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1);
+
 /** Checks that a tweaked pubkey is the result of calling
  *  secp256k1_xonly_pubkey_tweak_add with internal_pubkey and tweak32.
  *
@@ -166,6 +227,40 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_tweak_add_
     const unsigned char *tweak32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
 
+/** Checks many tweaked pubkeys as secp256k1_xonly_pubkey_tweak_add_check does.
+ *
+ *  The tweaked keys are recomputed as secp256k1_xonly_pubkey_tweak_add_batch
+ *  does, sharing the conversion to affine coordinates, which makes this faster
+ *  than checking them one by one. Every relation is checked exactly, so the
+ *  results identify the failing ones.
+ *
+ *  Returns: 1 if all tweaked pubkeys are the result of tweaking the
+ *           corresponding internal pubkey with the corresponding tweak.
+ *           0 if the arguments are invalid or some tweaked pubkey is not.
+ *  Args:             ctx: pointer to a context object initialized for
+ *                         verification (cannot be NULL)
+ *  Out:          results: pointer to an array of n integers, which are set to 1
+ *                         for the tweaked pubkeys that pass the check and to 0
+ *                         for the others (can be NULL)
+ *  In: tweaked_pubkey32s: pointer to an array of n pointers to serialized
+ *                         xonly_pubkeys
+ *    tweaked_pk_parities: pointer to an array of the n parities of the tweaked
+ *                         pubkeys
+ *       internal_pubkeys: pointer to an array of n pointers to x-only public
+ *                         key objects to apply the tweaks to
+ *               tweak32s: pointer to an array of n pointers to 32-byte tweaks
+ *                      n: the number of tweaked pubkeys to check (can be 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_tweak_add_check_batch(
+    const secp256k1_context* ctx,
+    int *results,
+    const unsigned char * const *tweaked_pubkey32s,
+    const int *tweaked_pk_parities,
+    const secp256k1_xonly_pubkey * const *internal_pubkeys,
+    const unsigned char * const *tweak32s,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
 /** Compute the keypair for a secret key.
  *
  *  Returns: 1: secret was valid, keypair is ready to use
@@ -180,6 +275,21 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_keypair_create(
     const unsigned char *seckey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Compute the keypair for a secret key with a signing session.
+ *
+ *  Same as secp256k1_keypair_create, but with the blinding value and the
+ *  callbacks of the session instead of those of its context.
+ *
+ *  Args: session: pointer to a signing session (cannot be NULL)
+ *  The other arguments and the return value are as for
+ *  secp256k1_keypair_create.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_keypair_create_with_session(
+    const secp256k1_signing_session* session,
+    secp256k1_keypair *keypair,
+    const unsigned char *seckey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Get the secret key from a keypair.
  *
  *  Returns: 0 if the arguments are invalid. 1 otherwise.
@@ -0,0 +1,437 @@
+#ifndef SECP256K1_MUSIG_H
+#define SECP256K1_MUSIG_H
+
+#include "secp256k1.h"
+#include "secp256k1_extrakeys.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** This module implements MuSig2 multi-signatures compliant with Bitcoin
+ *  Improvement Proposal 327 "MuSig2 for BIP340-compatible Multi-Signatures"
+ *  (https://github.com/bitcoin/bips/blob/master/bip-0327.mediawiki). The
+ *  aggregate signatures are BIP340 Schnorr signatures that can be verified with
+ *  secp256k1_schnorrsig_verify.
+ *
+ *  A signing session goes as follows:
+ *  1. The signers aggregate their public keys with secp256k1_musig_pubkey_agg,
+ *     which also fills a keyagg cache that all later steps use.
+ *  2. Every signer creates a nonce with secp256k1_musig_nonce_gen, or many of
+ *     them ahead of time with secp256k1_musig_nonce_gen_batch, and sends the
+ *     public nonce to the others.
+ *  3. Once the message is known, secp256k1_musig_nonce_agg and
+ *     secp256k1_musig_nonce_process combine the public nonces into a session.
+ *  4. Every signer creates a partial signature with secp256k1_musig_partial_sign.
+ *     This step only needs scalar arithmetic and hashing.
+ *  5. Anyone can check the partial signatures with
+ *     secp256k1_musig_partial_sig_verify and combine them into the final
+ *     signature with secp256k1_musig_partial_sig_agg.
+ *
+ *  A secret nonce must never be used for more than one partial signature, as
+ *  that reveals the secret key. secp256k1_musig_partial_sign therefore clears
+ *  the secret nonce it is given, and secret nonces must not be copied.
+ *
+ *  The structures below are opaque and their layout may change between
+ *  versions of the library. Use the parse and serialize functions to transmit
+ *  them.
+ */
+
+/** Opaque data structure that caches the result of key aggregation.
+ *
+ *  It holds the aggregate public key together with the values needed to
+ *  compute the coefficient of every signer's key, so the aggregation does not
+ *  have to be repeated for every signing session. It can also be used to tweak
+ *  the aggregate key.
+ */
+typedef struct {
+    unsigned char data[166];
+} secp256k1_musig_keyagg_cache;
+
+/** Opaque data structure that holds a signer's secret nonce.
+ *
+ *  It must only be used once, and must not be copied or serialized.
+ */
+typedef struct {
+    unsigned char data[132];
+} secp256k1_musig_secnonce;
+
+/** Opaque data structure that holds a signer's public nonce. */
+typedef struct {
+    unsigned char data[132];
+} secp256k1_musig_pubnonce;
+
+/** Opaque data structure that holds the sum of the public nonces of all
+ *  signers. */
+typedef struct {
+    unsigned char data[132];
+} secp256k1_musig_aggnonce;
+
+/** Opaque data structure that holds the state of a signing session, which is
+ *  derived from the aggregate nonce, the message and the aggregate key. It is
+ *  not secret. */
+typedef struct {
+    unsigned char data[133];
+} secp256k1_musig_session;
+
+/** Opaque data structure that holds a partial signature. */
+typedef struct {
+    unsigned char data[36];
+} secp256k1_musig_partial_sig;
+
+/** Parse a signer's public nonce.
+ *
+ *  Returns: 1 when the nonce could be parsed, 0 otherwise.
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *  Out:   nonce: pointer to a nonce object (cannot be NULL)
+ *  In:     in66: pointer to the 66-byte nonce to be parsed (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_pubnonce_parse(
+    const secp256k1_context* ctx,
+    secp256k1_musig_pubnonce* nonce,
+    const unsigned char *in66
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Serialize a signer's public nonce
+ *
+ *  Returns: 1 when the nonce could be serialized, 0 otherwise
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *  Out:   out66: pointer to a 66-byte array to store the serialized nonce
+ *                (cannot be NULL)
+ *  In:    nonce: pointer to the nonce (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_musig_pubnonce_serialize(
+    const secp256k1_context* ctx,
+    unsigned char *out66,
+    const secp256k1_musig_pubnonce* nonce
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Parse an aggregate public nonce.
+ *
+ *  Returns: 1 when the nonce could be parsed, 0 otherwise.
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *  Out:   nonce: pointer to a nonce object (cannot be NULL)
+ *  In:     in66: pointer to the 66-byte nonce to be parsed (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_aggnonce_parse(
+    const secp256k1_context* ctx,
+    secp256k1_musig_aggnonce* nonce,
+    const unsigned char *in66
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Serialize an aggregate public nonce
+ *
+ *  Returns: 1 when the nonce could be serialized, 0 otherwise
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *  Out:   out66: pointer to a 66-byte array to store the serialized nonce
+ *                (cannot be NULL)
+ *  In:    nonce: pointer to the nonce (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_musig_aggnonce_serialize(
+    const secp256k1_context* ctx,
+    unsigned char *out66,
+    const secp256k1_musig_aggnonce* nonce
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Parse a partial signature.
+ *
+ *  Returns: 1 when the partial signature could be parsed, 0 if it is not a
+ *           valid scalar.
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *  Out:     sig: pointer to a partial signature object (cannot be NULL)
+ *  In:     in32: pointer to the 32-byte partial signature to be parsed (cannot
+ *                be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_partial_sig_parse(
+    const secp256k1_context* ctx,
+    secp256k1_musig_partial_sig* sig,
+    const unsigned char *in32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Serialize a partial signature
+ *
+ *  Returns: 1 when the partial signature could be serialized, 0 otherwise
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *  Out:   out32: pointer to a 32-byte array to store the serialized partial
+ *                signature (cannot be NULL)
+ *  In:      sig: pointer to the partial signature (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_musig_partial_sig_serialize(
+    const secp256k1_context* ctx,
+    unsigned char *out32,
+    const secp256k1_musig_partial_sig* sig
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Compute an aggregate public key from the public keys of the signers
+ *
+ *  The aggregate key is a sum of the public keys weighted with coefficients,
+ *  computed with a single multi-scalar multiplication. The result depends on
+ *  the order of the public keys; secp256k1_ec_pubkey_sort gives a canonical
+ *  order. The same public key may appear more than once.
+ *
+ *  Returns: 1 if the public keys were successfully aggregated, 0 otherwise
+ *  Args:        ctx: pointer to a context object initialized for verification
+ *                    (cannot be NULL)
+ *           scratch: scratch space used for the multi-scalar multiplication
+ *                    (can be NULL, in which case the points are multiplied one
+ *                    at a time)
+ *  Out:      agg_pk: the x-only aggregate public key (can be NULL)
+ *      keyagg_cache: pointer to a keyagg cache that is needed to tweak the
+ *                    aggregate key and to sign (can be NULL)
+ *  In:      pubkeys: array of n_pubkeys pointers to the public keys of the
+ *                    signers (cannot be NULL)
+ *         n_pubkeys: the number of public keys (must be greater than 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_pubkey_agg(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_xonly_pubkey *agg_pk,
+    secp256k1_musig_keyagg_cache *keyagg_cache,
+    const secp256k1_pubkey * const* pubkeys,
+    size_t n_pubkeys
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(5);
+
+/** Obtain the aggregate public key from a keyagg cache, including its parity
+ *  and all tweaks applied to it.
+ *
+ *  Returns: 1 if the cache is valid, 0 otherwise
+ *  Args:        ctx: pointer to a context object (cannot be NULL)
+ *  Out:      agg_pk: the aggregate public key (cannot be NULL)
+ *  In:  keyagg_cache: pointer to a keyagg cache filled by
+ *                    secp256k1_musig_pubkey_agg (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_pubkey_get(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *agg_pk,
+    const secp256k1_musig_keyagg_cache *keyagg_cache
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Apply an ordinary "EC" tweak to the aggregate public key in a keyagg cache
+ *
+ *  This is the equivalent of secp256k1_ec_pubkey_tweak_add for the aggregate
+ *  key, as used for example in BIP32 derivation. Signatures created with the
+ *  updated cache are valid for the tweaked key.
+ *
+ *  Returns: 0 if the arguments are invalid or the resulting public key would be
+ *           invalid (only when the tweak is the negation of the corresponding
+ *           secret key). 1 otherwise.
+ *  Args:           ctx: pointer to a context object initialized for
+ *                       verification (cannot be NULL)
+ *  Out:  output_pubkey: the tweaked aggregate public key (can be NULL)
+ *  In/Out: keyagg_cache: pointer to a keyagg cache (cannot be NULL)
+ *  In:          tweak32: pointer to a 32-byte tweak (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_pubkey_ec_tweak_add(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *output_pubkey,
+    secp256k1_musig_keyagg_cache *keyagg_cache,
+    const unsigned char *tweak32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Apply an x-only tweak to the aggregate public key in a keyagg cache
+ *
+ *  This is the equivalent of secp256k1_xonly_pubkey_tweak_add for the
+ *  aggregate key, as used for example for Taproot outputs. Signatures created
+ *  with the updated cache are valid for the tweaked key.
+ *
+ *  Returns: 0 if the arguments are invalid or the resulting public key would be
+ *           invalid (only when the tweak is the negation of the corresponding
+ *           secret key). 1 otherwise.
+ *  Args:           ctx: pointer to a context object initialized for
+ *                       verification (cannot be NULL)
+ *  Out:  output_pubkey: the tweaked aggregate public key (can be NULL)
+ *  In/Out: keyagg_cache: pointer to a keyagg cache (cannot be NULL)
+ *  In:          tweak32: pointer to a 32-byte tweak (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_pubkey_xonly_tweak_add(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *output_pubkey,
+    secp256k1_musig_keyagg_cache *keyagg_cache,
+    const unsigned char *tweak32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Create a nonce for a signing session
+ *
+ *  The optional arguments are mixed into the nonce derivation. They do not
+ *  need to be given, but each of them that is given adds protection in case
+ *  session_secrand32 is not as random as it should be.
+ *
+ *  Returns: 0 if the arguments are invalid, 1 otherwise
+ *  Args:         ctx: pointer to a context object initialized for signing
+ *                     (cannot be NULL)
+ *  Out:     secnonce: pointer to a structure to store the secret nonce (cannot
+ *                     be NULL)
+ *           pubnonce: pointer to a structure to store the public nonce (cannot
+ *                     be NULL)
+ *  In/Out: session_secrand32: 32 bytes of fresh randomness that must never be
+ *                     used again (cannot be NULL or all zero). It is cleared
+ *                     so that it is not used again by accident.
+ *  In:        seckey: the 32-byte secret key that will be used for signing, if
+ *                     already known (can be NULL)
+ *             pubkey: the public key of the signer (cannot be NULL)
+ *              msg32: the 32-byte message that will be signed, if already
+ *                     known (can be NULL)
+ *       keyagg_cache: the keyagg cache of the signing session, if already
+ *                     available (can be NULL)
+ *      extra_input32: 32 bytes of further input (can be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_nonce_gen(
+    const secp256k1_context* ctx,
+    secp256k1_musig_secnonce *secnonce,
+    secp256k1_musig_pubnonce *pubnonce,
+    unsigned char *session_secrand32,
+    const unsigned char *seckey,
+    const secp256k1_pubkey *pubkey,
+    const unsigned char *msg32,
+    const secp256k1_musig_keyagg_cache *keyagg_cache,
+    const unsigned char *extra_input32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(6);
+
+/** Create many nonces ahead of the signing sessions that use them
+ *
+ *  Creates the same nonces as calling secp256k1_musig_nonce_gen for each
+ *  session_secrand32 with msg32 set to NULL, but is faster because the public
+ *  nonces are converted to affine coordinates together. Pregenerating nonces
+ *  this way leaves only scalar arithmetic and hashing for
+ *  secp256k1_musig_partial_sign once the message is known.
+ *
+ *  Returns: 0 if the arguments are invalid, 1 otherwise
+ *  Args:          ctx: pointer to a context object initialized for signing
+ *                      (cannot be NULL)
+ *  Out:     secnonces: array of n_nonces secret nonces (can only be NULL if
+ *                      n_nonces is 0)
+ *           pubnonces: array of n_nonces public nonces (can only be NULL if
+ *                      n_nonces is 0)
+ *  In/Out: session_secrand32s: array of n_nonces pointers to 32 bytes of fresh
+ *                      randomness, as session_secrand32 of
+ *                      secp256k1_musig_nonce_gen (can only be NULL if n_nonces
+ *                      is 0)
+ *  In:         seckey: as in secp256k1_musig_nonce_gen (can be NULL)
+ *              pubkey: as in secp256k1_musig_nonce_gen (cannot be NULL)
+ *        keyagg_cache: as in secp256k1_musig_nonce_gen (can be NULL)
+ *       extra_input32: as in secp256k1_musig_nonce_gen (can be NULL)
+ *            n_nonces: the number of nonces to create
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_nonce_gen_batch(
+    const secp256k1_context* ctx,
+    secp256k1_musig_secnonce *secnonces,
+    secp256k1_musig_pubnonce *pubnonces,
+    unsigned char * const *session_secrand32s,
+    const unsigned char *seckey,
+    const secp256k1_pubkey *pubkey,
+    const secp256k1_musig_keyagg_cache *keyagg_cache,
+    const unsigned char *extra_input32,
+    size_t n_nonces
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(6);
+
+/** Aggregate the public nonces of all signers
+ *
+ *  Returns: 0 if the arguments are invalid, 1 otherwise
+ *  Args:        ctx: pointer to a context object (cannot be NULL)
+ *  Out:    aggnonce: pointer to a structure to store the aggregate nonce
+ *                    (cannot be NULL)
+ *  In:    pubnonces: array of n_pubnonces pointers to public nonces (cannot be
+ *                    NULL)
+ *       n_pubnonces: the number of public nonces (must be greater than 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_nonce_agg(
+    const secp256k1_context* ctx,
+    secp256k1_musig_aggnonce *aggnonce,
+    const secp256k1_musig_pubnonce * const* pubnonces,
+    size_t n_pubnonces
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Start a signing session from the aggregate nonce and the message
+ *
+ *  Returns: 0 if the arguments are invalid, 1 otherwise
+ *  Args:        ctx: pointer to a context object initialized for verification
+ *                    (cannot be NULL)
+ *  Out:     session: pointer to a structure to store the session (cannot be
+ *                    NULL)
+ *  In:     aggnonce: pointer to the aggregate nonce (cannot be NULL)
+ *             msg32: the 32-byte message to sign (cannot be NULL)
+ *      keyagg_cache: pointer to the keyagg cache of the signers, after all
+ *                    tweaks have been applied (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_nonce_process(
+    const secp256k1_context* ctx,
+    secp256k1_musig_session *session,
+    const secp256k1_musig_aggnonce *aggnonce,
+    const unsigned char *msg32,
+    const secp256k1_musig_keyagg_cache *keyagg_cache
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
+/** Create a partial signature
+ *
+ *  The secret nonce is cleared, even if the function fails, so that it cannot
+ *  be used again. Nonce and key must belong to the same signer.
+ *
+ *  Returns: 0 if the arguments are invalid or the secret nonce was not created
+ *           for the public key of the keypair, 1 otherwise
+ *  Args:         ctx: pointer to a context object (cannot be NULL)
+ *  Out:  partial_sig: pointer to a structure to store the partial signature
+ *                     (cannot be NULL)
+ *  In/Out:  secnonce: pointer to the secret nonce (cannot be NULL)
+ *  In:       keypair: pointer to the keypair of the signer (cannot be NULL)
+ *       keyagg_cache: pointer to the keyagg cache (cannot be NULL)
+ *            session: pointer to the session (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_partial_sign(
+    const secp256k1_context* ctx,
+    secp256k1_musig_partial_sig *partial_sig,
+    secp256k1_musig_secnonce *secnonce,
+    const secp256k1_keypair *keypair,
+    const secp256k1_musig_keyagg_cache *keyagg_cache,
+    const secp256k1_musig_session *session
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
+/** Verify a partial signature of one signer
+ *
+ *  It is not necessary to verify the partial signatures to obtain a valid
+ *  final signature, but it tells which signer misbehaved if the final
+ *  signature turns out to be invalid.
+ *
+ *  Returns: 1 if the partial signature is valid, 0 otherwise
+ *  Args:         ctx: pointer to a context object initialized for verification
+ *                     (cannot be NULL)
+ *  In:   partial_sig: pointer to the partial signature (cannot be NULL)
+ *           pubnonce: pointer to the public nonce of the signer (cannot be
+ *                     NULL)
+ *             pubkey: pointer to the public key of the signer (cannot be NULL)
+ *       keyagg_cache: pointer to the keyagg cache (cannot be NULL)
+ *            session: pointer to the session (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_partial_sig_verify(
+    const secp256k1_context* ctx,
+    const secp256k1_musig_partial_sig *partial_sig,
+    const secp256k1_musig_pubnonce *pubnonce,
+    const secp256k1_pubkey *pubkey,
+    const secp256k1_musig_keyagg_cache *keyagg_cache,
+    const secp256k1_musig_session *session
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
+/** Combine the partial signatures of all signers into a Schnorr signature
+ *
+ *  Returns: 0 if the arguments are invalid, 1 otherwise (which does not mean
+ *           that the signature is valid)
+ *  Args:         ctx: pointer to a context object (cannot be NULL)
+ *  Out:        sig64: pointer to a 64-byte array to store the signature (cannot
+ *                     be NULL)
+ *  In:       session: pointer to the session (cannot be NULL)
+ *       partial_sigs: array of n_sigs pointers to partial signatures (cannot be
+ *                     NULL)
+ *             n_sigs: the number of partial signatures (must be greater than 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_partial_sig_agg(
+    const secp256k1_context* ctx,
+    unsigned char *sig64,
+    const secp256k1_musig_session *session,
+    const secp256k1_musig_partial_sig * const* partial_sigs,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_MUSIG_H */
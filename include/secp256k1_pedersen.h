@@ -0,0 +1,213 @@
+#ifndef SECP256K1_PEDERSEN_H
+#define SECP256K1_PEDERSEN_H
+
+#include <stdint.h>
+
+#include "secp256k1.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** This module implements Pedersen commitments to 64-bit values.
+ *
+ *  A commitment to the value v with the blinding factor r is the point
+ *  C = r*G + v*H, where H is a second generator whose discrete logarithm with
+ *  respect to G is unknown. H is the point whose X coordinate is the SHA256
+ *  hash of the uncompressed serialization of G, with an even Y coordinate.
+ *
+ *  Commitments are additively homomorphic: the sum of commitments is a
+ *  commitment to the sum of the values with the sum of the blinding factors.
+ *  secp256k1_pedersen_verify_tally uses this to check that a set of inputs
+ *  and outputs balance without learning the values.
+ */
+
+/** Opaque data structure that holds a parsed Pedersen commitment.
+ *
+ *  The exact representation of data inside is implementation defined and not
+ *  guaranteed to be portable between different platforms or versions. It is
+ *  however guaranteed to be 64 bytes in size, and can be safely copied/moved.
+ *  If you need to convert to a format suitable for storage or transmission,
+ *  use secp256k1_pedersen_commitment_serialize and
+ *  secp256k1_pedersen_commitment_parse.
+ */
+typedef struct {
+    unsigned char data[64];
+} secp256k1_pedersen_commitment;
+
+/** Opaque data structure that holds precomputed multiples of the generator H,
+ *  for computing many commitments.
+ *
+ *  Create it with secp256k1_pedersen_h_table_create and release it with
+ *  secp256k1_pedersen_h_table_destroy. It occupies about 16 kB of memory and
+ *  is never modified after creation, so it can be used from several threads at
+ *  the same time.
+ */
+typedef struct secp256k1_pedersen_h_table_struct secp256k1_pedersen_h_table;
+
+/** Parse a 33-byte commitment into a commitment object.
+ *
+ *  The serialization is the X coordinate of the point prefixed by the byte
+ *  0x08 if the Y coordinate is a quadratic residue and 0x09 if it is not, as
+ *  in secp256k1-zkp.
+ *
+ *  Returns: 1 if the commitment was fully valid.
+ *           0 if the commitment could not be parsed or is invalid.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     commit:     pointer to a commitment object. If 1 is returned, it is
+ *                       set to a parsed version of input. If not, its value is
+ *                       undefined.
+ *  In:      input:      pointer to a 33-byte serialized commitment
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_commitment_parse(
+    const secp256k1_context* ctx,
+    secp256k1_pedersen_commitment* commit,
+    const unsigned char *input
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Parse many 33-byte commitments into commitment objects.
+ *
+ *  Every commitment is parsed as secp256k1_pedersen_commitment_parse would,
+ *  but several are decompressed at a time, which is faster than parsing them
+ *  one by one.
+ *
+ *  Returns: 1 if all commitments were fully valid.
+ *           0 if some commitment could not be parsed or is invalid.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     commits:    pointer to an array of n_commits commitment objects.
+ *                       commits[i] is set to a parsed version of the i-th
+ *                       commitment if it is valid. If not, its value is
+ *                       undefined.
+ *           results:    pointer to an array of n_commits integers, which are
+ *                       set to 1 for the commitments that are valid and to 0
+ *                       for the others (can be NULL).
+ *  In:      input:      pointer to n_commits serialized commitments of 33 bytes
+ *                       each, stored back to back
+ *           n_commits:  the number of commitments (can be 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_commitment_parse_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pedersen_commitment* commits,
+    int *results,
+    const unsigned char *input,
+    size_t n_commits
+) SECP256K1_ARG_NONNULL(1);
+
+/** Serialize a commitment object into 33 bytes.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     output:     pointer to a 33-byte array to place the serialized
+ *                       commitment in
+ *  In:      commit:     pointer to a commitment object
+ */
+SECP256K1_API int secp256k1_pedersen_commitment_serialize(
+    const secp256k1_context* ctx,
+    unsigned char *output,
+    const secp256k1_pedersen_commitment* commit
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Precompute multiples of the generator H for use with
+ *  secp256k1_pedersen_commit
+ *
+ *  The memory is obtained from the allocator of ctx (see
+ *  secp256k1_context_create_with_allocator), or from malloc if it has none. The
+ *  object remembers the allocator, so it is released through it even if
+ *  secp256k1_pedersen_h_table_destroy is called with another context.
+ *
+ *  Returns: a newly created object.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_pedersen_h_table* secp256k1_pedersen_h_table_create(
+    const secp256k1_context* ctx
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy an object created by secp256k1_pedersen_h_table_create
+ *
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  In:      table:      object to destroy (can be NULL, in which case nothing happens)
+ */
+SECP256K1_API void secp256k1_pedersen_h_table_destroy(
+    const secp256k1_context* ctx,
+    secp256k1_pedersen_h_table *table
+) SECP256K1_ARG_NONNULL(1);
+
+/** Compute a Pedersen commitment in constant time.
+ *
+ *  The commitment is blind*G + value*H. Without a table, value*H is computed
+ *  with a constant-time point multiplication, which is several times slower.
+ *
+ *  Returns: 1 if the commitment was computed.
+ *           0 if the blinding factor is invalid (overflow) or both the
+ *             blinding factor and the value are zero.
+ *  Args:    ctx:        pointer to a context object, initialized for signing
+ *                       (cannot be NULL)
+ *  Out:     commit:     pointer to the resulting commitment
+ *  In:      table:      pointer to a table created with
+ *                       secp256k1_pedersen_h_table_create (can be NULL)
+ *           blind:      pointer to a 32-byte blinding factor
+ *           value:      the value to commit to
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_commit(
+    const secp256k1_context* ctx,
+    secp256k1_pedersen_commitment *commit,
+    const secp256k1_pedersen_h_table *table,
+    const unsigned char *blind,
+    uint64_t value
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4);
+
+/** Compute the sum of blinding factors, with some of them negated.
+ *
+ *  The result is the sum of the first npositive blinding factors minus the sum
+ *  of the others, modulo the group order. The blinding factor of the excess
+ *  of secp256k1_pedersen_verify_tally is computed with the inputs first.
+ *
+ *  Returns: 1 if the sum was computed.
+ *           0 if a blinding factor is invalid (overflow).
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     blind_out:  pointer to a 32-byte array for the sum
+ *  In:      blinds:     array of n pointers to 32-byte blinding factors
+ *           n:          the number of blinding factors
+ *           npositive:  how many of the blinding factors are added (at most n)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_blind_sum(
+    const secp256k1_context* ctx,
+    unsigned char *blind_out,
+    const unsigned char * const *blinds,
+    size_t n,
+    size_t npositive
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Verify that the inputs minus the outputs equal the excess.
+ *
+ *  Checks sum(inputs) - sum(outputs) - excess = 0 by adding up the points. If the input values equal the output values, the excess is
+ *  a commitment to zero with the difference of the blinding factors (see
+ *  secp256k1_pedersen_blind_sum); an excess that commits to a non-zero value
+ *  accounts for, for example, a fee.
+ *
+ *  Returns: 1 if the commitments balance.
+ *           0 otherwise.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  In:      inputs:     array of n_inputs pointers to commitments (can be NULL
+ *                       if n_inputs is 0)
+ *           n_inputs:   the number of inputs
+ *           outputs:    array of n_outputs pointers to commitments (can be NULL
+ *                       if n_outputs is 0)
+ *           n_outputs:  the number of outputs
+ *           excess:     pointer to the excess commitment (can be NULL, in which
+ *                       case the inputs must equal the outputs)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_verify_tally(
+    const secp256k1_context* ctx,
+    const secp256k1_pedersen_commitment * const *inputs,
+    size_t n_inputs,
+    const secp256k1_pedersen_commitment * const *outputs,
+    size_t n_outputs,
+    const secp256k1_pedersen_commitment *excess
+) SECP256K1_ARG_NONNULL(1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_PEDERSEN_H */
@@ -27,7 +27,8 @@ extern "C" {
  *  caller-provided memory.
  *
  *  The purpose of this function is to determine how much memory must be provided
- *  to secp256k1_context_preallocated_create.
+ *  to secp256k1_context_preallocated_create. The tables that make up most of
+ *  this size are described at secp256k1_context_create.
  *
  *  Returns: the required size of the caller-provided memory block
  *  In:      flags:    which parts of the context to initialize.
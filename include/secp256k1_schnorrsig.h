@@ -123,6 +123,23 @@ SECP256K1_API int secp256k1_schnorrsig_sign(
     unsigned char *aux_rand32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Create a Schnorr signature with a signing session.
+ *
+ *  Same as secp256k1_schnorrsig_sign, but with the blinding value and the
+ *  callbacks of the session instead of those of its context.
+ *
+ *  Args: session: pointer to a signing session (cannot be NULL)
+ *  The other arguments and the return value are as for
+ *  secp256k1_schnorrsig_sign.
+ */
+SECP256K1_API int secp256k1_schnorrsig_sign_with_session(
+    const secp256k1_signing_session* session,
+    unsigned char *sig64,
+    const unsigned char *msg32,
+    const secp256k1_keypair *keypair,
+    unsigned char *aux_rand32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Create a Schnorr signature with a more flexible API.
  *
  *  Same arguments as secp256k1_schnorrsig_sign except that it allows signing
@@ -145,6 +162,35 @@ SECP256K1_API int secp256k1_schnorrsig_sign_custom(
     secp256k1_schnorrsig_extraparams *extraparams
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
 
+/** Create Schnorr signatures on many messages with the same keypair.
+ *
+ *  Creates the same signatures as calling secp256k1_schnorrsig_sign for each
+ *  message, but is faster: the keypair is loaded once, and all nonce points are
+ *  converted to affine coordinates together.
+ *
+ *  Returns 1 if all signatures were created, 0 on failure. Signatures that could
+ *  not be created are zeroed.
+ *  Args:     ctx: pointer to a context object, initialized for signing (cannot
+ *                 be NULL)
+ *  Out:   sig64s: array of n_sigs pointers to 64-byte arrays to store the
+ *                 serialized signatures (can only be NULL if n_sigs is 0)
+ *  In:    msg32s: array of n_sigs pointers to the 32-byte messages being signed
+ *                 (can only be NULL if n_sigs is 0)
+ *        keypair: pointer to an initialized keypair (cannot be NULL)
+ *    aux_rand32s: array of n_sigs pointers to 32 bytes of fresh randomness, as
+ *                 aux_rand32 of secp256k1_schnorrsig_sign. Both the array and
+ *                 its entries can be NULL.
+ *         n_sigs: the number of messages
+ */
+SECP256K1_API int secp256k1_schnorrsig_sign_batch(
+    const secp256k1_context* ctx,
+    unsigned char * const *sig64s,
+    const unsigned char * const *msg32s,
+    const secp256k1_keypair *keypair,
+    unsigned char * const *aux_rand32s,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(4);
+
 /** Verify a Schnorr signature.
  *
  *  Returns: 1: correct signature
@@ -163,6 +209,32 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify(
     const secp256k1_xonly_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
 
+/** Verify a Schnorr signature, using a cache of valid signatures.
+ *
+ *  The same as secp256k1_schnorrsig_verify, but with a cache as for
+ *  secp256k1_ecdsa_verify_cached (see there for the meaning of erase).
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect signature
+ *  Args:    ctx: a secp256k1 context object, initialized for verification.
+ *         cache: pointer to a signature cache (cannot be NULL)
+ *  In:    sig64: pointer to the 64-byte signature to verify (cannot be NULL)
+ *           msg: the message being verified. Can only be NULL if msglen is 0.
+ *        msglen: length of the message
+ *        pubkey: pointer to an x-only public key to verify with (cannot be NULL)
+ *         erase: whether to remove the signature from the cache if it is found
+ *                (and to not add it otherwise)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_cached(
+    const secp256k1_context* ctx,
+    secp256k1_signature_cache *cache,
+    const unsigned char *sig64,
+    const unsigned char *msg,
+    size_t msglen,
+    const secp256k1_xonly_pubkey *pubkey,
+    int erase
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(6);
+
 #ifdef __cplusplus
 }
 #endif
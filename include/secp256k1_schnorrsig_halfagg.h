@@ -0,0 +1,127 @@
+#ifndef SECP256K1_SCHNORRSIG_HALFAGG_H
+#define SECP256K1_SCHNORRSIG_HALFAGG_H
+
+#include "secp256k1.h"
+#include "secp256k1_extrakeys.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** This module implements half-aggregation of BIP340 Schnorr signatures on
+ *  32-byte messages, following the draft "Half-Aggregation of BIP 340
+ *  Signatures" (https://github.com/BlockstreamResearch/cross-input-aggregation).
+ *
+ *  An aggregate of n signatures (R_i, s_i) is the 32*(n+1) byte string
+ *  R_0 || ... || R_{n-1} || s with s = sum z_i*s_i, where z_0 = 1 and the other
+ *  factors z_i are hashes of all signatures, public keys and messages up to the
+ *  i-th. Anyone can aggregate signatures without knowing the secret keys, and
+ *  signatures can be added to an aggregate as they arrive. An aggregate is
+ *  checked with a single multi-scalar multiplication over all R_i and public
+ *  keys, which is considerably faster than verifying the signatures one by one.
+ *
+ *  Aggregation is not a secret operation and is not constant time.
+ */
+
+/** The length of an aggregate of n signatures. The caller is responsible for
+ *  making sure that n is small enough for the result not to overflow. */
+#define SECP256K1_SCHNORRSIG_AGGSIG_LEN(n) (32 * ((n) + 1))
+
+/** Add signatures to an aggregate.
+ *
+ *  The aggregate of the first n_before signatures is extended by n_new more.
+ *  Since the factors depend on all earlier signatures, the public keys and
+ *  messages of the earlier signatures must be given again, in the same order.
+ *
+ *  Returns: 1 if the signatures were added.
+ *           0 if the arguments are invalid, aggsig_len is too small, the
+ *             aggregate is malformed or some S value of new_sigs64 is not
+ *             smaller than the group order. Then aggsig is unchanged.
+ *  Args:          ctx: pointer to a context object (cannot be NULL)
+ *  In/Out:     aggsig: pointer to an aggregate of the first n_before signatures,
+ *                      of length SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_before).
+ *                      Replaced by the aggregate of all n_before + n_new
+ *                      signatures.
+ *          aggsig_len: pointer to the size of the aggsig buffer. Set to the
+ *                      length of the new aggregate.
+ *  In:    all_pubkeys: array of n_before + n_new pointers to the public keys
+ *                      of all signatures
+ *          all_msgs32: array of n_before + n_new pointers to the 32-byte messages
+ *                      of all signatures
+ *          new_sigs64: array of n_new pointers to the 64-byte signatures to add
+ *            n_before: the number of signatures in the aggregate
+ *               n_new: the number of signatures to add
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_inc_aggregate(
+    const secp256k1_context* ctx,
+    unsigned char *aggsig,
+    size_t *aggsig_len,
+    const secp256k1_xonly_pubkey * const *all_pubkeys,
+    const unsigned char * const *all_msgs32,
+    const unsigned char * const *new_sigs64,
+    size_t n_before,
+    size_t n_new
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Aggregate signatures.
+ *
+ *  Equivalent to secp256k1_schnorrsig_inc_aggregate with n_before = 0 on the
+ *  empty aggregate of 32 zero bytes.
+ *
+ *  Returns: 1 if the signatures were aggregated.
+ *           0 if the arguments are invalid, aggsig_len is too small or some S
+ *             value of sigs64 is not smaller than the group order.
+ *  Args:          ctx: pointer to a context object (cannot be NULL)
+ *  Out:        aggsig: pointer to a buffer for the aggregate
+ *  In/Out: aggsig_len: pointer to the size of the aggsig buffer. Set to
+ *                      SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_sigs).
+ *  In:        pubkeys: array of n_sigs pointers to the public keys
+ *              msgs32: array of n_sigs pointers to the 32-byte messages
+ *              sigs64: array of n_sigs pointers to the 64-byte signatures
+ *              n_sigs: the number of signatures
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_aggregate(
+    const secp256k1_context* ctx,
+    unsigned char *aggsig,
+    size_t *aggsig_len,
+    const secp256k1_xonly_pubkey * const *pubkeys,
+    const unsigned char * const *msgs32,
+    const unsigned char * const *sigs64,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Verify an aggregate of signatures.
+ *
+ *  The aggregate is checked with one multi-scalar multiplication over its 2n
+ *  points. Without a scratch space it falls back to a separate multiplication
+ *  per point, which is slower than verifying the signatures one by one, so
+ *  pass one that fits all points (e.g. 2 MB for 2000 signatures).
+ *
+ *  Returns: 1 if the aggregate is valid for the given public keys and messages.
+ *           0 if the arguments are invalid or the aggregate is not valid.
+ *  Args:      ctx: pointer to a context object, initialized for verification
+ *                  (cannot be NULL)
+ *         scratch: scratch space used for the multi-scalar multiplication (can
+ *                  be NULL)
+ *  In:    pubkeys: array of n_sigs pointers to the public keys
+ *          msgs32: array of n_sigs pointers to the 32-byte messages
+ *          n_sigs: the number of signatures
+ *          aggsig: pointer to the aggregate
+ *      aggsig_len: the length of aggsig, which must be
+ *                  SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_sigs)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_aggverify(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    const secp256k1_xonly_pubkey * const *pubkeys,
+    const unsigned char * const *msgs32,
+    size_t n_sigs,
+    const unsigned char *aggsig,
+    size_t aggsig_len
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(6);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_SCHNORRSIG_HALFAGG_H */
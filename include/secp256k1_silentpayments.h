@@ -0,0 +1,136 @@
+#ifndef SECP256K1_SILENTPAYMENTS_H
+#define SECP256K1_SILENTPAYMENTS_H
+
+#include "secp256k1.h"
+#include "secp256k1_extrakeys.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** This module implements the receiving side of silent payments as specified
+ *  in BIP352 (https://github.com/bitcoin/bips/blob/master/bip-0352.mediawiki),
+ *  without labels.
+ *
+ *  A recipient publishes a scan public key B_scan and a spend public key
+ *  B_spend. The sender of a transaction with inputs summing to A derives the
+ *  shared secret S = input_hash*a*B_scan = input_hash*b_scan*A and pays to the
+ *  outputs P_k = B_spend + t_k*G with t_k = hash_BIP0352/SharedSecret(S || k)
+ *  for k = 0, 1, ... The recipient finds them by computing S for every
+ *  transaction and comparing the P_k with the outputs of the transaction.
+ *
+ *  The public data of a transaction (A and input_hash) only depends on the
+ *  transaction and can be shared between recipients, for example by an index
+ *  server. secp256k1_silentpayments_recipient_scan_block scans the transactions
+ *  of a whole block at once.
+ */
+
+/** Opaque data structure that holds the public data of a transaction that a
+ *  recipient needs for scanning: the sum A of the public keys of the eligible
+ *  inputs and the input hash.
+ *
+ *  The exact representation of data inside is implementation defined and not
+ *  guaranteed to be portable between different platforms or versions. It can
+ *  be safely copied/moved. It is created with
+ *  secp256k1_silentpayments_recipient_public_data_create.
+ */
+typedef struct {
+    unsigned char data[100];
+} secp256k1_silentpayments_public_data;
+
+/** A transaction to be scanned. */
+typedef struct {
+    /** The public data of the transaction. */
+    const secp256k1_silentpayments_public_data *public_data;
+    /** Array of n_outputs pointers to the x-only public keys of the taproot
+     *  outputs of the transaction. */
+    const secp256k1_xonly_pubkey * const *outputs;
+    size_t n_outputs;
+} secp256k1_silentpayments_recipient_tx;
+
+/** An output found by scanning. */
+typedef struct {
+    /** The output public key P_k. */
+    secp256k1_xonly_pubkey output;
+    /** The tweak t_k. The secret key of the output is b_spend + t_k, negated
+     *  if B_spend + t_k*G has an odd Y coordinate. */
+    unsigned char tweak[32];
+    /** The position of the transaction in the txs array. */
+    size_t tx_index;
+    /** The position of the output in the outputs of the transaction. */
+    size_t output_index;
+} secp256k1_silentpayments_found_output;
+
+/** Compute the public data of a transaction.
+ *
+ *  The eligible inputs of a transaction are given by their public keys. Keys of
+ *  taproot inputs are x-only and are taken with an even Y coordinate; the keys
+ *  of the other input types are passed as full public keys.
+ *
+ *  Returns: 1 if the public data was computed.
+ *           0 if the arguments are invalid, there are no inputs, the public keys
+ *             sum to the point at infinity or the input hash is not a valid
+ *             scalar.
+ *  Args:                 ctx: pointer to a context object (cannot be NULL)
+ *  Out:          public_data: pointer to the resulting public data
+ *  In:   outpoint_smallest36: pointer to the lexicographically smallest 36-byte
+ *                             serialized outpoint (txid || vout) of all inputs
+ *              xonly_pubkeys: array of n_xonly pointers to the x-only public
+ *                             keys of the taproot inputs (can be NULL if n_xonly
+ *                             is 0)
+ *                    n_xonly: the number of taproot inputs
+ *              plain_pubkeys: array of n_plain pointers to the public keys of
+ *                             the other inputs (can be NULL if n_plain is 0)
+ *                    n_plain: the number of other inputs
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_silentpayments_recipient_public_data_create(
+    const secp256k1_context* ctx,
+    secp256k1_silentpayments_public_data *public_data,
+    const unsigned char *outpoint_smallest36,
+    const secp256k1_xonly_pubkey * const *xonly_pubkeys,
+    size_t n_xonly,
+    const secp256k1_pubkey * const *plain_pubkeys,
+    size_t n_plain
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Scan transactions for outputs to a recipient.
+ *
+ *  The shared secrets of many transactions are computed together, which
+ *  shares the cost of converting the points to affine coordinates, and the
+ *  outputs of every transaction are looked up in a hash table instead of being
+ *  serialized and compared one by one. The cost per transaction is still
+ *  dominated by one constant-time point multiplication.
+ *
+ *  The found outputs are written in order of the transactions and, within a
+ *  transaction, in order of k.
+ *
+ *  Returns: 1 if the transactions were scanned.
+ *           0 if the arguments are invalid, the scan key is invalid or more
+ *             than the given number of outputs were found. In the latter case
+ *             found_outputs holds the first ones.
+ *  Args:               ctx: pointer to a context object, initialized for
+ *                           verification (cannot be NULL)
+ *  Out:      found_outputs: array of *n_found_outputs found outputs (can be
+ *                           NULL if *n_found_outputs is 0)
+ *  In/Out: n_found_outputs: pointer to the number of elements of
+ *                           found_outputs. Set to the number of found outputs.
+ *  In:                 txs: array of n_txs pointers to the transactions
+ *                    n_txs: the number of transactions
+ *               scan_key32: pointer to the 32-byte secret scan key b_scan
+ *             spend_pubkey: pointer to the spend public key B_spend
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_silentpayments_recipient_scan_block(
+    const secp256k1_context* ctx,
+    secp256k1_silentpayments_found_output *found_outputs,
+    size_t *n_found_outputs,
+    const secp256k1_silentpayments_recipient_tx * const *txs,
+    size_t n_txs,
+    const unsigned char *scan_key32,
+    const secp256k1_pubkey *spend_pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_SILENTPAYMENTS_H */
@@ -14,6 +14,8 @@
 typedef struct {
     secp256k1_context *ctx;
     secp256k1_pubkey point;
+    secp256k1_ecdh_precomputed_pubkey *prec;
+    unsigned char xonly_point[32];
     unsigned char scalar[32];
 } bench_ecdh_data;
 
@@ -32,6 +34,7 @@ static void bench_ecdh_setup(void* arg) {
         data->scalar[i] = i + 1;
     }
     CHECK(secp256k1_ec_pubkey_parse(data->ctx, &data->point, point, sizeof(point)) == 1);
+    memcpy(data->xonly_point, point + 1, 32);
 }
 
 static void bench_ecdh(void* arg, int iters) {
@@ -44,6 +47,46 @@ static void bench_ecdh(void* arg, int iters) {
     }
 }
 
+static void bench_ecdh_precomputed(void* arg, int iters) {
+    int i;
+    unsigned char res[32];
+    bench_ecdh_data *data = (bench_ecdh_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_ecdh_precomputed(data->ctx, res, data->prec, data->scalar, NULL, NULL) == 1);
+    }
+}
+
+/* Reports the time per public key, for batches of BENCH_ECDH_BATCH_SIZE keys. */
+#define BENCH_ECDH_BATCH_SIZE 32
+
+static void bench_ecdh_batch(void* arg, int iters) {
+    int i, j;
+    unsigned char res[BENCH_ECDH_BATCH_SIZE][32];
+    unsigned char *outputs[BENCH_ECDH_BATCH_SIZE];
+    const secp256k1_pubkey *points[BENCH_ECDH_BATCH_SIZE];
+    bench_ecdh_data *data = (bench_ecdh_data*)arg;
+
+    for (j = 0; j < BENCH_ECDH_BATCH_SIZE; j++) {
+        outputs[j] = res[j];
+        points[j] = &data->point;
+    }
+    for (i = 0; i < iters; i += BENCH_ECDH_BATCH_SIZE) {
+        size_t n = iters - i < BENCH_ECDH_BATCH_SIZE ? iters - i : BENCH_ECDH_BATCH_SIZE;
+        CHECK(secp256k1_ecdh_batch(data->ctx, outputs, points, n, data->scalar, NULL, NULL) == 1);
+    }
+}
+
+static void bench_ecdh_xonly(void* arg, int iters) {
+    int i;
+    unsigned char res[32];
+    bench_ecdh_data *data = (bench_ecdh_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_ecdh_xonly(data->ctx, res, data->xonly_point, data->scalar, NULL, NULL) == 1);
+    }
+}
+
 int main(void) {
     bench_ecdh_data data;
 
@@ -53,6 +96,13 @@ int main(void) {
     data.ctx = secp256k1_context_create(SECP256K1_FLAGS_TYPE_CONTEXT);
 
     run_benchmark("ecdh", bench_ecdh, bench_ecdh_setup, NULL, &data, 10, iters);
+    run_benchmark("ecdh_batch", bench_ecdh_batch, bench_ecdh_setup, NULL, &data, 10, iters);
+    bench_ecdh_setup(&data);
+    data.prec = secp256k1_ecdh_precomputed_pubkey_create(data.ctx, &data.point);
+    CHECK(data.prec != NULL);
+    run_benchmark("ecdh_precomputed", bench_ecdh_precomputed, NULL, NULL, &data, 10, iters);
+    secp256k1_ecdh_precomputed_pubkey_destroy(data.ctx, data.prec);
+    run_benchmark("ecdh_xonly", bench_ecdh_xonly, bench_ecdh_setup, NULL, &data, 10, iters);
 
     secp256k1_context_destroy(data.ctx);
     return 0;
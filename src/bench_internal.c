@@ -209,6 +209,27 @@ void bench_field_sqrt(void* arg, int iters) {
     CHECK(j <= iters);
 }
 
+/* Reports the time per square root. */
+void bench_field_sqrt_lanes(void* arg, int iters) {
+    int i, k, j = 0;
+    bench_inv *data = (bench_inv*)arg;
+    secp256k1_fe t[SECP256K1_FE_SQRT_LANES], r[SECP256K1_FE_SQRT_LANES];
+    int ret[SECP256K1_FE_SQRT_LANES];
+
+    for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+        t[k] = data->fe[k % 4];
+    }
+    for (i = 0; i < iters; i += SECP256K1_FE_SQRT_LANES) {
+        secp256k1_fe_sqrt_lanes(ret, r, t);
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            j += ret[k];
+            t[k] = r[k];
+            secp256k1_fe_add(&t[k], &data->fe[1]);
+        }
+    }
+    CHECK(j <= iters + SECP256K1_FE_SQRT_LANES);
+}
+
 void bench_group_double_var(void* arg, int iters) {
     int i;
     bench_inv *data = (bench_inv*)arg;
@@ -359,6 +380,7 @@ int main(int argc, char **argv) {
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse", bench_field_inverse, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse_var", bench_field_inverse_var, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqrt")) run_benchmark("field_sqrt", bench_field_sqrt, bench_setup, NULL, &data, 10, iters);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqrt")) run_benchmark("field_sqrt_lanes", bench_field_sqrt_lanes, bench_setup, NULL, &data, 10, iters);
 
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "double")) run_benchmark("group_double_var", bench_group_double_var, bench_setup, NULL, &data, 10, iters*10);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_var", bench_group_add_var, bench_setup, NULL, &data, 10, iters*10);
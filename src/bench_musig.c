@@ -0,0 +1,179 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "../include/secp256k1.h"
+#include "../include/secp256k1_musig.h"
+#include "util.h"
+#include "bench.h"
+
+/* The number of public keys that are aggregated, and the number of nonces that
+ * are created at once by secp256k1_musig_nonce_gen_batch. */
+#define BENCH_MUSIG_N 100
+
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_scratch_space *scratch;
+    secp256k1_keypair keypair;
+    secp256k1_pubkey pubkeys[BENCH_MUSIG_N];
+    const secp256k1_pubkey *pk_ptrs[BENCH_MUSIG_N];
+    secp256k1_musig_keyagg_cache cache;
+    secp256k1_musig_aggnonce aggnonce;
+    secp256k1_musig_session session;
+    secp256k1_musig_pubnonce pubnonce;
+    secp256k1_musig_partial_sig partial_sig;
+    unsigned char msg[32];
+
+    secp256k1_musig_secnonce *secnonces;
+    secp256k1_musig_pubnonce *pubnonces;
+    unsigned char (*secrands)[32];
+    unsigned char **secrand_ptrs;
+    int iters;
+} bench_musig_data;
+
+/* Fills the randomness that nonce generation consumes. */
+static void bench_musig_secrand_setup(void* arg) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    int i;
+
+    for (i = 0; i < data->iters; i++) {
+        memset(data->secrands[i], 'r', 32);
+        data->secrands[i][0] = i;
+        data->secrands[i][1] = i >> 8;
+        data->secrands[i][2] = i >> 16;
+    }
+}
+
+/* Creates the secret nonces that partial signing consumes. */
+static void bench_musig_secnonce_setup(void* arg) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+
+    bench_musig_secrand_setup(arg);
+    CHECK(secp256k1_musig_nonce_gen_batch(data->ctx, data->secnonces, data->pubnonces, data->secrand_ptrs, NULL, &data->pubkeys[0], &data->cache, NULL, data->iters));
+}
+
+/* Reports the time per public key, for BENCH_MUSIG_N keys at a time. */
+static void bench_musig_pubkey_agg(void* arg, int iters) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i += BENCH_MUSIG_N) {
+        size_t n = iters - i < BENCH_MUSIG_N ? iters - i : BENCH_MUSIG_N;
+        CHECK(secp256k1_musig_pubkey_agg(data->ctx, data->scratch, NULL, NULL, data->pk_ptrs, n));
+    }
+}
+
+static void bench_musig_nonce_gen(void* arg, int iters) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_musig_nonce_gen(data->ctx, &data->secnonces[i], &data->pubnonces[i], data->secrands[i], NULL, &data->pubkeys[0], NULL, &data->cache, NULL));
+    }
+}
+
+/* Reports the time per nonce, for BENCH_MUSIG_N nonces at a time. */
+static void bench_musig_nonce_gen_batch(void* arg, int iters) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i += BENCH_MUSIG_N) {
+        size_t n = iters - i < BENCH_MUSIG_N ? iters - i : BENCH_MUSIG_N;
+        CHECK(secp256k1_musig_nonce_gen_batch(data->ctx, &data->secnonces[i], &data->pubnonces[i], &data->secrand_ptrs[i], NULL, &data->pubkeys[0], &data->cache, NULL, n));
+    }
+}
+
+static void bench_musig_nonce_process(void* arg, int iters) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    secp256k1_musig_session session;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        data->msg[0] = i;
+        data->msg[1] = i >> 8;
+        CHECK(secp256k1_musig_nonce_process(data->ctx, &session, &data->aggnonce, data->msg, &data->cache));
+    }
+}
+
+static void bench_musig_partial_sign(void* arg, int iters) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    secp256k1_musig_partial_sig partial_sig;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_musig_partial_sign(data->ctx, &partial_sig, &data->secnonces[i], &data->keypair, &data->cache, &data->session));
+    }
+}
+
+static void bench_musig_partial_sig_verify(void* arg, int iters) {
+    bench_musig_data *data = (bench_musig_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_musig_partial_sig_verify(data->ctx, &data->partial_sig, &data->pubnonce, &data->pubkeys[0], &data->cache, &data->session));
+    }
+}
+
+int main(void) {
+    bench_musig_data data;
+    const secp256k1_musig_pubnonce *pubnonce_ptrs[2];
+    secp256k1_musig_secnonce secnonce;
+    unsigned char sk[32];
+    unsigned char secrand[32];
+    int i;
+    int iters = get_iters(10000);
+
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN);
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 1024 * 1024);
+    data.iters = iters;
+    data.secnonces = (secp256k1_musig_secnonce *)malloc(iters * sizeof(*data.secnonces));
+    data.pubnonces = (secp256k1_musig_pubnonce *)malloc(iters * sizeof(*data.pubnonces));
+    data.secrands = (unsigned char (*)[32])malloc(iters * 32);
+    data.secrand_ptrs = (unsigned char **)malloc(iters * sizeof(*data.secrand_ptrs));
+    for (i = 0; i < iters; i++) {
+        data.secrand_ptrs[i] = data.secrands[i];
+    }
+
+    for (i = 0; i < BENCH_MUSIG_N; i++) {
+        memset(sk, 's', sizeof(sk));
+        sk[0] = i;
+        sk[1] = i >> 8;
+        if (i == 0) {
+            CHECK(secp256k1_keypair_create(data.ctx, &data.keypair, sk));
+        }
+        CHECK(secp256k1_ec_pubkey_create(data.ctx, &data.pubkeys[i], sk));
+        data.pk_ptrs[i] = &data.pubkeys[i];
+    }
+    memset(data.msg, 'm', sizeof(data.msg));
+
+    /* A session of the first two signers, in which only the first one signs */
+    CHECK(secp256k1_musig_pubkey_agg(data.ctx, NULL, NULL, &data.cache, data.pk_ptrs, 2));
+    memset(secrand, 'a', sizeof(secrand));
+    CHECK(secp256k1_musig_nonce_gen(data.ctx, &secnonce, &data.pubnonce, secrand, NULL, &data.pubkeys[0], NULL, &data.cache, NULL));
+    memset(secrand, 'b', sizeof(secrand));
+    CHECK(secp256k1_musig_nonce_gen(data.ctx, &data.secnonces[0], &data.pubnonces[0], secrand, NULL, &data.pubkeys[1], NULL, &data.cache, NULL));
+    pubnonce_ptrs[0] = &data.pubnonce;
+    pubnonce_ptrs[1] = &data.pubnonces[0];
+    CHECK(secp256k1_musig_nonce_agg(data.ctx, &data.aggnonce, pubnonce_ptrs, 2));
+    CHECK(secp256k1_musig_nonce_process(data.ctx, &data.session, &data.aggnonce, data.msg, &data.cache));
+    CHECK(secp256k1_musig_partial_sign(data.ctx, &data.partial_sig, &secnonce, &data.keypair, &data.cache, &data.session));
+
+    run_benchmark("musig_pubkey_agg", bench_musig_pubkey_agg, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("musig_nonce_gen", bench_musig_nonce_gen, bench_musig_secrand_setup, NULL, (void *) &data, 10, iters);
+    run_benchmark("musig_nonce_gen_batch", bench_musig_nonce_gen_batch, bench_musig_secrand_setup, NULL, (void *) &data, 10, iters);
+    run_benchmark("musig_nonce_process", bench_musig_nonce_process, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("musig_partial_sign", bench_musig_partial_sign, bench_musig_secnonce_setup, NULL, (void *) &data, 10, iters);
+    run_benchmark("musig_partial_sig_verify", bench_musig_partial_sig_verify, NULL, NULL, (void *) &data, 10, iters);
+
+    free(data.secrand_ptrs);
+    free(data.secrands);
+    free(data.pubnonces);
+    free(data.secnonces);
+    secp256k1_scratch_space_destroy(data.ctx, data.scratch);
+    secp256k1_context_destroy(data.ctx);
+    return 0;
+}
@@ -0,0 +1,114 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "../include/secp256k1.h"
+#include "../include/secp256k1_pedersen.h"
+#include "util.h"
+#include "bench.h"
+
+/* The number of inputs and of outputs of a tally. */
+#define BENCH_PEDERSEN_N 100
+
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_pedersen_h_table *table;
+    unsigned char blind[32];
+
+    secp256k1_pedersen_commitment commits[2 * BENCH_PEDERSEN_N];
+    const secp256k1_pedersen_commitment *commit_ptrs[2 * BENCH_PEDERSEN_N];
+    secp256k1_pedersen_commitment excess;
+    unsigned char ser[2 * BENCH_PEDERSEN_N][33];
+} bench_pedersen_data;
+
+static void bench_pedersen_commit(void* arg, int iters) {
+    bench_pedersen_data *data = (bench_pedersen_data *)arg;
+    secp256k1_pedersen_commitment commit;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        data->blind[0] = i;
+        CHECK(secp256k1_pedersen_commit(data->ctx, &commit, data->table, data->blind, (uint64_t)i * 0x123456789ULL));
+    }
+}
+
+static void bench_pedersen_commit_no_table(void* arg, int iters) {
+    bench_pedersen_data *data = (bench_pedersen_data *)arg;
+    secp256k1_pedersen_commitment commit;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        data->blind[0] = i;
+        CHECK(secp256k1_pedersen_commit(data->ctx, &commit, NULL, data->blind, (uint64_t)i * 0x123456789ULL));
+    }
+}
+
+static void bench_pedersen_parse(void* arg, int iters) {
+    bench_pedersen_data *data = (bench_pedersen_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_pedersen_commitment_parse(data->ctx, &data->commits[i % (2 * BENCH_PEDERSEN_N)], data->ser[i % (2 * BENCH_PEDERSEN_N)]));
+    }
+}
+
+/* Reports the time per commitment, for 2*BENCH_PEDERSEN_N commitments at a
+ * time. */
+static void bench_pedersen_parse_batch(void* arg, int iters) {
+    bench_pedersen_data *data = (bench_pedersen_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i += 2 * BENCH_PEDERSEN_N) {
+        size_t n = iters - i < 2 * BENCH_PEDERSEN_N ? iters - i : 2 * BENCH_PEDERSEN_N;
+        CHECK(secp256k1_pedersen_commitment_parse_batch(data->ctx, data->commits, NULL, data->ser[0], n));
+    }
+}
+
+/* Reports the time per tally of BENCH_PEDERSEN_N inputs and outputs. */
+static void bench_pedersen_verify_tally(void* arg, int iters) {
+    bench_pedersen_data *data = (bench_pedersen_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_pedersen_verify_tally(data->ctx, data->commit_ptrs, BENCH_PEDERSEN_N, &data->commit_ptrs[BENCH_PEDERSEN_N], BENCH_PEDERSEN_N, &data->excess));
+    }
+}
+
+int main(void) {
+    bench_pedersen_data data;
+    unsigned char blinds[2 * BENCH_PEDERSEN_N][32];
+    const unsigned char *blind_ptrs[2 * BENCH_PEDERSEN_N];
+    unsigned char excess_blind[32];
+    int i;
+    int iters = get_iters(20000);
+
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    data.table = secp256k1_pedersen_h_table_create(data.ctx);
+    memset(data.blind, 'b', 32);
+
+    /* Every output has the value of one input. */
+    for (i = 0; i < 2 * BENCH_PEDERSEN_N; i++) {
+        memset(blinds[i], 'i', 32);
+        blinds[i][0] = i;
+        blind_ptrs[i] = blinds[i];
+        CHECK(secp256k1_pedersen_commit(data.ctx, &data.commits[i], data.table, blinds[i], 1000 + i % BENCH_PEDERSEN_N));
+        CHECK(secp256k1_pedersen_commitment_serialize(data.ctx, data.ser[i], &data.commits[i]));
+        data.commit_ptrs[i] = &data.commits[i];
+    }
+    CHECK(secp256k1_pedersen_blind_sum(data.ctx, excess_blind, blind_ptrs, 2 * BENCH_PEDERSEN_N, BENCH_PEDERSEN_N));
+    CHECK(secp256k1_pedersen_commit(data.ctx, &data.excess, data.table, excess_blind, 0));
+
+    run_benchmark("pedersen_commit", bench_pedersen_commit, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("pedersen_commit_no_table", bench_pedersen_commit_no_table, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("pedersen_parse", bench_pedersen_parse, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("pedersen_parse_batch", bench_pedersen_parse_batch, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("pedersen_verify_tally", bench_pedersen_verify_tally, NULL, NULL, (void *) &data, 10, iters / 100);
+
+    secp256k1_pedersen_h_table_destroy(data.ctx, data.table);
+    secp256k1_context_destroy(data.ctx);
+    return 0;
+}
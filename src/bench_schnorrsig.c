@@ -13,6 +13,14 @@
 #include "util.h"
 #include "bench.h"
 
+#ifdef ENABLE_MODULE_BATCH
+# include "../include/secp256k1_batch.h"
+#endif
+
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+# include "../include/secp256k1_schnorrsig_halfagg.h"
+#endif
+
 #define MSGLEN 32
 
 typedef struct {
@@ -23,6 +31,16 @@ typedef struct {
     const unsigned char **pk;
     const unsigned char **sigs;
     const unsigned char **msgs;
+#ifdef ENABLE_MODULE_BATCH
+    secp256k1_batch *batch;
+#endif
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+    secp256k1_scratch_space *scratch;
+    secp256k1_xonly_pubkey *xonly_pks;
+    const secp256k1_xonly_pubkey **xonly_pk_ptrs;
+    unsigned char *aggsig;
+    size_t aggsig_len;
+#endif
 } bench_schnorrsig_data;
 
 void bench_schnorrsig_sign(void* arg, int iters) {
@@ -38,6 +56,22 @@ void bench_schnorrsig_sign(void* arg, int iters) {
     }
 }
 
+void bench_schnorrsig_sign_batch(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+    unsigned char sigs[100][64];
+    unsigned char *sig_ptrs[100];
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        sig_ptrs[i] = sigs[i];
+    }
+    /* Sign all messages with the first keypair, 100 at a time. */
+    for (i = 0; i < iters; i += 100) {
+        size_t n = iters - i < 100 ? iters - i : 100;
+        CHECK(secp256k1_schnorrsig_sign_batch(data->ctx, sig_ptrs, &data->msgs[i], data->keypairs[0], NULL, n));
+    }
+}
+
 void bench_schnorrsig_verify(void* arg, int iters) {
     bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
     int i;
@@ -49,6 +83,40 @@ void bench_schnorrsig_verify(void* arg, int iters) {
     }
 }
 
+#ifdef ENABLE_MODULE_BATCH
+void bench_schnorrsig_batch_verify(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_xonly_pubkey pk;
+        CHECK(secp256k1_xonly_pubkey_parse(data->ctx, &pk, data->pk[i]) == 1);
+        CHECK(secp256k1_batch_add_schnorrsig(data->ctx, data->batch, data->sigs[i], data->msgs[i], MSGLEN, &pk));
+    }
+    CHECK(secp256k1_batch_verify(data->ctx, data->batch, NULL));
+}
+#endif
+
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+void bench_schnorrsig_aggregate(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+    size_t aggsig_len = SECP256K1_SCHNORRSIG_AGGSIG_LEN(iters);
+
+    CHECK(secp256k1_schnorrsig_aggregate(data->ctx, data->aggsig, &aggsig_len, data->xonly_pk_ptrs, data->msgs, data->sigs, iters));
+}
+
+/* Like bench_schnorrsig_verify, this includes parsing the public keys. */
+void bench_schnorrsig_aggverify(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_xonly_pubkey_parse(data->ctx, &data->xonly_pks[i], data->pk[i]) == 1);
+    }
+    CHECK(secp256k1_schnorrsig_aggverify(data->ctx, data->scratch, data->xonly_pk_ptrs, data->msgs, iters, data->aggsig, data->aggsig_len));
+}
+#endif
+
 int main(void) {
     int i;
     bench_schnorrsig_data data;
@@ -87,7 +155,32 @@ int main(void) {
     }
 
     run_benchmark("schnorrsig_sign", bench_schnorrsig_sign, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("schnorrsig_sign_batch", bench_schnorrsig_sign_batch, NULL, NULL, (void *) &data, 10, iters);
     run_benchmark("schnorrsig_verify", bench_schnorrsig_verify, NULL, NULL, (void *) &data, 10, iters);
+#ifdef ENABLE_MODULE_BATCH
+    data.batch = secp256k1_batch_create(data.ctx, 0, NULL);
+    CHECK(data.batch != NULL);
+    run_benchmark("schnorrsig_batch_verify", bench_schnorrsig_batch_verify, NULL, NULL, (void *) &data, 10, iters);
+    secp256k1_batch_destroy(data.ctx, data.batch);
+#endif
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+    /* Enough for a single multi-scalar multiplication over 2*10000 points */
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 8 * 1024 * 1024);
+    data.xonly_pks = (secp256k1_xonly_pubkey *)malloc(iters * sizeof(secp256k1_xonly_pubkey));
+    data.xonly_pk_ptrs = (const secp256k1_xonly_pubkey **)malloc(iters * sizeof(secp256k1_xonly_pubkey *));
+    data.aggsig_len = SECP256K1_SCHNORRSIG_AGGSIG_LEN(iters);
+    data.aggsig = (unsigned char *)malloc(data.aggsig_len);
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_xonly_pubkey_parse(data.ctx, &data.xonly_pks[i], data.pk[i]) == 1);
+        data.xonly_pk_ptrs[i] = &data.xonly_pks[i];
+    }
+    run_benchmark("schnorrsig_aggregate", bench_schnorrsig_aggregate, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("schnorrsig_aggverify", bench_schnorrsig_aggverify, NULL, NULL, (void *) &data, 10, iters);
+    free(data.aggsig);
+    free(data.xonly_pk_ptrs);
+    free(data.xonly_pks);
+    secp256k1_scratch_space_destroy(data.ctx, data.scratch);
+#endif
 
     for (i = 0; i < iters; i++) {
         free((void *)data.keypairs[i]);
@@ -12,6 +12,7 @@ typedef struct {
     secp256k1_context* ctx;
     unsigned char msg[32];
     unsigned char key[32];
+    secp256k1_ecdsa_signing_key signing_key;
 } bench_sign_data;
 
 static void bench_sign_setup(void* arg) {
@@ -44,6 +45,29 @@ static void bench_sign_run(void* arg, int iters) {
     }
 }
 
+static void bench_sign_signing_key_setup(void* arg) {
+    bench_sign_data *data = (bench_sign_data*)arg;
+
+    bench_sign_setup(arg);
+    CHECK(secp256k1_ecdsa_signing_key_create(data->ctx, &data->signing_key, data->key));
+}
+
+static void bench_sign_signing_key_run(void* arg, int iters) {
+    int i;
+    bench_sign_data *data = (bench_sign_data*)arg;
+
+    unsigned char sig[64];
+    for (i = 0; i < iters; i++) {
+        int j;
+        secp256k1_ecdsa_signature signature;
+        CHECK(secp256k1_ecdsa_sign_with_signing_key(data->ctx, &signature, data->msg, &data->signing_key, NULL));
+        CHECK(secp256k1_ecdsa_signature_serialize_compact(data->ctx, sig, &signature));
+        for (j = 0; j < 32; j++) {
+            data->msg[j] = sig[j];
+        }
+    }
+}
+
 int main(void) {
     bench_sign_data data;
 
@@ -52,6 +76,7 @@ int main(void) {
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
 
     run_benchmark("ecdsa_sign", bench_sign_run, bench_sign_setup, NULL, &data, 10, iters);
+    run_benchmark("ecdsa_sign_with_signing_key", bench_sign_signing_key_run, bench_sign_signing_key_setup, NULL, &data, 10, iters);
 
     secp256k1_context_destroy(data.ctx);
     return 0;
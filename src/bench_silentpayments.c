@@ -0,0 +1,148 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "../include/secp256k1.h"
+#include "../include/secp256k1_extrakeys.h"
+#include "../include/secp256k1_silentpayments.h"
+#include "util.h"
+#include "bench.h"
+
+#ifdef ENABLE_MODULE_ECDH
+# include "../include/secp256k1_ecdh.h"
+#endif
+
+/* The number of transactions in a block, each with two inputs and two
+ * outputs. */
+#define BENCH_SILENTPAYMENTS_N 100
+
+typedef struct {
+    secp256k1_context *ctx;
+    unsigned char scan_key[32];
+    secp256k1_pubkey spend_pubkey;
+
+    secp256k1_silentpayments_public_data public_data[BENCH_SILENTPAYMENTS_N];
+    secp256k1_xonly_pubkey outputs[BENCH_SILENTPAYMENTS_N][2];
+    const secp256k1_xonly_pubkey *output_ptrs[BENCH_SILENTPAYMENTS_N][2];
+    secp256k1_silentpayments_recipient_tx txs[BENCH_SILENTPAYMENTS_N];
+    const secp256k1_silentpayments_recipient_tx *tx_ptrs[BENCH_SILENTPAYMENTS_N];
+    secp256k1_silentpayments_found_output found[BENCH_SILENTPAYMENTS_N];
+
+    /* The public data as the public API computes it, for the naive scan. */
+    secp256k1_pubkey input_sums[BENCH_SILENTPAYMENTS_N];
+    unsigned char input_hashes[BENCH_SILENTPAYMENTS_N][32];
+} bench_silentpayments_data;
+
+/* Reports the time per transaction, for BENCH_SILENTPAYMENTS_N transactions at
+ * a time. */
+static void bench_silentpayments_scan_block(void* arg, int iters) {
+    bench_silentpayments_data *data = (bench_silentpayments_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i += BENCH_SILENTPAYMENTS_N) {
+        size_t n = iters - i < BENCH_SILENTPAYMENTS_N ? iters - i : BENCH_SILENTPAYMENTS_N;
+        size_t n_found = BENCH_SILENTPAYMENTS_N;
+        CHECK(secp256k1_silentpayments_recipient_scan_block(data->ctx, data->found, &n_found, data->tx_ptrs, n, data->scan_key, &data->spend_pubkey));
+        CHECK(n_found == 0);
+    }
+}
+
+#ifdef ENABLE_MODULE_ECDH
+/* Outputs the compressed serialization of the shared point. */
+static int bench_silentpayments_ecdh_hash(unsigned char *output, const unsigned char *x32, const unsigned char *y32, void *data) {
+    (void)data;
+    output[0] = 0x02 | (y32[31] & 1);
+    memcpy(&output[1], x32, 32);
+    return 1;
+}
+
+/* Scans the transactions one by one with the public API: secp256k1_ecdh,
+ * secp256k1_tagged_sha256, secp256k1_ec_pubkey_tweak_add and a comparison with
+ * every serialized output. */
+static void bench_silentpayments_scan_naive(void* arg, int iters) {
+    static const unsigned char tag[20] = "BIP0352/SharedSecret";
+    bench_silentpayments_data *data = (bench_silentpayments_data *)arg;
+    int i;
+
+    for (i = 0; i < iters; i++) {
+        size_t j = i % BENCH_SILENTPAYMENTS_N;
+        secp256k1_pubkey p = data->spend_pubkey;
+        secp256k1_xonly_pubkey p_xonly;
+        unsigned char d[32];
+        unsigned char buf[37];
+        unsigned char tweak[32];
+        unsigned char p32[32];
+        unsigned char output32[32];
+        size_t k;
+
+        memcpy(d, data->scan_key, 32);
+        CHECK(secp256k1_ec_seckey_tweak_mul(data->ctx, d, data->input_hashes[j]));
+        CHECK(secp256k1_ecdh(data->ctx, buf, &data->input_sums[j], d, bench_silentpayments_ecdh_hash, NULL));
+        memset(&buf[33], 0, 4);
+        CHECK(secp256k1_tagged_sha256(data->ctx, tweak, tag, sizeof(tag), buf, sizeof(buf)));
+        CHECK(secp256k1_ec_pubkey_tweak_add(data->ctx, &p, tweak));
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(data->ctx, &p_xonly, NULL, &p));
+        CHECK(secp256k1_xonly_pubkey_serialize(data->ctx, p32, &p_xonly));
+        for (k = 0; k < 2; k++) {
+            CHECK(secp256k1_xonly_pubkey_serialize(data->ctx, output32, &data->outputs[j][k]));
+            CHECK(secp256k1_memcmp_var(p32, output32, 32) != 0);
+        }
+    }
+}
+#endif
+
+int main(void) {
+    static const unsigned char tag[14] = "BIP0352/Inputs";
+    bench_silentpayments_data data;
+    unsigned char sk[32];
+    unsigned char buf[69];
+    int i, j;
+    int iters = get_iters(10000);
+
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    memset(data.scan_key, 's', 32);
+    memset(sk, 'p', 32);
+    CHECK(secp256k1_ec_pubkey_create(data.ctx, &data.spend_pubkey, sk));
+
+    for (i = 0; i < BENCH_SILENTPAYMENTS_N; i++) {
+        secp256k1_pubkey inputs[2];
+        const secp256k1_pubkey *input_ptrs[2];
+        size_t len = 33;
+
+        for (j = 0; j < 2; j++) {
+            secp256k1_pubkey pk;
+            memset(sk, 'i' + j, 32);
+            sk[0] = i;
+            CHECK(secp256k1_ec_pubkey_create(data.ctx, &inputs[j], sk));
+            input_ptrs[j] = &inputs[j];
+            memset(sk, 'o' + j, 32);
+            sk[0] = i;
+            CHECK(secp256k1_ec_pubkey_create(data.ctx, &pk, sk));
+            CHECK(secp256k1_xonly_pubkey_from_pubkey(data.ctx, &data.outputs[i][j], NULL, &pk));
+            data.output_ptrs[i][j] = &data.outputs[i][j];
+        }
+        memset(buf, 't', 36);
+        buf[0] = i;
+        CHECK(secp256k1_silentpayments_recipient_public_data_create(data.ctx, &data.public_data[i], buf, NULL, 0, input_ptrs, 2));
+        data.txs[i].public_data = &data.public_data[i];
+        data.txs[i].outputs = data.output_ptrs[i];
+        data.txs[i].n_outputs = 2;
+        data.tx_ptrs[i] = &data.txs[i];
+
+        CHECK(secp256k1_ec_pubkey_combine(data.ctx, &data.input_sums[i], input_ptrs, 2));
+        CHECK(secp256k1_ec_pubkey_serialize(data.ctx, &buf[36], &len, &data.input_sums[i], SECP256K1_EC_COMPRESSED));
+        CHECK(secp256k1_tagged_sha256(data.ctx, data.input_hashes[i], tag, sizeof(tag), buf, sizeof(buf)));
+    }
+
+    run_benchmark("silentpayments_scan_block", bench_silentpayments_scan_block, NULL, NULL, (void *) &data, 10, iters);
+#ifdef ENABLE_MODULE_ECDH
+    run_benchmark("silentpayments_scan_naive", bench_silentpayments_scan_naive, NULL, NULL, (void *) &data, 10, iters);
+#endif
+
+    secp256k1_context_destroy(data.ctx);
+    return 0;
+}
@@ -17,6 +17,11 @@
 #include <openssl/obj_mac.h>
 #endif
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+
+#define BENCH_VERIFY_THREADS 4
+#endif
 
 typedef struct {
     secp256k1_context *ctx;
@@ -26,6 +31,12 @@ typedef struct {
     size_t siglen;
     unsigned char pubkey[33];
     size_t pubkeylen;
+    secp256k1_ecdsa_signature multi_sigs[4];
+    secp256k1_pubkey multi_pubkeys[4];
+    unsigned char multi_msgs[4][32];
+    secp256k1_pubkey tweak_pubkey;
+    unsigned char tweaks[32][32];
+    secp256k1_signature_cache *cache;
 #ifdef ENABLE_OPENSSL_TESTS
     EC_GROUP* ec_group;
 #endif
@@ -50,6 +61,122 @@ static void bench_verify(void* arg, int iters) {
     }
 }
 
+/* Verifies a signature that is in the cache. */
+static void bench_verify_cached(void* arg, int iters) {
+    int i;
+    bench_verify_data* data = (bench_verify_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_ecdsa_verify_cached(data->ctx, data->cache, &data->multi_sigs[i & 3], data->multi_msgs[i & 3], &data->multi_pubkeys[i & 3], 0) == 1);
+    }
+}
+
+#ifdef HAVE_PTHREAD
+typedef struct {
+    bench_verify_data* data;
+    int iters;
+} bench_verify_thread_arg;
+
+static void* bench_verify_cached_thread(void* arg) {
+    bench_verify_thread_arg* thread_arg = (bench_verify_thread_arg*)arg;
+    bench_verify_cached(thread_arg->data, thread_arg->iters);
+    return NULL;
+}
+
+/* Verifies signatures that are in the cache from several threads at once,
+ * which share the context and the cache. */
+static void bench_verify_cached_threads(void* arg, int iters) {
+    int i;
+    pthread_t threads[BENCH_VERIFY_THREADS];
+    bench_verify_thread_arg thread_args[BENCH_VERIFY_THREADS];
+
+    for (i = 0; i < BENCH_VERIFY_THREADS; i++) {
+        thread_args[i].data = (bench_verify_data*)arg;
+        thread_args[i].iters = iters / BENCH_VERIFY_THREADS + (i < iters % BENCH_VERIFY_THREADS);
+        CHECK(pthread_create(&threads[i], NULL, bench_verify_cached_thread, &thread_args[i]) == 0);
+    }
+    for (i = 0; i < BENCH_VERIFY_THREADS; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+}
+#endif
+
+static void bench_pubkey_parse(void* arg, int iters) {
+    int i;
+    bench_verify_data* data = (bench_verify_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_pubkey pubkey;
+        CHECK(secp256k1_ec_pubkey_parse(data->ctx, &pubkey, data->pubkey, data->pubkeylen) == 1);
+    }
+}
+
+static void bench_compressed_pubkey_parse(void* arg, int iters) {
+    int i;
+    bench_verify_data* data = (bench_verify_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_compressed_pubkey pubkey;
+        CHECK(secp256k1_compressed_pubkey_parse(data->ctx, &pubkey, data->pubkey, data->pubkeylen) == 1);
+    }
+}
+
+static void bench_pubkey_tweak_add(void* arg, int iters) {
+    int i;
+    bench_verify_data* data = (bench_verify_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_pubkey pubkey = data->tweak_pubkey;
+        CHECK(secp256k1_ec_pubkey_tweak_add(data->ctx, &pubkey, data->tweaks[i % 32]) == 1);
+    }
+}
+
+static void bench_pubkey_tweak_add_batch(void* arg, int iters) {
+    int i, j;
+    bench_verify_data* data = (bench_verify_data*)arg;
+    secp256k1_pubkey outputs[32];
+    const secp256k1_pubkey *pubkeys[32];
+    const unsigned char *tweaks[32];
+
+    for (j = 0; j < 32; j++) {
+        pubkeys[j] = &data->tweak_pubkey;
+        tweaks[j] = data->tweaks[j];
+    }
+    for (i = 0; i < iters; i += 32) {
+        size_t n = iters - i < 32 ? iters - i : 32;
+        CHECK(secp256k1_ec_pubkey_tweak_add_batch(data->ctx, outputs, NULL, pubkeys, tweaks, n) == 1);
+    }
+}
+
+static void bench_pubkey_scan(void* arg, int iters) {
+    int i;
+    bench_verify_data* data = (bench_verify_data*)arg;
+    unsigned char output[256][33];
+
+    for (i = 0; i < iters; i += 256) {
+        size_t n = iters - i < 256 ? iters - i : 256;
+        CHECK(secp256k1_ec_pubkey_scan(data->ctx, &output[0][0], &data->tweak_pubkey, n, SECP256K1_EC_COMPRESSED) == 1);
+    }
+}
+
+static void bench_verify_multi(void* arg, int iters) {
+    int i, j;
+    bench_verify_data* data = (bench_verify_data*)arg;
+    const secp256k1_ecdsa_signature *sigs[4];
+    const secp256k1_pubkey *pubkeys[4];
+    const unsigned char *msgs[4];
+
+    for (j = 0; j < 4; j++) {
+        sigs[j] = &data->multi_sigs[j];
+        pubkeys[j] = &data->multi_pubkeys[j];
+        msgs[j] = data->multi_msgs[j];
+    }
+    for (i = 0; i < iters; i += 4) {
+        size_t n = iters - i < 4 ? iters - i : 4;
+        CHECK(secp256k1_ecdsa_verify_multi(data->ctx, NULL, sigs, msgs, pubkeys, n) == 1);
+    }
+}
+
 #ifdef ENABLE_OPENSSL_TESTS
 static void bench_verify_openssl(void* arg, int iters) {
     int i;
@@ -103,7 +230,41 @@ int main(void) {
     data.pubkeylen = 33;
     CHECK(secp256k1_ec_pubkey_serialize(data.ctx, data.pubkey, &data.pubkeylen, &pubkey, SECP256K1_EC_COMPRESSED) == 1);
 
+    for (i = 0; i < 4; i++) {
+        unsigned char key[32];
+        memcpy(key, data.key, 32);
+        key[0] ^= i + 1;
+        memcpy(data.multi_msgs[i], data.msg, 32);
+        data.multi_msgs[i][0] ^= i + 1;
+        CHECK(secp256k1_ecdsa_sign(data.ctx, &data.multi_sigs[i], data.multi_msgs[i], key, NULL, NULL));
+        CHECK(secp256k1_ec_pubkey_create(data.ctx, &data.multi_pubkeys[i], key));
+    }
+
+    data.tweak_pubkey = pubkey;
+    for (i = 0; i < 32; i++) {
+        memcpy(data.tweaks[i], data.key, 32);
+        data.tweaks[i][0] ^= i + 1;
+    }
+
     run_benchmark("ecdsa_verify", bench_verify, NULL, NULL, &data, 10, iters);
+    run_benchmark("ecdsa_verify_multi", bench_verify_multi, NULL, NULL, &data, 10, iters);
+    data.cache = secp256k1_signature_cache_create(data.ctx, 1024, data.key, SECP256K1_SIGNATURE_CACHE_NONE);
+    run_benchmark("ecdsa_verify_cached", bench_verify_cached, NULL, NULL, &data, 10, iters);
+#ifdef HAVE_PTHREAD
+    run_benchmark("ecdsa_verify_cached_4threads", bench_verify_cached_threads, NULL, NULL, &data, 10, iters);
+#endif
+    secp256k1_signature_cache_destroy(data.ctx, data.cache);
+    data.cache = secp256k1_signature_cache_create(data.ctx, 1024, data.key, SECP256K1_SIGNATURE_CACHE_COUNT);
+    run_benchmark("ecdsa_verify_cached_counting", bench_verify_cached, NULL, NULL, &data, 10, iters);
+#ifdef HAVE_PTHREAD
+    run_benchmark("ecdsa_verify_cached_counting_4threads", bench_verify_cached_threads, NULL, NULL, &data, 10, iters);
+#endif
+    secp256k1_signature_cache_destroy(data.ctx, data.cache);
+    run_benchmark("ec_pubkey_parse", bench_pubkey_parse, NULL, NULL, &data, 10, iters);
+    run_benchmark("compressed_pubkey_parse", bench_compressed_pubkey_parse, NULL, NULL, &data, 10, iters);
+    run_benchmark("ec_pubkey_tweak_add", bench_pubkey_tweak_add, NULL, NULL, &data, 10, iters);
+    run_benchmark("ec_pubkey_tweak_add_batch", bench_pubkey_tweak_add_batch, NULL, NULL, &data, 10, iters);
+    run_benchmark("ec_pubkey_scan", bench_pubkey_scan, NULL, NULL, &data, 10, iters);
 #ifdef ENABLE_OPENSSL_TESTS
     data.ec_group = EC_GROUP_new_by_curve_name(NID_secp256k1);
     run_benchmark("ecdsa_verify_openssl", bench_verify_openssl, NULL, NULL, &data, 10, iters);
@@ -16,6 +16,9 @@
 static int secp256k1_ecdsa_sig_parse(secp256k1_scalar *r, secp256k1_scalar *s, const unsigned char *sig, size_t size);
 static int secp256k1_ecdsa_sig_serialize(unsigned char *sig, size_t *size, const secp256k1_scalar *r, const secp256k1_scalar *s);
 static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ge *pubkey, const secp256k1_scalar *message);
+/** Verify num <= ECMULT_INTERLEAVE_MAX independent signatures, setting results[i] to the result
+ *  secp256k1_ecdsa_sig_verify would return for the i'th one. */
+static void secp256k1_ecdsa_sig_verify_multi(const secp256k1_ecmult_context *ctx, int *results, const secp256k1_scalar *r, const secp256k1_scalar *s, const secp256k1_ge *pubkeys, const secp256k1_scalar *messages, size_t num);
 static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context *ctx, secp256k1_scalar* r, secp256k1_scalar* s, const secp256k1_scalar *seckey, const secp256k1_scalar *message, const secp256k1_scalar *nonce, int *recid);
 
 #endif /* SECP256K1_ECDSA_H */
@@ -204,33 +204,24 @@ static int secp256k1_ecdsa_sig_serialize(unsigned char *sig, size_t *size, const
     return 1;
 }
 
-static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const secp256k1_scalar *sigr, const secp256k1_scalar *sigs, const secp256k1_ge *pubkey, const secp256k1_scalar *message) {
-    unsigned char c[32];
-    secp256k1_scalar sn, u1, u2;
+/* Check whether the recomputed point pr matches the r value of a signature. */
+static int secp256k1_ecdsa_sig_check_r(const secp256k1_scalar *sigr, const secp256k1_gej *pr) {
 #if !defined(EXHAUSTIVE_TEST_ORDER)
+    unsigned char c[32];
     secp256k1_fe xr;
 #endif
-    secp256k1_gej pubkeyj;
-    secp256k1_gej pr;
 
-    if (secp256k1_scalar_is_zero(sigr) || secp256k1_scalar_is_zero(sigs)) {
-        return 0;
-    }
-
-    secp256k1_scalar_inverse_var(&sn, sigs);
-    secp256k1_scalar_mul(&u1, &sn, message);
-    secp256k1_scalar_mul(&u2, &sn, sigr);
-    secp256k1_gej_set_ge(&pubkeyj, pubkey);
-    secp256k1_ecmult(ctx, &pr, &pubkeyj, &u2, &u1);
-    if (secp256k1_gej_is_infinity(&pr)) {
+    if (secp256k1_gej_is_infinity(pr)) {
         return 0;
     }
 
 #if defined(EXHAUSTIVE_TEST_ORDER)
 {
+    unsigned char c[32];
     secp256k1_scalar computed_r;
     secp256k1_ge pr_ge;
-    secp256k1_ge_set_gej(&pr_ge, &pr);
+    secp256k1_gej prj = *pr;
+    secp256k1_ge_set_gej(&pr_ge, &prj);
     secp256k1_fe_normalize(&pr_ge.x);
 
     secp256k1_fe_get_b32(c, &pr_ge.x);
@@ -257,7 +248,7 @@ static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const
      *  Thus, we can avoid the inversion, but we have to check both cases separately.
      *  secp256k1_gej_eq_x implements the (xr * pr.z^2 mod p == pr.x) test.
      */
-    if (secp256k1_gej_eq_x_var(&xr, &pr)) {
+    if (secp256k1_gej_eq_x_var(&xr, pr)) {
         /* xr * pr.z^2 mod p == pr.x, so the signature is valid. */
         return 1;
     }
@@ -266,7 +257,7 @@ static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const
         return 0;
     }
     secp256k1_fe_add(&xr, &secp256k1_ecdsa_const_order_as_fe);
-    if (secp256k1_gej_eq_x_var(&xr, &pr)) {
+    if (secp256k1_gej_eq_x_var(&xr, pr)) {
         /* (xr + n) * pr.z^2 mod p == pr.x, so the signature is valid. */
         return 1;
     }
@@ -274,6 +265,50 @@ static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const
 #endif
 }
 
+static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const secp256k1_scalar *sigr, const secp256k1_scalar *sigs, const secp256k1_ge *pubkey, const secp256k1_scalar *message) {
+    secp256k1_scalar sn, u1, u2;
+    secp256k1_gej pubkeyj;
+    secp256k1_gej pr;
+
+    if (secp256k1_scalar_is_zero(sigr) || secp256k1_scalar_is_zero(sigs)) {
+        return 0;
+    }
+
+    secp256k1_scalar_inverse_var(&sn, sigs);
+    secp256k1_scalar_mul(&u1, &sn, message);
+    secp256k1_scalar_mul(&u2, &sn, sigr);
+    secp256k1_gej_set_ge(&pubkeyj, pubkey);
+    secp256k1_ecmult(ctx, &pr, &pubkeyj, &u2, &u1);
+    return secp256k1_ecdsa_sig_check_r(sigr, &pr);
+}
+
+static void secp256k1_ecdsa_sig_verify_multi(const secp256k1_ecmult_context *ctx, int *results, const secp256k1_scalar *r, const secp256k1_scalar *s, const secp256k1_ge *pubkeys, const secp256k1_scalar *messages, size_t num) {
+    secp256k1_scalar u1[ECMULT_INTERLEAVE_MAX], u2[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej pubkeyj[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej pr[ECMULT_INTERLEAVE_MAX];
+    size_t i;
+
+    VERIFY_CHECK(num <= ECMULT_INTERLEAVE_MAX);
+
+    for (i = 0; i < num; i++) {
+        secp256k1_scalar sn;
+        if (secp256k1_scalar_is_zero(&r[i]) || secp256k1_scalar_is_zero(&s[i])) {
+            /* Results in pr[i] being infinity, which is rejected below. */
+            secp256k1_scalar_clear(&u1[i]);
+            secp256k1_scalar_clear(&u2[i]);
+        } else {
+            secp256k1_scalar_inverse_var(&sn, &s[i]);
+            secp256k1_scalar_mul(&u1[i], &sn, &messages[i]);
+            secp256k1_scalar_mul(&u2[i], &sn, &r[i]);
+        }
+        secp256k1_gej_set_ge(&pubkeyj[i], &pubkeys[i]);
+    }
+    secp256k1_ecmult_interleaved(ctx, pr, pubkeyj, u2, u1, num);
+    for (i = 0; i < num; i++) {
+        results[i] = secp256k1_ecdsa_sig_check_r(&r[i], &pr[i]);
+    }
+}
+
 static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context *ctx, secp256k1_scalar *sigr, secp256k1_scalar *sigs, const secp256k1_scalar *seckey, const secp256k1_scalar *message, const secp256k1_scalar *nonce, int *recid) {
     unsigned char b[32];
     secp256k1_gej rp;
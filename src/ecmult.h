@@ -15,17 +15,54 @@ typedef struct {
     /* For accelerating the computation of a*P + b*G: */
     secp256k1_ge_storage (*pre_g)[];    /* odd multiples of the generator */
     secp256k1_ge_storage (*pre_g_128)[]; /* odd multiples of 2^128*generator */
+    /* For accelerating the computation of b*G for public b, see secp256k1_ecmult_gen_var
+     * (NULL unless built with USE_ECMULT_GEN_VAR_TABLE): */
+    secp256k1_ge_storage (*pre_gen)[];  /* multiples 1..2^(w-1) of 2^(w*j)*generator, for every block j */
+    int window_g;                        /* window size the tables were computed for */
+    int external;                        /* whether the tables live in memory not owned by the context */
 } secp256k1_ecmult_context;
 
+/* A precomputed table image consists of a header of this size, followed by
+ * the pre_g and pre_g_128 tables. The header contains, in order: an 8-byte
+ * magic, a 4-byte version, the window size, sizeof(secp256k1_ge_storage), 4
+ * zero bytes (all little endian), the 8-byte little endian size of the tables,
+ * and the SHA256 of the tables. */
+#define SECP256K1_ECMULT_TABLE_HEADER_SIZE 64
+
+/** Return the size of a table image for the given window size. */
+static size_t secp256k1_ecmult_table_size(int window);
+/** Write a table image for the given window size into out, which must be
+ *  secp256k1_ecmult_table_size(window) bytes and suitably aligned for secp256k1_ge_storage. */
+static void secp256k1_ecmult_table_create(unsigned char *out, int window);
+/** Make ctx use the tables of an image created by secp256k1_ecmult_table_create
+ *  without copying them. Returns 0 if the image is malformed or corrupted. */
+static int secp256k1_ecmult_context_set_table(secp256k1_ecmult_context *ctx, const unsigned char *table, size_t len);
+
 static void secp256k1_ecmult_context_init(secp256k1_ecmult_context *ctx);
 static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, void **prealloc);
 static void secp256k1_ecmult_context_finalize_memcpy(secp256k1_ecmult_context *dst, const secp256k1_ecmult_context *src);
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx);
 static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context *ctx);
+static int secp256k1_ecmult_context_is_external(const secp256k1_ecmult_context *ctx);
+
+/** Multiply with the generator in variable time: R = a*G. Must not be used with
+ *  secret scalars. Faster than secp256k1_ecmult with only a generator part,
+ *  except for contexts using an external table image, on which it falls back to
+ *  that. */
+static void secp256k1_ecmult_gen_var(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_scalar *a);
 
 /** Double multiply: R = na*A + ng*G */
 static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
 
+/** Maximum number of double multiplications secp256k1_ecmult_interleaved accepts. */
+#define ECMULT_INTERLEAVE_MAX 4
+
+/** Several independent double multiplies: R[i] = na[i]*A[i] + ng[i]*G for i < num.
+ *  The computations are run in lockstep so that the lookups into the G tables
+ *  of one can be prefetched while the others are computed. num must be at
+ *  most ECMULT_INTERLEAVE_MAX. */
+static void secp256k1_ecmult_interleaved(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng, size_t num);
+
 typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data);
 
 /**
@@ -17,4 +17,12 @@
  */
 static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *q, int bits);
 
+/**
+ * Same as secp256k1_ecmult_const, but takes and returns only X coordinates: computes *r, the X
+ * coordinate of q*A for either point A with X coordinate *x. Returns 0 (leaving *r untouched) if
+ * *x is not the X coordinate of a point on the curve. q must not be zero. Constant time in q, but
+ * not in *x.
+ */
+static int secp256k1_ecmult_const_xonly(secp256k1_fe *r, const secp256k1_fe *x, const secp256k1_scalar *q, int bits);
+
 #endif /* SECP256K1_ECMULT_CONST_H */
@@ -134,33 +134,54 @@ static int secp256k1_wnaf_const(int *wnaf, const secp256k1_scalar *scalar, int w
     return skew;
 }
 
-static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar, int size) {
-    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
-    secp256k1_ge tmpa;
-    secp256k1_fe Z;
-
-    int skew_1;
-    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+/* The wNAF representation of a scalar used by secp256k1_ecmult_const. It depends only on the
+ * scalar, so it can be computed once and reused to multiply several points by the same scalar. */
+typedef struct {
+    int wnaf_1[1 + WNAF_SIZE(WINDOW_A - 1)];
     int wnaf_lam[1 + WNAF_SIZE(WINDOW_A - 1)];
+    int skew_1;
     int skew_lam;
-    secp256k1_scalar q_1, q_lam;
-    int wnaf_1[1 + WNAF_SIZE(WINDOW_A - 1)];
+    int size;
+} secp256k1_ecmult_const_scalar;
 
-    int i;
+static void secp256k1_ecmult_const_scalar_init(secp256k1_ecmult_const_scalar *w, const secp256k1_scalar *scalar, int size) {
+    secp256k1_scalar q_1, q_lam;
 
     /* build wnaf representation for q. */
-    int rsize = size;
+    w->size = size;
     if (size > 128) {
-        rsize = 128;
         /* split q into q_1 and q_lam (where q = q_1 + q_lam*lambda, and q_1 and q_lam are ~128 bit) */
         secp256k1_scalar_split_lambda(&q_1, &q_lam, scalar);
-        skew_1   = secp256k1_wnaf_const(wnaf_1,   &q_1,   WINDOW_A - 1, 128);
-        skew_lam = secp256k1_wnaf_const(wnaf_lam, &q_lam, WINDOW_A - 1, 128);
+        w->skew_1   = secp256k1_wnaf_const(w->wnaf_1,   &q_1,   WINDOW_A - 1, 128);
+        w->skew_lam = secp256k1_wnaf_const(w->wnaf_lam, &q_lam, WINDOW_A - 1, 128);
+        secp256k1_scalar_clear(&q_1);
+        secp256k1_scalar_clear(&q_lam);
     } else
     {
-        skew_1   = secp256k1_wnaf_const(wnaf_1, scalar, WINDOW_A - 1, size);
-        skew_lam = 0;
+        w->skew_1   = secp256k1_wnaf_const(w->wnaf_1, scalar, WINDOW_A - 1, size);
+        w->skew_lam = 0;
     }
+}
+
+static void secp256k1_ecmult_const_scalar_clear(secp256k1_ecmult_const_scalar *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+/* Multiply: R = q*A (in constant-time), for q given by its precomputed representation. */
+static void secp256k1_ecmult_const_prepared(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_ecmult_const_scalar *w) {
+    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_ge tmpa;
+    secp256k1_fe Z;
+
+    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+    const int *wnaf_1 = w->wnaf_1;
+    const int *wnaf_lam = w->wnaf_lam;
+    const int skew_1 = w->skew_1;
+    const int skew_lam = w->skew_lam;
+    const int size = w->size;
+    const int rsize = size > 128 ? 128 : size;
+
+    int i;
 
     /* Calculate odd multiples of a.
      * All multiples are brought to the same Z 'denominator', which is stored
@@ -251,4 +272,143 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
     }
 }
 
+static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar, int size) {
+    secp256k1_ecmult_const_scalar w;
+    secp256k1_ecmult_const_scalar_init(&w, scalar, size);
+    secp256k1_ecmult_const_prepared(r, a, &w);
+    secp256k1_ecmult_const_scalar_clear(&w);
+}
+
+/* The window size used by secp256k1_ecmult_const_prec_mul. As the table is computed only once per
+ * point, it can be larger than WINDOW_A. */
+#define ECMULT_CONST_PREC_WINDOW 6
+
+/* The affine odd multiples of a point A and of lambda*A, and 2*A, which is all
+ * secp256k1_ecmult_const_prec_mul needs to know about A. */
+typedef struct {
+    secp256k1_ge_storage pre[ECMULT_TABLE_SIZE(ECMULT_CONST_PREC_WINDOW)];
+    secp256k1_ge_storage pre_lam[ECMULT_TABLE_SIZE(ECMULT_CONST_PREC_WINDOW)];
+    secp256k1_ge_storage a2;
+} secp256k1_ecmult_const_prec;
+
+/* Compute the table for point A. Not constant time in A, which must not be infinity. */
+static void secp256k1_ecmult_const_prec_init(secp256k1_ecmult_const_prec *prec, const secp256k1_ge *a) {
+    secp256k1_gej aj, a2j;
+    secp256k1_ge p;
+    int i;
+
+    secp256k1_gej_set_ge(&aj, a);
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(ECMULT_CONST_PREC_WINDOW), prec->pre, &aj);
+    for (i = 0; i < ECMULT_TABLE_SIZE(ECMULT_CONST_PREC_WINDOW); i++) {
+        secp256k1_ge_from_storage(&p, &prec->pre[i]);
+        secp256k1_ge_mul_lambda(&p, &p);
+        secp256k1_ge_to_storage(&prec->pre_lam[i], &p);
+    }
+    secp256k1_gej_double_var(&a2j, &aj, NULL);
+    secp256k1_ge_set_gej_var(&p, &a2j);
+    secp256k1_ge_to_storage(&prec->a2, &p);
+}
+
+/* Set r to pre[(|n|-1)/2], negated if n < 0, without branching on or indexing with n. */
+static void secp256k1_ecmult_const_table_get_ge_storage(secp256k1_ge *r, const secp256k1_ge_storage *pre, int n, int w) {
+    /* Extract the sign-bit for a constant time absolute-value. */
+    int mask = n >> (sizeof(n) * CHAR_BIT - 1);
+    int abs_n = (n + mask) ^ mask;
+    int idx_n = abs_n >> 1;
+    secp256k1_ge_storage s;
+    secp256k1_fe neg_y;
+    VERIFY_CHECK((n & 1) == 1);
+    VERIFY_CHECK(n >= -((1 << (w-1)) - 1));
+    VERIFY_CHECK(n <=  ((1 << (w-1)) - 1));
+    secp256k1_ge_storage_table_select(&s, pre, ECMULT_TABLE_SIZE(w), idx_n);
+    secp256k1_ge_from_storage(r, &s);
+    secp256k1_fe_negate(&neg_y, &r->y, 1);
+    secp256k1_fe_cmov(&r->y, &neg_y, n != abs_n);
+}
+
+/* Multiply: R = q*A (in constant-time), for A given by its table. */
+static void secp256k1_ecmult_const_prec_mul(secp256k1_gej *r, const secp256k1_ecmult_const_prec *prec, const secp256k1_scalar *q) {
+    int wnaf_1[1 + WNAF_SIZE_BITS(128, ECMULT_CONST_PREC_WINDOW - 1)];
+    int wnaf_lam[1 + WNAF_SIZE_BITS(128, ECMULT_CONST_PREC_WINDOW - 1)];
+    int skew_1, skew_lam;
+    secp256k1_scalar q_1, q_lam;
+    secp256k1_ge tmpa;
+    secp256k1_ge_storage correction;
+    int i;
+
+    /* split q into q_1 and q_lam (where q = q_1 + q_lam*lambda, and q_1 and q_lam are ~128 bit) */
+    secp256k1_scalar_split_lambda(&q_1, &q_lam, q);
+    skew_1   = secp256k1_wnaf_const(wnaf_1,   &q_1,   ECMULT_CONST_PREC_WINDOW - 1, 128);
+    skew_lam = secp256k1_wnaf_const(wnaf_lam, &q_lam, ECMULT_CONST_PREC_WINDOW - 1, 128);
+    secp256k1_scalar_clear(&q_1);
+    secp256k1_scalar_clear(&q_lam);
+
+    /* As the table is affine, there is no Z coordinate to correct for at the end. */
+    i = WNAF_SIZE_BITS(128, ECMULT_CONST_PREC_WINDOW - 1);
+    secp256k1_ecmult_const_table_get_ge_storage(&tmpa, prec->pre, wnaf_1[i], ECMULT_CONST_PREC_WINDOW);
+    secp256k1_gej_set_ge(r, &tmpa);
+    secp256k1_ecmult_const_table_get_ge_storage(&tmpa, prec->pre_lam, wnaf_lam[i], ECMULT_CONST_PREC_WINDOW);
+    secp256k1_gej_add_ge(r, r, &tmpa);
+    for (i = WNAF_SIZE_BITS(128, ECMULT_CONST_PREC_WINDOW - 1) - 1; i >= 0; i--) {
+        int j;
+        for (j = 0; j < ECMULT_CONST_PREC_WINDOW - 1; ++j) {
+            secp256k1_gej_double(r, r);
+        }
+        secp256k1_ecmult_const_table_get_ge_storage(&tmpa, prec->pre, wnaf_1[i], ECMULT_CONST_PREC_WINDOW);
+        secp256k1_gej_add_ge(r, r, &tmpa);
+        secp256k1_ecmult_const_table_get_ge_storage(&tmpa, prec->pre_lam, wnaf_lam[i], ECMULT_CONST_PREC_WINDOW);
+        secp256k1_gej_add_ge(r, r, &tmpa);
+    }
+
+    /* Correct for wNAF skew: subtract A for even numbers and 2A for odd ones. */
+    correction = prec->pre[0];
+    secp256k1_ge_storage_cmov(&correction, &prec->a2, skew_1 == 2);
+    secp256k1_ge_from_storage(&tmpa, &correction);
+    secp256k1_ge_neg(&tmpa, &tmpa);
+    secp256k1_gej_add_ge(r, r, &tmpa);
+
+    correction = prec->pre[0];
+    secp256k1_ge_storage_cmov(&correction, &prec->a2, skew_lam == 2);
+    secp256k1_ge_from_storage(&tmpa, &correction);
+    secp256k1_ge_neg(&tmpa, &tmpa);
+    secp256k1_ge_mul_lambda(&tmpa, &tmpa);
+    secp256k1_gej_add_ge(r, r, &tmpa);
+
+    memset(wnaf_1, 0, sizeof(wnaf_1));
+    memset(wnaf_lam, 0, sizeof(wnaf_lam));
+}
+
+static int secp256k1_ecmult_const_xonly(secp256k1_fe *r, const secp256k1_fe *x, const secp256k1_scalar *q, int bits) {
+    secp256k1_fe g, i;
+    secp256k1_ge p;
+    secp256k1_gej rj;
+
+    /* Compute g = x^3 + 7, the square of the Y coordinate of the points with X coordinate x. */
+    secp256k1_fe_sqr(&g, x);
+    secp256k1_fe_mul(&g, &g, x);
+    secp256k1_fe_add(&g, &secp256k1_fe_const_b);
+    /* Reject X coordinates of points on the twist. */
+    if (!secp256k1_fe_is_square_var(&g)) {
+        return 0;
+    }
+
+    /* Instead of computing the square root y = sqrt(g), note that the Jacobian coordinates
+     * (x*g, g^2, sqrt(g)) represent the affine point (x, sqrt(g)). Multiplying by the
+     * unknown Z coordinate sqrt(g) commutes with all group operations, and none of the
+     * formulae depend on it, so we can pretend the input has Z = 1 (i.e. run the
+     * multiplication on the isomorphic curve y^2 = x^3 + 7*g^3, which does not affect the
+     * formulae either), and account for the factor only at the end:
+     * the resulting X coordinate is X / (Z * sqrt(g))^2 = X / (Z^2 * g). */
+    secp256k1_fe_mul(&p.x, x, &g);
+    secp256k1_fe_sqr(&p.y, &g);
+    p.infinity = 0;
+    secp256k1_ecmult_const(&rj, &p, q, bits);
+
+    secp256k1_fe_sqr(&i, &rj.z);
+    secp256k1_fe_mul(&i, &i, &g);
+    secp256k1_fe_inv(&i, &i);
+    secp256k1_fe_mul(r, &rj.x, &i);
+    return 1;
+}
+
 #endif /* SECP256K1_ECMULT_CONST_IMPL_H */
@@ -17,6 +17,13 @@
 #define ECMULT_GEN_PREC_G (1 << ECMULT_GEN_PREC_B)
 #define ECMULT_GEN_PREC_N (256 / ECMULT_GEN_PREC_B)
 
+/* The blinding of secp256k1_ecmult_gen: it computes initial + (a + blind)*G,
+ * where initial = -blind*G. */
+typedef struct {
+    secp256k1_scalar blind;
+    secp256k1_gej initial;
+} secp256k1_ecmult_gen_blinding;
+
 typedef struct {
     /* For accelerating the computation of a*G:
      * To harden against timing attacks, use the following mechanism:
@@ -31,8 +38,12 @@ typedef struct {
      * the intermediate sums while computing a*G.
      */
     secp256k1_ge_storage (*prec)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G]; /* prec[j][i] = (PREC_G)^j * i * G + U_i */
-    secp256k1_scalar blind;
-    secp256k1_gej initial;
+    /* The blinding is double buffered, so that secp256k1_ecmult_gen_blind can
+     * replace it while other threads multiply (a seqlock in "latch" form):
+     * readers use blinding[seq & 1] and retry if seq changed meanwhile. seq is
+     * even when no update is in progress, and then both entries are equal. */
+    secp256k1_ecmult_gen_blinding blinding[2];
+    unsigned int seq;
 } secp256k1_ecmult_gen_context;
 
 static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context* ctx);
@@ -44,6 +55,15 @@ static int secp256k1_ecmult_gen_context_is_built(const secp256k1_ecmult_gen_cont
 /** Multiply with the generator: R = a*G */
 static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context* ctx, secp256k1_gej *r, const secp256k1_scalar *a);
 
+/** Update the blinding. It can run while other threads call secp256k1_ecmult_gen with the same
+ *  context (if SECP256K1_HAVE_ATOMICS is defined), but not concurrently with itself. */
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32);
 
+/** Compute the blinding that follows cur (or reset it if seed32 is NULL), in place. Only the
+ *  precomputed table of ctx is used, so cur need not be the blinding of ctx. */
+static void secp256k1_ecmult_gen_blinding_update(const secp256k1_ecmult_gen_context *ctx, secp256k1_ecmult_gen_blinding *cur, const unsigned char *seed32);
+
+/** Read a consistent copy of the current blinding. */
+static void secp256k1_ecmult_gen_blinding_load(const secp256k1_ecmult_gen_context *ctx, secp256k1_ecmult_gen_blinding *r);
+
 #endif /* SECP256K1_ECMULT_GEN_H */
@@ -24,6 +24,7 @@
 
 static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context *ctx) {
     ctx->prec = NULL;
+    ctx->seq = 0;
 }
 
 static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx, void **prealloc) {
@@ -106,48 +107,74 @@ static int secp256k1_ecmult_gen_context_is_built(const secp256k1_ecmult_gen_cont
 }
 
 static void secp256k1_ecmult_gen_context_finalize_memcpy(secp256k1_ecmult_gen_context *dst, const secp256k1_ecmult_gen_context *src) {
-#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    if (src->prec != NULL) {
-        /* We cast to void* first to suppress a -Wcast-align warning. */
-        dst->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G])(void*)((unsigned char*)dst + ((unsigned char*)src->prec - (unsigned char*)src));
+    if (src->prec == NULL) {
+        return;
     }
-#else
-    (void)dst, (void)src;
+#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
+    /* We cast to void* first to suppress a -Wcast-align warning. */
+    dst->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G])(void*)((unsigned char*)dst + ((unsigned char*)src->prec - (unsigned char*)src));
 #endif
+    /* The blinding of src may have been updated during the copy. */
+    secp256k1_ecmult_gen_blinding_load(src, &dst->blinding[0]);
+    dst->blinding[1] = dst->blinding[0];
+    dst->seq = 0;
 }
 
 static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context *ctx) {
-    secp256k1_scalar_clear(&ctx->blind);
-    secp256k1_gej_clear(&ctx->initial);
+    int i;
+    for (i = 0; i < 2; i++) {
+        secp256k1_scalar_clear(&ctx->blinding[i].blind);
+        secp256k1_gej_clear(&ctx->blinding[i].initial);
+    }
+    ctx->seq = 0;
     ctx->prec = NULL;
 }
 
-static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
+static void secp256k1_ecmult_gen_blinding_load(const secp256k1_ecmult_gen_context *ctx, secp256k1_ecmult_gen_blinding *r) {
+    unsigned int seq;
+    do {
+        seq = secp256k1_atomic_load_acquire(&ctx->seq);
+        *r = ctx->blinding[seq & 1];
+        /* Order the copy before the second read of seq. */
+        secp256k1_atomic_fence_acquire();
+    } while (secp256k1_atomic_load_relaxed(&ctx->seq) != seq);
+}
+
+static void secp256k1_ecmult_gen_blinding_store(secp256k1_ecmult_gen_context *ctx, const secp256k1_ecmult_gen_blinding *b) {
+    unsigned int seq = secp256k1_atomic_load_relaxed(&ctx->seq);
+    /* Readers use blinding[1] while blinding[0] is written, then blinding[0]
+     * while blinding[1] is written. */
+    secp256k1_atomic_store_relaxed(&ctx->seq, seq + 1);
+    secp256k1_atomic_fence_release();
+    ctx->blinding[0] = *b;
+    secp256k1_atomic_store_release(&ctx->seq, seq + 2);
+    secp256k1_atomic_fence_release();
+    ctx->blinding[1] = *b;
+}
+
+static void secp256k1_ecmult_gen_blinded(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn, const secp256k1_ecmult_gen_blinding *blinding) {
     secp256k1_ge add;
     secp256k1_ge_storage adds;
     secp256k1_scalar gnb;
     int bits;
-    int i, j;
-    memset(&adds, 0, sizeof(adds));
-    *r = ctx->initial;
+    int j;
+    *r = blinding->initial;
     /* Blind scalar/point multiplication by computing (n-b)G + bG instead of nG. */
-    secp256k1_scalar_add(&gnb, gn, &ctx->blind);
+    secp256k1_scalar_add(&gnb, gn, &blinding->blind);
     add.infinity = 0;
     for (j = 0; j < ECMULT_GEN_PREC_N; j++) {
         bits = secp256k1_scalar_get_bits(&gnb, j * ECMULT_GEN_PREC_B, ECMULT_GEN_PREC_B);
-        for (i = 0; i < ECMULT_GEN_PREC_G; i++) {
-            /** This uses a conditional move to avoid any secret data in array indexes.
-             *   _Any_ use of secret indexes has been demonstrated to result in timing
-             *   sidechannels, even when the cache-line access patterns are uniform.
-             *  See also:
-             *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
-             *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
-             *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
-             *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
-             *    (https://www.tau.ac.il/~tromer/papers/cache.pdf)
-             */
-            secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == bits);
-        }
+        /** This uses a constant-time table scan to avoid any secret data in array indexes.
+         *   _Any_ use of secret indexes has been demonstrated to result in timing
+         *   sidechannels, even when the cache-line access patterns are uniform.
+         *  See also:
+         *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
+         *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
+         *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
+         *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
+         *    (https://www.tau.ac.il/~tromer/papers/cache.pdf)
+         */
+        secp256k1_ge_storage_table_select(&adds, (*ctx->prec)[j], ECMULT_GEN_PREC_G, bits);
         secp256k1_ge_from_storage(&add, &adds);
         secp256k1_gej_add_ge(r, r, &add);
     }
@@ -156,8 +183,16 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
     secp256k1_scalar_clear(&gnb);
 }
 
+static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
+    secp256k1_ecmult_gen_blinding blinding;
+    secp256k1_ecmult_gen_blinding_load(ctx, &blinding);
+    secp256k1_ecmult_gen_blinded(ctx, r, gn, &blinding);
+    secp256k1_scalar_clear(&blinding.blind);
+    secp256k1_gej_clear(&blinding.initial);
+}
+
 /* Setup blinding values for secp256k1_ecmult_gen. */
-static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32) {
+static void secp256k1_ecmult_gen_blinding_update(const secp256k1_ecmult_gen_context *ctx, secp256k1_ecmult_gen_blinding *cur, const unsigned char *seed32) {
     secp256k1_scalar b;
     secp256k1_gej gb;
     secp256k1_fe s;
@@ -167,12 +202,12 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     unsigned char keydata[64] = {0};
     if (seed32 == NULL) {
         /* When seed is NULL, reset the initial point and blinding value. */
-        secp256k1_gej_set_ge(&ctx->initial, &secp256k1_ge_const_g);
-        secp256k1_gej_neg(&ctx->initial, &ctx->initial);
-        secp256k1_scalar_set_int(&ctx->blind, 1);
+        secp256k1_gej_set_ge(&cur->initial, &secp256k1_ge_const_g);
+        secp256k1_gej_neg(&cur->initial, &cur->initial);
+        secp256k1_scalar_set_int(&cur->blind, 1);
     }
     /* The prior blinding value (if not reset) is chained forward by including it in the hash. */
-    secp256k1_scalar_get_b32(nonce32, &ctx->blind);
+    secp256k1_scalar_get_b32(nonce32, &cur->blind);
     /** Using a CSPRNG allows a failure free interface, avoids needing large amounts of random data,
      *   and guards against weak or adversarial seeds.  This is a simpler and safer interface than
      *   asking the caller for blinding values directly and expecting them to retry on failure.
@@ -189,7 +224,7 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     overflow |= secp256k1_fe_is_zero(&s);
     secp256k1_fe_cmov(&s, &secp256k1_fe_one, overflow);
     /* Randomize the projection to defend against multiplier sidechannels. */
-    secp256k1_gej_rescale(&ctx->initial, &s);
+    secp256k1_gej_rescale(&cur->initial, &s);
     secp256k1_fe_clear(&s);
     secp256k1_rfc6979_hmac_sha256_generate(&rng, nonce32, 32);
     secp256k1_scalar_set_b32(&b, nonce32, NULL);
@@ -197,12 +232,22 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     secp256k1_scalar_cmov(&b, &secp256k1_scalar_one, secp256k1_scalar_is_zero(&b));
     secp256k1_rfc6979_hmac_sha256_finalize(&rng);
     memset(nonce32, 0, 32);
-    secp256k1_ecmult_gen(ctx, &gb, &b);
-    secp256k1_scalar_negate(&b, &b);
-    ctx->blind = b;
-    ctx->initial = gb;
+    secp256k1_ecmult_gen_blinded(ctx, &gb, &b, cur);
+    secp256k1_scalar_negate(&cur->blind, &b);
+    cur->initial = gb;
     secp256k1_scalar_clear(&b);
     secp256k1_gej_clear(&gb);
 }
 
+static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32) {
+    secp256k1_ecmult_gen_blinding cur;
+    secp256k1_ecmult_gen_blinding_load(ctx, &cur);
+    secp256k1_ecmult_gen_blinding_update(ctx, &cur, seed32);
+    /* Publish the new blinding; concurrent secp256k1_ecmult_gen calls see
+     * either the old or the new one. */
+    secp256k1_ecmult_gen_blinding_store(ctx, &cur);
+    secp256k1_scalar_clear(&cur.blind);
+    secp256k1_gej_clear(&cur.initial);
+}
+
 #endif /* SECP256K1_ECMULT_GEN_IMPL_H */
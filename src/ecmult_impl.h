@@ -14,6 +14,7 @@
 #include "group.h"
 #include "scalar.h"
 #include "ecmult.h"
+#include "hash_impl.h"
 
 #if defined(EXHAUSTIVE_TEST_ORDER)
 /* We need to lower these values for exhaustive tests because
@@ -66,6 +67,15 @@
 /** The number of entries a table with precomputed multiples needs to have. */
 #define ECMULT_TABLE_SIZE(w) (1 << ((w)-2))
 
+/* secp256k1_ecmult_gen_var writes the scalar with one signed digit in
+ * [-2^(w-1), 2^(w-1)] per block of ECMULT_GEN_VAR_WINDOW bits, and looks up
+ * every nonzero digit in a table for its block, so that no doublings are needed.
+ * The table takes ECMULT_GEN_VAR_BLOCKS * ECMULT_GEN_VAR_ENTRIES * 64 bytes
+ * (88kB), so it is only built when USE_ECMULT_GEN_VAR_TABLE is defined. */
+#define ECMULT_GEN_VAR_WINDOW 6
+#define ECMULT_GEN_VAR_BLOCKS ((256 + ECMULT_GEN_VAR_WINDOW - 1) / ECMULT_GEN_VAR_WINDOW)
+#define ECMULT_GEN_VAR_ENTRIES (1 << (ECMULT_GEN_VAR_WINDOW - 1))
+
 /* The number of objects allocated on the scratch space for ecmult_multi algorithms */
 #define PIPPENGER_SCRATCH_OBJECTS 6
 #define STRAUSS_SCRATCH_OBJECTS 6
@@ -302,15 +312,66 @@ static void secp256k1_ecmult_odd_multiples_table_storage_var(const int n, secp25
 static const size_t SECP256K1_ECMULT_CONTEXT_PREALLOCATED_SIZE =
     ROUND_TO_ALIGN(sizeof((*((secp256k1_ecmult_context*) NULL)->pre_g)[0]) * ECMULT_TABLE_SIZE(WINDOW_G))
     + ROUND_TO_ALIGN(sizeof((*((secp256k1_ecmult_context*) NULL)->pre_g_128)[0]) * ECMULT_TABLE_SIZE(WINDOW_G))
+#ifdef USE_ECMULT_GEN_VAR_TABLE
+    + ROUND_TO_ALIGN(sizeof((*((secp256k1_ecmult_context*) NULL)->pre_gen)[0]) * ECMULT_GEN_VAR_BLOCKS * ECMULT_GEN_VAR_ENTRIES)
+#endif
     ;
 
+static const unsigned char secp256k1_ecmult_table_magic[8] = {'s', 'e', 'c', 'p', 'G', 't', 'b', 'l'};
+
 static void secp256k1_ecmult_context_init(secp256k1_ecmult_context *ctx) {
     ctx->pre_g = NULL;
     ctx->pre_g_128 = NULL;
+    ctx->pre_gen = NULL;
+    ctx->window_g = WINDOW_G;
+    ctx->external = 0;
+}
+
+#ifdef USE_ECMULT_GEN_VAR_TABLE
+/* Compute the table used by secp256k1_ecmult_gen_var into pre_gen: entry
+ * j*ECMULT_GEN_VAR_ENTRIES + i is (i+1)*2^(ECMULT_GEN_VAR_WINDOW*j)*G. */
+static void secp256k1_ecmult_gen_var_table_compute(secp256k1_ge_storage *pre_gen) {
+    secp256k1_gej multj[ECMULT_GEN_VAR_ENTRIES];
+    secp256k1_ge mult[ECMULT_GEN_VAR_ENTRIES];
+    secp256k1_ge base = secp256k1_ge_const_g;
+    int i, j;
+
+    for (j = 0; j < ECMULT_GEN_VAR_BLOCKS; j++) {
+        secp256k1_gej_set_ge(&multj[0], &base);
+        for (i = 1; i < ECMULT_GEN_VAR_ENTRIES; i++) {
+            secp256k1_gej_add_ge_var(&multj[i], &multj[i - 1], &base, NULL);
+        }
+        secp256k1_ge_set_all_gej_var(mult, multj, ECMULT_GEN_VAR_ENTRIES);
+        for (i = 0; i < ECMULT_GEN_VAR_ENTRIES; i++) {
+            secp256k1_ge_to_storage(&pre_gen[j * ECMULT_GEN_VAR_ENTRIES + i], &mult[i]);
+        }
+        /* The base of the next block is twice the largest multiple of this one. */
+        secp256k1_gej_double_var(&multj[0], &multj[ECMULT_GEN_VAR_ENTRIES - 1], NULL);
+        secp256k1_ge_set_gej_var(&base, &multj[0]);
+    }
+}
+#endif
+
+/* Compute the odd multiples of G and 2^128*G for a window of size w into pre_g and pre_g_128. */
+static void secp256k1_ecmult_table_compute(secp256k1_ge_storage *pre_g, secp256k1_ge_storage *pre_g_128, int w) {
+    secp256k1_gej gj, g_128j;
+    int i;
+
+    /* get the generator */
+    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+
+    /* precompute the tables with odd multiples */
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(w), pre_g, &gj);
+
+    /* calculate 2^128*generator */
+    g_128j = gj;
+    for (i = 0; i < 128; i++) {
+        secp256k1_gej_double_var(&g_128j, &g_128j, NULL);
+    }
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(w), pre_g_128, &g_128j);
 }
 
 static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, void **prealloc) {
-    secp256k1_gej gj;
     void* const base = *prealloc;
     size_t const prealloc_size = SECP256K1_ECMULT_CONTEXT_PREALLOCATED_SIZE;
 
@@ -318,9 +379,6 @@ static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, void *
         return;
     }
 
-    /* get the generator */
-    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
-
     {
         size_t size = sizeof((*ctx->pre_g)[0]) * ((size_t)ECMULT_TABLE_SIZE(WINDOW_G));
         /* check for overflow */
@@ -328,28 +386,131 @@ static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, void *
         ctx->pre_g = (secp256k1_ge_storage (*)[])manual_alloc(prealloc, sizeof((*ctx->pre_g)[0]) * ECMULT_TABLE_SIZE(WINDOW_G), base, prealloc_size);
     }
 
-    /* precompute the tables with odd multiples */
-    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), *ctx->pre_g, &gj);
-
     {
-        secp256k1_gej g_128j;
-        int i;
-
         size_t size = sizeof((*ctx->pre_g_128)[0]) * ((size_t) ECMULT_TABLE_SIZE(WINDOW_G));
         /* check for overflow */
         VERIFY_CHECK(size / sizeof((*ctx->pre_g_128)[0]) == ((size_t)ECMULT_TABLE_SIZE(WINDOW_G)));
         ctx->pre_g_128 = (secp256k1_ge_storage (*)[])manual_alloc(prealloc, sizeof((*ctx->pre_g_128)[0]) * ECMULT_TABLE_SIZE(WINDOW_G), base, prealloc_size);
+    }
 
-        /* calculate 2^128*generator */
-        g_128j = gj;
-        for (i = 0; i < 128; i++) {
-            secp256k1_gej_double_var(&g_128j, &g_128j, NULL);
-        }
-        secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), *ctx->pre_g_128, &g_128j);
+#ifdef USE_ECMULT_GEN_VAR_TABLE
+    ctx->pre_gen = (secp256k1_ge_storage (*)[])manual_alloc(prealloc, sizeof((*ctx->pre_gen)[0]) * ECMULT_GEN_VAR_BLOCKS * ECMULT_GEN_VAR_ENTRIES, base, prealloc_size);
+#endif
+
+    secp256k1_ecmult_table_compute(*ctx->pre_g, *ctx->pre_g_128, WINDOW_G);
+#if defined(USE_ECMULT_GEN_VAR_TABLE) && defined(EXHAUSTIVE_TEST_ORDER)
+    /* The multiples in the table would include the point at infinity. */
+    ctx->pre_gen = NULL;
+#elif defined(USE_ECMULT_GEN_VAR_TABLE)
+    secp256k1_ecmult_gen_var_table_compute(*ctx->pre_gen);
+#endif
+    ctx->window_g = WINDOW_G;
+}
+
+static size_t secp256k1_ecmult_table_size(int window) {
+    VERIFY_CHECK(window >= 2 && window <= 24);
+    return SECP256K1_ECMULT_TABLE_HEADER_SIZE + 2 * sizeof(secp256k1_ge_storage) * (size_t)ECMULT_TABLE_SIZE(window);
+}
+
+static void secp256k1_ecmult_table_write_le(unsigned char *out, uint64_t v, int bytes) {
+    int i;
+    for (i = 0; i < bytes; i++) {
+        out[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint64_t secp256k1_ecmult_table_read_le(const unsigned char *in, int bytes) {
+    uint64_t v = 0;
+    int i;
+    for (i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | in[i];
+    }
+    return v;
+}
+
+static void secp256k1_ecmult_table_create(unsigned char *out, int window) {
+    size_t n = ECMULT_TABLE_SIZE(window);
+    size_t body_size = secp256k1_ecmult_table_size(window) - SECP256K1_ECMULT_TABLE_HEADER_SIZE;
+    unsigned char *body = out + SECP256K1_ECMULT_TABLE_HEADER_SIZE;
+    secp256k1_ge_storage *pre_g = (secp256k1_ge_storage*)(void*)body;
+    secp256k1_sha256 sha;
+
+    secp256k1_ecmult_table_compute(pre_g, pre_g + n, window);
+
+    memset(out, 0, SECP256K1_ECMULT_TABLE_HEADER_SIZE);
+    memcpy(out, secp256k1_ecmult_table_magic, 8);
+    secp256k1_ecmult_table_write_le(out + 8, 1, 4);
+    secp256k1_ecmult_table_write_le(out + 12, window, 4);
+    secp256k1_ecmult_table_write_le(out + 16, sizeof(secp256k1_ge_storage), 4);
+    secp256k1_ecmult_table_write_le(out + 24, body_size, 8);
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, body, body_size);
+    secp256k1_sha256_finalize(&sha, out + 32);
+}
+
+static int secp256k1_ecmult_context_set_table(secp256k1_ecmult_context *ctx, const unsigned char *table, size_t len) {
+    secp256k1_ge_storage expected;
+    secp256k1_gej g_128j;
+    secp256k1_ge g_128;
+    secp256k1_sha256 sha;
+    unsigned char hash[32];
+    const secp256k1_ge_storage *pre_g;
+    uint64_t window;
+    size_t n;
+    int i;
+
+    if (len < SECP256K1_ECMULT_TABLE_HEADER_SIZE ||
+        secp256k1_memcmp_var(table, secp256k1_ecmult_table_magic, 8) != 0 ||
+        secp256k1_ecmult_table_read_le(table + 8, 4) != 1 ||
+        secp256k1_ecmult_table_read_le(table + 16, 4) != sizeof(secp256k1_ge_storage) ||
+        secp256k1_ecmult_table_read_le(table + 20, 4) != 0) {
+        return 0;
+    }
+    window = secp256k1_ecmult_table_read_le(table + 12, 4);
+    if (window < 2 || window > 24 || len != secp256k1_ecmult_table_size((int)window) ||
+        secp256k1_ecmult_table_read_le(table + 24, 8) != len - SECP256K1_ECMULT_TABLE_HEADER_SIZE) {
+        return 0;
+    }
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, table + SECP256K1_ECMULT_TABLE_HEADER_SIZE, len - SECP256K1_ECMULT_TABLE_HEADER_SIZE);
+    secp256k1_sha256_finalize(&sha, hash);
+    if (secp256k1_memcmp_var(hash, table + 32, 32) != 0) {
+        return 0;
+    }
+
+    /* The checksum does not catch images written on a platform with a different
+     * secp256k1_ge_storage representation, so check the first entry of both tables. */
+    n = ECMULT_TABLE_SIZE(window);
+    pre_g = (const secp256k1_ge_storage*)(const void*)(table + SECP256K1_ECMULT_TABLE_HEADER_SIZE);
+    secp256k1_ge_to_storage(&expected, &secp256k1_ge_const_g);
+    if (secp256k1_memcmp_var(&pre_g[0], &expected, sizeof(expected)) != 0) {
+        return 0;
+    }
+    secp256k1_gej_set_ge(&g_128j, &secp256k1_ge_const_g);
+    for (i = 0; i < 128; i++) {
+        secp256k1_gej_double_var(&g_128j, &g_128j, NULL);
+    }
+    secp256k1_ge_set_gej_var(&g_128, &g_128j);
+    secp256k1_fe_normalize_var(&g_128.x);
+    secp256k1_fe_normalize_var(&g_128.y);
+    secp256k1_ge_to_storage(&expected, &g_128);
+    if (secp256k1_memcmp_var(&pre_g[n], &expected, sizeof(expected)) != 0) {
+        return 0;
     }
+
+    /* The tables are never written through these pointers. */
+    ctx->pre_g = (secp256k1_ge_storage (*)[])(void*)(pre_g);
+    ctx->pre_g_128 = (secp256k1_ge_storage (*)[])(void*)(pre_g + n);
+    ctx->window_g = (int)window;
+    ctx->external = 1;
+    return 1;
 }
 
 static void secp256k1_ecmult_context_finalize_memcpy(secp256k1_ecmult_context *dst, const secp256k1_ecmult_context *src) {
+    if (src->external) {
+        /* The tables were not copied, keep referring to the same ones. */
+        return;
+    }
     if (src->pre_g != NULL) {
         /* We cast to void* first to suppress a -Wcast-align warning. */
         dst->pre_g = (secp256k1_ge_storage (*)[])(void*)((unsigned char*)dst + ((unsigned char*)(src->pre_g) - (unsigned char*)src));
@@ -357,12 +518,19 @@ static void secp256k1_ecmult_context_finalize_memcpy(secp256k1_ecmult_context *d
     if (src->pre_g_128 != NULL) {
         dst->pre_g_128 = (secp256k1_ge_storage (*)[])(void*)((unsigned char*)dst + ((unsigned char*)(src->pre_g_128) - (unsigned char*)src));
     }
+    if (src->pre_gen != NULL) {
+        dst->pre_gen = (secp256k1_ge_storage (*)[])(void*)((unsigned char*)dst + ((unsigned char*)(src->pre_gen) - (unsigned char*)src));
+    }
 }
 
 static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context *ctx) {
     return ctx->pre_g != NULL;
 }
 
+static int secp256k1_ecmult_context_is_external(const secp256k1_ecmult_context *ctx) {
+    return ctx->external;
+}
+
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx) {
     secp256k1_ecmult_context_init(ctx);
 }
@@ -518,8 +686,8 @@ static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, c
         secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
 
         /* Build wnaf representation for ng_1 and ng_128 */
-        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   WINDOW_G);
-        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, WINDOW_G);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   ctx->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, ctx->window_g);
         if (bits_ng_1 > bits) {
             bits = bits_ng_1;
         }
@@ -544,11 +712,11 @@ static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, c
             }
         }
         if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
         if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
     }
@@ -574,6 +742,127 @@ static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej
     secp256k1_ecmult_strauss_wnaf(ctx, &state, r, 1, a, na, ng);
 }
 
+static void secp256k1_ecmult_gen_var(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_scalar *a) {
+    int carry = 0;
+    int j;
+
+    if (ctx->pre_gen == NULL) {
+        secp256k1_ecmult(ctx, r, NULL, &secp256k1_scalar_zero, a);
+        return;
+    }
+    secp256k1_gej_set_infinity(r);
+    for (j = 0; j < ECMULT_GEN_VAR_BLOCKS; j++) {
+        int offset = j * ECMULT_GEN_VAR_WINDOW;
+        int count = 256 - offset < ECMULT_GEN_VAR_WINDOW ? 256 - offset : ECMULT_GEN_VAR_WINDOW;
+        int digit = (int)secp256k1_scalar_get_bits_var(a, offset, count) + carry;
+        secp256k1_ge add;
+        /* Digits above 2^(w-1) are replaced by their difference to 2^w, carrying
+         * into the next block. The last block has fewer bits, so it never carries. */
+        carry = digit > ECMULT_GEN_VAR_ENTRIES;
+        digit -= carry << ECMULT_GEN_VAR_WINDOW;
+        if (digit == 0) {
+            continue;
+        }
+        secp256k1_ge_from_storage(&add, &(*ctx->pre_gen)[j * ECMULT_GEN_VAR_ENTRIES + (digit > 0 ? digit : -digit) - 1]);
+        if (digit < 0) {
+            secp256k1_ge_neg(&add, &add);
+        }
+        secp256k1_gej_add_ge_var(r, r, &add, NULL);
+    }
+    VERIFY_CHECK(carry == 0);
+}
+
+struct secp256k1_ecmult_interleaved_state {
+    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_fe Z;
+    int wnaf_na_1[129];
+    int wnaf_na_lam[129];
+    int wnaf_ng_1[129];
+    int wnaf_ng_128[129];
+};
+
+static void secp256k1_ecmult_interleaved(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng, size_t num) {
+    struct secp256k1_ecmult_interleaved_state st[ECMULT_INTERLEAVE_MAX];
+    secp256k1_ge tmpa;
+    int bits = 0;
+    int i;
+    size_t j;
+
+    VERIFY_CHECK(num <= ECMULT_INTERLEAVE_MAX);
+
+    for (j = 0; j < num; ++j) {
+        secp256k1_scalar s_1, s_2;
+        int b;
+
+        if (secp256k1_scalar_is_zero(&na[j]) || secp256k1_gej_is_infinity(&a[j])) {
+            memset(st[j].wnaf_na_1, 0, sizeof(st[j].wnaf_na_1));
+            memset(st[j].wnaf_na_lam, 0, sizeof(st[j].wnaf_na_lam));
+            secp256k1_fe_set_int(&st[j].Z, 1);
+        } else {
+            /* Same per-point setup as secp256k1_ecmult_strauss_wnaf with a single point. */
+            secp256k1_scalar_split_lambda(&s_1, &s_2, &na[j]);
+            b = secp256k1_ecmult_wnaf(st[j].wnaf_na_1, 129, &s_1, WINDOW_A);
+            bits = b > bits ? b : bits;
+            b = secp256k1_ecmult_wnaf(st[j].wnaf_na_lam, 129, &s_2, WINDOW_A);
+            bits = b > bits ? b : bits;
+            secp256k1_ecmult_odd_multiples_table_globalz_windowa(st[j].pre_a, &st[j].Z, &a[j]);
+            for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
+                secp256k1_ge_mul_lambda(&st[j].pre_a_lam[i], &st[j].pre_a[i]);
+            }
+        }
+
+        secp256k1_scalar_split_128(&s_1, &s_2, &ng[j]);
+        b = secp256k1_ecmult_wnaf(st[j].wnaf_ng_1, 129, &s_1, ctx->window_g);
+        bits = b > bits ? b : bits;
+        b = secp256k1_ecmult_wnaf(st[j].wnaf_ng_128, 129, &s_2, ctx->window_g);
+        bits = b > bits ? b : bits;
+
+        secp256k1_gej_set_infinity(&r[j]);
+    }
+
+    for (i = bits - 1; i >= 0; i--) {
+        int n;
+        if (i > 0) {
+            /* Request the G table entries needed in the next iteration; they are
+             * fetched while the doublings and additions below are computed. */
+            for (j = 0; j < num; ++j) {
+                if ((n = st[j].wnaf_ng_1[i - 1])) {
+                    SECP256K1_PREFETCH(&(*ctx->pre_g)[(n > 0 ? n - 1 : -n - 1) / 2]);
+                }
+                if ((n = st[j].wnaf_ng_128[i - 1])) {
+                    SECP256K1_PREFETCH(&(*ctx->pre_g_128)[(n > 0 ? n - 1 : -n - 1) / 2]);
+                }
+            }
+        }
+        for (j = 0; j < num; ++j) {
+            secp256k1_gej_double_var(&r[j], &r[j], NULL);
+            if ((n = st[j].wnaf_na_1[i])) {
+                ECMULT_TABLE_GET_GE(&tmpa, st[j].pre_a, n, WINDOW_A);
+                secp256k1_gej_add_ge_var(&r[j], &r[j], &tmpa, NULL);
+            }
+            if ((n = st[j].wnaf_na_lam[i])) {
+                ECMULT_TABLE_GET_GE(&tmpa, st[j].pre_a_lam, n, WINDOW_A);
+                secp256k1_gej_add_ge_var(&r[j], &r[j], &tmpa, NULL);
+            }
+            if ((n = st[j].wnaf_ng_1[i])) {
+                ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, ctx->window_g);
+                secp256k1_gej_add_zinv_var(&r[j], &r[j], &tmpa, &st[j].Z);
+            }
+            if ((n = st[j].wnaf_ng_128[i])) {
+                ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, ctx->window_g);
+                secp256k1_gej_add_zinv_var(&r[j], &r[j], &tmpa, &st[j].Z);
+            }
+        }
+    }
+
+    for (j = 0; j < num; ++j) {
+        if (!r[j].infinity) {
+            secp256k1_fe_mul(&r[j].z, &r[j].z, &st[j].Z);
+        }
+    }
+}
+
 static size_t secp256k1_strauss_scratch_size(size_t n_points) {
     static const size_t point_size = (2 * sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe)) * ECMULT_TABLE_SIZE(WINDOW_A) + sizeof(struct secp256k1_strauss_point_state) + sizeof(secp256k1_gej) + sizeof(secp256k1_scalar);
     return n_points*point_size;
@@ -1040,6 +1329,9 @@ static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback,
     size_t n_batch_points;
 
     secp256k1_gej_set_infinity(r);
+    if (scratch != NULL) {
+        scratch->last_n_batches = 0;
+    }
     if (inp_g_sc == NULL && n == 0) {
         return 1;
     } else if (n == 0) {
@@ -1067,6 +1359,7 @@ static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback,
         }
         f = secp256k1_ecmult_strauss_batch;
     }
+    scratch->last_n_batches = n_batches;
     for(i = 0; i < n_batches; i++) {
         size_t nbp = n < n_batch_points ? n : n_batch_points;
         size_t offset = n_batch_points*i;
@@ -103,6 +103,20 @@ static void secp256k1_fe_sqr(secp256k1_fe *r, const secp256k1_fe *a);
  *  itself. */
 static int secp256k1_fe_sqrt(secp256k1_fe *r, const secp256k1_fe *a);
 
+/** The number of square roots computed at once by secp256k1_fe_sqrt_lanes. */
+#define SECP256K1_FE_SQRT_LANES 4
+
+/** Compute SECP256K1_FE_SQRT_LANES square roots at once: for every k, compute r[k] and ret[k] as
+ *  secp256k1_fe_sqrt(&r[k], &a[k]) would. The exponentiations are interleaved, which hides the
+ *  latency of the field squarings on CPUs that can execute several of them at the same time.
+ *  r and a must not overlap. */
+static void secp256k1_fe_sqrt_lanes(int *ret, secp256k1_fe *r, const secp256k1_fe *a);
+
+/** Checks whether a field element is a quadratic residue (has a square root), without
+ *  computing the root. Zero counts as a square. The input's magnitude can be at most 8.
+ *  Not constant time. */
+static int secp256k1_fe_is_square_var(const secp256k1_fe *a);
+
 /** Sets a field element to be the (modular) inverse of another. Requires the input's magnitude to be
  *  at most 8. The output magnitude is 1 (but not guaranteed to be normalized). */
 static void secp256k1_fe_inv(secp256k1_fe *r, const secp256k1_fe *a);
@@ -119,6 +133,9 @@ static void secp256k1_fe_from_storage(secp256k1_fe *r, const secp256k1_fe_storag
 /** If flag is true, set *r equal to *a; otherwise leave it. Constant-time.  Both *r and *a must be initialized.*/
 static void secp256k1_fe_storage_cmov(secp256k1_fe_storage *r, const secp256k1_fe_storage *a, int flag);
 
+/** If flag is true, bitwise OR *a into *r; otherwise leave it. Constant-time.  Both *r and *a must be initialized.*/
+static void secp256k1_fe_storage_or_cmov(secp256k1_fe_storage *r, const secp256k1_fe_storage *a, int flag);
+
 /** If flag is true, set *r equal to *a; otherwise leave it. Constant-time.  Both *r and *a must be initialized.*/
 static void secp256k1_fe_cmov(secp256k1_fe *r, const secp256k1_fe *a, int flag);
 
@@ -135,6 +135,56 @@ static int secp256k1_fe_sqrt(secp256k1_fe *r, const secp256k1_fe *a) {
     return secp256k1_fe_equal(&t1, a);
 }
 
+/* r[k] = a[k]^(2^n) * b[k] for every lane k. The lanes are processed in lockstep, so the
+ * squarings of different lanes, which do not depend on each other, can overlap. */
+static void secp256k1_fe_sqr_n_mul_lanes(secp256k1_fe *r, const secp256k1_fe *a, int n, const secp256k1_fe *b) {
+    int j, k;
+    for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+        r[k] = a[k];
+    }
+    for (j = 0; j < n; j++) {
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            secp256k1_fe_sqr(&r[k], &r[k]);
+        }
+    }
+    for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+        secp256k1_fe_mul(&r[k], &r[k], &b[k]);
+    }
+}
+
+static void secp256k1_fe_sqrt_lanes(int *ret, secp256k1_fe *r, const secp256k1_fe *a) {
+    /* The same addition chain as in secp256k1_fe_sqrt. */
+    secp256k1_fe x2[SECP256K1_FE_SQRT_LANES], x3[SECP256K1_FE_SQRT_LANES], x6[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe x9[SECP256K1_FE_SQRT_LANES], x11[SECP256K1_FE_SQRT_LANES], x22[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe x44[SECP256K1_FE_SQRT_LANES], x88[SECP256K1_FE_SQRT_LANES], x176[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe x220[SECP256K1_FE_SQRT_LANES], x223[SECP256K1_FE_SQRT_LANES], t1[SECP256K1_FE_SQRT_LANES];
+    int k;
+
+    VERIFY_CHECK(r != a);
+
+    secp256k1_fe_sqr_n_mul_lanes(x2, a, 1, a);
+    secp256k1_fe_sqr_n_mul_lanes(x3, x2, 1, a);
+    secp256k1_fe_sqr_n_mul_lanes(x6, x3, 3, x3);
+    secp256k1_fe_sqr_n_mul_lanes(x9, x6, 3, x3);
+    secp256k1_fe_sqr_n_mul_lanes(x11, x9, 2, x2);
+    secp256k1_fe_sqr_n_mul_lanes(x22, x11, 11, x11);
+    secp256k1_fe_sqr_n_mul_lanes(x44, x22, 22, x22);
+    secp256k1_fe_sqr_n_mul_lanes(x88, x44, 44, x44);
+    secp256k1_fe_sqr_n_mul_lanes(x176, x88, 88, x88);
+    secp256k1_fe_sqr_n_mul_lanes(x220, x176, 44, x44);
+    secp256k1_fe_sqr_n_mul_lanes(x223, x220, 3, x3);
+
+    secp256k1_fe_sqr_n_mul_lanes(t1, x223, 23, x22);
+    secp256k1_fe_sqr_n_mul_lanes(t1, t1, 6, x2);
+    for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+        secp256k1_fe_sqr(&t1[k], &t1[k]);
+        secp256k1_fe_sqr(&r[k], &t1[k]);
+        /* Check that a square root was actually calculated */
+        secp256k1_fe_sqr(&t1[k], &r[k]);
+        ret[k] = secp256k1_fe_equal(&t1[k], &a[k]);
+    }
+}
+
 static const secp256k1_fe secp256k1_fe_one = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
 
 #endif /* SECP256K1_FIELD_IMPL_H */
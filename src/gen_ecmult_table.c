@@ -0,0 +1,61 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+/* Writes a precomputed table image for secp256k1_context_create_with_ecmult_table.
+ * Usage: gen_ecmult_table <window size> <output file> */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/secp256k1.h"
+#include "assumptions.h"
+#include "util.h"
+#include "field_impl.h"
+#include "scalar_impl.h"
+#include "group_impl.h"
+#include "ecmult_impl.h"
+#include "scratch_impl.h"
+
+static void default_error_callback_fn(const char* str, void* data) {
+    (void)data;
+    fprintf(stderr, "[libsecp256k1] internal consistency check failed: %s\n", str);
+    abort();
+}
+
+static const secp256k1_callback default_error_callback = {
+    default_error_callback_fn,
+    NULL
+};
+
+int main(int argc, char **argv) {
+    unsigned char *table;
+    size_t size;
+    int window;
+    FILE* fp;
+
+    if (argc != 3 || (window = atoi(argv[1])) < 2 || window > 24) {
+        fprintf(stderr, "Usage: %s <window size in [2..24]> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    size = secp256k1_ecmult_table_size(window);
+    table = (unsigned char*)checked_malloc(&default_error_callback, size);
+    secp256k1_ecmult_table_create(table, window);
+
+    fp = fopen(argv[2], "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not open %s for writing!\n", argv[2]);
+        free(table);
+        return 1;
+    }
+    if (fwrite(table, 1, size, fp) != size || fclose(fp) != 0) {
+        fprintf(stderr, "Could not write %s!\n", argv[2]);
+        free(table);
+        return 1;
+    }
+    free(table);
+
+    return 0;
+}
@@ -46,6 +46,19 @@ static void secp256k1_ge_set_xy(secp256k1_ge *r, const secp256k1_fe *x, const se
  *  for Y. Return value indicates whether the result is valid. */
 static int secp256k1_ge_set_xo_var(secp256k1_ge *r, const secp256k1_fe *x, int odd);
 
+/** Set a group element (affine) equal to the point with the given X coordinate and a Y coordinate
+ *  that is a quadratic residue modulo p. Return value indicates whether the result is valid. */
+static int secp256k1_ge_set_xquad(secp256k1_ge *r, const secp256k1_fe *x);
+
+/** Do secp256k1_ge_set_xo_var for SECP256K1_FE_SQRT_LANES X coordinates at once: for every k,
+ *  ret[k] = secp256k1_ge_set_xo_var(&r[k], &x[k], odd[k]). The square roots are computed with
+ *  secp256k1_fe_sqrt_lanes. r[k] is left untouched if ret[k] is 0. */
+static void secp256k1_ge_set_xo_var_lanes(int *ret, secp256k1_ge *r, const secp256k1_fe *x, const int *odd);
+
+/** Determine whether x is the X coordinate of a point on the curve (and in the correct subgroup),
+ *  without computing its Y coordinate. */
+static int secp256k1_ge_x_on_curve_var(const secp256k1_fe *x);
+
 /** Check whether a group element is the point at infinity. */
 static int secp256k1_ge_is_infinity(const secp256k1_ge *a);
 
@@ -64,6 +77,11 @@ static void secp256k1_ge_set_gej_var(secp256k1_ge *r, secp256k1_gej *a);
 /** Set a batch of group elements equal to the inputs given in jacobian coordinates */
 static void secp256k1_ge_set_all_gej_var(secp256k1_ge *r, const secp256k1_gej *a, size_t len);
 
+/** Set a batch of group elements equal to the inputs given in jacobian coordinates, using a
+ *  single inversion. Constant time (in the values, not in len). None of the inputs may be
+ *  infinity. */
+static void secp256k1_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len);
+
 /** Bring a batch inputs given in jacobian coordinates (with known z-ratios) to
  *  the same global z "denominator". zr must contain the known z-ratios such
  *  that mul(a[i].z, zr[i+1]) == a[i+1].z. zr[0] is ignored. The x and y
@@ -127,6 +145,11 @@ static void secp256k1_ge_from_storage(secp256k1_ge *r, const secp256k1_ge_storag
 /** If flag is true, set *r equal to *a; otherwise leave it. Constant-time.  Both *r and *a must be initialized.*/
 static void secp256k1_ge_storage_cmov(secp256k1_ge_storage *r, const secp256k1_ge_storage *a, int flag);
 
+/** Set *r equal to table[idx], reading every one of the n entries so that neither the
+ *  memory access pattern nor the timing depends on idx. Requires 0 <= idx < n for a
+ *  meaningful result (out of range yields all zeroes). */
+static void secp256k1_ge_storage_table_select(secp256k1_ge_storage *r, const secp256k1_ge_storage *table, int n, int idx);
+
 /** Rescale a jacobian point by b which must be non-zero. Constant-time. */
 static void secp256k1_gej_rescale(secp256k1_gej *r, const secp256k1_fe *b);
 
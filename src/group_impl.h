@@ -155,6 +155,30 @@ static void secp256k1_ge_set_all_gej_var(secp256k1_ge *r, const secp256k1_gej *a
     }
 }
 
+static void secp256k1_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len) {
+    secp256k1_fe u;
+    size_t i;
+    if (len == 0) {
+        return;
+    }
+    /* Use the x coordinates of r to hold the prefix products of the z coordinates. */
+    r[0].x = a[0].z;
+    VERIFY_CHECK(!a[0].infinity);
+    for (i = 1; i < len; i++) {
+        VERIFY_CHECK(!a[i].infinity);
+        secp256k1_fe_mul(&r[i].x, &r[i - 1].x, &a[i].z);
+    }
+    secp256k1_fe_inv(&u, &r[len - 1].x);
+    for (i = len - 1; i > 0; i--) {
+        /* u is the inverse of the product of the first i+1 z coordinates. */
+        secp256k1_fe zi;
+        secp256k1_fe_mul(&zi, &u, &r[i - 1].x);
+        secp256k1_fe_mul(&u, &u, &a[i].z);
+        secp256k1_ge_set_gej_zinv(&r[i], &a[i], &zi);
+    }
+    secp256k1_ge_set_gej_zinv(&r[0], &a[0], &u);
+}
+
 static void secp256k1_ge_globalz_set_table_gej(size_t len, secp256k1_ge *r, secp256k1_fe *globalz, const secp256k1_gej *a, const secp256k1_fe *zr) {
     size_t i = len - 1;
     secp256k1_fe zs;
@@ -206,14 +230,19 @@ static void secp256k1_ge_clear(secp256k1_ge *r) {
     secp256k1_fe_clear(&r->y);
 }
 
-static int secp256k1_ge_set_xo_var(secp256k1_ge *r, const secp256k1_fe *x, int odd) {
+static int secp256k1_ge_set_xquad(secp256k1_ge *r, const secp256k1_fe *x) {
     secp256k1_fe x2, x3;
     r->x = *x;
     secp256k1_fe_sqr(&x2, x);
     secp256k1_fe_mul(&x3, x, &x2);
     r->infinity = 0;
     secp256k1_fe_add(&x3, &secp256k1_fe_const_b);
-    if (!secp256k1_fe_sqrt(&r->y, &x3)) {
+    /* As p = 3 mod 4, the root returned by secp256k1_fe_sqrt is itself a square. */
+    return secp256k1_fe_sqrt(&r->y, &x3);
+}
+
+static int secp256k1_ge_set_xo_var(secp256k1_ge *r, const secp256k1_fe *x, int odd) {
+    if (!secp256k1_ge_set_xquad(r, x)) {
         return 0;
     }
     secp256k1_fe_normalize_var(&r->y);
@@ -224,6 +253,45 @@ static int secp256k1_ge_set_xo_var(secp256k1_ge *r, const secp256k1_fe *x, int o
 
 }
 
+static void secp256k1_ge_set_xo_var_lanes(int *ret, secp256k1_ge *r, const secp256k1_fe *x, const int *odd) {
+    secp256k1_fe x3[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe y[SECP256K1_FE_SQRT_LANES];
+    int k;
+    for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+        secp256k1_fe x2;
+        secp256k1_fe_sqr(&x2, &x[k]);
+        secp256k1_fe_mul(&x3[k], &x[k], &x2);
+        secp256k1_fe_add(&x3[k], &secp256k1_fe_const_b);
+    }
+    secp256k1_fe_sqrt_lanes(ret, y, x3);
+    for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+        if (!ret[k]) {
+            continue;
+        }
+        r[k].x = x[k];
+        r[k].y = y[k];
+        r[k].infinity = 0;
+        secp256k1_fe_normalize_var(&r[k].y);
+        if (secp256k1_fe_is_odd(&r[k].y) != odd[k]) {
+            secp256k1_fe_negate(&r[k].y, &r[k].y, 1);
+        }
+    }
+}
+
+static int secp256k1_ge_x_on_curve_var(const secp256k1_fe *x) {
+#ifdef EXHAUSTIVE_TEST_ORDER
+    /* The test curves have a cofactor, so the subgroup check needs the full point. */
+    secp256k1_ge ge;
+    return secp256k1_ge_set_xo_var(&ge, x, 0) && secp256k1_ge_is_in_correct_subgroup(&ge);
+#else
+    secp256k1_fe c;
+    secp256k1_fe_sqr(&c, x);
+    secp256k1_fe_mul(&c, &c, x);
+    secp256k1_fe_add(&c, &secp256k1_fe_const_b);
+    return secp256k1_fe_is_square_var(&c);
+#endif
+}
+
 static void secp256k1_gej_set_ge(secp256k1_gej *r, const secp256k1_ge *a) {
    r->infinity = a->infinity;
    r->x = a->x;
@@ -641,6 +709,21 @@ static SECP256K1_INLINE void secp256k1_ge_storage_cmov(secp256k1_ge_storage *r,
     secp256k1_fe_storage_cmov(&r->y, &a->y, flag);
 }
 
+static void secp256k1_ge_storage_table_select(secp256k1_ge_storage *r, const secp256k1_ge_storage *table, int n, int idx) {
+    static const secp256k1_ge_storage zero = SECP256K1_GE_STORAGE_CONST(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    int i;
+    /* Accumulate the masked entries with OR rather than a cmov chain: each entry is then
+     * an independent load-and-mask over contiguous memory, which compilers turn into wide
+     * vector operations, and there is no read-modify-write dependency on the previous value
+     * of every limb. Storing the table limb-interleaved instead was measured to be no faster
+     * than the cmov chain, so the table keeps the secp256k1_ge_storage layout. */
+    *r = zero;
+    for (i = 0; i < n; i++) {
+        secp256k1_fe_storage_or_cmov(&r->x, &table[i].x, i == idx);
+        secp256k1_fe_storage_or_cmov(&r->y, &table[i].y, i == idx);
+    }
+}
+
 static void secp256k1_ge_mul_lambda(secp256k1_ge *r, const secp256k1_ge *a) {
     static const secp256k1_fe beta = SECP256K1_FE_CONST(
         0x7ae96a2bul, 0x657c0710ul, 0x6e64479eul, 0xac3434e9ul,
@@ -35,6 +35,12 @@ typedef struct {
 } secp256k1_rfc6979_hmac_sha256;
 
 static void secp256k1_rfc6979_hmac_sha256_initialize(secp256k1_rfc6979_hmac_sha256 *rng, const unsigned char *key, size_t keylen);
+/* Computes the SHA256 midstate that RFC6979 3.2.d reaches after hashing the first
+ * 31 bytes of the key, which is all that depends on them. */
+static void secp256k1_rfc6979_hmac_sha256_midstate(uint32_t *midstate8, const unsigned char *key31);
+/* Same as secp256k1_rfc6979_hmac_sha256_initialize, for keylen >= 31 and a midstate8
+ * computed by secp256k1_rfc6979_hmac_sha256_midstate from the first 31 bytes of key. */
+static void secp256k1_rfc6979_hmac_sha256_initialize_midstate(secp256k1_rfc6979_hmac_sha256 *rng, const uint32_t *midstate8, const unsigned char *key, size_t keylen);
 static void secp256k1_rfc6979_hmac_sha256_generate(secp256k1_rfc6979_hmac_sha256 *rng, unsigned char *out, size_t outlen);
 static void secp256k1_rfc6979_hmac_sha256_finalize(secp256k1_rfc6979_hmac_sha256 *rng);
 
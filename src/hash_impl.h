@@ -218,36 +218,99 @@ static void secp256k1_hmac_sha256_finalize(secp256k1_hmac_sha256 *hash, unsigned
 }
 
 
-static void secp256k1_rfc6979_hmac_sha256_initialize(secp256k1_rfc6979_hmac_sha256 *rng, const unsigned char *key, size_t keylen) {
-    secp256k1_hmac_sha256 hmac;
-    static const unsigned char zero[1] = {0x00};
+/* Initializes an HMAC-SHA256 with the all-zero 32-byte key K of RFC6979 3.2.c.
+ * The midstates were computed by applying SHA256 to 64 bytes 0x36 and 64 bytes
+ * 0x5c, the padded key blocks. */
+static void secp256k1_rfc6979_hmac_sha256_initialize_zero_key(secp256k1_hmac_sha256 *hmac) {
+    secp256k1_sha256_initialize(&hmac->inner);
+    hmac->inner.s[0] = 0xf454deadul;
+    hmac->inner.s[1] = 0x9725214ful;
+    hmac->inner.s[2] = 0x90daf2a0ul;
+    hmac->inner.s[3] = 0xdf1228eaul;
+    hmac->inner.s[4] = 0x64e5750ful;
+    hmac->inner.s[5] = 0xa3924181ul;
+    hmac->inner.s[6] = 0x824a932bul;
+    hmac->inner.s[7] = 0xf8e04e32ul;
+    hmac->inner.bytes = 64;
+
+    secp256k1_sha256_initialize(&hmac->outer);
+    hmac->outer.s[0] = 0xd385480ful;
+    hmac->outer.s[1] = 0x7abb6477ul;
+    hmac->outer.s[2] = 0x37c9c538ul;
+    hmac->outer.s[3] = 0x5dd82467ul;
+    hmac->outer.s[4] = 0x8e043a72ul;
+    hmac->outer.s[5] = 0x753434b0ul;
+    hmac->outer.s[6] = 0xdeb82818ul;
+    hmac->outer.s[7] = 0x361d45a6ul;
+    hmac->outer.bytes = 64;
+}
+
+/* Completes RFC6979 3.2.d to 3.2.g, given the HMAC of 3.2.d with V || 0x00 ||
+ * key[0..prefixlen-1] already written to it. */
+static void secp256k1_rfc6979_hmac_sha256_initialize_finish(secp256k1_rfc6979_hmac_sha256 *rng, secp256k1_hmac_sha256 *hmac, const unsigned char *key, size_t keylen, size_t prefixlen) {
     static const unsigned char one[1] = {0x01};
 
     memset(rng->v, 0x01, 32); /* RFC6979 3.2.b. */
-    memset(rng->k, 0x00, 32); /* RFC6979 3.2.c. */
 
     /* RFC6979 3.2.d. */
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
-    secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
-    secp256k1_hmac_sha256_write(&hmac, zero, 1);
-    secp256k1_hmac_sha256_write(&hmac, key, keylen);
-    secp256k1_hmac_sha256_finalize(&hmac, rng->k);
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
-    secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
-    secp256k1_hmac_sha256_finalize(&hmac, rng->v);
+    secp256k1_hmac_sha256_write(hmac, key + prefixlen, keylen - prefixlen);
+    secp256k1_hmac_sha256_finalize(hmac, rng->k);
+    secp256k1_hmac_sha256_initialize(hmac, rng->k, 32);
+    secp256k1_hmac_sha256_write(hmac, rng->v, 32);
+    secp256k1_hmac_sha256_finalize(hmac, rng->v);
 
     /* RFC6979 3.2.f. */
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
-    secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
-    secp256k1_hmac_sha256_write(&hmac, one, 1);
-    secp256k1_hmac_sha256_write(&hmac, key, keylen);
-    secp256k1_hmac_sha256_finalize(&hmac, rng->k);
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
-    secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
-    secp256k1_hmac_sha256_finalize(&hmac, rng->v);
+    secp256k1_hmac_sha256_initialize(hmac, rng->k, 32);
+    secp256k1_hmac_sha256_write(hmac, rng->v, 32);
+    secp256k1_hmac_sha256_write(hmac, one, 1);
+    secp256k1_hmac_sha256_write(hmac, key, keylen);
+    secp256k1_hmac_sha256_finalize(hmac, rng->k);
+    secp256k1_hmac_sha256_initialize(hmac, rng->k, 32);
+    secp256k1_hmac_sha256_write(hmac, rng->v, 32);
+    secp256k1_hmac_sha256_finalize(hmac, rng->v);
     rng->retry = 0;
 }
 
+static void secp256k1_rfc6979_hmac_sha256_initialize(secp256k1_rfc6979_hmac_sha256 *rng, const unsigned char *key, size_t keylen) {
+    secp256k1_hmac_sha256 hmac;
+    static const unsigned char zero[1] = {0x00};
+    unsigned char v[32];
+
+    memset(v, 0x01, 32); /* RFC6979 3.2.b. */
+
+    /* RFC6979 3.2.d, with K from RFC6979 3.2.c. */
+    secp256k1_rfc6979_hmac_sha256_initialize_zero_key(&hmac);
+    secp256k1_hmac_sha256_write(&hmac, v, 32);
+    secp256k1_hmac_sha256_write(&hmac, zero, 1);
+    secp256k1_rfc6979_hmac_sha256_initialize_finish(rng, &hmac, key, keylen, 0);
+}
+
+static void secp256k1_rfc6979_hmac_sha256_midstate(uint32_t *midstate8, const unsigned char *key31) {
+    secp256k1_hmac_sha256 hmac;
+    static const unsigned char zero[1] = {0x00};
+    unsigned char v[32];
+
+    memset(v, 0x01, 32);
+    secp256k1_rfc6979_hmac_sha256_initialize_zero_key(&hmac);
+    secp256k1_hmac_sha256_write(&hmac, v, 32);
+    secp256k1_hmac_sha256_write(&hmac, zero, 1);
+    secp256k1_hmac_sha256_write(&hmac, key31, 31);
+    /* V || 0x00 || key[0..30] fills the second block exactly. */
+    VERIFY_CHECK(hmac.inner.bytes == 128);
+    memcpy(midstate8, hmac.inner.s, sizeof(hmac.inner.s));
+    memset(&hmac, 0, sizeof(hmac));
+}
+
+static void secp256k1_rfc6979_hmac_sha256_initialize_midstate(secp256k1_rfc6979_hmac_sha256 *rng, const uint32_t *midstate8, const unsigned char *key, size_t keylen) {
+    secp256k1_hmac_sha256 hmac;
+
+    VERIFY_CHECK(keylen >= 31);
+    secp256k1_rfc6979_hmac_sha256_initialize_zero_key(&hmac);
+    memcpy(hmac.inner.s, midstate8, sizeof(hmac.inner.s));
+    hmac.inner.bytes = 128;
+    secp256k1_rfc6979_hmac_sha256_initialize_finish(rng, &hmac, key, keylen, 31);
+}
+
 static void secp256k1_rfc6979_hmac_sha256_generate(secp256k1_rfc6979_hmac_sha256 *rng, unsigned char *out, size_t outlen) {
     /* RFC6979 3.2.h. */
     static const unsigned char zero[1] = {0x00};
@@ -0,0 +1,325 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_BATCH_MAIN_H
+#define SECP256K1_MODULE_BATCH_MAIN_H
+
+#include "../../../include/secp256k1.h"
+#include "../../../include/secp256k1_batch.h"
+#include "../../hash.h"
+#include "../../scratch_impl.h"
+
+/* Every statement in a batch has the form g*G + c*A - B = 0:
+ *  - a Schnorr signature (R, s) on pubkey P with challenge e: g = s, A = P,
+ *    c = -e, B = R.
+ *  - a tweak check of Q against internal key P and tweak t: g = t, A = P,
+ *    c = 1, B = Q.
+ * A flush draws a random factor a_i per statement and checks that
+ *   (sum a_i*g_i)*G + sum (a_i*c_i)*A_i + sum (-a_i)*B_i = 0
+ * with a single multi-scalar multiplication. The factors are derived from a
+ * hash of every statement added so far, so they cannot be known before the
+ * statements are fixed. */
+struct secp256k1_batch_struct {
+    secp256k1_allocator allocator;
+    secp256k1_scratch *scratch;
+    /* A_i at 2*i and B_i at 2*i+1 */
+    secp256k1_ge *points;
+    /* c_i at 2*i and g_i at 2*i+1 */
+    secp256k1_scalar *scalars;
+    /* The scalars of points, filled in by a flush. */
+    secp256k1_scalar *rand_scalars;
+    size_t capacity;
+    /* The number of statements waiting for the next flush. */
+    size_t len;
+    /* The number of statements added since creation or the last verify. */
+    size_t n_added;
+    /* SIZE_MAX if no statement is known to fail. */
+    size_t first_failure;
+    secp256k1_sha256 sha;
+    unsigned char aux_rand16[16];
+};
+
+static const unsigned char secp256k1_batch_tag[15] = "secp256k1/batch";
+
+static void secp256k1_batch_reset(secp256k1_batch *batch) {
+    batch->len = 0;
+    batch->n_added = 0;
+    batch->first_failure = SIZE_MAX;
+    secp256k1_sha256_initialize_tagged(&batch->sha, secp256k1_batch_tag, sizeof(secp256k1_batch_tag));
+    secp256k1_sha256_write(&batch->sha, batch->aux_rand16, sizeof(batch->aux_rand16));
+}
+
+static size_t secp256k1_batch_scratch_size(size_t n_points) {
+    if (n_points >= ECMULT_PIPPENGER_THRESHOLD) {
+        int bucket_window = secp256k1_pippenger_bucket_window(n_points);
+        return secp256k1_pippenger_scratch_size(n_points, bucket_window) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
+    }
+    return secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT;
+}
+
+secp256k1_batch* secp256k1_batch_create(const secp256k1_context* ctx, size_t max_statements, const unsigned char *aux_rand16) {
+    const size_t base_alloc = ROUND_TO_ALIGN(sizeof(secp256k1_batch));
+    const size_t statement_size = ROUND_TO_ALIGN(2 * sizeof(secp256k1_ge)) + 2 * ROUND_TO_ALIGN(2 * sizeof(secp256k1_scalar));
+    secp256k1_batch *ret;
+    void *alloc;
+    void *prealloc;
+    size_t alloc_size;
+
+    VERIFY_CHECK(ctx != NULL);
+
+    if (max_statements == 0) {
+        max_statements = SECP256K1_BATCH_DEFAULT_MAX_STATEMENTS;
+    }
+    /* Each statement has two points, and the scratch space for them needs far
+     * less than 64 kB per point, so its size cannot overflow either. */
+    if (max_statements > (SIZE_MAX - base_alloc) / statement_size
+        || max_statements > ECMULT_MAX_POINTS_PER_BATCH / 2
+        || max_statements > SIZE_MAX / 2 / 65536) {
+        return NULL;
+    }
+
+    alloc_size = base_alloc + max_statements * statement_size;
+    alloc = checked_alloc(&ctx->allocator, &ctx->error_callback, alloc_size);
+    if (alloc == NULL) {
+        return NULL;
+    }
+    prealloc = alloc;
+    ret = (secp256k1_batch *)manual_alloc(&prealloc, sizeof(secp256k1_batch), alloc, alloc_size);
+    ret->allocator = ctx->allocator;
+    ret->points = (secp256k1_ge *)manual_alloc(&prealloc, max_statements * ROUND_TO_ALIGN(2 * sizeof(secp256k1_ge)), alloc, alloc_size);
+    ret->scalars = (secp256k1_scalar *)manual_alloc(&prealloc, max_statements * ROUND_TO_ALIGN(2 * sizeof(secp256k1_scalar)), alloc, alloc_size);
+    ret->rand_scalars = (secp256k1_scalar *)manual_alloc(&prealloc, max_statements * ROUND_TO_ALIGN(2 * sizeof(secp256k1_scalar)), alloc, alloc_size);
+    ret->capacity = max_statements;
+    ret->scratch = secp256k1_scratch_create(&ctx->error_callback, &ctx->allocator, secp256k1_batch_scratch_size(2 * max_statements));
+    if (ret->scratch == NULL) {
+        secp256k1_dealloc(&ret->allocator, ret);
+        return NULL;
+    }
+    if (aux_rand16 != NULL) {
+        memcpy(ret->aux_rand16, aux_rand16, sizeof(ret->aux_rand16));
+    } else {
+        memset(ret->aux_rand16, 0, sizeof(ret->aux_rand16));
+    }
+    secp256k1_batch_reset(ret);
+    return ret;
+}
+
+void secp256k1_batch_destroy(const secp256k1_context* ctx, secp256k1_batch *batch) {
+    VERIFY_CHECK(ctx != NULL);
+    if (batch != NULL) {
+        /* The allocator lives in the memory being released. */
+        secp256k1_allocator allocator = batch->allocator;
+        secp256k1_scratch_destroy(&ctx->error_callback, batch->scratch);
+        secp256k1_dealloc(&allocator, batch);
+    }
+}
+
+static int secp256k1_batch_ecmult_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_batch *batch = (const secp256k1_batch *)data;
+    *sc = batch->rand_scalars[idx];
+    *pt = batch->points[idx];
+    return 1;
+}
+
+/* Returns whether statement i of the waiting statements holds on its own. */
+static int secp256k1_batch_check_one(const secp256k1_ecmult_context *ecmult_ctx, const secp256k1_batch *batch, size_t i) {
+    secp256k1_gej rj;
+    secp256k1_gej aj;
+    secp256k1_ge neg_b;
+
+    secp256k1_gej_set_ge(&aj, &batch->points[2 * i]);
+    secp256k1_ecmult(ecmult_ctx, &rj, &aj, &batch->scalars[2 * i], &batch->scalars[2 * i + 1]);
+    secp256k1_ge_neg(&neg_b, &batch->points[2 * i + 1]);
+    secp256k1_gej_add_ge_var(&rj, &rj, &neg_b, NULL);
+    return secp256k1_gej_is_infinity(&rj);
+}
+
+/* Checks the waiting statements and empties them. If some statement does not
+ * hold, the first such one is recorded in first_failure. */
+static void secp256k1_batch_flush(const secp256k1_context *ctx, secp256k1_batch *batch) {
+    secp256k1_sha256 sha;
+    secp256k1_scalar g_sum;
+    secp256k1_gej rj;
+    unsigned char seed[32];
+    unsigned char rand32[32];
+    unsigned char buf[32];
+    size_t base = batch->n_added - batch->len;
+    size_t i;
+
+    if (batch->len == 0) {
+        return;
+    }
+
+    sha = batch->sha;
+    secp256k1_sha256_finalize(&sha, seed);
+    secp256k1_scalar_set_int(&g_sum, 0);
+    /* The factors have 128 bits, so each hash yields those of two statements. */
+    memset(buf, 0, 16);
+    for (i = 0; i < batch->len; i++) {
+        secp256k1_scalar a;
+        if (i % 2 == 0) {
+            unsigned char idx[4];
+            idx[0] = i >> 1;
+            idx[1] = i >> 9;
+            idx[2] = i >> 17;
+            idx[3] = i >> 25;
+            secp256k1_sha256_initialize(&sha);
+            secp256k1_sha256_write(&sha, seed, 32);
+            secp256k1_sha256_write(&sha, idx, 4);
+            secp256k1_sha256_finalize(&sha, rand32);
+        }
+        memcpy(buf + 16, rand32 + 16 * (i % 2), 16);
+        secp256k1_scalar_set_b32(&a, buf, NULL);
+        secp256k1_scalar_mul(&batch->rand_scalars[2 * i], &a, &batch->scalars[2 * i]);
+        secp256k1_scalar_negate(&batch->rand_scalars[2 * i + 1], &a);
+        secp256k1_scalar_mul(&a, &a, &batch->scalars[2 * i + 1]);
+        secp256k1_scalar_add(&g_sum, &g_sum, &a);
+    }
+
+    if (!secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, batch->scratch, &rj, &g_sum, secp256k1_batch_ecmult_callback, (void *) batch, 2 * batch->len)
+        || !secp256k1_gej_is_infinity(&rj)) {
+        /* Find the statement that does not hold. */
+        for (i = 0; i < batch->len; i++) {
+            if (!secp256k1_batch_check_one(&ctx->ecmult_ctx, batch, i)) {
+                batch->first_failure = base + i;
+                break;
+            }
+        }
+    }
+    batch->len = 0;
+}
+
+/* Records that the next statement does not hold. */
+static void secp256k1_batch_add_failure(const secp256k1_context *ctx, secp256k1_batch *batch) {
+    if (batch->first_failure == SIZE_MAX) {
+        /* An earlier statement may fail as well. */
+        secp256k1_batch_flush(ctx, batch);
+        if (batch->first_failure == SIZE_MAX) {
+            batch->first_failure = batch->n_added;
+        }
+    }
+    batch->n_added++;
+}
+
+/* Adds the statement g*G + c*A - B = 0. */
+static void secp256k1_batch_add(const secp256k1_context *ctx, secp256k1_batch *batch, const secp256k1_ge *a, const secp256k1_scalar *c, const secp256k1_ge *b, const secp256k1_scalar *g) {
+    unsigned char buf[32];
+    unsigned char parities;
+    secp256k1_ge a_norm = *a;
+    secp256k1_ge b_norm = *b;
+
+    if (batch->first_failure != SIZE_MAX) {
+        /* The verdict is already known. */
+        batch->n_added++;
+        return;
+    }
+    if (batch->len == batch->capacity) {
+        secp256k1_batch_flush(ctx, batch);
+    }
+
+    secp256k1_fe_normalize_var(&a_norm.x);
+    secp256k1_fe_normalize_var(&a_norm.y);
+    secp256k1_fe_normalize_var(&b_norm.x);
+    secp256k1_fe_normalize_var(&b_norm.y);
+    secp256k1_fe_get_b32(buf, &a_norm.x);
+    secp256k1_sha256_write(&batch->sha, buf, 32);
+    secp256k1_fe_get_b32(buf, &b_norm.x);
+    secp256k1_sha256_write(&batch->sha, buf, 32);
+    parities = secp256k1_fe_is_odd(&a_norm.y) | (secp256k1_fe_is_odd(&b_norm.y) << 1);
+    secp256k1_sha256_write(&batch->sha, &parities, 1);
+    secp256k1_scalar_get_b32(buf, c);
+    secp256k1_sha256_write(&batch->sha, buf, 32);
+    secp256k1_scalar_get_b32(buf, g);
+    secp256k1_sha256_write(&batch->sha, buf, 32);
+
+    batch->points[2 * batch->len] = a_norm;
+    batch->points[2 * batch->len + 1] = b_norm;
+    batch->scalars[2 * batch->len] = *c;
+    batch->scalars[2 * batch->len + 1] = *g;
+    batch->len++;
+    batch->n_added++;
+}
+
+int secp256k1_batch_verify(const secp256k1_context* ctx, secp256k1_batch *batch, size_t *first_failure) {
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(batch != NULL);
+
+    if (batch->first_failure == SIZE_MAX) {
+        secp256k1_batch_flush(ctx, batch);
+    }
+    ret = batch->first_failure == SIZE_MAX;
+    if (!ret && first_failure != NULL) {
+        *first_failure = batch->first_failure;
+    }
+    secp256k1_batch_reset(batch);
+    return ret;
+}
+
+int secp256k1_batch_add_schnorrsig(const secp256k1_context* ctx, secp256k1_batch *batch, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_xonly_pubkey *pubkey) {
+    secp256k1_scalar s;
+    secp256k1_scalar e;
+    secp256k1_ge pk;
+    secp256k1_ge r;
+    secp256k1_fe rx;
+    unsigned char buf[32];
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(batch != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(msg != NULL || msglen == 0);
+    ARG_CHECK(pubkey != NULL);
+
+    secp256k1_scalar_set_b32(&s, &sig64[32], &overflow);
+    if (!secp256k1_fe_set_b32(&rx, &sig64[0])
+        || overflow
+        || !secp256k1_ge_set_xo_var(&r, &rx, 0)
+        || !secp256k1_xonly_pubkey_load(ctx, &pk, pubkey)) {
+        secp256k1_batch_add_failure(ctx, batch);
+        return 0;
+    }
+
+    secp256k1_fe_get_b32(buf, &pk.x);
+    secp256k1_schnorrsig_challenge(&e, &sig64[0], msg, msglen, buf);
+    secp256k1_scalar_negate(&e, &e);
+    secp256k1_batch_add(ctx, batch, &pk, &e, &r, &s);
+    return 1;
+}
+
+int secp256k1_batch_add_xonly_pubkey_tweak_check(const secp256k1_context* ctx, secp256k1_batch *batch, const unsigned char *tweaked_pubkey32, int tweaked_pk_parity, const secp256k1_xonly_pubkey *internal_pubkey, const unsigned char *tweak32) {
+    secp256k1_scalar t;
+    secp256k1_scalar one;
+    secp256k1_ge pk;
+    secp256k1_ge q;
+    secp256k1_fe qx;
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(batch != NULL);
+    ARG_CHECK(tweaked_pubkey32 != NULL);
+    ARG_CHECK(internal_pubkey != NULL);
+    ARG_CHECK(tweak32 != NULL);
+
+    secp256k1_scalar_set_b32(&t, tweak32, &overflow);
+    if (overflow
+        || (tweaked_pk_parity != 0 && tweaked_pk_parity != 1)
+        || !secp256k1_fe_set_b32(&qx, tweaked_pubkey32)
+        || !secp256k1_ge_set_xo_var(&q, &qx, tweaked_pk_parity)
+        || !secp256k1_xonly_pubkey_load(ctx, &pk, internal_pubkey)) {
+        secp256k1_batch_add_failure(ctx, batch);
+        return 0;
+    }
+
+    secp256k1_scalar_set_int(&one, 1);
+    secp256k1_batch_add(ctx, batch, &pk, &one, &q, &t);
+    return 1;
+}
+
+#endif
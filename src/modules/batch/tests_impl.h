@@ -0,0 +1,248 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_BATCH_TESTS_H
+#define SECP256K1_MODULE_BATCH_TESTS_H
+
+#include "../../../include/secp256k1_batch.h"
+#include "../../../include/secp256k1_schnorrsig.h"
+
+void test_batch_api(void) {
+    secp256k1_batch *batch;
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    secp256k1_xonly_pubkey zero_pk;
+    unsigned char sk[32];
+    unsigned char msg[32];
+    unsigned char sig[64];
+    unsigned char pk32[32];
+    unsigned char tweak[32];
+    size_t first_failure;
+
+    /** setup **/
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    int ecount;
+
+    secp256k1_context_set_error_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_error_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+
+    secp256k1_testrand256(sk);
+    secp256k1_testrand256(msg);
+    memset(tweak, 0, sizeof(tweak));
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair) == 1);
+    CHECK(secp256k1_xonly_pubkey_serialize(ctx, pk32, &pk) == 1);
+    CHECK(secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, NULL) == 1);
+    memset(&zero_pk, 0, sizeof(zero_pk));
+
+    /** main test body **/
+    ecount = 0;
+    CHECK(secp256k1_batch_create(none, SIZE_MAX, NULL) == NULL);
+    batch = secp256k1_batch_create(none, 1, NULL);
+    CHECK(batch != NULL);
+    CHECK(ecount == 0);
+
+    CHECK(secp256k1_batch_add_schnorrsig(none, batch, sig, msg, sizeof(msg), &pk) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_batch_add_schnorrsig(vrfy, NULL, sig, msg, sizeof(msg), &pk) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_batch_add_schnorrsig(vrfy, batch, NULL, msg, sizeof(msg), &pk) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_batch_add_schnorrsig(vrfy, batch, sig, NULL, sizeof(msg), &pk) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_batch_add_schnorrsig(vrfy, batch, sig, msg, sizeof(msg), NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_batch_add_schnorrsig(vrfy, batch, sig, msg, sizeof(msg), &zero_pk) == 0);
+    CHECK(ecount == 6);
+    /* Only the invalid public key was added as a statement. */
+    CHECK(secp256k1_batch_verify(vrfy, batch, &first_failure) == 0);
+    CHECK(first_failure == 0);
+
+    ecount = 0;
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(none, batch, pk32, 0, &pk, tweak) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(vrfy, NULL, pk32, 0, &pk, tweak) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(vrfy, batch, NULL, 0, &pk, tweak) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(vrfy, batch, pk32, 0, NULL, tweak) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(vrfy, batch, pk32, 0, &pk, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(vrfy, batch, pk32, 0, &zero_pk, tweak) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_batch_verify(vrfy, batch, &first_failure) == 0);
+    CHECK(first_failure == 0);
+
+    ecount = 0;
+    CHECK(secp256k1_batch_verify(none, batch, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_batch_verify(vrfy, NULL, NULL) == 0);
+    CHECK(ecount == 2);
+    /* An empty batch holds. */
+    CHECK(secp256k1_batch_verify(vrfy, batch, NULL) == 1);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_batch_add_schnorrsig(vrfy, batch, sig, msg, sizeof(msg), &pk) == 1);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(vrfy, batch, pk32, 0, &pk, tweak) == 1);
+    CHECK(secp256k1_batch_verify(vrfy, batch, NULL) == 1);
+    CHECK(ecount == 2);
+
+    secp256k1_batch_destroy(none, batch);
+    secp256k1_batch_destroy(none, NULL);
+    CHECK(ecount == 2);
+
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(vrfy);
+}
+
+/* Fills a batch with n random statements, alternating between signatures and
+ * tweak checks, of which those at bad[0..n_bad-1] do not hold. bad must be
+ * sorted. */
+void test_batch_random(secp256k1_batch *batch, size_t n, const size_t *bad, size_t n_bad) {
+    size_t i;
+    size_t j = 0;
+    size_t first_failure;
+
+    for (i = 0; i < n; i++) {
+        secp256k1_keypair keypair;
+        secp256k1_xonly_pubkey pk;
+        unsigned char sk[32];
+        unsigned char msg[32];
+        int is_bad = j < n_bad && bad[j] == i;
+
+        j += is_bad;
+        secp256k1_testrand256(sk);
+        secp256k1_testrand256(msg);
+        CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+        CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair) == 1);
+        if (i % 2 == 0) {
+            unsigned char sig[64];
+            CHECK(secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, NULL) == 1);
+            if (is_bad) {
+                msg[secp256k1_testrand_int(32)] ^= 1 << secp256k1_testrand_int(8);
+            }
+            CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, sig, msg, sizeof(msg), &pk) == 1);
+        } else {
+            secp256k1_pubkey output_pk;
+            secp256k1_xonly_pubkey output_xonly_pk;
+            unsigned char output_pk32[32];
+            int pk_parity;
+            CHECK(secp256k1_xonly_pubkey_tweak_add(ctx, &output_pk, &pk, msg) == 1);
+            CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &output_xonly_pk, &pk_parity, &output_pk) == 1);
+            CHECK(secp256k1_xonly_pubkey_serialize(ctx, output_pk32, &output_xonly_pk) == 1);
+            /* The wrong parity gives the negated point, which still lifts. */
+            CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(ctx, batch, output_pk32, pk_parity ^ is_bad, &pk, msg) == 1);
+        }
+    }
+    if (n_bad == 0) {
+        CHECK(secp256k1_batch_verify(ctx, batch, NULL) == 1);
+    } else {
+        CHECK(secp256k1_batch_verify(ctx, batch, &first_failure) == 0);
+        CHECK(first_failure == bad[0]);
+    }
+}
+
+void test_batch_flush(size_t max_statements) {
+    secp256k1_batch *batch = secp256k1_batch_create(ctx, max_statements, NULL);
+    size_t n = 2 * max_statements + 3;
+    size_t bad[2];
+
+    CHECK(batch != NULL);
+    test_batch_random(batch, max_statements, NULL, 0);
+    /* The scratch space fits all points of a flush at once. */
+    CHECK(batch->scratch->last_n_batches == 1);
+    test_batch_random(batch, n, NULL, 0);
+
+    bad[0] = secp256k1_testrand_int(n);
+    test_batch_random(batch, n, bad, 1);
+    bad[1] = bad[0] + 1 + secp256k1_testrand_int(n - bad[0]);
+    if (bad[1] < n) {
+        test_batch_random(batch, n, bad, 2);
+    }
+    /* The batch is usable again after a failure. */
+    test_batch_random(batch, 3, NULL, 0);
+    secp256k1_batch_destroy(ctx, batch);
+}
+
+void test_batch_parse_failure(void) {
+    secp256k1_batch *batch;
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    unsigned char sk[32];
+    unsigned char msg[32];
+    unsigned char sig[64];
+    unsigned char bad_sig[64];
+    unsigned char pk32[32];
+    unsigned char aux_rand[16];
+    size_t first_failure;
+
+    secp256k1_testrand256(sk);
+    secp256k1_testrand256(msg);
+    secp256k1_testrand_bytes_test(aux_rand, sizeof(aux_rand));
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair) == 1);
+    CHECK(secp256k1_xonly_pubkey_serialize(ctx, pk32, &pk) == 1);
+    CHECK(secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, NULL) == 1);
+    batch = secp256k1_batch_create(ctx, 4, aux_rand);
+    CHECK(batch != NULL);
+
+    /* s is not smaller than the group order. */
+    memcpy(bad_sig, sig, 64);
+    memset(&bad_sig[32], 0xFF, 32);
+    CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, sig, msg, sizeof(msg), &pk) == 1);
+    CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, bad_sig, msg, sizeof(msg), &pk) == 0);
+    CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, sig, msg, sizeof(msg), &pk) == 1);
+    CHECK(secp256k1_batch_verify(ctx, batch, &first_failure) == 0);
+    CHECK(first_failure == 1);
+
+    /* r is not a field element. */
+    memcpy(bad_sig, sig, 64);
+    memset(bad_sig, 0xFF, 32);
+    CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, bad_sig, msg, sizeof(msg), &pk) == 0);
+    CHECK(secp256k1_batch_verify(ctx, batch, &first_failure) == 0);
+    CHECK(first_failure == 0);
+
+    /* A statement that does not hold before one that cannot be parsed is
+     * reported first. */
+    CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, sig, msg, sizeof(msg), &pk) == 1);
+    CHECK(secp256k1_batch_add_schnorrsig(ctx, batch, sig, msg, sizeof(msg) - 1, &pk) == 1);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(ctx, batch, pk32, 2, &pk, msg) == 0);
+    CHECK(secp256k1_batch_verify(ctx, batch, &first_failure) == 0);
+    CHECK(first_failure == 1);
+
+    /* The tweak is not smaller than the group order. */
+    memset(bad_sig, 0xFF, 32);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(ctx, batch, pk32, 0, &pk, bad_sig) == 0);
+    CHECK(secp256k1_batch_verify(ctx, batch, &first_failure) == 0);
+    CHECK(first_failure == 0);
+
+    /* The tweaked public key is not a field element. */
+    memset(msg, 0, sizeof(msg));
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(ctx, batch, pk32, 0, &pk, msg) == 1);
+    CHECK(secp256k1_batch_add_xonly_pubkey_tweak_check(ctx, batch, bad_sig, 0, &pk, msg) == 0);
+    CHECK(secp256k1_batch_verify(ctx, batch, &first_failure) == 0);
+    CHECK(first_failure == 1);
+
+    /* Nothing is added after a failure, and verify resets the batch. */
+    CHECK(secp256k1_batch_verify(ctx, batch, NULL) == 1);
+    secp256k1_batch_destroy(ctx, batch);
+}
+
+void run_batch_tests(void) {
+    int i;
+
+    test_batch_api();
+    test_batch_parse_failure();
+    for (i = 0; i < count; i++) {
+        test_batch_flush(1 + secp256k1_testrand_int(8));
+    }
+    /* Large enough for Pippenger's algorithm. */
+    test_batch_flush(50);
+}
+
+#endif
@@ -68,4 +68,198 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *output, const se
     return !!ret & !overflow;
 }
 
+/* Number of points whose affine conversion shares one field inversion in secp256k1_ecdh_batch. */
+#define ECDH_BATCH_CHUNK 32
+
+int secp256k1_ecdh_batch(const secp256k1_context* ctx, unsigned char * const *outputs, const secp256k1_pubkey * const *pubkeys, size_t n_pubkeys, const unsigned char *scalar, secp256k1_ecdh_hash_function hashfp, void *data) {
+    int ret = 1;
+    int overflow = 0;
+    secp256k1_gej resj[ECDH_BATCH_CHUNK];
+    secp256k1_ge res[ECDH_BATCH_CHUNK];
+    secp256k1_scalar s;
+    secp256k1_ecmult_const_scalar w;
+    unsigned char x[32];
+    unsigned char y[32];
+    size_t i, j, n;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_pubkeys == 0 || outputs != NULL);
+    ARG_CHECK(n_pubkeys == 0 || pubkeys != NULL);
+    ARG_CHECK(scalar != NULL);
+    for (i = 0; i < n_pubkeys; i++) {
+        ARG_CHECK(outputs[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (hashfp == NULL) {
+        hashfp = secp256k1_ecdh_hash_function_default;
+    }
+
+    secp256k1_scalar_set_b32(&s, scalar, &overflow);
+
+    overflow |= secp256k1_scalar_is_zero(&s);
+    secp256k1_scalar_cmov(&s, &secp256k1_scalar_one, overflow);
+
+    secp256k1_ecmult_const_scalar_init(&w, &s, 256);
+
+    for (i = 0; i < n_pubkeys; i += n) {
+        n = n_pubkeys - i < ECDH_BATCH_CHUNK ? n_pubkeys - i : ECDH_BATCH_CHUNK;
+        for (j = 0; j < n; j++) {
+            secp256k1_ge pt;
+            if (!secp256k1_pubkey_load(ctx, &pt, pubkeys[i + j])) {
+                pt = secp256k1_ge_const_g;
+                ret = 0;
+            }
+            secp256k1_ecmult_const_prepared(&resj[j], &pt, &w);
+        }
+        secp256k1_ge_set_all_gej(res, resj, n);
+
+        /* Compute a hash of every point */
+        for (j = 0; j < n; j++) {
+            secp256k1_fe_normalize(&res[j].x);
+            secp256k1_fe_normalize(&res[j].y);
+            secp256k1_fe_get_b32(x, &res[j].x);
+            secp256k1_fe_get_b32(y, &res[j].y);
+            ret &= !!hashfp(outputs[i + j], x, y, data);
+        }
+    }
+
+    memset(x, 0, 32);
+    memset(y, 0, 32);
+    memset(resj, 0, sizeof(resj));
+    memset(res, 0, sizeof(res));
+    secp256k1_ecmult_const_scalar_clear(&w);
+    secp256k1_scalar_clear(&s);
+
+    return ret & !overflow;
+}
+
+struct secp256k1_ecdh_precomputed_pubkey_struct {
+    secp256k1_ecmult_const_prec prec;
+    secp256k1_allocator allocator;
+};
+
+secp256k1_ecdh_precomputed_pubkey* secp256k1_ecdh_precomputed_pubkey_create(const secp256k1_context* ctx, const secp256k1_pubkey *pubkey) {
+    secp256k1_ecdh_precomputed_pubkey *ret;
+    secp256k1_ge pt;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_pubkey_load(ctx, &pt, pubkey)) {
+        return NULL;
+    }
+    ret = (secp256k1_ecdh_precomputed_pubkey *)checked_alloc(&ctx->allocator, &ctx->error_callback, sizeof(*ret));
+    if (ret != NULL) {
+        secp256k1_ecmult_const_prec_init(&ret->prec, &pt);
+        ret->allocator = ctx->allocator;
+    }
+    return ret;
+}
+
+void secp256k1_ecdh_precomputed_pubkey_destroy(const secp256k1_context* ctx, secp256k1_ecdh_precomputed_pubkey *pubkey) {
+    VERIFY_CHECK(ctx != NULL);
+    if (pubkey != NULL) {
+        /* The allocator lives in the memory being released. */
+        secp256k1_allocator allocator = pubkey->allocator;
+        secp256k1_dealloc(&allocator, pubkey);
+    }
+}
+
+int secp256k1_ecdh_precomputed(const secp256k1_context* ctx, unsigned char *output, const secp256k1_ecdh_precomputed_pubkey *pubkey, const unsigned char *scalar, secp256k1_ecdh_hash_function hashfp, void *data) {
+    int ret = 0;
+    int overflow = 0;
+    secp256k1_gej res;
+    secp256k1_ge pt;
+    secp256k1_scalar s;
+    unsigned char x[32];
+    unsigned char y[32];
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(output != NULL);
+    ARG_CHECK(pubkey != NULL);
+    ARG_CHECK(scalar != NULL);
+
+    if (hashfp == NULL) {
+        hashfp = secp256k1_ecdh_hash_function_default;
+    }
+
+    secp256k1_scalar_set_b32(&s, scalar, &overflow);
+
+    overflow |= secp256k1_scalar_is_zero(&s);
+    secp256k1_scalar_cmov(&s, &secp256k1_scalar_one, overflow);
+
+    secp256k1_ecmult_const_prec_mul(&res, &pubkey->prec, &s);
+    secp256k1_ge_set_gej(&pt, &res);
+
+    /* Compute a hash of the point */
+    secp256k1_fe_normalize(&pt.x);
+    secp256k1_fe_normalize(&pt.y);
+    secp256k1_fe_get_b32(x, &pt.x);
+    secp256k1_fe_get_b32(y, &pt.y);
+
+    ret = hashfp(output, x, y, data);
+
+    memset(x, 0, 32);
+    memset(y, 0, 32);
+    secp256k1_scalar_clear(&s);
+
+    return !!ret & !overflow;
+}
+
+static int ecdh_xonly_hash_function_sha256(unsigned char *output, const unsigned char *x32, void *data) {
+    secp256k1_sha256 sha;
+    (void)data;
+
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, x32, 32);
+    secp256k1_sha256_finalize(&sha, output);
+
+    return 1;
+}
+
+const secp256k1_ecdh_xonly_hash_function secp256k1_ecdh_xonly_hash_function_sha256 = ecdh_xonly_hash_function_sha256;
+const secp256k1_ecdh_xonly_hash_function secp256k1_ecdh_xonly_hash_function_default = ecdh_xonly_hash_function_sha256;
+
+int secp256k1_ecdh_xonly(const secp256k1_context* ctx, unsigned char *output, const unsigned char *xonly_pubkey32, const unsigned char *scalar, secp256k1_ecdh_xonly_hash_function hashfp, void *data) {
+    int ret = 0;
+    int overflow = 0;
+    secp256k1_fe x, rx;
+    secp256k1_scalar s;
+    unsigned char x32[32];
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(output != NULL);
+    ARG_CHECK(xonly_pubkey32 != NULL);
+    ARG_CHECK(scalar != NULL);
+
+    if (hashfp == NULL) {
+        hashfp = secp256k1_ecdh_xonly_hash_function_default;
+    }
+
+    if (!secp256k1_fe_set_b32(&x, xonly_pubkey32)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&s, scalar, &overflow);
+
+    overflow |= secp256k1_scalar_is_zero(&s);
+    secp256k1_scalar_cmov(&s, &secp256k1_scalar_one, overflow);
+
+    if (!secp256k1_ecmult_const_xonly(&rx, &x, &s, 256)) {
+        secp256k1_scalar_clear(&s);
+        return 0;
+    }
+
+    secp256k1_fe_normalize(&rx);
+    secp256k1_fe_get_b32(x32, &rx);
+
+    ret = hashfp(output, x32, data);
+
+    memset(x32, 0, 32);
+    secp256k1_fe_clear(&rx);
+    secp256k1_scalar_clear(&s);
+
+    return !!ret & !overflow;
+}
+
 #endif /* SECP256K1_MODULE_ECDH_MAIN_H */
@@ -24,6 +24,26 @@ int ecdh_hash_function_custom(unsigned char *output, const unsigned char *x, con
     return 1;
 }
 
+int ecdh_xonly_hash_function_test_fail(unsigned char *output, const unsigned char *x, void *data) {
+    (void)output;
+    (void)x;
+    (void)data;
+    return 0;
+}
+
+int ecdh_xonly_hash_function_custom(unsigned char *output, const unsigned char *x, void *data) {
+    (void)data;
+    memcpy(output, x, 32);
+    return 1;
+}
+
+int ecdh_hash_function_x(unsigned char *output, const unsigned char *x, const unsigned char *y, void *data) {
+    (void)y;
+    (void)data;
+    memcpy(output, x, 32);
+    return 1;
+}
+
 void test_ecdh_api(void) {
     /* Setup context that just counts errors */
     secp256k1_context *tctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
@@ -123,10 +143,297 @@ void test_bad_scalar(void) {
     CHECK(secp256k1_ecdh(ctx, output, &point, s_overflow, ecdh_hash_function_test_fail, NULL) == 0);
 }
 
+void test_ecdh_batch_api(void) {
+    secp256k1_context *tctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_pubkey point;
+    const secp256k1_pubkey *points[1];
+    unsigned char res[32];
+    unsigned char *outputs[1];
+    unsigned char s_one[32] = { 0 };
+    int32_t ecount = 0;
+    s_one[31] = 1;
+    points[0] = &point;
+    outputs[0] = res;
+
+    secp256k1_context_set_error_callback(tctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(tctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_create(tctx, &point, s_one) == 1);
+
+    /* Check all NULLs are detected */
+    CHECK(secp256k1_ecdh_batch(tctx, outputs, points, 1, s_one, NULL, NULL) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ecdh_batch(tctx, NULL, points, 1, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdh_batch(tctx, outputs, NULL, 1, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdh_batch(tctx, outputs, points, 1, NULL, NULL, NULL) == 0);
+    CHECK(ecount == 3);
+    outputs[0] = NULL;
+    CHECK(secp256k1_ecdh_batch(tctx, outputs, points, 1, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 4);
+    outputs[0] = res;
+    points[0] = NULL;
+    CHECK(secp256k1_ecdh_batch(tctx, outputs, points, 1, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 5);
+    /* Empty batches are fine, and the arrays are not accessed */
+    CHECK(secp256k1_ecdh_batch(tctx, NULL, NULL, 0, s_one, NULL, NULL) == 1);
+    CHECK(ecount == 5);
+
+    /* Cleanup */
+    secp256k1_context_destroy(tctx);
+}
+
+void test_ecdh_batch(void) {
+    /* Sizes around the internal chunk size of 32 */
+    static const size_t sizes[] = { 1, 2, 31, 32, 33, 70 };
+    secp256k1_pubkey points[70];
+    const secp256k1_pubkey *point_ptrs[70];
+    unsigned char outputs[70][65];
+    unsigned char *output_ptrs[70];
+    unsigned char expected[65];
+    unsigned char s_b32[32];
+    unsigned char s_zero[32] = { 0 };
+    secp256k1_scalar s;
+    size_t i, j;
+
+    for (i = 0; i < 70; i++) {
+        secp256k1_scalar k;
+        unsigned char k_b32[32];
+        random_scalar_order(&k);
+        secp256k1_scalar_get_b32(k_b32, &k);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &points[i], k_b32) == 1);
+        point_ptrs[i] = &points[i];
+        output_ptrs[i] = outputs[i];
+    }
+    random_scalar_order(&s);
+    secp256k1_scalar_get_b32(s_b32, &s);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        /* The results match secp256k1_ecdh, with the default and a custom hash function */
+        CHECK(secp256k1_ecdh_batch(ctx, output_ptrs, point_ptrs, sizes[i], s_b32, NULL, NULL) == 1);
+        for (j = 0; j < sizes[i]; j++) {
+            CHECK(secp256k1_ecdh(ctx, expected, &points[j], s_b32, NULL, NULL) == 1);
+            CHECK(secp256k1_memcmp_var(outputs[j], expected, 32) == 0);
+        }
+        CHECK(secp256k1_ecdh_batch(ctx, output_ptrs, point_ptrs, sizes[i], s_b32, ecdh_hash_function_custom, NULL) == 1);
+        for (j = 0; j < sizes[i]; j++) {
+            CHECK(secp256k1_ecdh(ctx, expected, &points[j], s_b32, ecdh_hash_function_custom, NULL) == 1);
+            CHECK(secp256k1_memcmp_var(outputs[j], expected, 65) == 0);
+        }
+    }
+
+    /* Bad scalars and hash function failures make the whole batch fail */
+    CHECK(secp256k1_ecdh_batch(ctx, output_ptrs, point_ptrs, 70, s_zero, NULL, NULL) == 0);
+    CHECK(secp256k1_ecdh_batch(ctx, output_ptrs, point_ptrs, 0, s_zero, NULL, NULL) == 0);
+    CHECK(secp256k1_ecdh_batch(ctx, output_ptrs, point_ptrs, 70, s_b32, ecdh_hash_function_test_fail, NULL) == 0);
+}
+
+void test_ecdh_precomputed_api(void) {
+    secp256k1_context *tctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_pubkey point, zero_point;
+    secp256k1_ecdh_precomputed_pubkey *prec;
+    unsigned char res[32];
+    unsigned char s_one[32] = { 0 };
+    int32_t ecount = 0;
+    s_one[31] = 1;
+
+    secp256k1_context_set_error_callback(tctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(tctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_create(tctx, &point, s_one) == 1);
+    memset(&zero_point, 0, sizeof(zero_point));
+
+    CHECK(secp256k1_ecdh_precomputed_pubkey_create(tctx, NULL) == NULL);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdh_precomputed_pubkey_create(tctx, &zero_point) == NULL);
+    CHECK(ecount == 2);
+    prec = secp256k1_ecdh_precomputed_pubkey_create(tctx, &point);
+    CHECK(prec != NULL);
+    CHECK(ecount == 2);
+
+    /* Check all NULLs are detected */
+    CHECK(secp256k1_ecdh_precomputed(tctx, res, prec, s_one, NULL, NULL) == 1);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdh_precomputed(tctx, NULL, prec, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdh_precomputed(tctx, res, NULL, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecdh_precomputed(tctx, res, prec, NULL, NULL, NULL) == 0);
+    CHECK(ecount == 5);
+
+    secp256k1_ecdh_precomputed_pubkey_destroy(tctx, prec);
+    secp256k1_ecdh_precomputed_pubkey_destroy(tctx, NULL);
+    CHECK(ecount == 5);
+
+    /* Cleanup */
+    secp256k1_context_destroy(tctx);
+}
+
+void test_ecdh_precomputed(void) {
+    unsigned char s_b32[32];
+    unsigned char s_zero[32] = { 0 };
+    unsigned char output[65];
+    unsigned char expected[65];
+    secp256k1_scalar s;
+    secp256k1_pubkey point;
+    secp256k1_ecdh_precomputed_pubkey *prec;
+    int i;
+
+    random_scalar_order(&s);
+    secp256k1_scalar_get_b32(s_b32, &s);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &point, s_b32) == 1);
+    prec = secp256k1_ecdh_precomputed_pubkey_create(ctx, &point);
+    CHECK(prec != NULL);
+
+    /* The results match secp256k1_ecdh, with the default and a custom hash function */
+    for (i = 0; i < count; i++) {
+        random_scalar_order(&s);
+        secp256k1_scalar_get_b32(s_b32, &s);
+        CHECK(secp256k1_ecdh_precomputed(ctx, output, prec, s_b32, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdh(ctx, expected, &point, s_b32, NULL, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(output, expected, 32) == 0);
+        CHECK(secp256k1_ecdh_precomputed(ctx, output, prec, s_b32, ecdh_hash_function_custom, NULL) == 1);
+        CHECK(secp256k1_ecdh(ctx, expected, &point, s_b32, ecdh_hash_function_custom, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(output, expected, 65) == 0);
+    }
+
+    /* Bad scalars and hash function failures */
+    CHECK(secp256k1_ecdh_precomputed(ctx, output, prec, s_zero, NULL, NULL) == 0);
+    CHECK(secp256k1_ecdh_precomputed(ctx, output, prec, s_b32, ecdh_hash_function_test_fail, NULL) == 0);
+
+    secp256k1_ecdh_precomputed_pubkey_destroy(ctx, prec);
+}
+
+void test_ecdh_xonly_api(void) {
+    secp256k1_context *tctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    unsigned char res[32];
+    unsigned char s_one[32] = { 0 };
+    unsigned char x[32];
+    secp256k1_ge g = secp256k1_ge_const_g;
+    int32_t ecount = 0;
+    s_one[31] = 1;
+
+    secp256k1_context_set_error_callback(tctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(tctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_fe_normalize_var(&g.x);
+    secp256k1_fe_get_b32(x, &g.x);
+
+    CHECK(secp256k1_ecdh_xonly(tctx, res, x, s_one, NULL, NULL) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ecdh_xonly(tctx, NULL, x, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdh_xonly(tctx, res, NULL, s_one, NULL, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdh_xonly(tctx, res, x, NULL, NULL, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdh_xonly(tctx, res, x, s_one, NULL, NULL) == 1);
+    CHECK(ecount == 3);
+
+    secp256k1_context_destroy(tctx);
+}
+
+void test_ecdh_xonly(void) {
+    int i;
+    for (i = 0; i < count; ++i) {
+        secp256k1_sha256 sha;
+        secp256k1_scalar s;
+        secp256k1_pubkey point, negpoint;
+        unsigned char pk_b32[32], s_b32[32];
+        unsigned char x[32];
+        unsigned char out_full[32], out_xonly[32], out_neg[32];
+        unsigned char ser[33];
+        size_t serlen = sizeof(ser);
+
+        random_scalar_order(&s);
+        secp256k1_scalar_get_b32(pk_b32, &s);
+        random_scalar_order(&s);
+        secp256k1_scalar_get_b32(s_b32, &s);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &point, pk_b32) == 1);
+        negpoint = point;
+        CHECK(secp256k1_ec_pubkey_negate(ctx, &negpoint) == 1);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &serlen, &point, SECP256K1_EC_COMPRESSED) == 1);
+        memcpy(x, ser + 1, 32);
+
+        /* The shared X coordinate matches the one from full ECDH, for both points with that X */
+        CHECK(secp256k1_ecdh(ctx, out_full, &point, s_b32, ecdh_hash_function_x, NULL) == 1);
+        CHECK(secp256k1_ecdh_xonly(ctx, out_xonly, x, s_b32, ecdh_xonly_hash_function_custom, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(out_full, out_xonly, 32) == 0);
+        CHECK(secp256k1_ecdh(ctx, out_neg, &negpoint, s_b32, ecdh_hash_function_x, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(out_neg, out_xonly, 32) == 0);
+
+        /* The default hash function is SHA256 of the X coordinate */
+        secp256k1_sha256_initialize(&sha);
+        secp256k1_sha256_write(&sha, out_xonly, 32);
+        secp256k1_sha256_finalize(&sha, out_full);
+        CHECK(secp256k1_ecdh_xonly(ctx, out_xonly, x, s_b32, NULL, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(out_full, out_xonly, 32) == 0);
+    }
+}
+
+void test_ecdh_xonly_bad_inputs(void) {
+    unsigned char s_zero[32] = { 0 };
+    unsigned char s_overflow[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+        0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b,
+        0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41
+    };
+    /* p, which does not fit in a field element */
+    unsigned char x_overflow[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xfc, 0x2f
+    };
+    unsigned char x[32];
+    unsigned char output[32];
+    secp256k1_fe fx;
+    secp256k1_ge ge;
+    int i;
+
+    /* Find an X coordinate on the twist */
+    do {
+        random_fe(&fx);
+    } while (secp256k1_ge_set_xo_var(&ge, &fx, 0));
+    secp256k1_fe_normalize_var(&fx);
+    secp256k1_fe_get_b32(x, &fx);
+    s_overflow[31] -= 1;
+    CHECK(secp256k1_ecdh_xonly(ctx, output, x, s_overflow, NULL, NULL) == 0);
+    CHECK(secp256k1_ecdh_xonly(ctx, output, x_overflow, s_overflow, NULL, NULL) == 0);
+
+    /* Find a valid X coordinate */
+    do {
+        random_fe(&fx);
+    } while (!secp256k1_ge_set_xo_var(&ge, &fx, 0));
+    secp256k1_fe_normalize_var(&fx);
+    secp256k1_fe_get_b32(x, &fx);
+    CHECK(secp256k1_ecdh_xonly(ctx, output, x, s_overflow, NULL, NULL) == 1);
+    CHECK(secp256k1_ecdh_xonly(ctx, output, x, s_overflow, ecdh_xonly_hash_function_test_fail, NULL) == 0);
+    s_overflow[31] += 1;
+    CHECK(secp256k1_ecdh_xonly(ctx, output, x, s_overflow, NULL, NULL) == 0);
+    CHECK(secp256k1_ecdh_xonly(ctx, output, x, s_zero, NULL, NULL) == 0);
+
+    /* The validity check agrees with decompression for many X coordinates */
+    for (i = 0; i < 2 * count; ++i) {
+        random_fe(&fx);
+        secp256k1_fe_normalize_var(&fx);
+        secp256k1_fe_get_b32(x, &fx);
+        s_zero[31] = 1;
+        CHECK(secp256k1_ecdh_xonly(ctx, output, x, s_zero, NULL, NULL) == secp256k1_ge_set_xo_var(&ge, &fx, 0));
+        s_zero[31] = 0;
+    }
+}
+
 void run_ecdh_tests(void) {
     test_ecdh_api();
     test_ecdh_generator_basepoint();
     test_bad_scalar();
+    test_ecdh_batch_api();
+    test_ecdh_batch();
+    test_ecdh_precomputed_api();
+    test_ecdh_precomputed();
+    test_ecdh_xonly_api();
+    test_ecdh_xonly();
+    test_ecdh_xonly_bad_inputs();
 }
 
 #endif /* SECP256K1_MODULE_ECDH_TESTS_H */
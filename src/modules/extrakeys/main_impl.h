@@ -114,6 +114,42 @@ int secp256k1_xonly_pubkey_from_pubkey(const secp256k1_context* ctx, secp256k1_x
     return 1;
 }
 
+int secp256k1_xonly_pubkey_scan(const secp256k1_context* ctx, unsigned char *output, const secp256k1_pubkey *pubkey, size_t n_pubkeys) {
+    secp256k1_ge r[SECP256K1_PUBKEY_SCAN_BATCH];
+    secp256k1_gej pj;
+    secp256k1_ge p;
+    int ret = 1;
+    size_t i, j, n;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_pubkeys == 0 || output != NULL);
+    ARG_CHECK(pubkey != NULL);
+    ARG_CHECK(n_pubkeys <= SIZE_MAX / 32);
+
+    if (!secp256k1_pubkey_load(ctx, &p, pubkey)) {
+        if (n_pubkeys > 0) {
+            memset(output, 0, n_pubkeys * 32);
+        }
+        return 0;
+    }
+    secp256k1_gej_set_ge(&pj, &p);
+    for (i = 0; i < n_pubkeys; i += n) {
+        n = n_pubkeys - i < SECP256K1_PUBKEY_SCAN_BATCH ? n_pubkeys - i : SECP256K1_PUBKEY_SCAN_BATCH;
+        secp256k1_pubkey_scan_helper(r, &pj, n);
+        for (j = 0; j < n; j++) {
+            unsigned char *out = &output[(i + j) * 32];
+            if (secp256k1_ge_is_infinity(&r[j])) {
+                memset(out, 0, 32);
+                ret = 0;
+                continue;
+            }
+            secp256k1_fe_normalize_var(&r[j].x);
+            secp256k1_fe_get_b32(out, &r[j].x);
+        }
+    }
+    return ret;
+}
+
 int secp256k1_xonly_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey *output_pubkey, const secp256k1_xonly_pubkey *internal_pubkey, const unsigned char *tweak32) {
     secp256k1_ge pk;
 
@@ -132,6 +168,42 @@ int secp256k1_xonly_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pub
     return 1;
 }
 
+int secp256k1_xonly_pubkey_tweak_add_batch(const secp256k1_context* ctx, secp256k1_pubkey *output_pubkeys, int *results, const secp256k1_xonly_pubkey * const *internal_pubkeys, const unsigned char * const *tweak32s, size_t n_pubkeys) {
+    secp256k1_ge pk[SECP256K1_TWEAK_ADD_BATCH];
+    int valid[SECP256K1_TWEAK_ADD_BATCH];
+    int ret = 1;
+    size_t i, j, n;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n_pubkeys == 0 || output_pubkeys != NULL);
+    ARG_CHECK(n_pubkeys == 0 || internal_pubkeys != NULL);
+    ARG_CHECK(n_pubkeys == 0 || tweak32s != NULL);
+    for (i = 0; i < n_pubkeys; i++) {
+        ARG_CHECK(internal_pubkeys[i] != NULL);
+        ARG_CHECK(tweak32s[i] != NULL);
+    }
+
+    for (i = 0; i < n_pubkeys; i += n) {
+        n = n_pubkeys - i < SECP256K1_TWEAK_ADD_BATCH ? n_pubkeys - i : SECP256K1_TWEAK_ADD_BATCH;
+        for (j = 0; j < n; j++) {
+            valid[j] = secp256k1_xonly_pubkey_load(ctx, &pk[j], internal_pubkeys[i + j]);
+        }
+        secp256k1_ec_pubkey_tweak_add_batch_helper(&ctx->ecmult_ctx, pk, valid, &tweak32s[i], n);
+        for (j = 0; j < n; j++) {
+            memset(&output_pubkeys[i + j], 0, sizeof(output_pubkeys[i + j]));
+            if (valid[j]) {
+                secp256k1_pubkey_save(&output_pubkeys[i + j], &pk[j]);
+            }
+            if (results != NULL) {
+                results[i + j] = valid[j];
+            }
+            ret &= valid[j];
+        }
+    }
+    return ret;
+}
+
 int secp256k1_xonly_pubkey_tweak_add_check(const secp256k1_context* ctx, const unsigned char *tweaked_pubkey32, int tweaked_pk_parity, const secp256k1_xonly_pubkey *internal_pubkey, const unsigned char *tweak32) {
     secp256k1_ge pk;
     unsigned char pk_expected32[32];
@@ -154,6 +226,48 @@ int secp256k1_xonly_pubkey_tweak_add_check(const secp256k1_context* ctx, const u
             && secp256k1_fe_is_odd(&pk.y) == tweaked_pk_parity;
 }
 
+int secp256k1_xonly_pubkey_tweak_add_check_batch(const secp256k1_context* ctx, int *results, const unsigned char * const *tweaked_pubkey32s, const int *tweaked_pk_parities, const secp256k1_xonly_pubkey * const *internal_pubkeys, const unsigned char * const *tweak32s, size_t n) {
+    secp256k1_ge pk[SECP256K1_TWEAK_ADD_BATCH];
+    int valid[SECP256K1_TWEAK_ADD_BATCH];
+    int ret = 1;
+    size_t i, j, num;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(tweaked_pubkey32s != NULL);
+    ARG_CHECK(tweaked_pk_parities != NULL);
+    ARG_CHECK(internal_pubkeys != NULL);
+    ARG_CHECK(tweak32s != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(tweaked_pubkey32s[i] != NULL);
+        ARG_CHECK(internal_pubkeys[i] != NULL);
+        ARG_CHECK(tweak32s[i] != NULL);
+    }
+
+    for (i = 0; i < n; i += num) {
+        num = n - i < SECP256K1_TWEAK_ADD_BATCH ? n - i : SECP256K1_TWEAK_ADD_BATCH;
+        for (j = 0; j < num; j++) {
+            valid[j] = secp256k1_xonly_pubkey_load(ctx, &pk[j], internal_pubkeys[i + j]);
+        }
+        secp256k1_ec_pubkey_tweak_add_batch_helper(&ctx->ecmult_ctx, pk, valid, &tweak32s[i], num);
+        for (j = 0; j < num; j++) {
+            if (valid[j]) {
+                unsigned char pk_expected32[32];
+                secp256k1_fe_normalize_var(&pk[j].x);
+                secp256k1_fe_normalize_var(&pk[j].y);
+                secp256k1_fe_get_b32(pk_expected32, &pk[j].x);
+                valid[j] = secp256k1_memcmp_var(pk_expected32, tweaked_pubkey32s[i + j], 32) == 0
+                    && secp256k1_fe_is_odd(&pk[j].y) == tweaked_pk_parities[i + j];
+            }
+            if (results != NULL) {
+                results[i + j] = valid[j];
+            }
+            ret &= valid[j];
+        }
+    }
+    return ret;
+}
+
 static void secp256k1_keypair_save(secp256k1_keypair *keypair, const secp256k1_scalar *sk, secp256k1_ge *pk) {
     secp256k1_scalar_get_b32(&keypair->data[0], sk);
     secp256k1_pubkey_save((secp256k1_pubkey *)&keypair->data[32], pk);
@@ -212,6 +326,17 @@ int secp256k1_keypair_create(const secp256k1_context* ctx, secp256k1_keypair *ke
     return ret;
 }
 
+int secp256k1_keypair_create_with_session(const secp256k1_signing_session* session, secp256k1_keypair *keypair, const unsigned char *seckey32) {
+    secp256k1_context view;
+    int ret;
+    VERIFY_CHECK(session != NULL);
+
+    secp256k1_signing_session_context_load(&view, session);
+    ret = secp256k1_keypair_create(&view, keypair, seckey32);
+    secp256k1_signing_session_context_clear(&view);
+    return ret;
+}
+
 int secp256k1_keypair_sec(const secp256k1_context* ctx, unsigned char *seckey, const secp256k1_keypair *keypair) {
     VERIFY_CHECK(ctx != NULL);
     ARG_CHECK(seckey != NULL);
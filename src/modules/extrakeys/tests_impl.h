@@ -246,6 +246,155 @@ void test_xonly_pubkey_tweak(void) {
     secp256k1_context_destroy(verify);
 }
 
+void test_xonly_pubkey_tweak_batch(void) {
+    enum { N = 40 };
+    unsigned char tweaks[N][32];
+    secp256k1_scalar sk[2];
+    secp256k1_xonly_pubkey internal_xonly_pk[2];
+    int pk_parity[2];
+    secp256k1_pubkey output_pk[N];
+    const secp256k1_xonly_pubkey *internal_ptrs[N];
+    const unsigned char *tweak_ptrs[N];
+    int results[N];
+    int all_valid = 1;
+    int ecount;
+    size_t i;
+    secp256k1_context *sign = api_test_context(SECP256K1_CONTEXT_SIGN, &ecount);
+    secp256k1_context *verify = api_test_context(SECP256K1_CONTEXT_VERIFY, &ecount);
+
+    for (i = 0; i < 2; i++) {
+        unsigned char sk32[32];
+        secp256k1_pubkey internal_pk;
+        random_scalar_order_test(&sk[i]);
+        secp256k1_scalar_get_b32(sk32, &sk[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &internal_pk, sk32) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &internal_xonly_pk[i], &pk_parity[i], &internal_pk) == 1);
+    }
+    for (i = 0; i < N; i++) {
+        size_t k = secp256k1_testrand_bits(1);
+        secp256k1_scalar t;
+        internal_ptrs[i] = &internal_xonly_pk[k];
+        tweak_ptrs[i] = tweaks[i];
+        switch (secp256k1_testrand_int(8)) {
+        case 0:
+            /* Overflowing tweak */
+            memset(tweaks[i], 0xff, 32);
+            break;
+        case 1:
+            /* The result is infinity. The x-only key corresponds to the negated
+             * secret key if the parity is odd. */
+            t = sk[k];
+            if (!pk_parity[k]) {
+                secp256k1_scalar_negate(&t, &t);
+            }
+            secp256k1_scalar_get_b32(tweaks[i], &t);
+            break;
+        default:
+            random_scalar_order_test(&t);
+            secp256k1_scalar_get_b32(tweaks[i], &t);
+        }
+    }
+
+    /* The results match secp256k1_xonly_pubkey_tweak_add */
+    for (i = 0; i < N; i++) {
+        secp256k1_pubkey tmp;
+        all_valid &= secp256k1_xonly_pubkey_tweak_add(verify, &tmp, internal_ptrs[i], tweaks[i]);
+    }
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(verify, output_pk, results, internal_ptrs, tweak_ptrs, N) == all_valid);
+    for (i = 0; i < N; i++) {
+        secp256k1_pubkey expected;
+        CHECK(results[i] == secp256k1_xonly_pubkey_tweak_add(verify, &expected, internal_ptrs[i], tweaks[i]));
+        CHECK(secp256k1_memcmp_var(&output_pk[i], &expected, sizeof(expected)) == 0);
+    }
+
+    ecount = 0;
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(sign, output_pk, NULL, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(verify, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(verify, NULL, NULL, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(verify, output_pk, NULL, NULL, tweak_ptrs, N) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(verify, output_pk, NULL, internal_ptrs, NULL, N) == 0);
+    CHECK(ecount == 4);
+    /* A NULL element in the last batch is detected before any output is
+     * written. */
+    memset(output_pk, 0xaa, sizeof(output_pk));
+    memset(results, 0xaa, sizeof(results));
+    internal_ptrs[N - 1] = NULL;
+    CHECK(secp256k1_xonly_pubkey_tweak_add_batch(verify, output_pk, results, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 5);
+    for (i = 0; i < sizeof(output_pk); i++) {
+        CHECK(((unsigned char *)output_pk)[i] == 0xaa);
+    }
+    for (i = 0; i < sizeof(results); i++) {
+        CHECK(((unsigned char *)results)[i] == 0xaa);
+    }
+
+    secp256k1_context_destroy(sign);
+    secp256k1_context_destroy(verify);
+}
+
+void test_xonly_pubkey_scan(void) {
+    /* Not a multiple of the batch size */
+    enum { N = 64 + 9 };
+    unsigned char output[N][32];
+    unsigned char compressed[N][33];
+    unsigned char seckey[32];
+    unsigned char zeros[32] = { 0 };
+    secp256k1_pubkey start;
+    secp256k1_scalar k;
+    int ecount;
+    size_t i;
+    secp256k1_context *none = api_test_context(SECP256K1_CONTEXT_NONE, &ecount);
+
+    /* The results match secp256k1_ec_pubkey_scan and
+     * secp256k1_xonly_pubkey_from_pubkey */
+    random_scalar_order_test(&k);
+    secp256k1_scalar_get_b32(seckey, &k);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &start, seckey) == 1);
+    CHECK(secp256k1_xonly_pubkey_scan(none, &output[0][0], &start, N) == 1);
+    CHECK(secp256k1_ec_pubkey_scan(none, &compressed[0][0], &start, N, SECP256K1_EC_COMPRESSED) == 1);
+    for (i = 0; i < N; i++) {
+        CHECK(secp256k1_memcmp_var(output[i], &compressed[i][1], 32) == 0);
+    }
+    for (i = 0; i < N; i++) {
+        secp256k1_xonly_pubkey xonly_pk;
+        secp256k1_pubkey pubkey;
+        unsigned char ser[32];
+        CHECK(secp256k1_ec_pubkey_parse(ctx, &pubkey, compressed[i], 33) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &xonly_pk, NULL, &pubkey) == 1);
+        CHECK(secp256k1_xonly_pubkey_serialize(ctx, ser, &xonly_pk) == 1);
+        CHECK(secp256k1_memcmp_var(output[i], ser, 32) == 0);
+    }
+
+    /* The key of -1 is followed by infinity. */
+    secp256k1_scalar_set_int(&k, 1);
+    secp256k1_scalar_negate(&k, &k);
+    secp256k1_scalar_get_b32(seckey, &k);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &start, seckey) == 1);
+    CHECK(secp256k1_xonly_pubkey_scan(none, &output[0][0], &start, 3) == 0);
+    CHECK(secp256k1_memcmp_var(output[1], zeros, 32) == 0);
+    CHECK(secp256k1_memcmp_var(output[0], output[2], 32) == 0);
+
+    ecount = 0;
+    CHECK(secp256k1_xonly_pubkey_scan(none, NULL, &start, 0) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_xonly_pubkey_scan(none, NULL, &start, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_xonly_pubkey_scan(none, &output[0][0], NULL, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_xonly_pubkey_scan(none, &output[0][0], &start, SIZE_MAX / 16) == 0);
+    CHECK(ecount == 3);
+    memset(&start, 0, sizeof(start));
+    CHECK(secp256k1_xonly_pubkey_scan(none, &output[0][0], &start, 1) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_memcmp_var(output[0], zeros, 32) == 0);
+
+    secp256k1_context_destroy(none);
+}
+
 void test_xonly_pubkey_tweak_check(void) {
     unsigned char zeros64[64] = { 0 };
     unsigned char overflows[32];
@@ -313,6 +462,99 @@ void test_xonly_pubkey_tweak_check(void) {
     secp256k1_context_destroy(verify);
 }
 
+void test_xonly_pubkey_tweak_check_batch(void) {
+    /* Not a multiple of the number of relations combined at once */
+    enum { N = 2 * 32 + 7 };
+    unsigned char tweaks[N][32];
+    unsigned char output_pk32[N][32];
+    int parities[N];
+    secp256k1_xonly_pubkey internal_xonly_pk[N];
+    const unsigned char *tweak_ptrs[N];
+    const unsigned char *output_ptrs[N];
+    const secp256k1_xonly_pubkey *internal_ptrs[N];
+    int results[N];
+    int all_valid;
+    int ecount;
+    size_t i;
+    secp256k1_context *sign = api_test_context(SECP256K1_CONTEXT_SIGN, &ecount);
+    secp256k1_context *verify = api_test_context(SECP256K1_CONTEXT_VERIFY, &ecount);
+
+    for (i = 0; i < N; i++) {
+        unsigned char sk[32];
+        secp256k1_scalar s;
+        secp256k1_pubkey pk;
+        secp256k1_xonly_pubkey output_xonly_pk;
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(sk, &s);
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(tweaks[i], &s);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pk, sk) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &internal_xonly_pk[i], NULL, &pk) == 1);
+        CHECK(secp256k1_xonly_pubkey_tweak_add(ctx, &pk, &internal_xonly_pk[i], tweaks[i]) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &output_xonly_pk, &parities[i], &pk) == 1);
+        CHECK(secp256k1_xonly_pubkey_serialize(ctx, output_pk32[i], &output_xonly_pk) == 1);
+        tweak_ptrs[i] = tweaks[i];
+        output_ptrs[i] = output_pk32[i];
+        internal_ptrs[i] = &internal_xonly_pk[i];
+    }
+
+    /* All relations hold */
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(ctx, results, output_ptrs, parities, internal_ptrs, tweak_ptrs, N) == 1);
+    for (i = 0; i < N; i++) {
+        CHECK(results[i] == 1);
+    }
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(ctx, NULL, output_ptrs, parities, internal_ptrs, tweak_ptrs, N) == 1);
+
+    /* Break some relations in different ways */
+    for (i = 0; i < N; i++) {
+        switch (secp256k1_testrand_int(12)) {
+        case 0:
+            parities[i] = !parities[i];
+            break;
+        case 1:
+            parities[i] = 2;
+            break;
+        case 2:
+            output_pk32[i][secp256k1_testrand_int(32)] ^= 1 << secp256k1_testrand_int(8);
+            break;
+        case 3:
+            memset(tweaks[i], 0xff, 32);
+            break;
+        case 4:
+            tweaks[i][31] ^= 1;
+            break;
+        }
+    }
+    all_valid = 1;
+    for (i = 0; i < N; i++) {
+        all_valid &= secp256k1_xonly_pubkey_tweak_add_check(ctx, output_pk32[i], parities[i], &internal_xonly_pk[i], tweaks[i]);
+    }
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(ctx, results, output_ptrs, parities, internal_ptrs, tweak_ptrs, N) == all_valid);
+    for (i = 0; i < N; i++) {
+        CHECK(results[i] == secp256k1_xonly_pubkey_tweak_add_check(ctx, output_pk32[i], parities[i], &internal_xonly_pk[i], tweaks[i]));
+    }
+
+    ecount = 0;
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(sign, NULL, output_ptrs, parities, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(verify, NULL, output_ptrs, parities, internal_ptrs, tweak_ptrs, 0) == 1);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(verify, NULL, NULL, parities, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(verify, NULL, output_ptrs, NULL, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(verify, NULL, output_ptrs, parities, NULL, tweak_ptrs, N) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(verify, NULL, output_ptrs, parities, internal_ptrs, NULL, N) == 0);
+    CHECK(ecount == 5);
+    internal_ptrs[N - 1] = NULL;
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(verify, NULL, output_ptrs, parities, internal_ptrs, tweak_ptrs, N) == 0);
+    CHECK(ecount == 6);
+
+    secp256k1_context_destroy(sign);
+    secp256k1_context_destroy(verify);
+}
+
 /* Starts with an initial pubkey and recursively creates N_PUBKEYS - 1
  * additional pubkeys by calling tweak_add. Then verifies every tweak starting
  * from the last pubkey. */
@@ -571,17 +813,38 @@ void test_keypair_add(void) {
     secp256k1_context_destroy(verify);
 }
 
+void test_keypair_with_session(void) {
+    secp256k1_signing_session *session = secp256k1_signing_session_create(ctx);
+    secp256k1_keypair keypair, keypair2;
+    unsigned char sk[32];
+    unsigned char seed32[32];
+
+    secp256k1_testrand256(seed32);
+    CHECK(secp256k1_signing_session_randomize(session, seed32) == 1);
+    secp256k1_testrand256(sk);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_create_with_session(session, &keypair2, sk) == 1);
+    CHECK(secp256k1_memcmp_var(&keypair, &keypair2, sizeof(keypair)) == 0);
+    memset(sk, 0, sizeof(sk));
+    CHECK(secp256k1_keypair_create_with_session(session, &keypair2, sk) == 0);
+    secp256k1_signing_session_destroy(session);
+}
+
 void run_extrakeys_tests(void) {
     /* xonly key test cases */
     test_xonly_pubkey();
     test_xonly_pubkey_tweak();
+    test_xonly_pubkey_tweak_batch();
+    test_xonly_pubkey_scan();
     test_xonly_pubkey_tweak_check();
+    test_xonly_pubkey_tweak_check_batch();
     test_xonly_pubkey_tweak_recursive();
     test_xonly_pubkey_comparison();
 
     /* keypair tests */
     test_keypair();
     test_keypair_add();
+    test_keypair_with_session();
 }
 
 #endif
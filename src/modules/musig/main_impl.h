@@ -0,0 +1,981 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_MUSIG_MAIN_H
+#define SECP256K1_MODULE_MUSIG_MAIN_H
+
+#include "../../../include/secp256k1.h"
+#include "../../../include/secp256k1_extrakeys.h"
+#include "../../../include/secp256k1_musig.h"
+#include "../../hash.h"
+
+static const unsigned char secp256k1_musig_keyagg_cache_magic[4] = { 0xf4, 0xad, 0xbb, 0xdf };
+static const unsigned char secp256k1_musig_secnonce_magic[4] = { 0x22, 0x0e, 0xdc, 0xf1 };
+static const unsigned char secp256k1_musig_pubnonce_magic[4] = { 0xf5, 0x7a, 0x3d, 0xa0 };
+static const unsigned char secp256k1_musig_aggnonce_magic[4] = { 0xa8, 0xb7, 0xe4, 0x67 };
+static const unsigned char secp256k1_musig_session_magic[4] = { 0x9d, 0xed, 0xe9, 0x17 };
+static const unsigned char secp256k1_musig_partial_sig_magic[4] = { 0xeb, 0xfb, 0x1a, 0x32 };
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("KeyAgg list")||SHA256("KeyAgg list"). */
+static void secp256k1_musig_keyagglist_sha256(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0xb399d5e0ul;
+    sha->s[1] = 0xc8fff302ul;
+    sha->s[2] = 0x6badac71ul;
+    sha->s[3] = 0x07c5b7f1ul;
+    sha->s[4] = 0x9701e2eful;
+    sha->s[5] = 0x2a72ecf8ul;
+    sha->s[6] = 0x201a4c7bul;
+    sha->s[7] = 0xab148a38ul;
+    sha->bytes = 64;
+}
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("KeyAgg coefficient")||SHA256("KeyAgg coefficient"). */
+static void secp256k1_musig_keyaggcoef_sha256(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0x6ef02c5aul;
+    sha->s[1] = 0x06a480deul;
+    sha->s[2] = 0x1f298665ul;
+    sha->s[3] = 0x1d1134f2ul;
+    sha->s[4] = 0x56a0b063ul;
+    sha->s[5] = 0x52da4147ul;
+    sha->s[6] = 0xf280d9d4ul;
+    sha->s[7] = 0x4484be15ul;
+    sha->bytes = 64;
+}
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("MuSig/aux")||SHA256("MuSig/aux"). */
+static void secp256k1_musig_aux_sha256(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0xa19e884bul;
+    sha->s[1] = 0xf463fe7eul;
+    sha->s[2] = 0x2f18f9a2ul;
+    sha->s[3] = 0xbeb0f9fful;
+    sha->s[4] = 0x0f37e8b0ul;
+    sha->s[5] = 0x06ebd26ful;
+    sha->s[6] = 0xe3b243d2ul;
+    sha->s[7] = 0x522fb150ul;
+    sha->bytes = 64;
+}
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("MuSig/nonce")||SHA256("MuSig/nonce"). */
+static void secp256k1_musig_nonce_sha256(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0x07101b64ul;
+    sha->s[1] = 0x18003414ul;
+    sha->s[2] = 0x0391bc43ul;
+    sha->s[3] = 0x0e6258eeul;
+    sha->s[4] = 0x29d26b72ul;
+    sha->s[5] = 0x8343937eul;
+    sha->s[6] = 0xb7a0a4fbul;
+    sha->s[7] = 0xff568a30ul;
+    sha->bytes = 64;
+}
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("MuSig/noncecoef")||SHA256("MuSig/noncecoef"). */
+static void secp256k1_musig_noncecoef_sha256(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0x2c7d5a45ul;
+    sha->s[1] = 0x06bf7e53ul;
+    sha->s[2] = 0x89be68a6ul;
+    sha->s[3] = 0x971254c0ul;
+    sha->s[4] = 0x60ac12d2ul;
+    sha->s[5] = 0x72846dcdul;
+    sha->s[6] = 0x6c81212ful;
+    sha->s[7] = 0xde7a2500ul;
+    sha->bytes = 64;
+}
+
+/* Points are stored in the opaque structures in the same 64-byte format as in
+ * secp256k1_pubkey. */
+static void secp256k1_musig_ge_save(unsigned char *data, secp256k1_ge *ge) {
+    secp256k1_pubkey_save((secp256k1_pubkey *) data, ge);
+}
+
+static void secp256k1_musig_ge_load(secp256k1_ge *ge, const unsigned char *data) {
+    if (sizeof(secp256k1_ge_storage) == 64) {
+        secp256k1_ge_storage s;
+        memcpy(&s, data, sizeof(s));
+        secp256k1_ge_from_storage(ge, &s);
+    } else {
+        secp256k1_fe x, y;
+        secp256k1_fe_set_b32(&x, data);
+        secp256k1_fe_set_b32(&y, data + 32);
+        secp256k1_ge_set_xy(ge, &x, &y);
+    }
+}
+
+/* Like secp256k1_musig_ge_save, but stores the point at infinity as 64 zero
+ * bytes, which is not the encoding of any other point. */
+static void secp256k1_musig_ge_save_ext(unsigned char *data, secp256k1_ge *ge) {
+    if (secp256k1_ge_is_infinity(ge)) {
+        memset(data, 0, 64);
+    } else {
+        secp256k1_musig_ge_save(data, ge);
+    }
+}
+
+static void secp256k1_musig_ge_load_ext(secp256k1_ge *ge, const unsigned char *data) {
+    static const unsigned char zeros[64] = { 0 };
+    if (secp256k1_memcmp_var(data, zeros, sizeof(zeros)) == 0) {
+        secp256k1_ge_set_infinity(ge);
+    } else {
+        secp256k1_musig_ge_load(ge, data);
+    }
+}
+
+/* Serializes a point in compressed form, or as 33 zero bytes if it is the
+ * point at infinity. */
+static void secp256k1_musig_ge_serialize_ext(unsigned char *out33, secp256k1_ge *ge) {
+    if (secp256k1_ge_is_infinity(ge)) {
+        memset(out33, 0, 33);
+    } else {
+        size_t size = 33;
+        int ret = secp256k1_eckey_pubkey_serialize(ge, out33, &size, 1);
+#ifdef VERIFY
+        VERIFY_CHECK(ret && size == 33);
+#else
+        (void) ret;
+#endif
+    }
+}
+
+static int secp256k1_musig_ge_parse_ext(secp256k1_ge *ge, const unsigned char *in33) {
+    static const unsigned char zeros[33] = { 0 };
+    if (secp256k1_memcmp_var(in33, zeros, sizeof(zeros)) == 0) {
+        secp256k1_ge_set_infinity(ge);
+        return 1;
+    }
+    return secp256k1_eckey_pubkey_parse(ge, in33, 33);
+}
+
+typedef struct {
+    /* The aggregate public key, with all tweaks applied */
+    secp256k1_ge pk;
+    /* The compressed serialization of the first public key that differs from
+     * the first one, or 33 zero bytes if there is none */
+    unsigned char second_pk[33];
+    /* The hash of the list of all public keys */
+    unsigned char pk_hash[32];
+    /* Whether the product of the negations applied by x-only tweaks is -1 */
+    int parity_acc;
+    /* The sum of all tweaks, negated along with the key by x-only tweaks */
+    secp256k1_scalar tweak;
+} secp256k1_keyagg_cache_internal;
+
+/* The cache is stored as: magic || pk || second_pk || pk_hash || parity_acc ||
+ * tweak, which takes 4 + 64 + 33 + 32 + 1 + 32 = 166 bytes. */
+static void secp256k1_keyagg_cache_save(secp256k1_musig_keyagg_cache *cache, secp256k1_keyagg_cache_internal *cache_i) {
+    unsigned char *ptr = cache->data;
+    memcpy(ptr, secp256k1_musig_keyagg_cache_magic, 4);
+    ptr += 4;
+    secp256k1_musig_ge_save(ptr, &cache_i->pk);
+    ptr += 64;
+    memcpy(ptr, cache_i->second_pk, 33);
+    ptr += 33;
+    memcpy(ptr, cache_i->pk_hash, 32);
+    ptr += 32;
+    *ptr = cache_i->parity_acc;
+    ptr += 1;
+    secp256k1_scalar_get_b32(ptr, &cache_i->tweak);
+}
+
+static int secp256k1_keyagg_cache_load(const secp256k1_context* ctx, secp256k1_keyagg_cache_internal *cache_i, const secp256k1_musig_keyagg_cache *cache) {
+    const unsigned char *ptr = cache->data;
+    ARG_CHECK(secp256k1_memcmp_var(ptr, secp256k1_musig_keyagg_cache_magic, 4) == 0);
+    ptr += 4;
+    secp256k1_musig_ge_load(&cache_i->pk, ptr);
+    ptr += 64;
+    memcpy(cache_i->second_pk, ptr, 33);
+    ptr += 33;
+    memcpy(cache_i->pk_hash, ptr, 32);
+    ptr += 32;
+    cache_i->parity_acc = *ptr & 1;
+    ptr += 1;
+    secp256k1_scalar_set_b32(&cache_i->tweak, ptr, NULL);
+    return 1;
+}
+
+/* Computes the coefficient of a public key, hash(pk_hash || pk), where pk is
+ * the compressed serialization. As an optimization, the coefficient of the
+ * second distinct key in the list is 1, so that its multiplication is cheap. */
+static void secp256k1_musig_keyaggcoef_internal(secp256k1_scalar *r, const unsigned char *pk_hash, secp256k1_ge *pk, const unsigned char *second_pk) {
+    unsigned char buf[33];
+    size_t buflen = sizeof(buf);
+    int ret;
+
+    ret = secp256k1_eckey_pubkey_serialize(pk, buf, &buflen, 1);
+#ifdef VERIFY
+    VERIFY_CHECK(ret && buflen == sizeof(buf));
+#else
+    (void) ret;
+#endif
+
+    if (secp256k1_memcmp_var(buf, second_pk, sizeof(buf)) == 0) {
+        secp256k1_scalar_set_int(r, 1);
+    } else {
+        secp256k1_sha256 sha;
+        unsigned char hash[32];
+        secp256k1_musig_keyaggcoef_sha256(&sha);
+        secp256k1_sha256_write(&sha, pk_hash, 32);
+        secp256k1_sha256_write(&sha, buf, sizeof(buf));
+        secp256k1_sha256_finalize(&sha, hash);
+        secp256k1_scalar_set_b32(r, hash, NULL);
+    }
+}
+
+static void secp256k1_musig_keyaggcoef(secp256k1_scalar *r, const secp256k1_keyagg_cache_internal *cache_i, secp256k1_ge *pk) {
+    secp256k1_musig_keyaggcoef_internal(r, cache_i->pk_hash, pk, cache_i->second_pk);
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const secp256k1_pubkey * const* pubkeys;
+    const unsigned char *pk_hash;
+    const unsigned char *second_pk;
+} secp256k1_musig_pubkey_agg_ecmult_data;
+
+static int secp256k1_musig_pubkey_agg_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    secp256k1_musig_pubkey_agg_ecmult_data *ecmult_data = (secp256k1_musig_pubkey_agg_ecmult_data *) data;
+    secp256k1_ge pk;
+    if (!secp256k1_pubkey_load(ecmult_data->ctx, pt, ecmult_data->pubkeys[idx])) {
+        return 0;
+    }
+    pk = *pt;
+    secp256k1_musig_keyaggcoef_internal(sc, ecmult_data->pk_hash, &pk, ecmult_data->second_pk);
+    return 1;
+}
+
+int secp256k1_musig_pubkey_agg(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_xonly_pubkey *agg_pk, secp256k1_musig_keyagg_cache *keyagg_cache, const secp256k1_pubkey * const* pubkeys, size_t n_pubkeys) {
+    secp256k1_musig_pubkey_agg_ecmult_data ecmult_data;
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_sha256 sha;
+    secp256k1_gej pkj;
+    secp256k1_ge pkp;
+    unsigned char first_pk[33];
+    int have_second = 0;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (agg_pk != NULL) {
+        memset(agg_pk, 0, sizeof(*agg_pk));
+    }
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(pubkeys != NULL);
+    ARG_CHECK(n_pubkeys > 0);
+
+    /* Hash the list of keys and find the second distinct key in one pass. */
+    memset(cache_i.second_pk, 0, sizeof(cache_i.second_pk));
+    secp256k1_musig_keyagglist_sha256(&sha);
+    for (i = 0; i < n_pubkeys; i++) {
+        secp256k1_ge pk;
+        unsigned char ser[33];
+        size_t ser_len = sizeof(ser);
+
+        ARG_CHECK(pubkeys[i] != NULL);
+        if (!secp256k1_pubkey_load(ctx, &pk, pubkeys[i])) {
+            return 0;
+        }
+        if (!secp256k1_eckey_pubkey_serialize(&pk, ser, &ser_len, 1)) {
+            return 0;
+        }
+        secp256k1_sha256_write(&sha, ser, sizeof(ser));
+        if (i == 0) {
+            memcpy(first_pk, ser, sizeof(ser));
+        } else if (!have_second && secp256k1_memcmp_var(ser, first_pk, sizeof(ser)) != 0) {
+            memcpy(cache_i.second_pk, ser, sizeof(ser));
+            have_second = 1;
+        }
+    }
+    secp256k1_sha256_finalize(&sha, cache_i.pk_hash);
+
+    ecmult_data.ctx = ctx;
+    ecmult_data.pubkeys = pubkeys;
+    ecmult_data.pk_hash = cache_i.pk_hash;
+    ecmult_data.second_pk = cache_i.second_pk;
+    if (!secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &pkj, NULL, secp256k1_musig_pubkey_agg_callback, (void *) &ecmult_data, n_pubkeys)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej_var(&pkp, &pkj);
+    /* The coefficients are hashes of the keys, so the sum is only infinity if
+     * the hash function is broken. */
+    if (secp256k1_ge_is_infinity(&pkp)) {
+        return 0;
+    }
+    secp256k1_fe_normalize_var(&pkp.x);
+    secp256k1_fe_normalize_var(&pkp.y);
+
+    if (keyagg_cache != NULL) {
+        cache_i.pk = pkp;
+        cache_i.parity_acc = 0;
+        secp256k1_scalar_clear(&cache_i.tweak);
+        secp256k1_keyagg_cache_save(keyagg_cache, &cache_i);
+    }
+    if (agg_pk != NULL) {
+        secp256k1_extrakeys_ge_even_y(&pkp);
+        secp256k1_xonly_pubkey_save(agg_pk, &pkp);
+    }
+    return 1;
+}
+
+int secp256k1_musig_pubkey_get(const secp256k1_context* ctx, secp256k1_pubkey *agg_pk, const secp256k1_musig_keyagg_cache *keyagg_cache) {
+    secp256k1_keyagg_cache_internal cache_i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(agg_pk != NULL);
+    memset(agg_pk, 0, sizeof(*agg_pk));
+    ARG_CHECK(keyagg_cache != NULL);
+
+    if (!secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache)) {
+        return 0;
+    }
+    secp256k1_pubkey_save(agg_pk, &cache_i.pk);
+    return 1;
+}
+
+static int secp256k1_musig_pubkey_tweak_add_internal(const secp256k1_context* ctx, secp256k1_pubkey *output_pubkey, secp256k1_musig_keyagg_cache *keyagg_cache, const unsigned char *tweak32, int xonly) {
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_scalar tweak;
+    int overflow = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (output_pubkey != NULL) {
+        memset(output_pubkey, 0, sizeof(*output_pubkey));
+    }
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(keyagg_cache != NULL);
+    ARG_CHECK(tweak32 != NULL);
+
+    if (!secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&tweak, tweak32, &overflow);
+    if (overflow) {
+        return 0;
+    }
+    /* An x-only tweak applies to the key with even Y, so the key and the sum
+     * of the previous tweaks are negated first if Y is odd. */
+    if (xonly && secp256k1_extrakeys_ge_even_y(&cache_i.pk)) {
+        cache_i.parity_acc ^= 1;
+        secp256k1_scalar_negate(&cache_i.tweak, &cache_i.tweak);
+    }
+    secp256k1_scalar_add(&cache_i.tweak, &cache_i.tweak, &tweak);
+    if (!secp256k1_eckey_pubkey_tweak_add(&ctx->ecmult_ctx, &cache_i.pk, &tweak)) {
+        return 0;
+    }
+    secp256k1_fe_normalize_var(&cache_i.pk.x);
+    secp256k1_fe_normalize_var(&cache_i.pk.y);
+    secp256k1_keyagg_cache_save(keyagg_cache, &cache_i);
+    if (output_pubkey != NULL) {
+        secp256k1_pubkey_save(output_pubkey, &cache_i.pk);
+    }
+    return 1;
+}
+
+int secp256k1_musig_pubkey_ec_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey *output_pubkey, secp256k1_musig_keyagg_cache *keyagg_cache, const unsigned char *tweak32) {
+    return secp256k1_musig_pubkey_tweak_add_internal(ctx, output_pubkey, keyagg_cache, tweak32, 0);
+}
+
+int secp256k1_musig_pubkey_xonly_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey *output_pubkey, secp256k1_musig_keyagg_cache *keyagg_cache, const unsigned char *tweak32) {
+    return secp256k1_musig_pubkey_tweak_add_internal(ctx, output_pubkey, keyagg_cache, tweak32, 1);
+}
+
+/* The secret nonce is stored as: magic || k[0] || k[1] || pk, where pk is the
+ * public key of the signer it was created for. */
+static void secp256k1_musig_secnonce_save(secp256k1_musig_secnonce *secnonce, const secp256k1_scalar *k, secp256k1_ge *pk) {
+    memcpy(&secnonce->data[0], secp256k1_musig_secnonce_magic, 4);
+    secp256k1_scalar_get_b32(&secnonce->data[4], &k[0]);
+    secp256k1_scalar_get_b32(&secnonce->data[36], &k[1]);
+    secp256k1_musig_ge_save(&secnonce->data[68], pk);
+}
+
+static int secp256k1_musig_secnonce_load(const secp256k1_context* ctx, secp256k1_scalar *k, secp256k1_ge *pk, const secp256k1_musig_secnonce *secnonce) {
+    int is_valid;
+
+    /* The magic and the public key are not secret. */
+    secp256k1_declassify(ctx, &secnonce->data[0], 4);
+    secp256k1_declassify(ctx, &secnonce->data[68], 64);
+    is_valid = secp256k1_memcmp_var(&secnonce->data[0], secp256k1_musig_secnonce_magic, 4) == 0;
+    ARG_CHECK(is_valid);
+    secp256k1_scalar_set_b32(&k[0], &secnonce->data[4], NULL);
+    secp256k1_scalar_set_b32(&k[1], &secnonce->data[36], NULL);
+    secp256k1_musig_ge_load(pk, &secnonce->data[68]);
+    return 1;
+}
+
+/* The public nonce is stored as: magic || R[0] || R[1]. */
+static void secp256k1_musig_pubnonce_save(secp256k1_musig_pubnonce *pubnonce, secp256k1_ge *ges) {
+    memcpy(&pubnonce->data[0], secp256k1_musig_pubnonce_magic, 4);
+    secp256k1_musig_ge_save(&pubnonce->data[4], &ges[0]);
+    secp256k1_musig_ge_save(&pubnonce->data[68], &ges[1]);
+}
+
+static int secp256k1_musig_pubnonce_load(const secp256k1_context* ctx, secp256k1_ge *ges, const secp256k1_musig_pubnonce *pubnonce) {
+    ARG_CHECK(secp256k1_memcmp_var(&pubnonce->data[0], secp256k1_musig_pubnonce_magic, 4) == 0);
+    secp256k1_musig_ge_load(&ges[0], &pubnonce->data[4]);
+    secp256k1_musig_ge_load(&ges[1], &pubnonce->data[68]);
+    return 1;
+}
+
+/* The aggregate nonce has the same layout as the public nonce, but its points
+ * may be infinity. */
+static void secp256k1_musig_aggnonce_save(secp256k1_musig_aggnonce *aggnonce, secp256k1_ge *ges) {
+    memcpy(&aggnonce->data[0], secp256k1_musig_aggnonce_magic, 4);
+    secp256k1_musig_ge_save_ext(&aggnonce->data[4], &ges[0]);
+    secp256k1_musig_ge_save_ext(&aggnonce->data[68], &ges[1]);
+}
+
+static int secp256k1_musig_aggnonce_load(const secp256k1_context* ctx, secp256k1_ge *ges, const secp256k1_musig_aggnonce *aggnonce) {
+    ARG_CHECK(secp256k1_memcmp_var(&aggnonce->data[0], secp256k1_musig_aggnonce_magic, 4) == 0);
+    secp256k1_musig_ge_load_ext(&ges[0], &aggnonce->data[4]);
+    secp256k1_musig_ge_load_ext(&ges[1], &aggnonce->data[68]);
+    return 1;
+}
+
+typedef struct {
+    /* Whether the final nonce R has odd Y */
+    int fin_nonce_parity;
+    /* The X coordinate of R */
+    unsigned char fin_nonce[32];
+    /* The nonce coefficient b */
+    secp256k1_scalar noncecoef;
+    /* The challenge e of the Schnorr signature */
+    secp256k1_scalar challenge;
+    /* The part of the final s that is contributed by the tweaks */
+    secp256k1_scalar s_part;
+} secp256k1_musig_session_internal;
+
+/* The session is stored as: magic || fin_nonce_parity || fin_nonce ||
+ * noncecoef || challenge || s_part, which takes 4 + 1 + 4 * 32 = 133 bytes. */
+static void secp256k1_musig_session_save(secp256k1_musig_session *session, const secp256k1_musig_session_internal *session_i) {
+    unsigned char *ptr = session->data;
+    memcpy(ptr, secp256k1_musig_session_magic, 4);
+    ptr += 4;
+    *ptr = session_i->fin_nonce_parity;
+    ptr += 1;
+    memcpy(ptr, session_i->fin_nonce, 32);
+    ptr += 32;
+    secp256k1_scalar_get_b32(ptr, &session_i->noncecoef);
+    ptr += 32;
+    secp256k1_scalar_get_b32(ptr, &session_i->challenge);
+    ptr += 32;
+    secp256k1_scalar_get_b32(ptr, &session_i->s_part);
+}
+
+static int secp256k1_musig_session_load(const secp256k1_context* ctx, secp256k1_musig_session_internal *session_i, const secp256k1_musig_session *session) {
+    const unsigned char *ptr = session->data;
+    ARG_CHECK(secp256k1_memcmp_var(ptr, secp256k1_musig_session_magic, 4) == 0);
+    ptr += 4;
+    session_i->fin_nonce_parity = *ptr & 1;
+    ptr += 1;
+    memcpy(session_i->fin_nonce, ptr, 32);
+    ptr += 32;
+    secp256k1_scalar_set_b32(&session_i->noncecoef, ptr, NULL);
+    ptr += 32;
+    secp256k1_scalar_set_b32(&session_i->challenge, ptr, NULL);
+    ptr += 32;
+    secp256k1_scalar_set_b32(&session_i->s_part, ptr, NULL);
+    return 1;
+}
+
+static void secp256k1_musig_partial_sig_save(secp256k1_musig_partial_sig *sig, const secp256k1_scalar *s) {
+    memcpy(&sig->data[0], secp256k1_musig_partial_sig_magic, 4);
+    secp256k1_scalar_get_b32(&sig->data[4], s);
+}
+
+static int secp256k1_musig_partial_sig_load(const secp256k1_context* ctx, secp256k1_scalar *s, const secp256k1_musig_partial_sig *sig) {
+    ARG_CHECK(secp256k1_memcmp_var(&sig->data[0], secp256k1_musig_partial_sig_magic, 4) == 0);
+    secp256k1_scalar_set_b32(s, &sig->data[4], NULL);
+    return 1;
+}
+
+int secp256k1_musig_pubnonce_parse(const secp256k1_context* ctx, secp256k1_musig_pubnonce* nonce, const unsigned char *in66) {
+    secp256k1_ge ges[2];
+    int i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(nonce != NULL);
+    memset(nonce, 0, sizeof(*nonce));
+    ARG_CHECK(in66 != NULL);
+
+    for (i = 0; i < 2; i++) {
+        if (!secp256k1_eckey_pubkey_parse(&ges[i], &in66[33*i], 33)) {
+            return 0;
+        }
+        if (!secp256k1_ge_is_in_correct_subgroup(&ges[i])) {
+            return 0;
+        }
+    }
+    secp256k1_musig_pubnonce_save(nonce, ges);
+    return 1;
+}
+
+int secp256k1_musig_pubnonce_serialize(const secp256k1_context* ctx, unsigned char *out66, const secp256k1_musig_pubnonce* nonce) {
+    secp256k1_ge ges[2];
+    int i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(out66 != NULL);
+    memset(out66, 0, 66);
+    ARG_CHECK(nonce != NULL);
+
+    if (!secp256k1_musig_pubnonce_load(ctx, ges, nonce)) {
+        return 0;
+    }
+    for (i = 0; i < 2; i++) {
+        secp256k1_musig_ge_serialize_ext(&out66[33*i], &ges[i]);
+    }
+    return 1;
+}
+
+int secp256k1_musig_aggnonce_parse(const secp256k1_context* ctx, secp256k1_musig_aggnonce* nonce, const unsigned char *in66) {
+    secp256k1_ge ges[2];
+    int i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(nonce != NULL);
+    memset(nonce, 0, sizeof(*nonce));
+    ARG_CHECK(in66 != NULL);
+
+    for (i = 0; i < 2; i++) {
+        if (!secp256k1_musig_ge_parse_ext(&ges[i], &in66[33*i])) {
+            return 0;
+        }
+    }
+    secp256k1_musig_aggnonce_save(nonce, ges);
+    return 1;
+}
+
+int secp256k1_musig_aggnonce_serialize(const secp256k1_context* ctx, unsigned char *out66, const secp256k1_musig_aggnonce* nonce) {
+    secp256k1_ge ges[2];
+    int i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(out66 != NULL);
+    memset(out66, 0, 66);
+    ARG_CHECK(nonce != NULL);
+
+    if (!secp256k1_musig_aggnonce_load(ctx, ges, nonce)) {
+        return 0;
+    }
+    for (i = 0; i < 2; i++) {
+        secp256k1_musig_ge_serialize_ext(&out66[33*i], &ges[i]);
+    }
+    return 1;
+}
+
+int secp256k1_musig_partial_sig_parse(const secp256k1_context* ctx, secp256k1_musig_partial_sig* sig, const unsigned char *in32) {
+    secp256k1_scalar s;
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(sig != NULL);
+    memset(sig, 0, sizeof(*sig));
+    ARG_CHECK(in32 != NULL);
+
+    secp256k1_scalar_set_b32(&s, in32, &overflow);
+    if (overflow) {
+        return 0;
+    }
+    secp256k1_musig_partial_sig_save(sig, &s);
+    return 1;
+}
+
+int secp256k1_musig_partial_sig_serialize(const secp256k1_context* ctx, unsigned char *out32, const secp256k1_musig_partial_sig* sig) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(out32 != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(secp256k1_memcmp_var(&sig->data[0], secp256k1_musig_partial_sig_magic, 4) == 0);
+
+    memcpy(out32, &sig->data[4], 32);
+    return 1;
+}
+
+/* Writes bytes(prefix_size, len) || data to the hash, where the length is
+ * encoded in big endian. */
+static void secp256k1_nonce_function_musig_helper(secp256k1_sha256 *sha, unsigned int prefix_size, const unsigned char *data, unsigned char len) {
+    unsigned char len_buf[8] = { 0 };
+    VERIFY_CHECK(prefix_size >= 1 && prefix_size <= sizeof(len_buf));
+    len_buf[prefix_size - 1] = len;
+    secp256k1_sha256_write(sha, len_buf, prefix_size);
+    if (len != 0) {
+        secp256k1_sha256_write(sha, data, len);
+    }
+}
+
+/* Derives the two secret nonces k[0] and k[1] as specified by NonceGen in
+ * BIP327. */
+static void secp256k1_nonce_function_musig(secp256k1_scalar *k, const unsigned char *session_secrand, const unsigned char *msg32, const unsigned char *seckey32, const unsigned char *pk33, const unsigned char *agg_pk32, const unsigned char *extra_input32) {
+    secp256k1_sha256 sha;
+    unsigned char rand[32];
+    unsigned char msg_present;
+    unsigned char i;
+
+    if (seckey32 != NULL) {
+        secp256k1_musig_aux_sha256(&sha);
+        secp256k1_sha256_write(&sha, session_secrand, 32);
+        secp256k1_sha256_finalize(&sha, rand);
+        for (i = 0; i < 32; i++) {
+            rand[i] ^= seckey32[i];
+        }
+    } else {
+        memcpy(rand, session_secrand, sizeof(rand));
+    }
+
+    secp256k1_musig_nonce_sha256(&sha);
+    secp256k1_sha256_write(&sha, rand, sizeof(rand));
+    secp256k1_nonce_function_musig_helper(&sha, 1, pk33, 33);
+    secp256k1_nonce_function_musig_helper(&sha, 1, agg_pk32, agg_pk32 != NULL ? 32 : 0);
+    msg_present = msg32 != NULL;
+    secp256k1_sha256_write(&sha, &msg_present, 1);
+    if (msg_present) {
+        secp256k1_nonce_function_musig_helper(&sha, 8, msg32, 32);
+    }
+    secp256k1_nonce_function_musig_helper(&sha, 4, extra_input32, extra_input32 != NULL ? 32 : 0);
+
+    for (i = 0; i < 2; i++) {
+        secp256k1_sha256 sha_tmp = sha;
+        unsigned char buf[32];
+        secp256k1_sha256_write(&sha_tmp, &i, 1);
+        secp256k1_sha256_finalize(&sha_tmp, buf);
+        secp256k1_scalar_set_b32(&k[i], buf, NULL);
+        memset(buf, 0, sizeof(buf));
+        memset(&sha_tmp, 0, sizeof(sha_tmp));
+    }
+    memset(rand, 0, sizeof(rand));
+    memset(&sha, 0, sizeof(sha));
+}
+
+/* The number of nonces whose points secp256k1_musig_nonce_gen_internal
+ * converts to affine coordinates at once. */
+#define SECP256K1_MUSIG_NONCE_GEN_BATCH 32
+
+static int secp256k1_musig_nonce_gen_internal(const secp256k1_context* ctx, secp256k1_musig_secnonce *secnonces, secp256k1_musig_pubnonce *pubnonces, unsigned char * const *session_secrand32s, const unsigned char *seckey, const secp256k1_pubkey *pubkey, const unsigned char *msg32, const secp256k1_musig_keyagg_cache *keyagg_cache, const unsigned char *extra_input32, size_t n_nonces) {
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_gej noncej[2 * SECP256K1_MUSIG_NONCE_GEN_BATCH];
+    secp256k1_ge nonce_pt[2 * SECP256K1_MUSIG_NONCE_GEN_BATCH];
+    int valid[SECP256K1_MUSIG_NONCE_GEN_BATCH];
+    secp256k1_ge pk;
+    unsigned char pk_ser[33];
+    size_t pk_ser_len = sizeof(pk_ser);
+    unsigned char agg_pk_ser[32];
+    const unsigned char *agg_pk_ser_ptr = NULL;
+    int ret = 1;
+    size_t i, j, num;
+
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_pubkey_load(ctx, &pk, pubkey)) {
+        return 0;
+    }
+    if (!secp256k1_eckey_pubkey_serialize(&pk, pk_ser, &pk_ser_len, 1)) {
+        return 0;
+    }
+    if (keyagg_cache != NULL) {
+        if (!secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache)) {
+            return 0;
+        }
+        secp256k1_fe_get_b32(agg_pk_ser, &cache_i.pk.x);
+        agg_pk_ser_ptr = agg_pk_ser;
+    }
+
+    for (i = 0; i < n_nonces; i += num) {
+        num = n_nonces - i < SECP256K1_MUSIG_NONCE_GEN_BATCH ? n_nonces - i : SECP256K1_MUSIG_NONCE_GEN_BATCH;
+        for (j = 0; j < num; j++) {
+            unsigned char *session_secrand32 = session_secrand32s[i + j];
+            secp256k1_scalar k[2];
+            unsigned char acc = 0;
+            int l;
+
+            /* Refuse all-zero randomness as a defense against a faulty RNG.
+             * As the randomness is cleared after use, this also catches
+             * passing the same buffer twice. */
+            for (l = 0; l < 32; l++) {
+                acc |= session_secrand32[l];
+            }
+            valid[j] = acc != 0;
+            secp256k1_nonce_function_musig(k, session_secrand32, msg32, seckey, pk_ser, agg_pk_ser_ptr, extra_input32);
+            memset(session_secrand32, 0, 32);
+            valid[j] &= !secp256k1_scalar_is_zero(&k[0]) & !secp256k1_scalar_is_zero(&k[1]);
+            secp256k1_scalar_cmov(&k[0], &secp256k1_scalar_one, !valid[j]);
+            secp256k1_scalar_cmov(&k[1], &secp256k1_scalar_one, !valid[j]);
+
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &noncej[2*j], &k[0]);
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &noncej[2*j + 1], &k[1]);
+            secp256k1_musig_secnonce_save(&secnonces[i + j], k, &pk);
+            secp256k1_scalar_clear(&k[0]);
+            secp256k1_scalar_clear(&k[1]);
+        }
+
+        /* The Z coordinates are blinded by secp256k1_ecmult_gen, and the batch
+         * inversion is constant time. */
+        secp256k1_ge_set_all_gej(nonce_pt, noncej, 2 * num);
+
+        for (j = 0; j < num; j++) {
+            /* We declassify the nonce points because they are public. */
+            secp256k1_declassify(ctx, &nonce_pt[2*j], 2 * sizeof(nonce_pt[0]));
+            secp256k1_declassify(ctx, &valid[j], sizeof(valid[j]));
+            secp256k1_musig_pubnonce_save(&pubnonces[i + j], &nonce_pt[2*j]);
+            secp256k1_memczero(&secnonces[i + j], sizeof(secnonces[i + j]), !valid[j]);
+            secp256k1_memczero(&pubnonces[i + j], sizeof(pubnonces[i + j]), !valid[j]);
+            ret &= valid[j];
+        }
+    }
+    return ret;
+}
+
+int secp256k1_musig_nonce_gen(const secp256k1_context* ctx, secp256k1_musig_secnonce *secnonce, secp256k1_musig_pubnonce *pubnonce, unsigned char *session_secrand32, const unsigned char *seckey, const secp256k1_pubkey *pubkey, const unsigned char *msg32, const secp256k1_musig_keyagg_cache *keyagg_cache, const unsigned char *extra_input32) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secnonce != NULL);
+    memset(secnonce, 0, sizeof(*secnonce));
+    ARG_CHECK(pubnonce != NULL);
+    memset(pubnonce, 0, sizeof(*pubnonce));
+    ARG_CHECK(session_secrand32 != NULL);
+
+    return secp256k1_musig_nonce_gen_internal(ctx, secnonce, pubnonce, &session_secrand32, seckey, pubkey, msg32, keyagg_cache, extra_input32, 1);
+}
+
+int secp256k1_musig_nonce_gen_batch(const secp256k1_context* ctx, secp256k1_musig_secnonce *secnonces, secp256k1_musig_pubnonce *pubnonces, unsigned char * const *session_secrand32s, const unsigned char *seckey, const secp256k1_pubkey *pubkey, const secp256k1_musig_keyagg_cache *keyagg_cache, const unsigned char *extra_input32, size_t n_nonces) {
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (n_nonces > 0) {
+        ARG_CHECK(secnonces != NULL);
+        memset(secnonces, 0, n_nonces * sizeof(*secnonces));
+        ARG_CHECK(pubnonces != NULL);
+        memset(pubnonces, 0, n_nonces * sizeof(*pubnonces));
+        ARG_CHECK(session_secrand32s != NULL);
+    }
+    for (i = 0; i < n_nonces; i++) {
+        ARG_CHECK(session_secrand32s[i] != NULL);
+    }
+
+    return secp256k1_musig_nonce_gen_internal(ctx, secnonces, pubnonces, session_secrand32s, seckey, pubkey, NULL, keyagg_cache, extra_input32, n_nonces);
+}
+
+int secp256k1_musig_nonce_agg(const secp256k1_context* ctx, secp256k1_musig_aggnonce *aggnonce, const secp256k1_musig_pubnonce * const* pubnonces, size_t n_pubnonces) {
+    secp256k1_gej aggnoncej[2];
+    secp256k1_ge aggnonce_pt[2];
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(aggnonce != NULL);
+    memset(aggnonce, 0, sizeof(*aggnonce));
+    ARG_CHECK(pubnonces != NULL);
+    ARG_CHECK(n_pubnonces > 0);
+
+    secp256k1_gej_set_infinity(&aggnoncej[0]);
+    secp256k1_gej_set_infinity(&aggnoncej[1]);
+    for (i = 0; i < n_pubnonces; i++) {
+        secp256k1_ge nonce_pt[2];
+        ARG_CHECK(pubnonces[i] != NULL);
+        if (!secp256k1_musig_pubnonce_load(ctx, nonce_pt, pubnonces[i])) {
+            return 0;
+        }
+        secp256k1_gej_add_ge_var(&aggnoncej[0], &aggnoncej[0], &nonce_pt[0], NULL);
+        secp256k1_gej_add_ge_var(&aggnoncej[1], &aggnoncej[1], &nonce_pt[1], NULL);
+    }
+    secp256k1_ge_set_all_gej_var(aggnonce_pt, aggnoncej, 2);
+    secp256k1_musig_aggnonce_save(aggnonce, aggnonce_pt);
+    return 1;
+}
+
+int secp256k1_musig_nonce_process(const secp256k1_context* ctx, secp256k1_musig_session *session, const secp256k1_musig_aggnonce *aggnonce, const unsigned char *msg32, const secp256k1_musig_keyagg_cache *keyagg_cache) {
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_musig_session_internal session_i;
+    secp256k1_ge aggnonce_pt[2];
+    secp256k1_ge fin_nonce_pt;
+    secp256k1_gej fin_noncej;
+    secp256k1_sha256 sha;
+    unsigned char aggnonce_ser[66];
+    unsigned char agg_pk32[32];
+    unsigned char buf[32];
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(session != NULL);
+    ARG_CHECK(aggnonce != NULL);
+    ARG_CHECK(msg32 != NULL);
+    ARG_CHECK(keyagg_cache != NULL);
+
+    if (!secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache)) {
+        return 0;
+    }
+    if (!secp256k1_musig_aggnonce_load(ctx, aggnonce_pt, aggnonce)) {
+        return 0;
+    }
+    secp256k1_musig_ge_serialize_ext(&aggnonce_ser[0], &aggnonce_pt[0]);
+    secp256k1_musig_ge_serialize_ext(&aggnonce_ser[33], &aggnonce_pt[1]);
+    secp256k1_fe_get_b32(agg_pk32, &cache_i.pk.x);
+
+    /* b = hash(aggnonce || agg_pk || msg) */
+    secp256k1_musig_noncecoef_sha256(&sha);
+    secp256k1_sha256_write(&sha, aggnonce_ser, sizeof(aggnonce_ser));
+    secp256k1_sha256_write(&sha, agg_pk32, sizeof(agg_pk32));
+    secp256k1_sha256_write(&sha, msg32, 32);
+    secp256k1_sha256_finalize(&sha, buf);
+    secp256k1_scalar_set_b32(&session_i.noncecoef, buf, NULL);
+
+    /* R = R[0] + b*R[1], or G if that is infinity */
+    secp256k1_gej_set_ge(&fin_noncej, &aggnonce_pt[1]);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &fin_noncej, &fin_noncej, &session_i.noncecoef, NULL);
+    secp256k1_gej_add_ge_var(&fin_noncej, &fin_noncej, &aggnonce_pt[0], NULL);
+    secp256k1_ge_set_gej_var(&fin_nonce_pt, &fin_noncej);
+    if (secp256k1_ge_is_infinity(&fin_nonce_pt)) {
+        fin_nonce_pt = secp256k1_ge_const_g;
+    }
+    secp256k1_fe_normalize_var(&fin_nonce_pt.x);
+    secp256k1_fe_normalize_var(&fin_nonce_pt.y);
+    secp256k1_fe_get_b32(session_i.fin_nonce, &fin_nonce_pt.x);
+    session_i.fin_nonce_parity = secp256k1_fe_is_odd(&fin_nonce_pt.y);
+
+    secp256k1_schnorrsig_challenge(&session_i.challenge, session_i.fin_nonce, msg32, 32, agg_pk32);
+
+    /* The tweaks contribute e*g*tweak to the final s, where g is -1 if the
+     * aggregate key has odd Y. */
+    secp256k1_scalar_mul(&session_i.s_part, &session_i.challenge, &cache_i.tweak);
+    if (secp256k1_fe_is_odd(&cache_i.pk.y)) {
+        secp256k1_scalar_negate(&session_i.s_part, &session_i.s_part);
+    }
+
+    secp256k1_musig_session_save(session, &session_i);
+    return 1;
+}
+
+int secp256k1_musig_partial_sign(const secp256k1_context* ctx, secp256k1_musig_partial_sig *partial_sig, secp256k1_musig_secnonce *secnonce, const secp256k1_keypair *keypair, const secp256k1_musig_keyagg_cache *keyagg_cache, const secp256k1_musig_session *session) {
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_musig_session_internal session_i;
+    secp256k1_scalar k[2];
+    secp256k1_scalar sk, mu, s;
+    secp256k1_ge pk, keypair_pk;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secnonce != NULL);
+    /* Fails if the magic does not match, which is also the case if the nonce
+     * was already used. */
+    ret = secp256k1_musig_secnonce_load(ctx, k, &pk, secnonce);
+    /* Clear the nonce so that it cannot be used again, whatever happens. */
+    memset(secnonce, 0, sizeof(*secnonce));
+    ret = ret && partial_sig != NULL && keypair != NULL && keyagg_cache != NULL && session != NULL;
+    ret = ret && secp256k1_keypair_load(ctx, &sk, &keypair_pk, keypair);
+    ret = ret && secp256k1_fe_equal_var(&pk.x, &keypair_pk.x) && secp256k1_fe_equal_var(&pk.y, &keypair_pk.y);
+    ret = ret && secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache);
+    ret = ret && secp256k1_musig_session_load(ctx, &session_i, session);
+    if (!ret) {
+        secp256k1_scalar_clear(&k[0]);
+        secp256k1_scalar_clear(&k[1]);
+        secp256k1_scalar_clear(&sk);
+        ARG_CHECK(partial_sig != NULL);
+        ARG_CHECK(keypair != NULL);
+        ARG_CHECK(keyagg_cache != NULL);
+        ARG_CHECK(session != NULL);
+        return 0;
+    }
+
+    /* d = g*gacc*sk, where g is -1 if the aggregate key has odd Y and gacc is
+     * the product of the negations applied by x-only tweaks. */
+    secp256k1_scalar_cond_negate(&sk, secp256k1_fe_is_odd(&cache_i.pk.y) != cache_i.parity_acc);
+    secp256k1_musig_keyaggcoef(&mu, &cache_i, &pk);
+    secp256k1_scalar_mul(&sk, &sk, &mu);
+
+    /* The nonces are negated if the final nonce R has odd Y. */
+    secp256k1_scalar_cond_negate(&k[0], session_i.fin_nonce_parity);
+    secp256k1_scalar_cond_negate(&k[1], session_i.fin_nonce_parity);
+
+    /* s = k[0] + b*k[1] + e*mu*d */
+    secp256k1_scalar_mul(&s, &session_i.challenge, &sk);
+    secp256k1_scalar_mul(&k[1], &session_i.noncecoef, &k[1]);
+    secp256k1_scalar_add(&s, &s, &k[0]);
+    secp256k1_scalar_add(&s, &s, &k[1]);
+    secp256k1_musig_partial_sig_save(partial_sig, &s);
+
+    secp256k1_scalar_clear(&k[0]);
+    secp256k1_scalar_clear(&k[1]);
+    secp256k1_scalar_clear(&sk);
+    return 1;
+}
+
+int secp256k1_musig_partial_sig_verify(const secp256k1_context* ctx, const secp256k1_musig_partial_sig *partial_sig, const secp256k1_musig_pubnonce *pubnonce, const secp256k1_pubkey *pubkey, const secp256k1_musig_keyagg_cache *keyagg_cache, const secp256k1_musig_session *session) {
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_musig_session_internal session_i;
+    secp256k1_scalar mu, e, s;
+    secp256k1_gej pkj, rj, tmp;
+    secp256k1_ge nonce_pt[2];
+    secp256k1_ge pkp;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(partial_sig != NULL);
+    ARG_CHECK(pubnonce != NULL);
+    ARG_CHECK(pubkey != NULL);
+    ARG_CHECK(keyagg_cache != NULL);
+    ARG_CHECK(session != NULL);
+
+    if (!secp256k1_musig_session_load(ctx, &session_i, session)
+        || !secp256k1_musig_partial_sig_load(ctx, &s, partial_sig)
+        || !secp256k1_musig_pubnonce_load(ctx, nonce_pt, pubnonce)
+        || !secp256k1_pubkey_load(ctx, &pkp, pubkey)
+        || !secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache)) {
+        return 0;
+    }
+
+    /* The signer's effective nonce is R[0] + b*R[1], negated if the final
+     * nonce has odd Y. */
+    secp256k1_gej_set_ge(&rj, &nonce_pt[1]);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &rj, &rj, &session_i.noncecoef, NULL);
+    secp256k1_gej_add_ge_var(&rj, &rj, &nonce_pt[0], NULL);
+    if (session_i.fin_nonce_parity) {
+        secp256k1_gej_neg(&rj, &rj);
+    }
+
+    /* e*mu*g*gacc, with g and gacc as in secp256k1_musig_partial_sign */
+    secp256k1_gej_set_ge(&pkj, &pkp);
+    secp256k1_musig_keyaggcoef(&mu, &cache_i, &pkp);
+    secp256k1_scalar_mul(&e, &session_i.challenge, &mu);
+    if (secp256k1_fe_is_odd(&cache_i.pk.y) != cache_i.parity_acc) {
+        secp256k1_scalar_negate(&e, &e);
+    }
+
+    /* Check that -s*G + e*mu*g*gacc*P + R_eff is infinity. */
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &tmp, &pkj, &e, &s);
+    secp256k1_gej_add_var(&tmp, &tmp, &rj, NULL);
+    return secp256k1_gej_is_infinity(&tmp);
+}
+
+int secp256k1_musig_partial_sig_agg(const secp256k1_context* ctx, unsigned char *sig64, const secp256k1_musig_session *session, const secp256k1_musig_partial_sig * const* partial_sigs, size_t n_sigs) {
+    secp256k1_musig_session_internal session_i;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(session != NULL);
+    ARG_CHECK(partial_sigs != NULL);
+    ARG_CHECK(n_sigs > 0);
+
+    if (!secp256k1_musig_session_load(ctx, &session_i, session)) {
+        return 0;
+    }
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_scalar term;
+        ARG_CHECK(partial_sigs[i] != NULL);
+        if (!secp256k1_musig_partial_sig_load(ctx, &term, partial_sigs[i])) {
+            return 0;
+        }
+        secp256k1_scalar_add(&session_i.s_part, &session_i.s_part, &term);
+    }
+    memcpy(&sig64[0], session_i.fin_nonce, 32);
+    secp256k1_scalar_get_b32(&sig64[32], &session_i.s_part);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,1111 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_MUSIG_TESTS_H
+#define SECP256K1_MODULE_MUSIG_TESTS_H
+
+#include "../../../include/secp256k1_musig.h"
+#include "../../../include/secp256k1_schnorrsig.h"
+
+/* Checks that the hashes initialized with fixed midstates have the expected
+ * state. */
+void test_musig_sha256_tagged(void) {
+    static const char *tags[5] = { "KeyAgg list", "KeyAgg coefficient", "MuSig/aux", "MuSig/nonce", "MuSig/noncecoef" };
+    void (*initialize[5])(secp256k1_sha256 *sha) = {
+        secp256k1_musig_keyagglist_sha256,
+        secp256k1_musig_keyaggcoef_sha256,
+        secp256k1_musig_aux_sha256,
+        secp256k1_musig_nonce_sha256,
+        secp256k1_musig_noncecoef_sha256
+    };
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        secp256k1_sha256 sha;
+        secp256k1_sha256 sha_optimized;
+        secp256k1_sha256_initialize_tagged(&sha, (const unsigned char *) tags[i], strlen(tags[i]));
+        initialize[i](&sha_optimized);
+        test_sha256_eq(&sha, &sha_optimized);
+    }
+}
+
+/* Key aggregation test vectors from BIP327. */
+void test_musig_pubkey_agg_vectors(void) {
+    static const unsigned char pks[3][33] = {
+        {
+            0x02, 0xF9, 0x30, 0x8A, 0x01, 0x92, 0x58, 0xC3, 0x10, 0x49, 0x34, 0x4F, 0x85, 0xF8, 0x9D, 0x52,
+            0x29, 0xB5, 0x31, 0xC8, 0x45, 0x83, 0x6F, 0x99, 0xB0, 0x86, 0x01, 0xF1, 0x13, 0xBC, 0xE0, 0x36,
+            0xF9
+        },
+        {
+            0x03, 0xDF, 0xF1, 0xD7, 0x7F, 0x2A, 0x67, 0x1C, 0x5F, 0x36, 0x18, 0x37, 0x26, 0xDB, 0x23, 0x41,
+            0xBE, 0x58, 0xFE, 0xAE, 0x1D, 0xA2, 0xDE, 0xCE, 0xD8, 0x43, 0x24, 0x0F, 0x7B, 0x50, 0x2B, 0xA6,
+            0x59
+        },
+        {
+            0x02, 0x35, 0x90, 0xA9, 0x4E, 0x76, 0x8F, 0x8E, 0x18, 0x15, 0xC2, 0xF2, 0x4B, 0x4D, 0x80, 0xA8,
+            0xE3, 0x14, 0x93, 0x16, 0xC3, 0x51, 0x8C, 0xE7, 0xB7, 0xAD, 0x33, 0x83, 0x68, 0xD0, 0x38, 0xCA,
+            0x66
+        }
+    };
+    static const size_t key_indices[4][4] = {
+        { 0, 1, 2 },
+        { 2, 1, 0 },
+        { 0, 0, 0 },
+        { 0, 0, 1, 1 }
+    };
+    static const size_t n_keys[4] = { 3, 3, 3, 4 };
+    static const unsigned char expected[4][32] = {
+        {
+            0x90, 0x53, 0x9E, 0xED, 0xE5, 0x65, 0xF5, 0xD0, 0x54, 0xF3, 0x2C, 0xC0, 0xC2, 0x20, 0x12, 0x68,
+            0x89, 0xED, 0x1E, 0x5D, 0x19, 0x3B, 0xAF, 0x15, 0xAE, 0xF3, 0x44, 0xFE, 0x59, 0xD4, 0x61, 0x0C
+        },
+        {
+            0x62, 0x04, 0xDE, 0x8B, 0x08, 0x34, 0x26, 0xDC, 0x6E, 0xAF, 0x95, 0x02, 0xD2, 0x70, 0x24, 0xD5,
+            0x3F, 0xC8, 0x26, 0xBF, 0x7D, 0x20, 0x12, 0x14, 0x8A, 0x05, 0x75, 0x43, 0x5D, 0xF5, 0x4B, 0x2B
+        },
+        {
+            0xB4, 0x36, 0xE3, 0xBA, 0xD6, 0x2B, 0x8C, 0xD4, 0x09, 0x96, 0x9A, 0x22, 0x47, 0x31, 0xC1, 0x93,
+            0xD0, 0x51, 0x16, 0x2D, 0x8C, 0x5A, 0xE8, 0xB1, 0x09, 0x30, 0x61, 0x27, 0xDA, 0x3A, 0xA9, 0x35
+        },
+        {
+            0x69, 0xBC, 0x22, 0xBF, 0xA5, 0xD1, 0x06, 0x30, 0x6E, 0x48, 0xA2, 0x06, 0x79, 0xDE, 0x1D, 0x73,
+            0x89, 0x38, 0x61, 0x24, 0xD0, 0x75, 0x71, 0xD0, 0xD8, 0x72, 0x68, 0x60, 0x28, 0xC2, 0x6A, 0x3E
+        }
+    };
+    secp256k1_pubkey pubkeys[3];
+    int i;
+    size_t j;
+
+    for (i = 0; i < 3; i++) {
+        CHECK(secp256k1_ec_pubkey_parse(ctx, &pubkeys[i], pks[i], 33) == 1);
+    }
+    for (i = 0; i < 4; i++) {
+        const secp256k1_pubkey *pk_ptrs[4];
+        secp256k1_xonly_pubkey agg_pk;
+        unsigned char agg_pk32[32];
+
+        for (j = 0; j < n_keys[i]; j++) {
+            pk_ptrs[j] = &pubkeys[key_indices[i][j]];
+        }
+        CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, &agg_pk, NULL, pk_ptrs, n_keys[i]) == 1);
+        CHECK(secp256k1_xonly_pubkey_serialize(ctx, agg_pk32, &agg_pk) == 1);
+        CHECK(secp256k1_memcmp_var(agg_pk32, expected[i], 32) == 0);
+    }
+}
+
+/* NonceGen test vectors from BIP327 whose message, if given, has 32 bytes.
+ * The first gives all optional inputs, the second none of them. */
+void test_musig_nonce_gen_vectors(void) {
+    static const unsigned char rand[32] = {
+        0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+        0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F
+    };
+    static const unsigned char sk[32] = {
+        0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+        0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02
+    };
+    static const unsigned char agg_pk[32] = {
+        0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+        0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07
+    };
+    static const unsigned char msg[32] = {
+        0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+        0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01
+    };
+    static const unsigned char extra_in[32] = {
+        0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+        0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08
+    };
+    static const unsigned char pks[2][33] = {
+        {
+            0x02, 0x4D, 0x4B, 0x6C, 0xD1, 0x36, 0x10, 0x32, 0xCA, 0x9B, 0xD2, 0xAE, 0xB9, 0xD9, 0x00, 0xAA,
+            0x4D, 0x45, 0xD9, 0xEA, 0xD8, 0x0A, 0xC9, 0x42, 0x33, 0x74, 0xC4, 0x51, 0xA7, 0x25, 0x4D, 0x07,
+            0x66
+        },
+        {
+            0x02, 0xF9, 0x30, 0x8A, 0x01, 0x92, 0x58, 0xC3, 0x10, 0x49, 0x34, 0x4F, 0x85, 0xF8, 0x9D, 0x52,
+            0x29, 0xB5, 0x31, 0xC8, 0x45, 0x83, 0x6F, 0x99, 0xB0, 0x86, 0x01, 0xF1, 0x13, 0xBC, 0xE0, 0x36,
+            0xF9
+        }
+    };
+    /* The first 64 bytes of the expected secnonce, k1 || k2. */
+    static const unsigned char expected_k[2][64] = {
+        {
+            0xB1, 0x14, 0xE5, 0x02, 0xBE, 0xAA, 0x4E, 0x30, 0x1D, 0xD0, 0x8A, 0x50, 0x26, 0x41, 0x72, 0xC8,
+            0x4E, 0x41, 0x65, 0x0E, 0x6C, 0xB7, 0x26, 0xB4, 0x10, 0xC0, 0x69, 0x4D, 0x59, 0xEF, 0xFB, 0x64,
+            0x95, 0xB5, 0xCA, 0xF2, 0x8D, 0x04, 0x5B, 0x97, 0x3D, 0x63, 0xE3, 0xC9, 0x9A, 0x44, 0xB8, 0x07,
+            0xBD, 0xE3, 0x75, 0xFD, 0x6C, 0xB3, 0x9E, 0x46, 0xDC, 0x4A, 0x51, 0x17, 0x08, 0xD0, 0xE9, 0xD2
+        },
+        {
+            0x89, 0xBD, 0xD7, 0x87, 0xD0, 0x28, 0x4E, 0x5E, 0x4D, 0x5F, 0xC5, 0x72, 0xE4, 0x9E, 0x31, 0x6B,
+            0xAB, 0x7E, 0x21, 0xE3, 0xB1, 0x83, 0x0D, 0xE3, 0x7D, 0xFE, 0x80, 0x15, 0x6F, 0xA4, 0x1A, 0x6D,
+            0x0B, 0x17, 0xAE, 0x8D, 0x02, 0x4C, 0x53, 0x67, 0x96, 0x99, 0xA6, 0xFD, 0x79, 0x44, 0xD9, 0xC4,
+            0xA3, 0x66, 0xB5, 0x14, 0xBA, 0xF4, 0x30, 0x88, 0xE0, 0x70, 0x8B, 0x10, 0x23, 0xDD, 0x28, 0x97
+        }
+    };
+    static const unsigned char expected_pubnonce[2][66] = {
+        {
+            0x02, 0xF7, 0xBE, 0x70, 0x89, 0xE8, 0x37, 0x6E, 0xB3, 0x55, 0x27, 0x23, 0x68, 0x76, 0x6B, 0x17,
+            0xE8, 0x8E, 0x7D, 0xB7, 0x20, 0x47, 0xD0, 0x5E, 0x56, 0xAA, 0x88, 0x1E, 0xA5, 0x2B, 0x3B, 0x35,
+            0xDF, 0x02, 0xC2, 0x9C, 0x80, 0x46, 0xFD, 0xD0, 0xDE, 0xD4, 0xC7, 0xE5, 0x58, 0x69, 0x13, 0x72,
+            0x00, 0xFB, 0xDB, 0xFE, 0x2E, 0xB6, 0x54, 0x26, 0x7B, 0x6D, 0x70, 0x13, 0x60, 0x2C, 0xAE, 0xD3,
+            0x11, 0x5A
+        },
+        {
+            0x02, 0xC9, 0x6E, 0x7C, 0xB1, 0xE8, 0xAA, 0x5D, 0xAC, 0x64, 0xD8, 0x72, 0x94, 0x79, 0x14, 0x19,
+            0x8F, 0x60, 0x7D, 0x90, 0xEC, 0xDE, 0x52, 0x00, 0xDE, 0x52, 0x97, 0x8A, 0xD5, 0xDE, 0xD6, 0x3C,
+            0x00, 0x02, 0x99, 0xEC, 0x51, 0x17, 0xC2, 0xD2, 0x9E, 0xDE, 0xE8, 0xA2, 0x09, 0x25, 0x87, 0xC3,
+            0x90, 0x9B, 0xE6, 0x94, 0xD5, 0xCF, 0xF0, 0x66, 0x7D, 0x6C, 0x02, 0xEA, 0x40, 0x59, 0xF7, 0xCD,
+            0x97, 0x86
+        }
+    };
+    int i, j;
+
+    for (i = 0; i < 2; i++) {
+        secp256k1_scalar k[2];
+
+        if (i == 0) {
+            secp256k1_nonce_function_musig(k, rand, msg, sk, pks[i], agg_pk, extra_in);
+        } else {
+            secp256k1_nonce_function_musig(k, rand, NULL, NULL, pks[i], NULL, NULL);
+        }
+        for (j = 0; j < 2; j++) {
+            unsigned char k32[32];
+            unsigned char pubnonce33[33];
+            size_t len = sizeof(pubnonce33);
+            secp256k1_pubkey r;
+
+            secp256k1_scalar_get_b32(k32, &k[j]);
+            CHECK(secp256k1_memcmp_var(k32, &expected_k[i][32*j], 32) == 0);
+            CHECK(secp256k1_ec_pubkey_create(ctx, &r, k32) == 1);
+            CHECK(secp256k1_ec_pubkey_serialize(ctx, pubnonce33, &len, &r, SECP256K1_EC_COMPRESSED) == 1);
+            CHECK(secp256k1_memcmp_var(pubnonce33, &expected_pubnonce[i][33*j], 33) == 0);
+        }
+    }
+}
+
+/* NonceAgg test vectors from BIP327. The second valid case sums to infinity in
+ * the second component. The invalid public nonces have a wrong tag, an X
+ * coordinate not on the curve and an X coordinate that exceeds the field
+ * size. */
+void test_musig_nonce_agg_vectors(void) {
+    static const unsigned char pubnonces[7][66] = {
+        {
+            0x02, 0x01, 0x51, 0xC8, 0x0F, 0x43, 0x56, 0x48, 0xDF, 0x67, 0xA2, 0x2B, 0x74, 0x9C, 0xD7, 0x98,
+            0xCE, 0x54, 0xE0, 0x32, 0x1D, 0x03, 0x4B, 0x92, 0xB7, 0x09, 0xB5, 0x67, 0xD6, 0x0A, 0x42, 0xE6,
+            0x66, 0x03, 0xBA, 0x47, 0xFB, 0xC1, 0x83, 0x44, 0x37, 0xB3, 0x21, 0x2E, 0x89, 0xA8, 0x4D, 0x84,
+            0x25, 0xE7, 0xBF, 0x12, 0xE0, 0x24, 0x5D, 0x98, 0x26, 0x22, 0x68, 0xEB, 0xDC, 0xB3, 0x85, 0xD5,
+            0x06, 0x41
+        },
+        {
+            0x03, 0xFF, 0x40, 0x6F, 0xFD, 0x8A, 0xDB, 0x9C, 0xD2, 0x98, 0x77, 0xE4, 0x98, 0x50, 0x14, 0xF6,
+            0x6A, 0x59, 0xF6, 0xCD, 0x01, 0xC0, 0xE8, 0x8C, 0xAA, 0x8E, 0x5F, 0x31, 0x66, 0xB1, 0xF6, 0x76,
+            0xA6, 0x02, 0x48, 0xC2, 0x64, 0xCD, 0xD5, 0x7D, 0x3C, 0x24, 0xD7, 0x99, 0x90, 0xB0, 0xF8, 0x65,
+            0x67, 0x4E, 0xB6, 0x2A, 0x0F, 0x90, 0x18, 0x27, 0x7A, 0x95, 0x01, 0x1B, 0x41, 0xBF, 0xC1, 0x93,
+            0xB8, 0x33
+        },
+        {
+            0x02, 0x01, 0x51, 0xC8, 0x0F, 0x43, 0x56, 0x48, 0xDF, 0x67, 0xA2, 0x2B, 0x74, 0x9C, 0xD7, 0x98,
+            0xCE, 0x54, 0xE0, 0x32, 0x1D, 0x03, 0x4B, 0x92, 0xB7, 0x09, 0xB5, 0x67, 0xD6, 0x0A, 0x42, 0xE6,
+            0x66, 0x02, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62, 0x95, 0xCE, 0x87,
+            0x0B, 0x07, 0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8,
+            0x17, 0x98
+        },
+        {
+            0x03, 0xFF, 0x40, 0x6F, 0xFD, 0x8A, 0xDB, 0x9C, 0xD2, 0x98, 0x77, 0xE4, 0x98, 0x50, 0x14, 0xF6,
+            0x6A, 0x59, 0xF6, 0xCD, 0x01, 0xC0, 0xE8, 0x8C, 0xAA, 0x8E, 0x5F, 0x31, 0x66, 0xB1, 0xF6, 0x76,
+            0xA6, 0x03, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62, 0x95, 0xCE, 0x87,
+            0x0B, 0x07, 0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8,
+            0x17, 0x98
+        },
+        {
+            0x04, 0xFF, 0x40, 0x6F, 0xFD, 0x8A, 0xDB, 0x9C, 0xD2, 0x98, 0x77, 0xE4, 0x98, 0x50, 0x14, 0xF6,
+            0x6A, 0x59, 0xF6, 0xCD, 0x01, 0xC0, 0xE8, 0x8C, 0xAA, 0x8E, 0x5F, 0x31, 0x66, 0xB1, 0xF6, 0x76,
+            0xA6, 0x02, 0x48, 0xC2, 0x64, 0xCD, 0xD5, 0x7D, 0x3C, 0x24, 0xD7, 0x99, 0x90, 0xB0, 0xF8, 0x65,
+            0x67, 0x4E, 0xB6, 0x2A, 0x0F, 0x90, 0x18, 0x27, 0x7A, 0x95, 0x01, 0x1B, 0x41, 0xBF, 0xC1, 0x93,
+            0xB8, 0x33
+        },
+        {
+            0x03, 0xFF, 0x40, 0x6F, 0xFD, 0x8A, 0xDB, 0x9C, 0xD2, 0x98, 0x77, 0xE4, 0x98, 0x50, 0x14, 0xF6,
+            0x6A, 0x59, 0xF6, 0xCD, 0x01, 0xC0, 0xE8, 0x8C, 0xAA, 0x8E, 0x5F, 0x31, 0x66, 0xB1, 0xF6, 0x76,
+            0xA6, 0x02, 0x48, 0xC2, 0x64, 0xCD, 0xD5, 0x7D, 0x3C, 0x24, 0xD7, 0x99, 0x90, 0xB0, 0xF8, 0x65,
+            0x67, 0x4E, 0xB6, 0x2A, 0x0F, 0x90, 0x18, 0x27, 0x7A, 0x95, 0x01, 0x1B, 0x41, 0xBF, 0xC1, 0x93,
+            0xB8, 0x31
+        },
+        {
+            0x03, 0xFF, 0x40, 0x6F, 0xFD, 0x8A, 0xDB, 0x9C, 0xD2, 0x98, 0x77, 0xE4, 0x98, 0x50, 0x14, 0xF6,
+            0x6A, 0x59, 0xF6, 0xCD, 0x01, 0xC0, 0xE8, 0x8C, 0xAA, 0x8E, 0x5F, 0x31, 0x66, 0xB1, 0xF6, 0x76,
+            0xA6, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF,
+            0xFC, 0x30
+        }
+    };
+    static const unsigned char expected[2][66] = {
+        {
+            0x03, 0x5F, 0xE1, 0x87, 0x3B, 0x4F, 0x29, 0x67, 0xF5, 0x2F, 0xEA, 0x4A, 0x06, 0xAD, 0x5A, 0x8E,
+            0xCC, 0xBE, 0x9D, 0x0F, 0xD7, 0x30, 0x68, 0x01, 0x2C, 0x89, 0x4E, 0x2E, 0x87, 0xCC, 0xB5, 0x80,
+            0x4B, 0x02, 0x47, 0x25, 0x37, 0x73, 0x45, 0xBD, 0xE0, 0xE9, 0xC3, 0x3A, 0xF3, 0xC4, 0x3C, 0x0A,
+            0x29, 0xA9, 0x24, 0x9F, 0x2F, 0x29, 0x56, 0xFA, 0x8C, 0xFE, 0xB5, 0x5C, 0x85, 0x73, 0xD0, 0x26,
+            0x2D, 0xC8
+        },
+        {
+            0x03, 0x5F, 0xE1, 0x87, 0x3B, 0x4F, 0x29, 0x67, 0xF5, 0x2F, 0xEA, 0x4A, 0x06, 0xAD, 0x5A, 0x8E,
+            0xCC, 0xBE, 0x9D, 0x0F, 0xD7, 0x30, 0x68, 0x01, 0x2C, 0x89, 0x4E, 0x2E, 0x87, 0xCC, 0xB5, 0x80,
+            0x4B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00
+        }
+    };
+    secp256k1_musig_pubnonce pubnonce[4];
+    secp256k1_musig_pubnonce invalid;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        CHECK(secp256k1_musig_pubnonce_parse(ctx, &pubnonce[i], pubnonces[i]) == 1);
+    }
+    for (i = 4; i < 7; i++) {
+        CHECK(secp256k1_musig_pubnonce_parse(ctx, &invalid, pubnonces[i]) == 0);
+    }
+    for (i = 0; i < 2; i++) {
+        const secp256k1_musig_pubnonce *pubnonce_ptrs[2];
+        secp256k1_musig_aggnonce aggnonce;
+        unsigned char aggnonce66[66];
+
+        pubnonce_ptrs[0] = &pubnonce[2*i];
+        pubnonce_ptrs[1] = &pubnonce[2*i + 1];
+        CHECK(secp256k1_musig_nonce_agg(ctx, &aggnonce, pubnonce_ptrs, 2) == 1);
+        CHECK(secp256k1_musig_aggnonce_serialize(ctx, aggnonce66, &aggnonce) == 1);
+        CHECK(secp256k1_memcmp_var(aggnonce66, expected[i], 66) == 0);
+    }
+}
+
+/* Data shared by the Sign and tweak test vectors from BIP327: the secret key
+ * of the signer, its secret nonce and the public nonces of all signers, of
+ * which the last one is the negation of the first. */
+static const unsigned char test_musig_vector_sk[32] = {
+        0x7F, 0xB9, 0xE0, 0xE6, 0x87, 0xAD, 0xA1, 0xEE, 0xBF, 0x7E, 0xCF, 0xE2, 0xF2, 0x1E, 0x73, 0xEB,
+        0xDB, 0x51, 0xA7, 0xD4, 0x50, 0x94, 0x8D, 0xFE, 0x8D, 0x76, 0xD7, 0xF2, 0xD1, 0x00, 0x76, 0x71
+    };
+static const unsigned char test_musig_vector_k[64] = {
+        0x50, 0x8B, 0x81, 0xA6, 0x11, 0xF1, 0x00, 0xA6, 0xB2, 0xB6, 0xB2, 0x96, 0x56, 0x59, 0x08, 0x98,
+        0xAF, 0x48, 0x8B, 0xCF, 0x2E, 0x1F, 0x55, 0xCF, 0x22, 0xE5, 0xCF, 0xB8, 0x44, 0x21, 0xFE, 0x61,
+        0xFA, 0x27, 0xFD, 0x49, 0xB1, 0xD5, 0x00, 0x85, 0xB4, 0x81, 0x28, 0x5E, 0x1C, 0xA2, 0x05, 0xD5,
+        0x5C, 0x82, 0xCC, 0x1B, 0x31, 0xFF, 0x5C, 0xD5, 0x4A, 0x48, 0x98, 0x29, 0x35, 0x59, 0x01, 0xF7
+    };
+static const unsigned char test_musig_vector_pubnonces[4][66] = {
+        {
+            0x03, 0x37, 0xC8, 0x78, 0x21, 0xAF, 0xD5, 0x0A, 0x86, 0x44, 0xD8, 0x20, 0xA8, 0xF3, 0xE0, 0x2E,
+            0x49, 0x9C, 0x93, 0x18, 0x65, 0xC2, 0x36, 0x0F, 0xB4, 0x3D, 0x0A, 0x0D, 0x20, 0xDA, 0xFE, 0x07,
+            0xEA, 0x02, 0x87, 0xBF, 0x89, 0x1D, 0x2A, 0x6D, 0xEA, 0xEB, 0xAD, 0xC9, 0x09, 0x35, 0x2A, 0xA9,
+            0x40, 0x5D, 0x14, 0x28, 0xC1, 0x5F, 0x4B, 0x75, 0xF0, 0x4D, 0xAE, 0x64, 0x2A, 0x95, 0xC2, 0x54,
+            0x84, 0x80
+        },
+        {
+            0x02, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62, 0x95, 0xCE, 0x87, 0x0B,
+            0x07, 0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8, 0x17,
+            0x98, 0x02, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62, 0x95, 0xCE, 0x87,
+            0x0B, 0x07, 0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8,
+            0x17, 0x98
+        },
+        {
+            0x03, 0x2D, 0xE2, 0x66, 0x26, 0x28, 0xC9, 0x0B, 0x03, 0xF5, 0xE7, 0x20, 0x28, 0x4E, 0xB5, 0x2F,
+            0xF7, 0xD7, 0x1F, 0x42, 0x84, 0xF6, 0x27, 0xB6, 0x8A, 0x85, 0x3D, 0x78, 0xC7, 0x8E, 0x1F, 0xFE,
+            0x93, 0x03, 0xE4, 0xC5, 0x52, 0x4E, 0x83, 0xFF, 0xE1, 0x49, 0x3B, 0x90, 0x77, 0xCF, 0x1C, 0xA6,
+            0xBE, 0xB2, 0x09, 0x0C, 0x93, 0xD9, 0x30, 0x32, 0x10, 0x71, 0xAD, 0x40, 0xB2, 0xF4, 0x4E, 0x59,
+            0x90, 0x46
+        },
+        {
+            0x02, 0x37, 0xC8, 0x78, 0x21, 0xAF, 0xD5, 0x0A, 0x86, 0x44, 0xD8, 0x20, 0xA8, 0xF3, 0xE0, 0x2E,
+            0x49, 0x9C, 0x93, 0x18, 0x65, 0xC2, 0x36, 0x0F, 0xB4, 0x3D, 0x0A, 0x0D, 0x20, 0xDA, 0xFE, 0x07,
+            0xEA, 0x03, 0x87, 0xBF, 0x89, 0x1D, 0x2A, 0x6D, 0xEA, 0xEB, 0xAD, 0xC9, 0x09, 0x35, 0x2A, 0xA9,
+            0x40, 0x5D, 0x14, 0x28, 0xC1, 0x5F, 0x4B, 0x75, 0xF0, 0x4D, 0xAE, 0x64, 0x2A, 0x95, 0xC2, 0x54,
+            0x84, 0x80
+        }
+    };
+static const unsigned char test_musig_vector_msg[32] = {
+        0xF9, 0x54, 0x66, 0xD0, 0x86, 0x77, 0x0E, 0x68, 0x99, 0x64, 0x66, 0x42, 0x19, 0x26, 0x6F, 0xE5,
+        0xED, 0x21, 0x5C, 0x92, 0xAE, 0x20, 0xBA, 0xB5, 0xC9, 0xD7, 0x9A, 0xDD, 0xDD, 0xF3, 0xC0, 0xCF
+    };
+
+/* Signs with the secret key and nonce of the vectors as the signer at
+ * signer_index, after applying the tweaks to the aggregate key, and checks the
+ * partial signature against expected32 and with
+ * secp256k1_musig_partial_sig_verify. */
+void test_musig_vector_sign(const unsigned char (*pks)[33], const size_t *key_indices, const size_t *nonce_indices, size_t n_signers, size_t signer_index, const unsigned char (*tweaks)[32], const int *is_xonly, size_t n_tweaks, const unsigned char *expected32) {
+    secp256k1_pubkey pubkeys[3];
+    const secp256k1_pubkey *pk_ptrs[3];
+    secp256k1_musig_pubnonce pubnonces[3];
+    const secp256k1_musig_pubnonce *pubnonce_ptrs[3];
+    secp256k1_musig_keyagg_cache cache;
+    secp256k1_musig_aggnonce aggnonce;
+    secp256k1_musig_session session;
+    secp256k1_musig_secnonce secnonce;
+    secp256k1_musig_partial_sig partial_sig;
+    secp256k1_keypair keypair;
+    secp256k1_scalar k[2];
+    secp256k1_ge pk;
+    unsigned char sig32[32];
+    size_t i;
+
+    CHECK(n_signers <= 3);
+    for (i = 0; i < n_signers; i++) {
+        CHECK(secp256k1_ec_pubkey_parse(ctx, &pubkeys[i], pks[key_indices[i]], 33) == 1);
+        pk_ptrs[i] = &pubkeys[i];
+        CHECK(secp256k1_musig_pubnonce_parse(ctx, &pubnonces[i], test_musig_vector_pubnonces[nonce_indices[i]]) == 1);
+        pubnonce_ptrs[i] = &pubnonces[i];
+    }
+    CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, NULL, &cache, pk_ptrs, n_signers) == 1);
+    for (i = 0; i < n_tweaks; i++) {
+        if (is_xonly[i]) {
+            CHECK(secp256k1_musig_pubkey_xonly_tweak_add(ctx, NULL, &cache, tweaks[i]) == 1);
+        } else {
+            CHECK(secp256k1_musig_pubkey_ec_tweak_add(ctx, NULL, &cache, tweaks[i]) == 1);
+        }
+    }
+    CHECK(secp256k1_musig_nonce_agg(ctx, &aggnonce, pubnonce_ptrs, n_signers) == 1);
+    CHECK(secp256k1_musig_nonce_process(ctx, &session, &aggnonce, test_musig_vector_msg, &cache) == 1);
+
+    CHECK(secp256k1_keypair_create(ctx, &keypair, test_musig_vector_sk) == 1);
+    CHECK(secp256k1_pubkey_load(ctx, &pk, &pubkeys[signer_index]));
+    secp256k1_scalar_set_b32(&k[0], &test_musig_vector_k[0], NULL);
+    secp256k1_scalar_set_b32(&k[1], &test_musig_vector_k[32], NULL);
+    secp256k1_musig_secnonce_save(&secnonce, k, &pk);
+    CHECK(secp256k1_musig_partial_sign(ctx, &partial_sig, &secnonce, &keypair, &cache, &session) == 1);
+    CHECK(secp256k1_musig_partial_sig_serialize(ctx, sig32, &partial_sig) == 1);
+    CHECK(secp256k1_memcmp_var(sig32, expected32, 32) == 0);
+    CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sig, &pubnonces[signer_index], &pubkeys[signer_index], &cache, &session) == 1);
+}
+
+/* Sign and PartialSigVerify test vectors from BIP327 with a 32-byte
+ * message. */
+void test_musig_sign_verify_vectors(void) {
+    static const unsigned char pks[3][33] = {
+        {
+            0x03, 0x93, 0x5F, 0x97, 0x2D, 0xA0, 0x13, 0xF8, 0x0A, 0xE0, 0x11, 0x89, 0x0F, 0xA8, 0x9B, 0x67,
+            0xA2, 0x7B, 0x7B, 0xE6, 0xCC, 0xB2, 0x4D, 0x32, 0x74, 0xD1, 0x8B, 0x2D, 0x40, 0x67, 0xF2, 0x61,
+            0xA9
+        },
+        {
+            0x02, 0xF9, 0x30, 0x8A, 0x01, 0x92, 0x58, 0xC3, 0x10, 0x49, 0x34, 0x4F, 0x85, 0xF8, 0x9D, 0x52,
+            0x29, 0xB5, 0x31, 0xC8, 0x45, 0x83, 0x6F, 0x99, 0xB0, 0x86, 0x01, 0xF1, 0x13, 0xBC, 0xE0, 0x36,
+            0xF9
+        },
+        {
+            0x02, 0xDF, 0xF1, 0xD7, 0x7F, 0x2A, 0x67, 0x1C, 0x5F, 0x36, 0x18, 0x37, 0x26, 0xDB, 0x23, 0x41,
+            0xBE, 0x58, 0xFE, 0xAE, 0x1D, 0xA2, 0xDE, 0xCE, 0xD8, 0x43, 0x24, 0x0F, 0x7B, 0x50, 0x2B, 0xA6,
+            0x61
+        }
+    };
+    static const unsigned char aggnonces[2][66] = {
+        {
+            0x02, 0x84, 0x65, 0xFC, 0xF0, 0xBB, 0xDB, 0xCF, 0x44, 0x3A, 0xAB, 0xCC, 0xE5, 0x33, 0xD4, 0x2B,
+            0x4B, 0x5A, 0x10, 0x96, 0x6A, 0xC0, 0x9A, 0x49, 0x65, 0x5E, 0x8C, 0x42, 0xDA, 0xAB, 0x8F, 0xCD,
+            0x61, 0x03, 0x74, 0x96, 0xA3, 0xCC, 0x86, 0x92, 0x6D, 0x45, 0x2C, 0xAF, 0xCF, 0xD5, 0x5D, 0x25,
+            0x97, 0x2C, 0xA1, 0x67, 0x5D, 0x54, 0x93, 0x10, 0xDE, 0x29, 0x6B, 0xFF, 0x42, 0xF7, 0x2E, 0xEE,
+            0xA8, 0xC9
+        },
+        {
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00
+        }
+    };
+    static const size_t key_indices[4][3] = {
+        { 0, 1, 2 },
+        { 1, 0, 2 },
+        { 1, 2, 0 },
+        { 0, 1 }
+    };
+    static const size_t nonce_indices[4][3] = {
+        { 0, 1, 2 },
+        { 1, 0, 2 },
+        { 1, 2, 0 },
+        { 0, 3 }
+    };
+    static const size_t n_signers[4] = { 3, 3, 3, 2 };
+    static const size_t signer_index[4] = { 0, 1, 2, 0 };
+    static const size_t aggnonce_index[4] = { 0, 0, 0, 1 };
+    static const unsigned char expected[4][32] = {
+        {
+            0x01, 0x2A, 0xBB, 0xCB, 0x52, 0xB3, 0x01, 0x6A, 0xC0, 0x3A, 0xD8, 0x23, 0x95, 0xA1, 0xA4, 0x15,
+            0xC4, 0x8B, 0x93, 0xDE, 0xF7, 0x87, 0x18, 0xE6, 0x2A, 0x7A, 0x90, 0x05, 0x2F, 0xE2, 0x24, 0xFB
+        },
+        {
+            0x9F, 0xF2, 0xF7, 0xAA, 0xA8, 0x56, 0x15, 0x0C, 0xC8, 0x81, 0x92, 0x54, 0x21, 0x8D, 0x3A, 0xDE,
+            0xEB, 0x05, 0x35, 0x26, 0x90, 0x51, 0x89, 0x77, 0x24, 0xF9, 0xDB, 0x37, 0x89, 0x51, 0x3A, 0x52
+        },
+        {
+            0xFA, 0x23, 0xC3, 0x59, 0xF6, 0xFA, 0xC4, 0xE7, 0x79, 0x6B, 0xB9, 0x3B, 0xC9, 0xF0, 0x53, 0x2A,
+            0x95, 0x46, 0x8C, 0x53, 0x9B, 0xA2, 0x0F, 0xF8, 0x6D, 0x7C, 0x76, 0xED, 0x92, 0x22, 0x79, 0x00
+        },
+        {
+            0xAE, 0x38, 0x60, 0x64, 0xB2, 0x61, 0x05, 0x40, 0x47, 0x98, 0xF7, 0x5D, 0xE2, 0xEB, 0x9A, 0xF5,
+            0xED, 0xA5, 0x38, 0x7B, 0x06, 0x4B, 0x83, 0xD0, 0x49, 0xCB, 0x7C, 0x5E, 0x08, 0x87, 0x95, 0x31
+        }
+    };
+    /* The negation of the first expected partial signature */
+    static const unsigned char negated[32] = {
+        0xFE, 0xD5, 0x44, 0x34, 0xAD, 0x4C, 0xFE, 0x95, 0x3F, 0xC5, 0x27, 0xDC, 0x6A, 0x5E, 0x5B, 0xE8,
+        0xF6, 0x23, 0x49, 0x07, 0xB7, 0xC1, 0x87, 0x55, 0x95, 0x57, 0xCE, 0x87, 0xA0, 0x54, 0x1C, 0x46
+    };
+    secp256k1_pubkey pubkeys[3];
+    const secp256k1_pubkey *pk_ptrs[3];
+    secp256k1_musig_pubnonce pubnonces[3];
+    const secp256k1_musig_pubnonce *pubnonce_ptrs[3];
+    secp256k1_musig_keyagg_cache cache;
+    secp256k1_musig_aggnonce aggnonce;
+    secp256k1_musig_session session;
+    secp256k1_musig_partial_sig partial_sig;
+    unsigned char aggnonce66[66];
+    size_t i, j;
+
+    for (i = 0; i < 4; i++) {
+        test_musig_vector_sign(pks, key_indices[i], nonce_indices[i], n_signers[i], signer_index[i], NULL, NULL, 0, expected[i]);
+
+        /* The public nonces aggregate to the aggregate nonce of the vector. */
+        for (j = 0; j < n_signers[i]; j++) {
+            CHECK(secp256k1_musig_pubnonce_parse(ctx, &pubnonces[j], test_musig_vector_pubnonces[nonce_indices[i][j]]) == 1);
+            pubnonce_ptrs[j] = &pubnonces[j];
+        }
+        CHECK(secp256k1_musig_nonce_agg(ctx, &aggnonce, pubnonce_ptrs, n_signers[i]) == 1);
+        CHECK(secp256k1_musig_aggnonce_serialize(ctx, aggnonce66, &aggnonce) == 1);
+        CHECK(secp256k1_memcmp_var(aggnonce66, aggnonces[aggnonce_index[i]], 66) == 0);
+    }
+
+    /* PartialSigVerify fails for the negated partial signature and for the
+     * public nonce or public key of another signer. */
+    for (i = 0; i < 3; i++) {
+        CHECK(secp256k1_ec_pubkey_parse(ctx, &pubkeys[i], pks[i], 33) == 1);
+        pk_ptrs[i] = &pubkeys[i];
+        CHECK(secp256k1_musig_pubnonce_parse(ctx, &pubnonces[i], test_musig_vector_pubnonces[i]) == 1);
+    }
+    CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, NULL, &cache, pk_ptrs, 3) == 1);
+    CHECK(secp256k1_musig_aggnonce_parse(ctx, &aggnonce, aggnonces[0]) == 1);
+    CHECK(secp256k1_musig_nonce_process(ctx, &session, &aggnonce, test_musig_vector_msg, &cache) == 1);
+    CHECK(secp256k1_musig_partial_sig_parse(ctx, &partial_sig, expected[0]) == 1);
+    CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sig, &pubnonces[0], &pubkeys[0], &cache, &session) == 1);
+    CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sig, &pubnonces[1], &pubkeys[0], &cache, &session) == 0);
+    CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sig, &pubnonces[0], &pubkeys[1], &cache, &session) == 0);
+    CHECK(secp256k1_musig_partial_sig_parse(ctx, &partial_sig, negated) == 1);
+    CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sig, &pubnonces[0], &pubkeys[0], &cache, &session) == 0);
+}
+
+/* Tweak test vectors from BIP327 */
+void test_musig_tweak_vectors(void) {
+    static const unsigned char pks[3][33] = {
+        {
+            0x03, 0x93, 0x5F, 0x97, 0x2D, 0xA0, 0x13, 0xF8, 0x0A, 0xE0, 0x11, 0x89, 0x0F, 0xA8, 0x9B, 0x67,
+            0xA2, 0x7B, 0x7B, 0xE6, 0xCC, 0xB2, 0x4D, 0x32, 0x74, 0xD1, 0x8B, 0x2D, 0x40, 0x67, 0xF2, 0x61,
+            0xA9
+        },
+        {
+            0x02, 0xF9, 0x30, 0x8A, 0x01, 0x92, 0x58, 0xC3, 0x10, 0x49, 0x34, 0x4F, 0x85, 0xF8, 0x9D, 0x52,
+            0x29, 0xB5, 0x31, 0xC8, 0x45, 0x83, 0x6F, 0x99, 0xB0, 0x86, 0x01, 0xF1, 0x13, 0xBC, 0xE0, 0x36,
+            0xF9
+        },
+        {
+            0x02, 0xDF, 0xF1, 0xD7, 0x7F, 0x2A, 0x67, 0x1C, 0x5F, 0x36, 0x18, 0x37, 0x26, 0xDB, 0x23, 0x41,
+            0xBE, 0x58, 0xFE, 0xAE, 0x1D, 0xA2, 0xDE, 0xCE, 0xD8, 0x43, 0x24, 0x0F, 0x7B, 0x50, 0x2B, 0xA6,
+            0x59
+        }
+    };
+    static const unsigned char tweaks[4][32] = {
+        {
+            0xE8, 0xF7, 0x91, 0xFF, 0x92, 0x25, 0xA2, 0xAF, 0x01, 0x02, 0xAF, 0xFF, 0x4A, 0x9A, 0x72, 0x3D,
+            0x96, 0x12, 0xA6, 0x82, 0xA2, 0x5E, 0xBE, 0x79, 0x80, 0x2B, 0x26, 0x3C, 0xDF, 0xCD, 0x83, 0xBB
+        },
+        {
+            0xAE, 0x2E, 0xA7, 0x97, 0xCC, 0x0F, 0xE7, 0x2A, 0xC5, 0xB9, 0x7B, 0x97, 0xF3, 0xC6, 0x95, 0x7D,
+            0x7E, 0x41, 0x99, 0xA1, 0x67, 0xA5, 0x8E, 0xB0, 0x8B, 0xCA, 0xFF, 0xDA, 0x70, 0xAC, 0x04, 0x55
+        },
+        {
+            0xF5, 0x2E, 0xCB, 0xC5, 0x65, 0xB3, 0xD8, 0xBE, 0xA2, 0xDF, 0xD5, 0xB7, 0x5A, 0x4F, 0x45, 0x7E,
+            0x54, 0x36, 0x98, 0x09, 0x32, 0x2E, 0x41, 0x20, 0x83, 0x16, 0x26, 0xF2, 0x90, 0xFA, 0x87, 0xE0
+        },
+        {
+            0x19, 0x69, 0xAD, 0x73, 0xCC, 0x17, 0x7F, 0xA0, 0xB4, 0xFC, 0xED, 0x6D, 0xF1, 0xF7, 0xBF, 0x99,
+            0x07, 0xE6, 0x65, 0xFD, 0xE9, 0xBA, 0x19, 0x6A, 0x74, 0xFE, 0xD0, 0xA3, 0xCF, 0x5A, 0xEF, 0x9D
+        }
+    };
+    static const size_t key_indices[3] = { 1, 2, 0 };
+    static const size_t nonce_indices[3] = { 1, 2, 0 };
+    static const size_t n_tweaks[5] = { 1, 1, 2, 4, 4 };
+    static const int is_xonly[5][4] = {
+        { 1 },
+        { 0 },
+        { 0, 1 },
+        { 0, 0, 1, 1 },
+        { 1, 0, 1, 0 }
+    };
+    static const unsigned char expected[5][32] = {
+        {
+            0xE2, 0x8A, 0x5C, 0x66, 0xE6, 0x1E, 0x17, 0x8C, 0x2B, 0xA1, 0x9D, 0xB7, 0x7B, 0x6C, 0xF9, 0xF7,
+            0xE2, 0xF0, 0xF5, 0x6C, 0x17, 0x91, 0x8C, 0xD1, 0x31, 0x35, 0xE6, 0x0C, 0xC8, 0x48, 0xFE, 0x91
+        },
+        {
+            0x38, 0xB0, 0x76, 0x77, 0x98, 0x25, 0x2F, 0x21, 0xBF, 0x57, 0x02, 0xC4, 0x80, 0x28, 0xB0, 0x95,
+            0x42, 0x83, 0x20, 0xF7, 0x3A, 0x4B, 0x14, 0xDB, 0x1E, 0x25, 0xDE, 0x58, 0x54, 0x3D, 0x2D, 0x2D
+        },
+        {
+            0x40, 0x8A, 0x0A, 0x21, 0xC4, 0xA0, 0xF5, 0xDA, 0xCA, 0xF9, 0x64, 0x6A, 0xD6, 0xEB, 0x6F, 0xEC,
+            0xD7, 0xF7, 0xA1, 0x1F, 0x03, 0xED, 0x1F, 0x48, 0xDF, 0xFF, 0x21, 0x85, 0xBC, 0x2C, 0x24, 0x08
+        },
+        {
+            0x45, 0xAB, 0xD2, 0x06, 0xE6, 0x1E, 0x3D, 0xF2, 0xEC, 0x9E, 0x26, 0x4A, 0x6F, 0xEC, 0x82, 0x92,
+            0x14, 0x1A, 0x63, 0x3C, 0x28, 0x58, 0x63, 0x88, 0x23, 0x55, 0x41, 0xF9, 0xAD, 0xE7, 0x54, 0x35
+        },
+        {
+            0xB2, 0x55, 0xFD, 0xCA, 0xC2, 0x7B, 0x40, 0xC7, 0xCE, 0x78, 0x48, 0xE2, 0xD3, 0xB7, 0xBF, 0x5E,
+            0xA0, 0xED, 0x75, 0x6D, 0xA8, 0x15, 0x65, 0xAC, 0x80, 0x4C, 0xCC, 0xA3, 0xE1, 0xD5, 0xD2, 0x39
+        }
+    };
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        test_musig_vector_sign(pks, key_indices, nonce_indices, 3, 2, tweaks, is_xonly[i], n_tweaks[i], expected[i]);
+    }
+}
+
+/* Checks key aggregation against a straightforward computation of the sum of
+ * the public keys weighted with their coefficients, with and without a scratch
+ * space. */
+void test_musig_pubkey_agg_sum(size_t n) {
+    secp256k1_pubkey *pubkeys = (secp256k1_pubkey *) checked_malloc(&ctx->error_callback, n * sizeof(*pubkeys));
+    const secp256k1_pubkey **pk_ptrs = (const secp256k1_pubkey **) checked_malloc(&ctx->error_callback, n * sizeof(*pk_ptrs));
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1024 * 1024);
+    secp256k1_musig_keyagg_cache cache;
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_xonly_pubkey agg_pk, agg_pk_scratch;
+    secp256k1_pubkey full_agg_pk;
+    secp256k1_sha256 sha;
+    unsigned char pk_hash[32];
+    secp256k1_gej sumj;
+    secp256k1_ge sum;
+    size_t i;
+
+    secp256k1_musig_keyagglist_sha256(&sha);
+    for (i = 0; i < n; i++) {
+        unsigned char ser[33];
+        size_t ser_len = sizeof(ser);
+        secp256k1_scalar sk;
+
+        /* Repeat some keys. */
+        if (i > 0 && secp256k1_testrand_bits(2) == 0) {
+            pubkeys[i] = pubkeys[secp256k1_testrand_int(i)];
+        } else {
+            random_scalar_order_test(&sk);
+            secp256k1_scalar_get_b32(ser, &sk);
+            CHECK(secp256k1_ec_pubkey_create(ctx, &pubkeys[i], ser) == 1);
+        }
+        pk_ptrs[i] = &pubkeys[i];
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &ser_len, &pubkeys[i], SECP256K1_EC_COMPRESSED) == 1);
+        secp256k1_sha256_write(&sha, ser, sizeof(ser));
+    }
+    secp256k1_sha256_finalize(&sha, pk_hash);
+
+    CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, &agg_pk, &cache, pk_ptrs, n) == 1);
+    CHECK(secp256k1_musig_pubkey_agg(ctx, scratch, &agg_pk_scratch, NULL, pk_ptrs, n) == 1);
+    CHECK(secp256k1_memcmp_var(&agg_pk, &agg_pk_scratch, sizeof(agg_pk)) == 0);
+    CHECK(secp256k1_keyagg_cache_load(ctx, &cache_i, &cache) == 1);
+    CHECK(secp256k1_memcmp_var(cache_i.pk_hash, pk_hash, 32) == 0);
+    CHECK(cache_i.parity_acc == 0);
+    CHECK(secp256k1_scalar_is_zero(&cache_i.tweak));
+
+    secp256k1_gej_set_infinity(&sumj);
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar mu;
+        secp256k1_gej pkj;
+        secp256k1_ge pk;
+        CHECK(secp256k1_pubkey_load(ctx, &pk, &pubkeys[i]));
+        secp256k1_gej_set_ge(&pkj, &pk);
+        secp256k1_musig_keyaggcoef(&mu, &cache_i, &pk);
+        /* The second distinct key has coefficient 1. */
+        if (secp256k1_memcmp_var(&pubkeys[i], &pubkeys[0], sizeof(pubkeys[0])) != 0) {
+            size_t j = 1;
+            while (secp256k1_memcmp_var(&pubkeys[j], &pubkeys[0], sizeof(pubkeys[0])) == 0) {
+                j++;
+            }
+            CHECK(secp256k1_scalar_is_one(&mu) == (secp256k1_memcmp_var(&pubkeys[i], &pubkeys[j], sizeof(pubkeys[0])) == 0));
+        }
+        secp256k1_ecmult(&ctx->ecmult_ctx, &pkj, &pkj, &mu, NULL);
+        secp256k1_gej_add_var(&sumj, &sumj, &pkj, NULL);
+    }
+    secp256k1_ge_set_gej(&sum, &sumj);
+    CHECK(secp256k1_musig_pubkey_get(ctx, &full_agg_pk, &cache) == 1);
+    CHECK(secp256k1_pubkey_load(ctx, &cache_i.pk, &full_agg_pk));
+    ge_equals_ge(&sum, &cache_i.pk);
+
+    secp256k1_scratch_space_destroy(ctx, scratch);
+    free(pk_ptrs);
+    free(pubkeys);
+}
+
+/* Runs a signing session of n signers, optionally with tweaks, and checks
+ * that the result is a valid Schnorr signature for the aggregate key. */
+void test_musig_session(size_t n, int tweak) {
+    secp256k1_keypair keypairs[5];
+    secp256k1_pubkey pubkeys[5];
+    const secp256k1_pubkey *pk_ptrs[5];
+    secp256k1_musig_secnonce secnonces[5];
+    secp256k1_musig_pubnonce pubnonces[5];
+    const secp256k1_musig_pubnonce *pubnonce_ptrs[5];
+    secp256k1_musig_partial_sig partial_sigs[5];
+    const secp256k1_musig_partial_sig *partial_sig_ptrs[5];
+    secp256k1_musig_keyagg_cache cache;
+    secp256k1_musig_aggnonce aggnonce;
+    secp256k1_musig_session session;
+    secp256k1_xonly_pubkey agg_pk;
+    secp256k1_pubkey tweaked_pk;
+    unsigned char msg[32];
+    unsigned char sig[64];
+    size_t i;
+
+    CHECK(n <= 5);
+    secp256k1_testrand256(msg);
+    for (i = 0; i < n; i++) {
+        unsigned char sk[32];
+        secp256k1_testrand256(sk);
+        CHECK(secp256k1_keypair_create(ctx, &keypairs[i], sk) == 1);
+        CHECK(secp256k1_keypair_pub(ctx, &pubkeys[i], &keypairs[i]) == 1);
+        pk_ptrs[i] = &pubkeys[i];
+    }
+    CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, &agg_pk, &cache, pk_ptrs, n) == 1);
+
+    if (tweak) {
+        unsigned char tweak32[32];
+        secp256k1_xonly_pubkey xonly_pk;
+        secp256k1_pubkey expected_pk;
+        unsigned char expected_ser[33], ser[33];
+        size_t len = sizeof(ser);
+
+        /* An ordinary tweak, as in BIP32 derivation */
+        secp256k1_testrand256(tweak32);
+        CHECK(secp256k1_musig_pubkey_get(ctx, &expected_pk, &cache) == 1);
+        CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &expected_pk, tweak32) == 1);
+        CHECK(secp256k1_musig_pubkey_ec_tweak_add(ctx, &tweaked_pk, &cache, tweak32) == 1);
+        CHECK(secp256k1_ec_pubkey_cmp(ctx, &tweaked_pk, &expected_pk) == 0);
+
+        /* An x-only tweak, as in Taproot */
+        secp256k1_testrand256(tweak32);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &xonly_pk, NULL, &tweaked_pk) == 1);
+        CHECK(secp256k1_xonly_pubkey_tweak_add(ctx, &expected_pk, &xonly_pk, tweak32) == 1);
+        CHECK(secp256k1_musig_pubkey_xonly_tweak_add(ctx, &tweaked_pk, &cache, tweak32) == 1);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, expected_ser, &len, &expected_pk, SECP256K1_EC_COMPRESSED) == 1);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &tweaked_pk, SECP256K1_EC_COMPRESSED) == 1);
+        CHECK(secp256k1_memcmp_var(ser, expected_ser, sizeof(ser)) == 0);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &agg_pk, NULL, &tweaked_pk) == 1);
+    }
+
+    for (i = 0; i < n; i++) {
+        unsigned char session_secrand[32];
+        unsigned char sk[32];
+        secp256k1_testrand256(session_secrand);
+        CHECK(secp256k1_keypair_sec(ctx, sk, &keypairs[i]) == 1);
+        /* Vary which optional inputs are given. */
+        CHECK(secp256k1_musig_nonce_gen(ctx, &secnonces[i], &pubnonces[i], session_secrand, i & 1 ? sk : NULL, &pubkeys[i], i & 2 ? msg : NULL, i & 1 ? NULL : &cache, i & 2 ? NULL : msg) == 1);
+        pubnonce_ptrs[i] = &pubnonces[i];
+    }
+    CHECK(secp256k1_musig_nonce_agg(ctx, &aggnonce, pubnonce_ptrs, n) == 1);
+    CHECK(secp256k1_musig_nonce_process(ctx, &session, &aggnonce, msg, &cache) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_musig_partial_sign(ctx, &partial_sigs[i], &secnonces[i], &keypairs[i], &cache, &session) == 1);
+        CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sigs[i], &pubnonces[i], &pubkeys[i], &cache, &session) == 1);
+        /* The partial signature does not verify for another signer. */
+        CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sigs[i], &pubnonces[(i + 1) % n], &pubkeys[(i + 1) % n], &cache, &session) == (n == 1));
+        partial_sig_ptrs[i] = &partial_sigs[i];
+    }
+    CHECK(secp256k1_musig_partial_sig_agg(ctx, sig, &session, partial_sig_ptrs, n) == 1);
+    CHECK(secp256k1_schnorrsig_verify(ctx, sig, msg, sizeof(msg), &agg_pk) == 1);
+
+    /* A partial signature that is off by one makes the final signature
+     * invalid, and is detected by secp256k1_musig_partial_sig_verify. */
+    {
+        secp256k1_scalar s;
+        CHECK(secp256k1_musig_partial_sig_load(ctx, &s, &partial_sigs[0]));
+        secp256k1_scalar_add(&s, &s, &secp256k1_scalar_one);
+        secp256k1_musig_partial_sig_save(&partial_sigs[0], &s);
+        CHECK(secp256k1_musig_partial_sig_verify(ctx, &partial_sigs[0], &pubnonces[0], &pubkeys[0], &cache, &session) == 0);
+        CHECK(secp256k1_musig_partial_sig_agg(ctx, sig, &session, partial_sig_ptrs, n) == 1);
+        CHECK(secp256k1_schnorrsig_verify(ctx, sig, msg, sizeof(msg), &agg_pk) == 0);
+    }
+}
+
+/* Checks that secp256k1_musig_nonce_gen_batch creates the same nonces as
+ * secp256k1_musig_nonce_gen. */
+void test_musig_nonce_gen_batch(size_t n) {
+    secp256k1_musig_secnonce *secnonces = (secp256k1_musig_secnonce *) checked_malloc(&ctx->error_callback, n * sizeof(*secnonces));
+    secp256k1_musig_pubnonce *pubnonces = (secp256k1_musig_pubnonce *) checked_malloc(&ctx->error_callback, n * sizeof(*pubnonces));
+    unsigned char (*secrands)[32] = (unsigned char (*)[32]) checked_malloc(&ctx->error_callback, n * 32);
+    unsigned char (*secrands_copy)[32] = (unsigned char (*)[32]) checked_malloc(&ctx->error_callback, n * 32);
+    unsigned char **secrand_ptrs = (unsigned char **) checked_malloc(&ctx->error_callback, n * sizeof(*secrand_ptrs));
+    static const unsigned char zeros[32] = { 0 };
+    secp256k1_musig_keyagg_cache cache;
+    const secp256k1_pubkey *pk_ptr;
+    secp256k1_pubkey pubkey;
+    unsigned char sk[32];
+    unsigned char extra[32];
+    int use_seckey = secp256k1_testrand_bits(1);
+    int use_cache = secp256k1_testrand_bits(1);
+    int use_extra = secp256k1_testrand_bits(1);
+    size_t i, zero_idx = n;
+
+    secp256k1_testrand256(sk);
+    secp256k1_testrand256(extra);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, sk) == 1);
+    pk_ptr = &pubkey;
+    CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, NULL, &cache, &pk_ptr, 1) == 1);
+    for (i = 0; i < n; i++) {
+        secp256k1_testrand256(secrands[i]);
+        secrand_ptrs[i] = secrands[i];
+    }
+    /* All-zero randomness is refused. */
+    if (n > 0 && secp256k1_testrand_bits(1)) {
+        zero_idx = secp256k1_testrand_int(n);
+        memset(secrands[zero_idx], 0, 32);
+    }
+    memcpy(secrands_copy, secrands, n * 32);
+
+    CHECK(secp256k1_musig_nonce_gen_batch(ctx, secnonces, pubnonces, secrand_ptrs, use_seckey ? sk : NULL, &pubkey, use_cache ? &cache : NULL, use_extra ? extra : NULL, n) == (zero_idx == n));
+    for (i = 0; i < n; i++) {
+        secp256k1_musig_secnonce secnonce;
+        secp256k1_musig_pubnonce pubnonce;
+
+        CHECK(secp256k1_memcmp_var(secrands[i], zeros, 32) == 0);
+        CHECK(secp256k1_musig_nonce_gen(ctx, &secnonce, &pubnonce, secrands_copy[i], use_seckey ? sk : NULL, &pubkey, NULL, use_cache ? &cache : NULL, use_extra ? extra : NULL) == (i != zero_idx));
+        CHECK(secp256k1_memcmp_var(&secnonces[i], &secnonce, sizeof(secnonce)) == 0);
+        CHECK(secp256k1_memcmp_var(&pubnonces[i], &pubnonce, sizeof(pubnonce)) == 0);
+    }
+
+    free(secrand_ptrs);
+    free(secrands_copy);
+    free(secrands);
+    free(pubnonces);
+    free(secnonces);
+}
+
+void test_musig_api(void) {
+    secp256k1_keypair keypair, keypair2;
+    secp256k1_pubkey pubkey, pubkey2;
+    const secp256k1_pubkey *pk_ptrs[2];
+    const secp256k1_pubkey *invalid_pk_ptrs[2];
+    secp256k1_pubkey invalid_pk;
+    secp256k1_musig_keyagg_cache cache, invalid_cache;
+    secp256k1_musig_secnonce secnonce, secnonce2;
+    secp256k1_musig_pubnonce pubnonce, pubnonce2;
+    const secp256k1_musig_pubnonce *pubnonce_ptrs[2];
+    secp256k1_musig_aggnonce aggnonce;
+    secp256k1_musig_session session;
+    secp256k1_musig_partial_sig partial_sig, partial_sig2;
+    const secp256k1_musig_partial_sig *partial_sig_ptrs[2];
+    secp256k1_xonly_pubkey agg_pk;
+    secp256k1_pubkey full_agg_pk;
+    unsigned char sk[32], sk2[32];
+    unsigned char msg[32];
+    unsigned char session_secrand[32];
+    unsigned char *session_secrand_ptr = session_secrand;
+    unsigned char tweak[32];
+    unsigned char ser[66];
+    unsigned char ser2[66];
+    unsigned char sig[64];
+    static const unsigned char zeros[sizeof(secp256k1_musig_keyagg_cache)] = { 0 };
+    static const unsigned char group_order[32] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE,
+        0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48, 0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x41
+    };
+
+    /** setup **/
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    int ecount;
+
+    secp256k1_context_set_error_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_error_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_error_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+
+    secp256k1_testrand256(sk);
+    secp256k1_testrand256(sk2);
+    secp256k1_testrand256(msg);
+    secp256k1_testrand256(tweak);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_create(ctx, &keypair2, sk2) == 1);
+    CHECK(secp256k1_keypair_pub(ctx, &pubkey, &keypair) == 1);
+    CHECK(secp256k1_keypair_pub(ctx, &pubkey2, &keypair2) == 1);
+    pk_ptrs[0] = &pubkey;
+    pk_ptrs[1] = &pubkey2;
+    memset(&invalid_pk, 0, sizeof(invalid_pk));
+    invalid_pk_ptrs[0] = &pubkey;
+    invalid_pk_ptrs[1] = &invalid_pk;
+    memset(&invalid_cache, 0, sizeof(invalid_cache));
+
+    /** Key aggregation **/
+    ecount = 0;
+    CHECK(secp256k1_musig_pubkey_agg(none, NULL, &agg_pk, &cache, pk_ptrs, 2) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_pubkey_agg(vrfy, NULL, &agg_pk, &cache, NULL, 2) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_pubkey_agg(vrfy, NULL, &agg_pk, &cache, pk_ptrs, 0) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_pubkey_agg(vrfy, NULL, &agg_pk, &cache, invalid_pk_ptrs, 2) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_memcmp_var(&agg_pk, zeros, sizeof(agg_pk)) == 0);
+    CHECK(secp256k1_musig_pubkey_agg(vrfy, NULL, NULL, NULL, pk_ptrs, 2) == 1);
+    CHECK(secp256k1_musig_pubkey_agg(vrfy, NULL, &agg_pk, &cache, pk_ptrs, 2) == 1);
+    CHECK(ecount == 4);
+
+    CHECK(secp256k1_musig_pubkey_get(none, NULL, &cache) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_musig_pubkey_get(none, &full_agg_pk, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_musig_pubkey_get(none, &full_agg_pk, &invalid_cache) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_memcmp_var(&full_agg_pk, zeros, sizeof(full_agg_pk)) == 0);
+    CHECK(secp256k1_musig_pubkey_get(none, &full_agg_pk, &cache) == 1);
+    CHECK(ecount == 7);
+
+    /** Tweaking **/
+    {
+        secp256k1_musig_keyagg_cache cache_tmp = cache;
+        ecount = 0;
+        CHECK(secp256k1_musig_pubkey_ec_tweak_add(none, NULL, &cache_tmp, tweak) == 0);
+        CHECK(ecount == 1);
+        CHECK(secp256k1_musig_pubkey_ec_tweak_add(vrfy, NULL, NULL, tweak) == 0);
+        CHECK(ecount == 2);
+        CHECK(secp256k1_musig_pubkey_xonly_tweak_add(vrfy, NULL, &cache_tmp, NULL) == 0);
+        CHECK(ecount == 3);
+        CHECK(secp256k1_musig_pubkey_xonly_tweak_add(vrfy, NULL, &invalid_cache, tweak) == 0);
+        CHECK(ecount == 4);
+        /* A tweak that overflows is refused and leaves the cache unchanged. */
+        CHECK(secp256k1_musig_pubkey_ec_tweak_add(vrfy, &full_agg_pk, &cache_tmp, group_order) == 0);
+        CHECK(secp256k1_memcmp_var(&cache_tmp, &cache, sizeof(cache)) == 0);
+        CHECK(ecount == 4);
+        CHECK(secp256k1_musig_pubkey_ec_tweak_add(vrfy, NULL, &cache_tmp, tweak) == 1);
+        CHECK(secp256k1_musig_pubkey_xonly_tweak_add(vrfy, &full_agg_pk, &cache_tmp, tweak) == 1);
+        CHECK(ecount == 4);
+    }
+
+    /** Nonce generation **/
+    ecount = 0;
+    secp256k1_testrand256(session_secrand);
+    CHECK(secp256k1_musig_nonce_gen(vrfy, &secnonce, &pubnonce, session_secrand, sk, &pubkey, msg, &cache, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_nonce_gen(sign, NULL, &pubnonce, session_secrand, sk, &pubkey, msg, &cache, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce, NULL, session_secrand, sk, &pubkey, msg, &cache, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce, &pubnonce, NULL, sk, &pubkey, msg, &cache, NULL) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce, &pubnonce, session_secrand, sk, NULL, msg, &cache, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce, &pubnonce, session_secrand, sk, &invalid_pk, msg, &cache, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce, &pubnonce, session_secrand, sk, &pubkey, msg, &invalid_cache, NULL) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_memcmp_var(&secnonce, zeros, sizeof(secnonce)) == 0);
+    CHECK(secp256k1_memcmp_var(&pubnonce, zeros, sizeof(pubnonce)) == 0);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce, &pubnonce, session_secrand, sk, &pubkey, msg, &cache, NULL) == 1);
+    CHECK(ecount == 7);
+    /* The randomness was cleared, so it cannot be used again. */
+    CHECK(secp256k1_memcmp_var(session_secrand, zeros, sizeof(session_secrand)) == 0);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce2, &pubnonce2, session_secrand, sk2, &pubkey2, msg, &cache, NULL) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_memcmp_var(&secnonce2, zeros, sizeof(secnonce2)) == 0);
+    CHECK(secp256k1_memcmp_var(&pubnonce2, zeros, sizeof(pubnonce2)) == 0);
+    secp256k1_testrand256(session_secrand);
+    CHECK(secp256k1_musig_nonce_gen(sign, &secnonce2, &pubnonce2, session_secrand, NULL, &pubkey2, NULL, NULL, NULL) == 1);
+
+    CHECK(secp256k1_musig_nonce_gen_batch(sign, NULL, NULL, NULL, NULL, &pubkey, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_musig_nonce_gen_batch(sign, NULL, &pubnonce2, &session_secrand_ptr, NULL, &pubkey, NULL, NULL, 1) == 0);
+    CHECK(ecount == 8);
+    CHECK(secp256k1_musig_nonce_gen_batch(sign, &secnonce2, NULL, &session_secrand_ptr, NULL, &pubkey, NULL, NULL, 1) == 0);
+    CHECK(ecount == 9);
+    CHECK(secp256k1_musig_nonce_gen_batch(sign, &secnonce2, &pubnonce2, NULL, NULL, &pubkey, NULL, NULL, 1) == 0);
+    CHECK(ecount == 10);
+    session_secrand_ptr = NULL;
+    CHECK(secp256k1_musig_nonce_gen_batch(sign, &secnonce2, &pubnonce2, &session_secrand_ptr, NULL, &pubkey, NULL, NULL, 1) == 0);
+    CHECK(ecount == 11);
+    session_secrand_ptr = session_secrand;
+    /* secnonce2 was cleared by the failed calls, so generate it again. */
+    secp256k1_testrand256(session_secrand);
+    CHECK(secp256k1_musig_nonce_gen_batch(sign, &secnonce2, &pubnonce2, &session_secrand_ptr, NULL, &pubkey2, NULL, NULL, 1) == 1);
+    CHECK(ecount == 11);
+
+    /** Serialization **/
+    ecount = 0;
+    CHECK(secp256k1_musig_pubnonce_serialize(none, NULL, &pubnonce) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_pubnonce_serialize(none, ser, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_pubnonce_serialize(none, ser, (secp256k1_musig_pubnonce *) &invalid_cache) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_pubnonce_serialize(none, ser, &pubnonce) == 1);
+    CHECK(secp256k1_musig_pubnonce_parse(none, NULL, ser) == 0);
+    CHECK(ecount == 4);
+    {
+        secp256k1_musig_pubnonce pubnonce_tmp;
+        CHECK(secp256k1_musig_pubnonce_parse(none, &pubnonce_tmp, NULL) == 0);
+        CHECK(ecount == 5);
+        CHECK(secp256k1_musig_pubnonce_parse(none, &pubnonce_tmp, zeros) == 0);
+        CHECK(secp256k1_musig_pubnonce_parse(none, &pubnonce_tmp, ser) == 1);
+        CHECK(secp256k1_memcmp_var(&pubnonce_tmp, &pubnonce, sizeof(pubnonce)) == 0);
+        CHECK(secp256k1_musig_pubnonce_serialize(none, ser2, &pubnonce_tmp) == 1);
+        CHECK(secp256k1_memcmp_var(ser, ser2, sizeof(ser)) == 0);
+        CHECK(ecount == 5);
+    }
+
+    pubnonce_ptrs[0] = &pubnonce;
+    pubnonce_ptrs[1] = &pubnonce2;
+
+    /** Nonce aggregation **/
+    ecount = 0;
+    CHECK(secp256k1_musig_nonce_agg(none, NULL, pubnonce_ptrs, 2) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_nonce_agg(none, &aggnonce, NULL, 2) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_nonce_agg(none, &aggnonce, pubnonce_ptrs, 0) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_nonce_agg(none, &aggnonce, pubnonce_ptrs, 2) == 1);
+    CHECK(ecount == 3);
+
+    /* An aggregate nonce may contain the point at infinity. */
+    CHECK(secp256k1_musig_aggnonce_parse(none, &aggnonce, zeros) == 1);
+    CHECK(secp256k1_musig_aggnonce_serialize(none, ser2, &aggnonce) == 1);
+    CHECK(secp256k1_memcmp_var(ser2, zeros, sizeof(ser2)) == 0);
+    CHECK(secp256k1_musig_nonce_agg(none, &aggnonce, pubnonce_ptrs, 2) == 1);
+    CHECK(secp256k1_musig_aggnonce_serialize(none, ser, &aggnonce) == 1);
+    CHECK(secp256k1_musig_aggnonce_parse(none, &aggnonce, ser) == 1);
+    CHECK(secp256k1_musig_aggnonce_serialize(none, ser2, &aggnonce) == 1);
+    CHECK(secp256k1_memcmp_var(ser, ser2, sizeof(ser)) == 0);
+    CHECK(secp256k1_musig_aggnonce_serialize(none, ser, (secp256k1_musig_aggnonce *) &pubnonce) == 0);
+    CHECK(ecount == 4);
+
+    /** Nonce processing **/
+    ecount = 0;
+    CHECK(secp256k1_musig_nonce_process(none, &session, &aggnonce, msg, &cache) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_nonce_process(vrfy, NULL, &aggnonce, msg, &cache) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_nonce_process(vrfy, &session, NULL, msg, &cache) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_nonce_process(vrfy, &session, &aggnonce, NULL, &cache) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_musig_nonce_process(vrfy, &session, &aggnonce, msg, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_musig_nonce_process(vrfy, &session, &aggnonce, msg, &invalid_cache) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_musig_nonce_process(vrfy, &session, &aggnonce, msg, &cache) == 1);
+    CHECK(ecount == 6);
+
+    /** Signing **/
+    ecount = 0;
+    {
+        secp256k1_musig_secnonce secnonce_tmp = secnonce;
+        CHECK(secp256k1_musig_partial_sign(none, NULL, &secnonce_tmp, &keypair, &cache, &session) == 0);
+        CHECK(ecount == 1);
+        /* The nonce was cleared, so using it again is an illegal argument. */
+        CHECK(secp256k1_memcmp_var(&secnonce_tmp, zeros, sizeof(secnonce_tmp)) == 0);
+        CHECK(secp256k1_musig_partial_sign(none, &partial_sig, &secnonce_tmp, &keypair, &cache, &session) == 0);
+        CHECK(ecount == 2);
+        CHECK(secp256k1_musig_partial_sign(none, &partial_sig, NULL, &keypair, &cache, &session) == 0);
+        CHECK(ecount == 3);
+        secnonce_tmp = secnonce;
+        CHECK(secp256k1_musig_partial_sign(none, &partial_sig, &secnonce_tmp, NULL, &cache, &session) == 0);
+        CHECK(ecount == 4);
+        secnonce_tmp = secnonce;
+        CHECK(secp256k1_musig_partial_sign(none, &partial_sig, &secnonce_tmp, &keypair, &invalid_cache, &session) == 0);
+        CHECK(ecount == 5);
+        secnonce_tmp = secnonce;
+        CHECK(secp256k1_musig_partial_sign(none, &partial_sig, &secnonce_tmp, &keypair, &cache, (secp256k1_musig_session *) &invalid_cache) == 0);
+        CHECK(ecount == 6);
+        /* The nonce belongs to another signer. */
+        secnonce_tmp = secnonce;
+        CHECK(secp256k1_musig_partial_sign(none, &partial_sig, &secnonce_tmp, &keypair2, &cache, &session) == 0);
+        CHECK(ecount == 6);
+    }
+    CHECK(secp256k1_musig_partial_sign(none, &partial_sig, &secnonce, &keypair, &cache, &session) == 1);
+    CHECK(secp256k1_musig_partial_sign(none, &partial_sig2, &secnonce2, &keypair2, &cache, &session) == 1);
+    CHECK(ecount == 6);
+
+    /** Partial signature serialization **/
+    ecount = 0;
+    CHECK(secp256k1_musig_partial_sig_serialize(none, NULL, &partial_sig) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_partial_sig_serialize(none, ser, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_partial_sig_parse(none, NULL, ser) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_partial_sig_parse(none, &partial_sig, NULL) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_musig_partial_sig_parse(none, &partial_sig, group_order) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_musig_partial_sig_serialize(none, ser, &partial_sig2) == 1);
+    CHECK(secp256k1_musig_partial_sig_parse(none, &partial_sig, ser) == 1);
+    CHECK(secp256k1_memcmp_var(&partial_sig, &partial_sig2, sizeof(partial_sig)) == 0);
+    CHECK(ecount == 4);
+
+    /** Partial signature verification **/
+    ecount = 0;
+    CHECK(secp256k1_musig_partial_sig_verify(none, &partial_sig2, &pubnonce2, &pubkey2, &cache, &session) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, NULL, &pubnonce2, &pubkey2, &cache, &session) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, &partial_sig2, NULL, &pubkey2, &cache, &session) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, &partial_sig2, &pubnonce2, &invalid_pk, &cache, &session) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, &partial_sig2, &pubnonce2, &pubkey2, NULL, &session) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, &partial_sig2, &pubnonce2, &pubkey2, &cache, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, &partial_sig2, &pubnonce2, &pubkey2, &cache, &session) == 1);
+    CHECK(secp256k1_musig_partial_sig_verify(vrfy, &partial_sig2, &pubnonce, &pubkey2, &cache, &session) == 0);
+    CHECK(ecount == 6);
+
+    /** Signature aggregation **/
+    partial_sig_ptrs[0] = &partial_sig;
+    partial_sig_ptrs[1] = &partial_sig2;
+    ecount = 0;
+    CHECK(secp256k1_musig_partial_sig_agg(none, NULL, &session, partial_sig_ptrs, 2) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_musig_partial_sig_agg(none, sig, NULL, partial_sig_ptrs, 2) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_musig_partial_sig_agg(none, sig, &session, NULL, 2) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_musig_partial_sig_agg(none, sig, &session, partial_sig_ptrs, 0) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_musig_partial_sig_agg(none, sig, &session, partial_sig_ptrs, 2) == 1);
+    CHECK(ecount == 4);
+
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(sign);
+    secp256k1_context_destroy(vrfy);
+}
+
+void run_musig_tests(void) {
+    int i;
+
+    test_musig_sha256_tagged();
+    test_musig_pubkey_agg_vectors();
+    test_musig_nonce_gen_vectors();
+    test_musig_nonce_agg_vectors();
+    test_musig_sign_verify_vectors();
+    test_musig_tweak_vectors();
+    test_musig_api();
+    for (i = 0; i < count; i++) {
+        test_musig_pubkey_agg_sum(1 + secp256k1_testrand_int(8));
+        test_musig_session(1 + secp256k1_testrand_int(5), secp256k1_testrand_bits(1));
+        test_musig_nonce_gen_batch(1 + secp256k1_testrand_int(40));
+    }
+    /* Large enough for Pippenger's algorithm. */
+    test_musig_pubkey_agg_sum(100);
+}
+
+#endif
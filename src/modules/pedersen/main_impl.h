@@ -0,0 +1,366 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_PEDERSEN_MAIN_H
+#define SECP256K1_MODULE_PEDERSEN_MAIN_H
+
+#include "../../../include/secp256k1_pedersen.h"
+#include "../../ecmult_const_impl.h"
+
+/* The second generator H. Its X coordinate is SHA256(0x04 || G.x || G.y). */
+static const secp256k1_ge secp256k1_pedersen_h = SECP256K1_GE_CONST(
+    0x50929b74UL, 0xc1a04954UL, 0xb78b4b60UL, 0x35e97a5eUL,
+    0x078a5a0fUL, 0x28ec96d5UL, 0x47bfee9aUL, 0xce803ac0UL,
+    0x31d3c686UL, 0x3973926eUL, 0x049e637cUL, 0xb1b5f40aUL,
+    0x36dac28aUL, 0xf1766968UL, 0xc30c2313UL, 0xf3a38904UL
+);
+
+/* As in secp256k1-zkp, the tag encodes whether Y is a quadratic residue (0x08)
+ * or not (0x09), rather than its parity. */
+#define SECP256K1_PEDERSEN_TAG_QUAD 0x08
+#define SECP256K1_PEDERSEN_TAG_NONQUAD 0x09
+
+/* The table for value*H is built like the one for a*G in ecmult_gen, but only
+ * covers the 64 bits of a value. */
+#define SECP256K1_PEDERSEN_H_TABLE_B 4
+#define SECP256K1_PEDERSEN_H_TABLE_G (1 << SECP256K1_PEDERSEN_H_TABLE_B)
+#define SECP256K1_PEDERSEN_H_TABLE_N (64 / SECP256K1_PEDERSEN_H_TABLE_B)
+
+struct secp256k1_pedersen_h_table_struct {
+    /* prec[j][i] = (H_TABLE_G)^j * i * H + U_j, with U_j = 2^j * U for
+     * j < H_TABLE_N - 1 and U_j = (1 - 2^j) * U for the last one, where U is a
+     * point with no known discrete logarithm. The U_j sum to zero, so
+     * sum(prec[j][n_j]) is value*H for the 4-bit windows n_j of the value, and
+     * none of the partial sums has a known discrete logarithm either. */
+    secp256k1_ge_storage prec[SECP256K1_PEDERSEN_H_TABLE_N][SECP256K1_PEDERSEN_H_TABLE_G];
+    secp256k1_allocator allocator;
+};
+
+static void secp256k1_pedersen_h_table_build(secp256k1_pedersen_h_table *table) {
+    secp256k1_ge prec[SECP256K1_PEDERSEN_H_TABLE_N * SECP256K1_PEDERSEN_H_TABLE_G];
+    secp256k1_gej precj[SECP256K1_PEDERSEN_H_TABLE_N * SECP256K1_PEDERSEN_H_TABLE_G];
+    secp256k1_gej hbase;
+    secp256k1_gej numsbase;
+    secp256k1_gej nums_gej;
+    int i, j;
+
+    /* The same point with no known discrete logarithm as in ecmult_gen, but
+     * with H instead of G added. */
+    {
+        static const unsigned char nums_b32[33] = "The scalar for this x is unknown";
+        secp256k1_fe nums_x;
+        secp256k1_ge nums_ge;
+        int r;
+        r = secp256k1_fe_set_b32(&nums_x, nums_b32);
+        (void)r;
+        VERIFY_CHECK(r);
+        r = secp256k1_ge_set_xo_var(&nums_ge, &nums_x, 0);
+        (void)r;
+        VERIFY_CHECK(r);
+        secp256k1_gej_set_ge(&nums_gej, &nums_ge);
+        secp256k1_gej_add_ge_var(&nums_gej, &nums_gej, &secp256k1_pedersen_h, NULL);
+    }
+
+    secp256k1_gej_set_ge(&hbase, &secp256k1_pedersen_h);
+    numsbase = nums_gej;
+    for (j = 0; j < SECP256K1_PEDERSEN_H_TABLE_N; j++) {
+        precj[j*SECP256K1_PEDERSEN_H_TABLE_G] = numsbase;
+        for (i = 1; i < SECP256K1_PEDERSEN_H_TABLE_G; i++) {
+            secp256k1_gej_add_var(&precj[j*SECP256K1_PEDERSEN_H_TABLE_G + i], &precj[j*SECP256K1_PEDERSEN_H_TABLE_G + i - 1], &hbase, NULL);
+        }
+        for (i = 0; i < SECP256K1_PEDERSEN_H_TABLE_B; i++) {
+            secp256k1_gej_double_var(&hbase, &hbase, NULL);
+        }
+        secp256k1_gej_double_var(&numsbase, &numsbase, NULL);
+        if (j == SECP256K1_PEDERSEN_H_TABLE_N - 2) {
+            secp256k1_gej_neg(&numsbase, &numsbase);
+            secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
+        }
+    }
+    secp256k1_ge_set_all_gej_var(prec, precj, SECP256K1_PEDERSEN_H_TABLE_N * SECP256K1_PEDERSEN_H_TABLE_G);
+    for (j = 0; j < SECP256K1_PEDERSEN_H_TABLE_N; j++) {
+        for (i = 0; i < SECP256K1_PEDERSEN_H_TABLE_G; i++) {
+            secp256k1_ge_to_storage(&table->prec[j][i], &prec[j*SECP256K1_PEDERSEN_H_TABLE_G + i]);
+        }
+    }
+}
+
+/* Add value*H to r in constant time, as secp256k1_ecmult_gen does for a*G. */
+static void secp256k1_pedersen_h_table_mul_add(secp256k1_gej *r, const secp256k1_pedersen_h_table *table, uint64_t value) {
+    secp256k1_ge add;
+    secp256k1_ge_storage adds;
+    int bits;
+    int j;
+    for (j = 0; j < SECP256K1_PEDERSEN_H_TABLE_N; j++) {
+        bits = (int)((value >> (j * SECP256K1_PEDERSEN_H_TABLE_B)) & (SECP256K1_PEDERSEN_H_TABLE_G - 1));
+        /* A constant-time table scan, see secp256k1_ecmult_gen. */
+        secp256k1_ge_storage_table_select(&adds, table->prec[j], SECP256K1_PEDERSEN_H_TABLE_G, bits);
+        secp256k1_ge_from_storage(&add, &adds);
+        secp256k1_gej_add_ge(r, r, &add);
+    }
+    bits = 0;
+    secp256k1_ge_clear(&add);
+}
+
+/* Add value*H to r in constant time without a table. (value + 1)*H is never
+ * infinity, so it can be added with secp256k1_gej_add_ge. */
+static void secp256k1_pedersen_h_mul_add(secp256k1_gej *r, uint64_t value) {
+    secp256k1_scalar v;
+    secp256k1_gej vhj;
+    secp256k1_ge vh;
+    secp256k1_ge neg_h;
+    unsigned char buf[32] = {0};
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        buf[31 - i] = value >> (8 * i);
+    }
+    secp256k1_scalar_set_b32(&v, buf, NULL);
+    secp256k1_scalar_add(&v, &v, &secp256k1_scalar_one);
+    /* value + 1 has at most 65 bits. */
+    secp256k1_ecmult_const(&vhj, &secp256k1_pedersen_h, &v, 66);
+    secp256k1_ge_set_gej(&vh, &vhj);
+    secp256k1_gej_add_ge(r, r, &vh);
+    secp256k1_ge_neg(&neg_h, &secp256k1_pedersen_h);
+    secp256k1_gej_add_ge(r, r, &neg_h);
+    memset(buf, 0, sizeof(buf));
+    secp256k1_scalar_clear(&v);
+    secp256k1_gej_clear(&vhj);
+    secp256k1_ge_clear(&vh);
+}
+
+static int secp256k1_pedersen_commitment_load(const secp256k1_context* ctx, secp256k1_ge* ge, const secp256k1_pedersen_commitment* commit) {
+    return secp256k1_pubkey_load(ctx, ge, (const secp256k1_pubkey *) commit);
+}
+
+static void secp256k1_pedersen_commitment_save(secp256k1_pedersen_commitment* commit, secp256k1_ge* ge) {
+    secp256k1_pubkey_save((secp256k1_pubkey *) commit, ge);
+}
+
+int secp256k1_pedersen_commitment_parse(const secp256k1_context* ctx, secp256k1_pedersen_commitment* commit, const unsigned char *input) {
+    secp256k1_fe x;
+    secp256k1_ge ge;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(commit != NULL);
+    memset(commit, 0, sizeof(*commit));
+    ARG_CHECK(input != NULL);
+
+    if ((input[0] & 0xFE) != SECP256K1_PEDERSEN_TAG_QUAD
+        || !secp256k1_fe_set_b32(&x, &input[1])
+        || !secp256k1_ge_set_xquad(&ge, &x)) {
+        return 0;
+    }
+    if (input[0] == SECP256K1_PEDERSEN_TAG_NONQUAD) {
+        secp256k1_ge_neg(&ge, &ge);
+    }
+    secp256k1_pedersen_commitment_save(commit, &ge);
+    return 1;
+}
+
+int secp256k1_pedersen_commitment_parse_batch(const secp256k1_context* ctx, secp256k1_pedersen_commitment* commits, int *results, const unsigned char *input, size_t n_commits) {
+    secp256k1_ge ge;
+    secp256k1_fe x[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe x3[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe y[SECP256K1_FE_SQRT_LANES];
+    int nonquad[SECP256K1_FE_SQRT_LANES];
+    int valid[SECP256K1_FE_SQRT_LANES];
+    int sqrt_ok[SECP256K1_FE_SQRT_LANES];
+    int ret = 1;
+    size_t i;
+    int k;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_commits == 0 || commits != NULL);
+    ARG_CHECK(n_commits == 0 || input != NULL);
+
+    for (i = 0; i < n_commits; i += SECP256K1_FE_SQRT_LANES) {
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            const unsigned char *in;
+            valid[k] = 0;
+            nonquad[k] = 0;
+            x[k] = secp256k1_fe_one;
+            if (i + k >= n_commits) {
+                continue;
+            }
+            in = input + (i + k) * 33;
+            memset(&commits[i + k], 0, sizeof(commits[i + k]));
+            if ((in[0] & 0xFE) == SECP256K1_PEDERSEN_TAG_QUAD && secp256k1_fe_set_b32(&x[k], &in[1])) {
+                valid[k] = 1;
+                nonquad[k] = in[0] == SECP256K1_PEDERSEN_TAG_NONQUAD;
+            } else {
+                x[k] = secp256k1_fe_one;
+            }
+        }
+        /* Batched secp256k1_ge_set_xquad: the roots of x^3 + 7 are squares. */
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            secp256k1_fe x2;
+            secp256k1_fe_sqr(&x2, &x[k]);
+            secp256k1_fe_mul(&x3[k], &x[k], &x2);
+            secp256k1_fe_add(&x3[k], &secp256k1_fe_const_b);
+        }
+        secp256k1_fe_sqrt_lanes(sqrt_ok, y, x3);
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES && i + k < n_commits; k++) {
+            valid[k] &= sqrt_ok[k];
+            if (valid[k]) {
+                secp256k1_ge_set_xy(&ge, &x[k], &y[k]);
+                if (nonquad[k]) {
+                    secp256k1_ge_neg(&ge, &ge);
+                }
+                secp256k1_pedersen_commitment_save(&commits[i + k], &ge);
+            }
+            if (results != NULL) {
+                results[i + k] = valid[k];
+            }
+            ret &= valid[k];
+        }
+    }
+    return ret;
+}
+
+int secp256k1_pedersen_commitment_serialize(const secp256k1_context* ctx, unsigned char *output, const secp256k1_pedersen_commitment* commit) {
+    secp256k1_ge ge;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(output != NULL);
+    memset(output, 0, 33);
+    ARG_CHECK(commit != NULL);
+
+    if (!secp256k1_pedersen_commitment_load(ctx, &ge, commit)) {
+        return 0;
+    }
+    secp256k1_fe_normalize_var(&ge.x);
+    secp256k1_fe_normalize_var(&ge.y);
+    output[0] = SECP256K1_PEDERSEN_TAG_NONQUAD ^ secp256k1_fe_is_square_var(&ge.y);
+    secp256k1_fe_get_b32(&output[1], &ge.x);
+    return 1;
+}
+
+secp256k1_pedersen_h_table* secp256k1_pedersen_h_table_create(const secp256k1_context* ctx) {
+    secp256k1_pedersen_h_table *ret;
+
+    VERIFY_CHECK(ctx != NULL);
+
+    ret = (secp256k1_pedersen_h_table *)checked_alloc(&ctx->allocator, &ctx->error_callback, sizeof(*ret));
+    if (ret != NULL) {
+        secp256k1_pedersen_h_table_build(ret);
+        ret->allocator = ctx->allocator;
+    }
+    return ret;
+}
+
+void secp256k1_pedersen_h_table_destroy(const secp256k1_context* ctx, secp256k1_pedersen_h_table *table) {
+    VERIFY_CHECK(ctx != NULL);
+    if (table != NULL) {
+        /* The allocator lives in the memory being released. */
+        secp256k1_allocator allocator = table->allocator;
+        secp256k1_dealloc(&allocator, table);
+    }
+}
+
+int secp256k1_pedersen_commit(const secp256k1_context* ctx, secp256k1_pedersen_commitment *commit, const secp256k1_pedersen_h_table *table, const unsigned char *blind, uint64_t value) {
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    secp256k1_scalar sec;
+    int overflow;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(commit != NULL);
+    memset(commit, 0, sizeof(*commit));
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(blind != NULL);
+
+    secp256k1_scalar_set_b32(&sec, blind, &overflow);
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rj, &sec);
+    if (table != NULL) {
+        secp256k1_pedersen_h_table_mul_add(&rj, table, value);
+    } else {
+        secp256k1_pedersen_h_mul_add(&rj, value);
+    }
+    secp256k1_ge_set_gej(&r, &rj);
+    ret = !overflow & !secp256k1_ge_is_infinity(&r);
+    secp256k1_declassify(ctx, &ret, sizeof(ret));
+    if (ret) {
+        secp256k1_pedersen_commitment_save(commit, &r);
+    }
+    secp256k1_scalar_clear(&sec);
+    secp256k1_gej_clear(&rj);
+    return ret;
+}
+
+int secp256k1_pedersen_blind_sum(const secp256k1_context* ctx, unsigned char *blind_out, const unsigned char * const *blinds, size_t n, size_t npositive) {
+    secp256k1_scalar acc;
+    secp256k1_scalar x;
+    size_t i;
+    int overflow;
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(blind_out != NULL);
+    ARG_CHECK(blinds != NULL);
+    ARG_CHECK(npositive <= n);
+
+    secp256k1_scalar_set_int(&acc, 0);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(blinds[i] != NULL);
+        secp256k1_scalar_set_b32(&x, blinds[i], &overflow);
+        ret &= !overflow;
+        if (i >= npositive) {
+            secp256k1_scalar_negate(&x, &x);
+        }
+        secp256k1_scalar_add(&acc, &acc, &x);
+    }
+    secp256k1_declassify(ctx, &ret, sizeof(ret));
+    secp256k1_scalar_get_b32(blind_out, &acc);
+    secp256k1_memczero(blind_out, 32, !ret);
+    secp256k1_scalar_clear(&acc);
+    secp256k1_scalar_clear(&x);
+    return ret;
+}
+
+/* Adds the commitments to *sum, or subtracts them if negate is set. As there
+ * are no weights, summing the points directly is much cheaper than a
+ * multi-scalar multiplication with scalars of one. */
+static int secp256k1_pedersen_tally_add(const secp256k1_context* ctx, secp256k1_gej *sum, const secp256k1_pedersen_commitment * const *commits, size_t n, int negate) {
+    secp256k1_ge ge;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (!secp256k1_pedersen_commitment_load(ctx, &ge, commits[i])) {
+            return 0;
+        }
+        if (negate) {
+            secp256k1_ge_neg(&ge, &ge);
+        }
+        secp256k1_gej_add_ge_var(sum, sum, &ge, NULL);
+    }
+    return 1;
+}
+
+int secp256k1_pedersen_verify_tally(const secp256k1_context* ctx, const secp256k1_pedersen_commitment * const *inputs, size_t n_inputs, const secp256k1_pedersen_commitment * const *outputs, size_t n_outputs, const secp256k1_pedersen_commitment *excess) {
+    secp256k1_gej sumj;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_inputs == 0 || inputs != NULL);
+    ARG_CHECK(n_outputs == 0 || outputs != NULL);
+    for (i = 0; i < n_inputs; i++) {
+        ARG_CHECK(inputs[i] != NULL);
+    }
+    for (i = 0; i < n_outputs; i++) {
+        ARG_CHECK(outputs[i] != NULL);
+    }
+
+    secp256k1_gej_set_infinity(&sumj);
+    if (!secp256k1_pedersen_tally_add(ctx, &sumj, inputs, n_inputs, 0)
+        || !secp256k1_pedersen_tally_add(ctx, &sumj, outputs, n_outputs, 1)
+        || (excess != NULL && !secp256k1_pedersen_tally_add(ctx, &sumj, &excess, 1, 1))) {
+        return 0;
+    }
+    return secp256k1_gej_is_infinity(&sumj);
+}
+
+#endif
@@ -0,0 +1,436 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_PEDERSEN_TESTS_H
+#define SECP256K1_MODULE_PEDERSEN_TESTS_H
+
+#include "../../../include/secp256k1_pedersen.h"
+
+#define TEST_PEDERSEN_MAX_COMMITS 100
+
+/* Checks that H is the point with X coordinate SHA256(0x04 || G.x || G.y) and
+ * an even Y coordinate. */
+void test_pedersen_h(void) {
+    unsigned char g65[65];
+    unsigned char hx[32];
+    unsigned char x[32];
+    size_t len = sizeof(g65);
+    secp256k1_ge g = secp256k1_ge_const_g;
+    secp256k1_ge h = secp256k1_pedersen_h;
+    secp256k1_sha256 sha;
+
+    CHECK(secp256k1_eckey_pubkey_serialize(&g, g65, &len, 0));
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, g65, sizeof(g65));
+    secp256k1_sha256_finalize(&sha, hx);
+    secp256k1_fe_get_b32(x, &h.x);
+    CHECK(secp256k1_memcmp_var(x, hx, 32) == 0);
+    CHECK(secp256k1_ge_is_valid_var(&h));
+    CHECK(!secp256k1_fe_is_odd(&h.y));
+}
+
+static uint64_t test_pedersen_random_value(void) {
+    /* Mostly small values, so that sums of many do not overflow. */
+    switch (secp256k1_testrand_int(4)) {
+    case 0:
+        return 0;
+    case 1:
+        return ((uint64_t)secp256k1_testrand32() << 32) | secp256k1_testrand32();
+    default:
+        return secp256k1_testrand_bits(32);
+    }
+}
+
+/* Compute blind*G + value*H with secp256k1_ecmult. Returns 0 if the blinding
+ * factor overflows. */
+static int test_pedersen_commit_ref(secp256k1_gej *r, const unsigned char *blind, uint64_t value) {
+    secp256k1_scalar b, v, hi;
+    secp256k1_gej hj;
+    int overflow;
+
+    secp256k1_scalar_set_b32(&b, blind, &overflow);
+    secp256k1_scalar_set_int(&v, (unsigned int)(value >> 32));
+    secp256k1_scalar_set_int(&hi, 1u << 16);
+    secp256k1_scalar_mul(&v, &v, &hi);
+    secp256k1_scalar_mul(&v, &v, &hi);
+    secp256k1_scalar_set_int(&hi, (unsigned int)(value & 0xFFFFFFFF));
+    secp256k1_scalar_add(&v, &v, &hi);
+    secp256k1_gej_set_ge(&hj, &secp256k1_pedersen_h);
+    secp256k1_ecmult(&ctx->ecmult_ctx, r, &hj, &v, &b);
+    return !overflow;
+}
+
+static void test_pedersen_commit_check(const secp256k1_pedersen_h_table *table, const unsigned char *blind, uint64_t value) {
+    secp256k1_pedersen_commitment commit, commit2;
+    secp256k1_gej expected;
+    secp256k1_ge ge;
+    unsigned char ser[33];
+    int valid;
+
+    valid = test_pedersen_commit_ref(&expected, blind, value) && !secp256k1_gej_is_infinity(&expected);
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, table, blind, value) == valid);
+    CHECK(secp256k1_pedersen_commit(ctx, &commit2, NULL, blind, value) == valid);
+    if (!valid) {
+        return;
+    }
+    CHECK(secp256k1_pedersen_commitment_load(ctx, &ge, &commit));
+    ge_equals_gej(&ge, &expected);
+    CHECK(secp256k1_memcmp_var(&commit, &commit2, sizeof(commit)) == 0);
+
+    /* Round trip */
+    CHECK(secp256k1_pedersen_commitment_serialize(ctx, ser, &commit) == 1);
+    CHECK(ser[0] == (secp256k1_fe_is_square_var(&ge.y) ? 0x08 : 0x09));
+    CHECK(secp256k1_pedersen_commitment_parse(ctx, &commit2, ser) == 1);
+    CHECK(secp256k1_memcmp_var(&commit, &commit2, sizeof(commit)) == 0);
+}
+
+void test_pedersen_commit(const secp256k1_pedersen_h_table *table) {
+    unsigned char blind[32];
+    unsigned char zeros32[32] = { 0 };
+    secp256k1_pedersen_commitment commit;
+    int i;
+
+    secp256k1_testrand256(blind);
+    test_pedersen_commit_check(table, blind, 0);
+    test_pedersen_commit_check(table, blind, 1);
+    test_pedersen_commit_check(table, blind, ~(uint64_t)0);
+    test_pedersen_commit_check(table, zeros32, 1);
+    test_pedersen_commit_check(table, zeros32, ~(uint64_t)0);
+    for (i = 0; i < 64; i++) {
+        test_pedersen_commit_check(table, blind, (uint64_t)1 << i);
+    }
+    for (i = 0; i < count; i++) {
+        secp256k1_testrand256_test(blind);
+        test_pedersen_commit_check(table, blind, test_pedersen_random_value());
+    }
+
+    /* A commitment to zero with a zero blinding factor is infinity. */
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, table, zeros32, 0) == 0);
+    CHECK(secp256k1_memcmp_var(&commit, zeros32, 32) == 0);
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, NULL, zeros32, 0) == 0);
+    /* Overflowing blinding factor */
+    memset(blind, 0xFF, sizeof(blind));
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, table, blind, 1) == 0);
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, NULL, blind, 1) == 0);
+}
+
+/* Fixed vectors as in secp256k1-zkp's pedersen tests: the tag is 0x08 for a Y
+ * coordinate that is a quadratic residue and 0x09 otherwise, regardless of
+ * parity. 2G has an even square Y, so -2G is tagged 0x09; H has an even
+ * non-square Y, so it is tagged 0x09 as well. */
+void test_pedersen_fixed_vectors(void) {
+    static const unsigned char two_g[33] = {
+        0x08,
+        0xc6, 0x04, 0x7f, 0x94, 0x41, 0xed, 0x7d, 0x6d, 0x30, 0x45, 0x40, 0x6e, 0x95, 0xc0, 0x7c, 0xd8,
+        0x5c, 0x77, 0x8e, 0x4b, 0x8c, 0xef, 0x3c, 0xa7, 0xab, 0xac, 0x09, 0xb9, 0x5c, 0x70, 0x9e, 0xe5
+    };
+    static const unsigned char h[33] = {
+        0x09,
+        0x50, 0x92, 0x9b, 0x74, 0xc1, 0xa0, 0x49, 0x54, 0xb7, 0x8b, 0x4b, 0x60, 0x35, 0xe9, 0x7a, 0x5e,
+        0x07, 0x8a, 0x5a, 0x0f, 0x28, 0xec, 0x96, 0xd5, 0x47, 0xbf, 0xee, 0x9a, 0xce, 0x80, 0x3a, 0xc0
+    };
+    static const unsigned char two[32] = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02
+    };
+    static const unsigned char minus_two[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+        0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x3f
+    };
+    unsigned char zeros32[32] = { 0 };
+    unsigned char ser[33];
+    secp256k1_pedersen_commitment commit, parsed;
+
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, NULL, two, 0) == 1);
+    CHECK(secp256k1_pedersen_commitment_serialize(ctx, ser, &commit) == 1);
+    CHECK(secp256k1_memcmp_var(ser, two_g, 33) == 0);
+    CHECK(secp256k1_pedersen_commitment_parse(ctx, &parsed, two_g) == 1);
+    CHECK(secp256k1_memcmp_var(&parsed, &commit, sizeof(commit)) == 0);
+
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, NULL, minus_two, 0) == 1);
+    CHECK(secp256k1_pedersen_commitment_serialize(ctx, ser, &commit) == 1);
+    CHECK(ser[0] == 0x09);
+    CHECK(secp256k1_memcmp_var(&ser[1], &two_g[1], 32) == 0);
+    CHECK(secp256k1_pedersen_commitment_parse(ctx, &parsed, ser) == 1);
+    CHECK(secp256k1_memcmp_var(&parsed, &commit, sizeof(commit)) == 0);
+    CHECK(secp256k1_pedersen_commitment_parse_batch(ctx, &parsed, NULL, ser, 1) == 1);
+    CHECK(secp256k1_memcmp_var(&parsed, &commit, sizeof(commit)) == 0);
+
+    CHECK(secp256k1_pedersen_commit(ctx, &commit, NULL, zeros32, 1) == 1);
+    CHECK(secp256k1_pedersen_commitment_serialize(ctx, ser, &commit) == 1);
+    CHECK(secp256k1_memcmp_var(ser, h, 33) == 0);
+    CHECK(secp256k1_pedersen_commitment_parse(ctx, &parsed, h) == 1);
+    CHECK(secp256k1_memcmp_var(&parsed, &commit, sizeof(commit)) == 0);
+}
+
+void test_pedersen_parse(void) {
+    secp256k1_pedersen_commitment commits[TEST_PEDERSEN_MAX_COMMITS];
+    secp256k1_pedersen_commitment commit;
+    unsigned char ser[TEST_PEDERSEN_MAX_COMMITS][33];
+    int results[TEST_PEDERSEN_MAX_COMMITS];
+    int valid[TEST_PEDERSEN_MAX_COMMITS];
+    size_t n = 1 + secp256k1_testrand_int(TEST_PEDERSEN_MAX_COMMITS);
+    size_t i;
+    int all_valid = 1;
+
+    for (i = 0; i < n; i++) {
+        unsigned char blind[32];
+        secp256k1_testrand256(blind);
+        CHECK(secp256k1_pedersen_commit(ctx, &commit, NULL, blind, test_pedersen_random_value()) == 1);
+        CHECK(secp256k1_pedersen_commitment_serialize(ctx, ser[i], &commit) == 1);
+        valid[i] = 1;
+        switch (secp256k1_testrand_int(8)) {
+        case 0:
+            /* Wrong tag */
+            ser[i][0] = secp256k1_testrand_bits(1) ? 0x02 : 0x0a;
+            valid[i] = 0;
+            break;
+        case 1:
+            /* X coordinate overflows */
+            memset(&ser[i][1], 0xFF, 32);
+            valid[i] = 0;
+            break;
+        case 2: {
+            /* Possibly not on the curve */
+            secp256k1_fe x;
+            secp256k1_ge ge;
+            secp256k1_testrand256(&ser[i][1]);
+            valid[i] = secp256k1_fe_set_b32(&x, &ser[i][1]) && secp256k1_ge_set_xo_var(&ge, &x, 0);
+            break;
+        }
+        default:
+            break;
+        }
+        all_valid &= valid[i];
+        CHECK(secp256k1_pedersen_commitment_parse(ctx, &commit, ser[i]) == valid[i]);
+    }
+    CHECK(secp256k1_pedersen_commitment_parse_batch(ctx, commits, results, ser[0], n) == all_valid);
+    for (i = 0; i < n; i++) {
+        CHECK(results[i] == valid[i]);
+        if (valid[i]) {
+            unsigned char ser2[33];
+            CHECK(secp256k1_pedersen_commitment_parse(ctx, &commit, ser[i]) == 1);
+            CHECK(secp256k1_memcmp_var(&commit, &commits[i], sizeof(commit)) == 0);
+            CHECK(secp256k1_pedersen_commitment_serialize(ctx, ser2, &commits[i]) == 1);
+            CHECK(secp256k1_memcmp_var(ser2, ser[i], 33) == 0);
+        }
+    }
+    CHECK(secp256k1_pedersen_commitment_parse_batch(ctx, commits, NULL, ser[0], n) == all_valid);
+    CHECK(secp256k1_pedersen_commitment_parse_batch(ctx, NULL, NULL, NULL, 0) == 1);
+}
+
+/* Commits to n_inputs inputs and n_outputs outputs of the same total value
+ * minus a fee, and checks that they tally with the excess of the fee and only
+ * with it. */
+void test_pedersen_tally(const secp256k1_pedersen_h_table *table, size_t n_inputs, size_t n_outputs) {
+    secp256k1_pedersen_commitment commits[2 * TEST_PEDERSEN_MAX_COMMITS];
+    const secp256k1_pedersen_commitment *ptrs[2 * TEST_PEDERSEN_MAX_COMMITS];
+    unsigned char blinds[2 * TEST_PEDERSEN_MAX_COMMITS][32];
+    const unsigned char *blind_ptrs[2 * TEST_PEDERSEN_MAX_COMMITS];
+    uint64_t values[2 * TEST_PEDERSEN_MAX_COMMITS];
+    uint64_t total = 0;
+    uint64_t fee;
+    unsigned char excess_blind[32];
+    secp256k1_pedersen_commitment excess, excess_wrong;
+    size_t n = n_inputs + n_outputs;
+    size_t i;
+    int excess_valid;
+
+    CHECK(n_inputs <= TEST_PEDERSEN_MAX_COMMITS && n_outputs <= TEST_PEDERSEN_MAX_COMMITS);
+    for (i = 0; i < n_inputs; i++) {
+        values[i] = secp256k1_testrand_bits(32);
+        total += values[i];
+    }
+    for (i = n_inputs; i < n; i++) {
+        values[i] = secp256k1_testrand_bits(31);
+        if (values[i] > total) {
+            values[i] = total;
+        }
+        total -= values[i];
+    }
+    fee = total;
+    for (i = 0; i < n; i++) {
+        secp256k1_testrand256(blinds[i]);
+        blind_ptrs[i] = blinds[i];
+        CHECK(secp256k1_pedersen_commit(ctx, &commits[i], table, blinds[i], values[i]) == 1);
+        ptrs[i] = &commits[i];
+    }
+    CHECK(secp256k1_pedersen_blind_sum(ctx, excess_blind, blind_ptrs, n, n_inputs) == 1);
+    excess_valid = secp256k1_pedersen_commit(ctx, &excess, table, excess_blind, fee);
+
+    if (excess_valid) {
+        CHECK(secp256k1_pedersen_verify_tally(ctx, ptrs, n_inputs, &ptrs[n_inputs], n_outputs, &excess) == 1);
+        /* Inputs and outputs swapped */
+        CHECK(secp256k1_pedersen_verify_tally(ctx, &ptrs[n_inputs], n_outputs, ptrs, n_inputs, &excess) == 0);
+        CHECK(secp256k1_pedersen_verify_tally(ctx, ptrs, n_inputs, &ptrs[n_inputs], n_outputs, NULL) == 0);
+        /* Wrong fee */
+        CHECK(secp256k1_pedersen_commit(ctx, &excess_wrong, table, excess_blind, fee + 1) == 1);
+        CHECK(secp256k1_pedersen_verify_tally(ctx, ptrs, n_inputs, &ptrs[n_inputs], n_outputs, &excess_wrong) == 0);
+        /* A commitment missing */
+        if (n_outputs > 0) {
+            CHECK(secp256k1_pedersen_verify_tally(ctx, ptrs, n_inputs, &ptrs[n_inputs], n_outputs - 1, &excess) == 0);
+        }
+    } else {
+        /* The excess is infinity, so the commitments balance without it. */
+        CHECK(secp256k1_pedersen_verify_tally(ctx, ptrs, n_inputs, &ptrs[n_inputs], n_outputs, NULL) == 1);
+    }
+}
+
+void test_pedersen_blind_sum(void) {
+    unsigned char blinds[3][32];
+    const unsigned char *ptrs[3];
+    unsigned char sum[32];
+    unsigned char zeros32[32] = { 0 };
+    secp256k1_scalar s[3], r, t;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        random_scalar_order_test(&s[i]);
+        secp256k1_scalar_get_b32(blinds[i], &s[i]);
+        ptrs[i] = blinds[i];
+    }
+    CHECK(secp256k1_pedersen_blind_sum(ctx, sum, ptrs, 3, 1) == 1);
+    secp256k1_scalar_set_b32(&r, sum, NULL);
+    secp256k1_scalar_add(&t, &s[1], &s[2]);
+    secp256k1_scalar_negate(&t, &t);
+    secp256k1_scalar_add(&t, &t, &s[0]);
+    CHECK(secp256k1_scalar_eq(&r, &t));
+    CHECK(secp256k1_pedersen_blind_sum(ctx, sum, ptrs, 3, 3) == 1);
+    secp256k1_scalar_set_b32(&r, sum, NULL);
+    secp256k1_scalar_add(&t, &s[0], &s[1]);
+    secp256k1_scalar_add(&t, &t, &s[2]);
+    CHECK(secp256k1_scalar_eq(&r, &t));
+    CHECK(secp256k1_pedersen_blind_sum(ctx, sum, ptrs, 0, 0) == 1);
+    CHECK(secp256k1_memcmp_var(sum, zeros32, 32) == 0);
+    /* x - x = 0 */
+    ptrs[1] = blinds[0];
+    CHECK(secp256k1_pedersen_blind_sum(ctx, sum, ptrs, 2, 1) == 1);
+    CHECK(secp256k1_memcmp_var(sum, zeros32, 32) == 0);
+    /* Overflow */
+    memset(blinds[2], 0xFF, 32);
+    CHECK(secp256k1_pedersen_blind_sum(ctx, sum, ptrs, 3, 1) == 0);
+    CHECK(secp256k1_memcmp_var(sum, zeros32, 32) == 0);
+}
+
+void test_pedersen_api(void) {
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    secp256k1_pedersen_h_table *table;
+    secp256k1_pedersen_commitment commit, invalid_commit;
+    const secp256k1_pedersen_commitment *ptrs[2];
+    unsigned char blind[32];
+    const unsigned char *blind_ptrs[2];
+    unsigned char ser[33];
+    unsigned char zeros33[33] = { 0 };
+    int32_t ecount = 0;
+
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    secp256k1_testrand256(blind);
+    memset(&invalid_commit, 0, sizeof(invalid_commit));
+
+    table = secp256k1_pedersen_h_table_create(none);
+    CHECK(table != NULL);
+
+    /* commit */
+    CHECK(secp256k1_pedersen_commit(sign, &commit, table, blind, 5) == 1);
+    CHECK(secp256k1_pedersen_commit(sign, &commit, NULL, blind, 5) == 1);
+    CHECK(secp256k1_pedersen_commit(none, &commit, table, blind, 5) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_pedersen_commit(vrfy, &commit, table, blind, 5) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_pedersen_commit(sign, NULL, table, blind, 5) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_pedersen_commit(sign, &commit, table, NULL, 5) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_pedersen_commit(sign, &commit, table, blind, 5) == 1);
+
+    /* parse and serialize */
+    CHECK(secp256k1_pedersen_commitment_serialize(none, ser, &commit) == 1);
+    CHECK(secp256k1_pedersen_commitment_serialize(none, NULL, &commit) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_pedersen_commitment_serialize(none, ser, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_memcmp_var(ser, zeros33, 33) == 0);
+    CHECK(secp256k1_pedersen_commitment_serialize(none, ser, &invalid_commit) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_pedersen_commitment_serialize(none, ser, &commit) == 1);
+    CHECK(secp256k1_pedersen_commitment_parse(none, &commit, ser) == 1);
+    CHECK(secp256k1_pedersen_commitment_parse(none, NULL, ser) == 0);
+    CHECK(ecount == 8);
+    CHECK(secp256k1_pedersen_commitment_parse(none, &commit, NULL) == 0);
+    CHECK(ecount == 9);
+    CHECK(secp256k1_pedersen_commitment_parse(none, &commit, zeros33) == 0);
+    CHECK(ecount == 9);
+    CHECK(secp256k1_pedersen_commitment_parse_batch(none, &commit, NULL, ser, 1) == 1);
+    CHECK(secp256k1_pedersen_commitment_parse_batch(none, NULL, NULL, ser, 1) == 0);
+    CHECK(ecount == 10);
+    CHECK(secp256k1_pedersen_commitment_parse_batch(none, &commit, NULL, NULL, 1) == 0);
+    CHECK(ecount == 11);
+
+    /* blind_sum */
+    blind_ptrs[0] = blind;
+    blind_ptrs[1] = NULL;
+    CHECK(secp256k1_pedersen_blind_sum(none, blind, blind_ptrs, 1, 1) == 1);
+    CHECK(secp256k1_pedersen_blind_sum(none, NULL, blind_ptrs, 1, 1) == 0);
+    CHECK(ecount == 12);
+    CHECK(secp256k1_pedersen_blind_sum(none, blind, NULL, 1, 1) == 0);
+    CHECK(ecount == 13);
+    CHECK(secp256k1_pedersen_blind_sum(none, blind, blind_ptrs, 1, 2) == 0);
+    CHECK(ecount == 14);
+    CHECK(secp256k1_pedersen_blind_sum(none, blind, blind_ptrs, 2, 1) == 0);
+    CHECK(ecount == 15);
+
+    /* verify_tally */
+    ptrs[0] = &commit;
+    ptrs[1] = NULL;
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, ptrs, 1, ptrs, 1, NULL) == 1);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, ptrs, 1, NULL, 0, &commit) == 1);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, NULL, 0, NULL, 0, NULL) == 1);
+    CHECK(secp256k1_pedersen_verify_tally(none, ptrs, 1, ptrs, 1, NULL) == 1);
+    CHECK(secp256k1_pedersen_verify_tally(sign, ptrs, 1, ptrs, 1, NULL) == 1);
+    CHECK(ecount == 15);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, NULL, 1, ptrs, 1, NULL) == 0);
+    CHECK(ecount == 16);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, ptrs, 1, NULL, 1, NULL) == 0);
+    CHECK(ecount == 17);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, ptrs, 2, ptrs, 1, NULL) == 0);
+    CHECK(ecount == 18);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, ptrs, 1, ptrs, 2, NULL) == 0);
+    CHECK(ecount == 19);
+    CHECK(secp256k1_pedersen_verify_tally(vrfy, ptrs, 1, ptrs, 1, &invalid_commit) == 0);
+    CHECK(ecount == 20);
+
+    secp256k1_pedersen_h_table_destroy(none, table);
+    secp256k1_pedersen_h_table_destroy(none, NULL);
+    CHECK(ecount == 20);
+
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(sign);
+    secp256k1_context_destroy(vrfy);
+}
+
+void run_pedersen_tests(void) {
+    secp256k1_pedersen_h_table *table = secp256k1_pedersen_h_table_create(ctx);
+    int i;
+
+    test_pedersen_h();
+    test_pedersen_api();
+    test_pedersen_commit(table);
+    test_pedersen_fixed_vectors();
+    test_pedersen_blind_sum();
+    for (i = 0; i < count; i++) {
+        test_pedersen_parse();
+        test_pedersen_tally(table, secp256k1_testrand_int(5), secp256k1_testrand_int(5));
+        test_pedersen_tally(NULL, 1 + secp256k1_testrand_int(3), 1 + secp256k1_testrand_int(3));
+    }
+    test_pedersen_tally(table, TEST_PEDERSEN_MAX_COMMITS, TEST_PEDERSEN_MAX_COMMITS);
+
+    secp256k1_pedersen_h_table_destroy(ctx, table);
+}
+
+#endif
@@ -189,6 +189,17 @@ int secp256k1_schnorrsig_sign(const secp256k1_context* ctx, unsigned char *sig64
     return secp256k1_schnorrsig_sign_internal(ctx, sig64, msg32, 32, keypair, secp256k1_nonce_function_bip340, aux_rand32);
 }
 
+int secp256k1_schnorrsig_sign_with_session(const secp256k1_signing_session* session, unsigned char *sig64, const unsigned char *msg32, const secp256k1_keypair *keypair, unsigned char *aux_rand32) {
+    secp256k1_context view;
+    int ret;
+    VERIFY_CHECK(session != NULL);
+
+    secp256k1_signing_session_context_load(&view, session);
+    ret = secp256k1_schnorrsig_sign(&view, sig64, msg32, keypair, aux_rand32);
+    secp256k1_signing_session_context_clear(&view);
+    return ret;
+}
+
 int secp256k1_schnorrsig_sign_custom(const secp256k1_context* ctx, unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_keypair *keypair, secp256k1_schnorrsig_extraparams *extraparams) {
     secp256k1_nonce_function_hardened noncefp = NULL;
     void *ndata = NULL;
@@ -204,6 +215,119 @@ int secp256k1_schnorrsig_sign_custom(const secp256k1_context* ctx, unsigned char
     return secp256k1_schnorrsig_sign_internal(ctx, sig64, msg, msglen, keypair, noncefp, ndata);
 }
 
+/* The number of signatures secp256k1_schnorrsig_sign_batch converts to affine
+ * coordinates at once. */
+#define SECP256K1_SCHNORRSIG_SIGN_BATCH 32
+
+int secp256k1_schnorrsig_sign_batch(const secp256k1_context* ctx, unsigned char * const *sig64s, const unsigned char * const *msg32s, const secp256k1_keypair *keypair, unsigned char * const *aux_rand32s, size_t n_sigs) {
+    secp256k1_scalar sk;
+    secp256k1_scalar k[SECP256K1_SCHNORRSIG_SIGN_BATCH];
+    secp256k1_gej rj[SECP256K1_SCHNORRSIG_SIGN_BATCH];
+    secp256k1_ge r[SECP256K1_SCHNORRSIG_SIGN_BATCH];
+    int valid[SECP256K1_SCHNORRSIG_SIGN_BATCH];
+    secp256k1_ge pk;
+    secp256k1_sha256 sha_keyed;
+    unsigned char pk_buf[32];
+    unsigned char seckey[32];
+    int key_valid;
+    int ret = 1;
+    size_t i, j, num;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(keypair != NULL);
+    if (n_sigs > 0) {
+        ARG_CHECK(sig64s != NULL);
+        ARG_CHECK(msg32s != NULL);
+    }
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(sig64s[i] != NULL);
+        ARG_CHECK(msg32s[i] != NULL);
+    }
+
+    key_valid = secp256k1_keypair_load(ctx, &sk, &pk, keypair);
+    /* As in secp256k1_schnorrsig_sign_internal. */
+    if (secp256k1_fe_is_odd(&pk.y)) {
+        secp256k1_scalar_negate(&sk, &sk);
+    }
+    secp256k1_scalar_get_b32(seckey, &sk);
+    secp256k1_fe_get_b32(pk_buf, &pk.x);
+
+    /* Without auxiliary randomness, nonce_function_bip340 hashes seckey || pk
+     * || msg, and seckey || pk fills a block. */
+    secp256k1_nonce_function_bip340_sha256_tagged(&sha_keyed);
+    secp256k1_sha256_write(&sha_keyed, seckey, 32);
+    secp256k1_sha256_write(&sha_keyed, pk_buf, 32);
+
+    for (i = 0; i < n_sigs; i += num) {
+        num = n_sigs - i < SECP256K1_SCHNORRSIG_SIGN_BATCH ? n_sigs - i : SECP256K1_SCHNORRSIG_SIGN_BATCH;
+        for (j = 0; j < num; j++) {
+            const unsigned char *aux_rand32 = aux_rand32s != NULL ? aux_rand32s[i + j] : NULL;
+            secp256k1_sha256 sha;
+            unsigned char buf[32];
+
+            /* Derive the nonce like nonce_function_bip340. */
+            if (aux_rand32 != NULL) {
+                unsigned char masked_key[32];
+                int l;
+                secp256k1_nonce_function_bip340_sha256_tagged_aux(&sha);
+                secp256k1_sha256_write(&sha, aux_rand32, 32);
+                secp256k1_sha256_finalize(&sha, masked_key);
+                for (l = 0; l < 32; l++) {
+                    masked_key[l] ^= seckey[l];
+                }
+                secp256k1_nonce_function_bip340_sha256_tagged(&sha);
+                secp256k1_sha256_write(&sha, masked_key, 32);
+                secp256k1_sha256_write(&sha, pk_buf, 32);
+                memset(masked_key, 0, sizeof(masked_key));
+            } else {
+                sha = sha_keyed;
+            }
+            secp256k1_sha256_write(&sha, msg32s[i + j], 32);
+            secp256k1_sha256_finalize(&sha, buf);
+            secp256k1_scalar_set_b32(&k[j], buf, NULL);
+            valid[j] = key_valid & !secp256k1_scalar_is_zero(&k[j]);
+            secp256k1_scalar_cmov(&k[j], &secp256k1_scalar_one, !valid[j]);
+            memset(buf, 0, sizeof(buf));
+
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rj[j], &k[j]);
+        }
+
+        /* The Z coordinates are blinded by secp256k1_ecmult_gen, and the batch
+         * inversion is constant time. */
+        secp256k1_ge_set_all_gej(r, rj, num);
+
+        for (j = 0; j < num; j++) {
+            unsigned char *sig64 = sig64s[i + j];
+            secp256k1_scalar e;
+
+            /* We declassify r to allow using it as a branch point. This is fine
+             * because r is not a secret. */
+            secp256k1_declassify(ctx, &r[j], sizeof(r[j]));
+            secp256k1_fe_normalize_var(&r[j].y);
+            if (secp256k1_fe_is_odd(&r[j].y)) {
+                secp256k1_scalar_negate(&k[j], &k[j]);
+            }
+            secp256k1_fe_normalize_var(&r[j].x);
+            secp256k1_fe_get_b32(&sig64[0], &r[j].x);
+
+            secp256k1_schnorrsig_challenge(&e, &sig64[0], msg32s[i + j], 32, pk_buf);
+            secp256k1_scalar_mul(&e, &e, &sk);
+            secp256k1_scalar_add(&e, &e, &k[j]);
+            secp256k1_scalar_get_b32(&sig64[32], &e);
+
+            secp256k1_memczero(sig64, 64, !valid[j]);
+            ret &= valid[j];
+            secp256k1_scalar_clear(&k[j]);
+        }
+    }
+
+    secp256k1_scalar_clear(&sk);
+    memset(seckey, 0, sizeof(seckey));
+    memset(&sha_keyed, 0, sizeof(sha_keyed));
+    return ret;
+}
+
 int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_xonly_pubkey *pubkey) {
     secp256k1_scalar s;
     secp256k1_scalar e;
@@ -253,4 +377,48 @@ int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned cha
            secp256k1_fe_equal_var(&rx, &r.x);
 }
 
+int secp256k1_schnorrsig_verify_cached(const secp256k1_context* ctx, secp256k1_signature_cache *cache, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_xonly_pubkey *pubkey, int erase) {
+    static const unsigned char type = 1;
+    secp256k1_sha256 sha;
+    secp256k1_ge pk;
+    unsigned char buf[32];
+    unsigned char digest[32];
+    int ret;
+    int i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(cache != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(msg != NULL || msglen == 0);
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_xonly_pubkey_load(ctx, &pk, pubkey)) {
+        return 0;
+    }
+    /* The digest commits to the signature type, the public key, the message
+     * and its length, and the signature. */
+    sha = cache->hasher;
+    secp256k1_sha256_write(&sha, &type, 1);
+    secp256k1_fe_normalize_var(&pk.x);
+    secp256k1_fe_get_b32(buf, &pk.x);
+    secp256k1_sha256_write(&sha, buf, 32);
+    for (i = 0; i < 8; i++) {
+        buf[i] = (unsigned char)((uint64_t)msglen >> (56 - 8*i));
+    }
+    secp256k1_sha256_write(&sha, buf, 8);
+    secp256k1_sha256_write(&sha, msg, msglen);
+    secp256k1_sha256_write(&sha, sig64, 64);
+    secp256k1_sha256_finalize(&sha, digest);
+
+    if (secp256k1_sigcache_lookup(cache, digest, erase)) {
+        return 1;
+    }
+    ret = secp256k1_schnorrsig_verify(ctx, sig64, msg, msglen, pubkey);
+    if (ret && !erase) {
+        secp256k1_sigcache_insert(cache, digest);
+    }
+    return ret;
+}
+
 #endif
@@ -838,6 +838,69 @@ void test_schnorrsig_sign_verify(void) {
 }
 #undef N_SIGS
 
+/* Checks that secp256k1_schnorrsig_sign_batch creates the same signatures as
+ * secp256k1_schnorrsig_sign, with up to two batches of affine conversions. */
+void test_schnorrsig_sign_batch(void) {
+    unsigned char sk[32];
+    unsigned char msg[2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1][32];
+    unsigned char aux_rand[2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1][32];
+    unsigned char sig[2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1][64];
+    unsigned char *sig_ptrs[2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1];
+    const unsigned char *msg_ptrs[2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1];
+    unsigned char *aux_rand_ptrs[2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1];
+    unsigned char sig2[64];
+    unsigned char zeros64[64] = { 0 };
+    secp256k1_keypair keypair;
+    secp256k1_keypair invalid_keypair = {{ 0 }};
+    size_t n = secp256k1_testrand_int(2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 2);
+    size_t i;
+    int ecount = 0;
+
+    secp256k1_testrand256(sk);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk));
+    for (i = 0; i < 2 * SECP256K1_SCHNORRSIG_SIGN_BATCH + 1; i++) {
+        secp256k1_testrand256(msg[i]);
+        secp256k1_testrand256(aux_rand[i]);
+        sig_ptrs[i] = sig[i];
+        msg_ptrs[i] = msg[i];
+        aux_rand_ptrs[i] = secp256k1_testrand_bits(1) ? aux_rand[i] : NULL;
+    }
+
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, msg_ptrs, &keypair, aux_rand_ptrs, n) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_schnorrsig_sign(ctx, sig2, msg[i], &keypair, aux_rand_ptrs[i]) == 1);
+        CHECK(secp256k1_memcmp_var(sig[i], sig2, 64) == 0);
+    }
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, msg_ptrs, &keypair, NULL, n) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_schnorrsig_sign(ctx, sig2, msg[i], &keypair, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(sig[i], sig2, 64) == 0);
+    }
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, NULL, NULL, &keypair, NULL, 0) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, msg_ptrs, NULL, NULL, n) == 0);
+    CHECK(ecount == 1);
+    if (n > 0) {
+        CHECK(secp256k1_schnorrsig_sign_batch(ctx, NULL, msg_ptrs, &keypair, NULL, n) == 0);
+        CHECK(ecount == 2);
+        CHECK(secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, NULL, &keypair, NULL, n) == 0);
+        CHECK(ecount == 3);
+        msg_ptrs[n - 1] = NULL;
+        CHECK(secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, msg_ptrs, &keypair, NULL, n) == 0);
+        CHECK(ecount == 4);
+        msg_ptrs[n - 1] = msg[n - 1];
+        /* An invalid keypair gives zeroed signatures. */
+        CHECK(secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, msg_ptrs, &invalid_keypair, aux_rand_ptrs, n) == 0);
+        CHECK(ecount == 5);
+        for (i = 0; i < n; i++) {
+            CHECK(secp256k1_memcmp_var(sig[i], zeros64, 64) == 0);
+        }
+    }
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
 void test_schnorrsig_taproot(void) {
     unsigned char sk[32];
     secp256k1_keypair keypair;
@@ -874,6 +937,67 @@ void test_schnorrsig_taproot(void) {
     CHECK(secp256k1_xonly_pubkey_tweak_add_check(ctx, output_pk_bytes, pk_parity, &internal_pk, tweak) == 1);
 }
 
+void test_schnorrsig_sign_with_session(void) {
+    secp256k1_signing_session *session = secp256k1_signing_session_create(ctx);
+    secp256k1_keypair keypair;
+    unsigned char sk[32];
+    unsigned char msg[32];
+    unsigned char aux_rand[32];
+    unsigned char seed32[32];
+    unsigned char sig[64];
+    unsigned char sig2[64];
+
+    secp256k1_testrand256(seed32);
+    CHECK(secp256k1_signing_session_randomize(session, seed32) == 1);
+    secp256k1_testrand256(sk);
+    secp256k1_testrand256(msg);
+    secp256k1_testrand256(aux_rand);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, aux_rand) == 1);
+    CHECK(secp256k1_schnorrsig_sign_with_session(session, sig2, msg, &keypair, aux_rand) == 1);
+    CHECK(secp256k1_memcmp_var(sig, sig2, sizeof(sig)) == 0);
+    secp256k1_signing_session_destroy(session);
+}
+
+void test_schnorrsig_verify_cached(void) {
+    secp256k1_signature_cache *cache;
+    secp256k1_signature_cache_stats stats;
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    unsigned char sk[32];
+    unsigned char salt[32];
+    unsigned char msg[100];
+    unsigned char sig[64];
+    size_t msglen;
+
+    secp256k1_testrand256(salt);
+    cache = secp256k1_signature_cache_create(ctx, 64, salt, SECP256K1_SIGNATURE_CACHE_COUNT);
+    secp256k1_testrand256(sk);
+    secp256k1_testrand_bytes_test(msg, sizeof(msg));
+    msglen = secp256k1_testrand_int(sizeof(msg) + 1);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair) == 1);
+    CHECK(secp256k1_schnorrsig_sign_custom(ctx, sig, msg, msglen, &keypair, NULL) == 1);
+
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 0) == 1);
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 0) == 1);
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 1) == 1);
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 1) == 1);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.hits == 2 && stats.misses == 2);
+    /* A signature for a shorter message is not confused with the cached one. */
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 0) == 1);
+    if (msglen > 0) {
+        CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen - 1, &pk, 0) == 0);
+    }
+    sig[0] ^= 1;
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 0) == 0);
+    CHECK(secp256k1_schnorrsig_verify_cached(ctx, cache, sig, msg, msglen, &pk, 0) == 0);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.hits == 2 && stats.misses == 5 + (msglen > 0));
+    secp256k1_signature_cache_destroy(ctx, cache);
+}
+
 void run_schnorrsig_tests(void) {
     int i;
     run_nonce_function_bip340_tests();
@@ -884,7 +1008,10 @@ void run_schnorrsig_tests(void) {
     for (i = 0; i < count; i++) {
         test_schnorrsig_sign();
         test_schnorrsig_sign_verify();
+        test_schnorrsig_sign_batch();
     }
+    test_schnorrsig_sign_with_session();
+    test_schnorrsig_verify_cached();
     test_schnorrsig_taproot();
 }
 
@@ -0,0 +1,228 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_SCHNORRSIG_HALFAGG_MAIN_H
+#define SECP256K1_MODULE_SCHNORRSIG_HALFAGG_MAIN_H
+
+#include "../../../include/secp256k1.h"
+#include "../../../include/secp256k1_schnorrsig.h"
+#include "../../../include/secp256k1_schnorrsig_halfagg.h"
+#include "../../hash.h"
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("HalfAgg/randomizer")||SHA256("HalfAgg/randomizer"). */
+static void secp256k1_schnorrsig_halfagg_sha256_tagged(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0xd11f5532ul;
+    sha->s[1] = 0xfa57f70ful;
+    sha->s[2] = 0x5db0d728ul;
+    sha->s[3] = 0xf806ffe1ul;
+    sha->s[4] = 0x1d4db069ul;
+    sha->s[5] = 0xb4d587e1ul;
+    sha->s[6] = 0x50451c2aul;
+    sha->s[7] = 0x10fb63e9ul;
+
+    sha->bytes = 64;
+}
+
+/* Writes r32 || pk || msg32 of a signature to the randomizer hash. The public
+ * key is loaded into pk and serialized into pk32. */
+static int secp256k1_schnorrsig_halfagg_absorb(const secp256k1_context *ctx, secp256k1_sha256 *sha, secp256k1_ge *pk, unsigned char *pk32, const unsigned char *r32, const secp256k1_xonly_pubkey *pubkey, const unsigned char *msg32) {
+    if (!secp256k1_xonly_pubkey_load(ctx, pk, pubkey)) {
+        return 0;
+    }
+    secp256k1_fe_get_b32(pk32, &pk->x);
+    secp256k1_sha256_write(sha, r32, 32);
+    secp256k1_sha256_write(sha, pk32, 32);
+    secp256k1_sha256_write(sha, msg32, 32);
+    return 1;
+}
+
+/* Sets z to the factor of the i-th signature, once the randomizer hash has
+ * absorbed the signatures up to the i-th. */
+static void secp256k1_schnorrsig_halfagg_randomizer(secp256k1_scalar *z, const secp256k1_sha256 *sha, size_t i) {
+    secp256k1_sha256 sha_copy;
+    unsigned char buf[32];
+
+    if (i == 0) {
+        secp256k1_scalar_set_int(z, 1);
+        return;
+    }
+    sha_copy = *sha;
+    secp256k1_sha256_finalize(&sha_copy, buf);
+    secp256k1_scalar_set_b32(z, buf, NULL);
+}
+
+int secp256k1_schnorrsig_inc_aggregate(const secp256k1_context* ctx, unsigned char *aggsig, size_t *aggsig_len, const secp256k1_xonly_pubkey * const *all_pubkeys, const unsigned char * const *all_msgs32, const unsigned char * const *new_sigs64, size_t n_before, size_t n_new) {
+    secp256k1_sha256 sha;
+    secp256k1_scalar s;
+    secp256k1_ge pk;
+    unsigned char pk32[32];
+    size_t n_sigs;
+    size_t i;
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(aggsig != NULL);
+    ARG_CHECK(aggsig_len != NULL);
+    ARG_CHECK(n_before <= SIZE_MAX / 32 - 1);
+    ARG_CHECK(n_new <= SIZE_MAX / 32 - 1 - n_before);
+    n_sigs = n_before + n_new;
+    if (n_sigs > 0) {
+        ARG_CHECK(all_pubkeys != NULL);
+        ARG_CHECK(all_msgs32 != NULL);
+    }
+    if (n_new > 0) {
+        ARG_CHECK(new_sigs64 != NULL);
+    }
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(all_pubkeys[i] != NULL);
+        ARG_CHECK(all_msgs32[i] != NULL);
+    }
+    for (i = 0; i < n_new; i++) {
+        ARG_CHECK(new_sigs64[i] != NULL);
+    }
+
+    if (*aggsig_len < SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_sigs)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&s, &aggsig[32 * n_before], &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    /* The factors of the earlier signatures are already in s, so their part of
+     * the hash only needs to be recomputed. */
+    secp256k1_schnorrsig_halfagg_sha256_tagged(&sha);
+    for (i = 0; i < n_before; i++) {
+        if (!secp256k1_schnorrsig_halfagg_absorb(ctx, &sha, &pk, pk32, &aggsig[32 * i], all_pubkeys[i], all_msgs32[i])) {
+            return 0;
+        }
+    }
+    for (i = 0; i < n_new; i++) {
+        secp256k1_scalar z;
+        secp256k1_scalar si;
+
+        secp256k1_scalar_set_b32(&si, &new_sigs64[i][32], &overflow);
+        if (overflow || !secp256k1_schnorrsig_halfagg_absorb(ctx, &sha, &pk, pk32, &new_sigs64[i][0], all_pubkeys[n_before + i], all_msgs32[n_before + i])) {
+            return 0;
+        }
+        secp256k1_schnorrsig_halfagg_randomizer(&z, &sha, n_before + i);
+        secp256k1_scalar_mul(&si, &si, &z);
+        secp256k1_scalar_add(&s, &s, &si);
+    }
+
+    /* The new R values overwrite the old s, so they are only written once all
+     * signatures are known to be well-formed. */
+    for (i = 0; i < n_new; i++) {
+        memcpy(&aggsig[32 * (n_before + i)], &new_sigs64[i][0], 32);
+    }
+    secp256k1_scalar_get_b32(&aggsig[32 * n_sigs], &s);
+    *aggsig_len = SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_sigs);
+    return 1;
+}
+
+int secp256k1_schnorrsig_aggregate(const secp256k1_context* ctx, unsigned char *aggsig, size_t *aggsig_len, const secp256k1_xonly_pubkey * const *pubkeys, const unsigned char * const *msgs32, const unsigned char * const *sigs64, size_t n_sigs) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(aggsig != NULL);
+    ARG_CHECK(aggsig_len != NULL);
+
+    if (*aggsig_len < SECP256K1_SCHNORRSIG_AGGSIG_LEN(0)) {
+        return 0;
+    }
+    memset(aggsig, 0, SECP256K1_SCHNORRSIG_AGGSIG_LEN(0));
+    return secp256k1_schnorrsig_inc_aggregate(ctx, aggsig, aggsig_len, pubkeys, msgs32, sigs64, 0, n_sigs);
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const secp256k1_xonly_pubkey * const *pubkeys;
+    const unsigned char * const *msgs32;
+    const unsigned char *aggsig;
+    secp256k1_sha256 sha;
+    /* The number of signatures absorbed by sha so far. */
+    size_t n_absorbed;
+    /* The public key and factor of the last absorbed signature. */
+    secp256k1_ge pk;
+    unsigned char pk32[32];
+    secp256k1_scalar z;
+} secp256k1_schnorrsig_aggverify_ecmult_data;
+
+/* Provides z_i*R_i at index 2*i and (z_i*e_i)*P_i at index 2*i+1. Since z_i
+ * depends on all earlier signatures, the points must be asked for in order,
+ * as secp256k1_ecmult_multi_var does; otherwise verification fails. */
+static int secp256k1_schnorrsig_aggverify_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    secp256k1_schnorrsig_aggverify_ecmult_data *cbdata = (secp256k1_schnorrsig_aggverify_ecmult_data *)data;
+    size_t i = idx / 2;
+    const unsigned char *r32 = &cbdata->aggsig[32 * i];
+
+    if (idx % 2 == 0) {
+        secp256k1_fe rx;
+
+        if (i != cbdata->n_absorbed
+            || !secp256k1_fe_set_b32(&rx, r32)
+            || !secp256k1_ge_set_xo_var(pt, &rx, 0)
+            || !secp256k1_schnorrsig_halfagg_absorb(cbdata->ctx, &cbdata->sha, &cbdata->pk, cbdata->pk32, r32, cbdata->pubkeys[i], cbdata->msgs32[i])) {
+            return 0;
+        }
+        cbdata->n_absorbed++;
+        secp256k1_schnorrsig_halfagg_randomizer(&cbdata->z, &cbdata->sha, i);
+        *sc = cbdata->z;
+    } else {
+        secp256k1_scalar e;
+
+        if (i + 1 != cbdata->n_absorbed) {
+            return 0;
+        }
+        secp256k1_schnorrsig_challenge(&e, r32, cbdata->msgs32[i], 32, cbdata->pk32);
+        secp256k1_scalar_mul(sc, &e, &cbdata->z);
+        *pt = cbdata->pk;
+    }
+    return 1;
+}
+
+int secp256k1_schnorrsig_aggverify(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, const secp256k1_xonly_pubkey * const *pubkeys, const unsigned char * const *msgs32, size_t n_sigs, const unsigned char *aggsig, size_t aggsig_len) {
+    secp256k1_schnorrsig_aggverify_ecmult_data cbdata;
+    secp256k1_scalar s;
+    secp256k1_gej rj;
+    size_t i;
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(aggsig != NULL);
+    if (n_sigs > 0) {
+        ARG_CHECK(pubkeys != NULL);
+        ARG_CHECK(msgs32 != NULL);
+    }
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(pubkeys[i] != NULL);
+        ARG_CHECK(msgs32[i] != NULL);
+    }
+
+    /* Also rejects an n_sigs for which 2*n_sigs points would overflow. */
+    if (n_sigs > SIZE_MAX / 32 - 1 || aggsig_len != SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_sigs)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&s, &aggsig[32 * n_sigs], &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    /* Check that sum z_i*R_i + sum (z_i*e_i)*P_i - s*G is infinity. */
+    cbdata.ctx = ctx;
+    cbdata.pubkeys = pubkeys;
+    cbdata.msgs32 = msgs32;
+    cbdata.aggsig = aggsig;
+    secp256k1_schnorrsig_halfagg_sha256_tagged(&cbdata.sha);
+    cbdata.n_absorbed = 0;
+    secp256k1_scalar_negate(&s, &s);
+    if (!secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &rj, &s, secp256k1_schnorrsig_aggverify_callback, (void *) &cbdata, 2 * n_sigs)) {
+        return 0;
+    }
+    return secp256k1_gej_is_infinity(&rj);
+}
+
+#endif
@@ -0,0 +1,361 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_SCHNORRSIG_HALFAGG_TESTS_H
+#define SECP256K1_MODULE_SCHNORRSIG_HALFAGG_TESTS_H
+
+#include "../../../include/secp256k1_schnorrsig.h"
+#include "../../../include/secp256k1_schnorrsig_halfagg.h"
+
+/* Checks that the hash initialized with a fixed midstate has the expected
+ * state. */
+void test_schnorrsig_halfagg_sha256_tagged(void) {
+    static const unsigned char tag[18] = "HalfAgg/randomizer";
+    secp256k1_sha256 sha;
+    secp256k1_sha256 sha_optimized;
+
+    secp256k1_sha256_initialize_tagged(&sha, tag, sizeof(tag));
+    secp256k1_schnorrsig_halfagg_sha256_tagged(&sha_optimized);
+    test_sha256_eq(&sha, &sha_optimized);
+}
+
+/* Creates n random signatures and sets pointers to their public keys,
+ * messages and signatures. */
+void test_schnorrsig_halfagg_setup(size_t n, secp256k1_xonly_pubkey *pubkeys, unsigned char (*msgs)[32], unsigned char (*sigs)[64], const secp256k1_xonly_pubkey **pk_ptrs, const unsigned char **msg_ptrs, const unsigned char **sig_ptrs) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        unsigned char sk[32];
+        secp256k1_keypair keypair;
+        secp256k1_scalar sk_s;
+
+        random_scalar_order_test(&sk_s);
+        secp256k1_scalar_get_b32(sk, &sk_s);
+        secp256k1_testrand256(msgs[i]);
+        CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+        CHECK(secp256k1_keypair_xonly_pub(ctx, &pubkeys[i], NULL, &keypair) == 1);
+        CHECK(secp256k1_schnorrsig_sign(ctx, sigs[i], msgs[i], &keypair, NULL) == 1);
+        pk_ptrs[i] = &pubkeys[i];
+        msg_ptrs[i] = msgs[i];
+        sig_ptrs[i] = sigs[i];
+    }
+}
+
+/* Aggregates n signatures at once and incrementally, and checks that the
+ * aggregate verifies while modified ones do not. */
+void test_schnorrsig_aggregate(size_t n) {
+    secp256k1_xonly_pubkey *pubkeys = (secp256k1_xonly_pubkey *) checked_malloc(&ctx->error_callback, (n + 1) * sizeof(*pubkeys));
+    unsigned char (*msgs)[32] = (unsigned char (*)[32]) checked_malloc(&ctx->error_callback, (n + 1) * 32);
+    unsigned char (*sigs)[64] = (unsigned char (*)[64]) checked_malloc(&ctx->error_callback, (n + 1) * 64);
+    const secp256k1_xonly_pubkey **pk_ptrs = (const secp256k1_xonly_pubkey **) checked_malloc(&ctx->error_callback, (n + 1) * sizeof(*pk_ptrs));
+    const unsigned char **msg_ptrs = (const unsigned char **) checked_malloc(&ctx->error_callback, (n + 1) * sizeof(*msg_ptrs));
+    const unsigned char **sig_ptrs = (const unsigned char **) checked_malloc(&ctx->error_callback, (n + 1) * sizeof(*sig_ptrs));
+    size_t aggsig_max_len = SECP256K1_SCHNORRSIG_AGGSIG_LEN(n);
+    unsigned char *aggsig = (unsigned char *) checked_malloc(&ctx->error_callback, aggsig_max_len);
+    unsigned char *aggsig_inc = (unsigned char *) checked_malloc(&ctx->error_callback, aggsig_max_len);
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1024 * 1024);
+    size_t aggsig_len, aggsig_inc_len;
+    size_t n_before, i;
+
+    test_schnorrsig_halfagg_setup(n, pubkeys, msgs, sigs, pk_ptrs, msg_ptrs, sig_ptrs);
+
+    aggsig_len = aggsig_max_len;
+    CHECK(secp256k1_schnorrsig_aggregate(ctx, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, n) == 1);
+    CHECK(aggsig_len == aggsig_max_len);
+    CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 1);
+    CHECK(secp256k1_schnorrsig_aggverify(ctx, NULL, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_memcmp_var(&aggsig[32 * i], sigs[i], 32) == 0);
+    }
+    if (n == 1) {
+        /* The first factor is 1. */
+        CHECK(secp256k1_memcmp_var(&aggsig[32], &sigs[0][32], 32) == 0);
+    }
+
+    /* Adding the signatures in two steps gives the same aggregate. */
+    n_before = secp256k1_testrand_int(n + 1);
+    aggsig_inc_len = aggsig_max_len;
+    CHECK(secp256k1_schnorrsig_aggregate(ctx, aggsig_inc, &aggsig_inc_len, pk_ptrs, msg_ptrs, sig_ptrs, n_before) == 1);
+    CHECK(aggsig_inc_len == SECP256K1_SCHNORRSIG_AGGSIG_LEN(n_before));
+    CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n_before, aggsig_inc, aggsig_inc_len) == 1);
+    /* The buffer must hold the new aggregate. */
+    aggsig_inc_len = aggsig_max_len - 1;
+    CHECK(secp256k1_schnorrsig_inc_aggregate(ctx, aggsig_inc, &aggsig_inc_len, pk_ptrs, msg_ptrs, &sig_ptrs[n_before], n_before, n - n_before) == 0);
+    CHECK(aggsig_inc_len == aggsig_max_len - 1);
+    aggsig_inc_len = aggsig_max_len;
+    CHECK(secp256k1_schnorrsig_inc_aggregate(ctx, aggsig_inc, &aggsig_inc_len, pk_ptrs, msg_ptrs, &sig_ptrs[n_before], n_before, n - n_before) == 1);
+    CHECK(aggsig_inc_len == aggsig_max_len);
+    CHECK(secp256k1_memcmp_var(aggsig, aggsig_inc, aggsig_len) == 0);
+
+    /* Wrong lengths */
+    CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len - 1) == 0);
+    if (n > 0) {
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n - 1, aggsig, aggsig_len) == 0);
+    }
+
+    /* Modified aggregate, message and public key */
+    i = secp256k1_testrand_int(aggsig_len);
+    memcpy(aggsig_inc, aggsig, aggsig_len);
+    aggsig_inc[i] ^= 1 << secp256k1_testrand_int(8);
+    CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig_inc, aggsig_len) == 0);
+    if (n > 0) {
+        size_t j = secp256k1_testrand_int(32);
+        i = secp256k1_testrand_int(n);
+        msgs[i][j] ^= 1;
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 0);
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, NULL, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 0);
+        msgs[i][j] ^= 1;
+        test_schnorrsig_halfagg_setup(1, &pubkeys[n], &msgs[n], &sigs[n], &pk_ptrs[n], &msg_ptrs[n], &sig_ptrs[n]);
+        pk_ptrs[i] = &pubkeys[n];
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 0);
+        pk_ptrs[i] = &pubkeys[i];
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 1);
+    }
+
+    /* Signatures in another order */
+    if (n > 1) {
+        test_schnorrsig_halfagg_setup(n, pubkeys, msgs, sigs, pk_ptrs, msg_ptrs, sig_ptrs);
+        CHECK(secp256k1_schnorrsig_aggregate(ctx, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, n) == 1);
+        pk_ptrs[0] = &pubkeys[1];
+        pk_ptrs[1] = &pubkeys[0];
+        msg_ptrs[0] = msgs[1];
+        msg_ptrs[1] = msgs[0];
+        memcpy(aggsig_inc, aggsig, aggsig_len);
+        memcpy(&aggsig_inc[0], &aggsig[32], 32);
+        memcpy(&aggsig_inc[32], &aggsig[0], 32);
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, scratch, pk_ptrs, msg_ptrs, n, aggsig_inc, aggsig_len) == 0);
+    }
+
+    secp256k1_scratch_space_destroy(ctx, scratch);
+    free(aggsig_inc);
+    free(aggsig);
+    free(sig_ptrs);
+    free(msg_ptrs);
+    free(pk_ptrs);
+    free(sigs);
+    free(msgs);
+    free(pubkeys);
+}
+
+/* Known-answer vectors for the aggregation of the BIP340 signatures of the
+ * messages 0x01..01, 0x02..02 and 0x03..03 by the secret keys 3, 4 and 5,
+ * signed with an all-zero aux_rand32. For every prefix of n signatures the
+ * aggregate is R_0 || ... || R_{n-1} || s with s = sum z_i*s_i, where z_0 = 1
+ * and z_i for i > 0 is the "HalfAgg/randomizer" tagged hash of
+ * R_0 || pk_0 || m_0 || ... || R_i || pk_i || m_i, as in the half-aggregation
+ * draft. The expected values were computed with a separate implementation of
+ * the draft. */
+void test_schnorrsig_aggregate_vectors(void) {
+    static const unsigned char pks[3][32] = {
+        {
+            0xF9, 0x30, 0x8A, 0x01, 0x92, 0x58, 0xC3, 0x10, 0x49, 0x34, 0x4F, 0x85, 0xF8, 0x9D, 0x52, 0x29,
+            0xB5, 0x31, 0xC8, 0x45, 0x83, 0x6F, 0x99, 0xB0, 0x86, 0x01, 0xF1, 0x13, 0xBC, 0xE0, 0x36, 0xF9
+        },
+        {
+            0xE4, 0x93, 0xDB, 0xF1, 0xC1, 0x0D, 0x80, 0xF3, 0x58, 0x1E, 0x49, 0x04, 0x93, 0x0B, 0x14, 0x04,
+            0xCC, 0x6C, 0x13, 0x90, 0x0E, 0xE0, 0x75, 0x84, 0x74, 0xFA, 0x94, 0xAB, 0xE8, 0xC4, 0xCD, 0x13
+        },
+        {
+            0x2F, 0x8B, 0xDE, 0x4D, 0x1A, 0x07, 0x20, 0x93, 0x55, 0xB4, 0xA7, 0x25, 0x0A, 0x5C, 0x51, 0x28,
+            0xE8, 0x8B, 0x84, 0xBD, 0xDC, 0x61, 0x9A, 0xB7, 0xCB, 0xA8, 0xD5, 0x69, 0xB2, 0x40, 0xEF, 0xE4
+        }
+    };
+    static const unsigned char sigs[3][64] = {
+        {
+            0xE7, 0xAE, 0x02, 0x42, 0x0A, 0x12, 0x14, 0x32, 0x87, 0x1B, 0xAC, 0xEB, 0xC0, 0x31, 0xC6, 0x50,
+            0x1B, 0x07, 0xF5, 0xD1, 0x2E, 0x0F, 0xDE, 0x32, 0xF4, 0x9A, 0x98, 0xAC, 0xFB, 0x59, 0xD3, 0xAC,
+            0xE1, 0x8C, 0x02, 0x05, 0x56, 0x3C, 0xB1, 0x9F, 0x95, 0x12, 0xA1, 0x55, 0x7A, 0x64, 0x70, 0x4D,
+            0xC0, 0x61, 0x65, 0x77, 0x00, 0x13, 0x18, 0xF5, 0x48, 0x89, 0x93, 0x88, 0xEE, 0x39, 0xBF, 0xEB
+        },
+        {
+            0x90, 0x0E, 0x10, 0xF6, 0xA7, 0x86, 0xF3, 0x9B, 0x7A, 0xCE, 0x3E, 0x2C, 0xBE, 0xDA, 0x1B, 0x39,
+            0x24, 0x15, 0x74, 0x3E, 0x0D, 0xA4, 0xF1, 0x87, 0xCE, 0x53, 0x37, 0x25, 0x38, 0xBE, 0xB5, 0x9E,
+            0x40, 0x7C, 0x96, 0x6A, 0x18, 0x7D, 0x70, 0xDC, 0x53, 0x0F, 0xEA, 0xAE, 0xB3, 0xC4, 0x6B, 0x51,
+            0x0E, 0xBE, 0x48, 0xD7, 0xE8, 0xEA, 0x2F, 0xD8, 0x64, 0xA9, 0xA9, 0xA3, 0xC9, 0x63, 0x4F, 0x8E
+        },
+        {
+            0x08, 0xA2, 0xE2, 0x87, 0x04, 0x1E, 0x3D, 0xF2, 0xE2, 0xB5, 0x01, 0xA2, 0x58, 0xE7, 0xD3, 0xE5,
+            0x0F, 0x71, 0xAE, 0x84, 0xBE, 0x2F, 0x4E, 0xBD, 0xD8, 0xF3, 0x5B, 0x98, 0x38, 0x0B, 0x31, 0xDB,
+            0x2A, 0xA5, 0x8A, 0xB7, 0x6F, 0xCE, 0x36, 0x53, 0x2B, 0x2E, 0x8D, 0x1F, 0x96, 0x84, 0xBE, 0x22,
+            0x06, 0xEC, 0x67, 0x7B, 0xE2, 0xB4, 0x9E, 0x0D, 0xC2, 0x84, 0xDF, 0x52, 0x40, 0x3E, 0xAF, 0x14
+        }
+    };
+    /* The s value of the aggregate of the first n signatures */
+    static const unsigned char expected_s[4][32] = {
+        {
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0xE1, 0x8C, 0x02, 0x05, 0x56, 0x3C, 0xB1, 0x9F, 0x95, 0x12, 0xA1, 0x55, 0x7A, 0x64, 0x70, 0x4D,
+            0xC0, 0x61, 0x65, 0x77, 0x00, 0x13, 0x18, 0xF5, 0x48, 0x89, 0x93, 0x88, 0xEE, 0x39, 0xBF, 0xEB
+        },
+        {
+            0x38, 0x53, 0xBC, 0x64, 0xCB, 0xEA, 0xE1, 0x8A, 0x2B, 0x9A, 0x13, 0x20, 0x1F, 0x3A, 0x20, 0x23,
+            0x61, 0x4D, 0xC2, 0xDA, 0x30, 0x61, 0x56, 0x90, 0x1A, 0xAE, 0x35, 0x83, 0x14, 0x33, 0x1B, 0x71
+        },
+        {
+            0x22, 0x75, 0x4B, 0x48, 0xE2, 0x20, 0x81, 0x62, 0x46, 0x23, 0xCF, 0x44, 0x85, 0x3E, 0x57, 0x4F,
+            0xA3, 0xAB, 0x45, 0x2F, 0x76, 0x75, 0xFB, 0xE5, 0x5E, 0x77, 0x98, 0xCA, 0x3E, 0x08, 0x44, 0x44
+        }
+    };
+    secp256k1_xonly_pubkey pubkeys[3];
+    unsigned char msgs[3][32];
+    const secp256k1_xonly_pubkey *pk_ptrs[3];
+    const unsigned char *msg_ptrs[3];
+    const unsigned char *sig_ptrs[3];
+    unsigned char aggsig[SECP256K1_SCHNORRSIG_AGGSIG_LEN(3)];
+    unsigned char aggsig_inc[SECP256K1_SCHNORRSIG_AGGSIG_LEN(3)];
+    size_t aggsig_len, aggsig_inc_len;
+    size_t i, n;
+
+    for (i = 0; i < 3; i++) {
+        CHECK(secp256k1_xonly_pubkey_parse(ctx, &pubkeys[i], pks[i]) == 1);
+        memset(msgs[i], i + 1, 32);
+        CHECK(secp256k1_schnorrsig_verify(ctx, sigs[i], msgs[i], 32, &pubkeys[i]) == 1);
+        pk_ptrs[i] = &pubkeys[i];
+        msg_ptrs[i] = msgs[i];
+        sig_ptrs[i] = sigs[i];
+    }
+    aggsig_inc_len = sizeof(aggsig_inc);
+    CHECK(secp256k1_schnorrsig_aggregate(ctx, aggsig_inc, &aggsig_inc_len, NULL, NULL, NULL, 0) == 1);
+    for (n = 0; n <= 3; n++) {
+        aggsig_len = sizeof(aggsig);
+        CHECK(secp256k1_schnorrsig_aggregate(ctx, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, n) == 1);
+        CHECK(aggsig_len == SECP256K1_SCHNORRSIG_AGGSIG_LEN(n));
+        for (i = 0; i < n; i++) {
+            CHECK(secp256k1_memcmp_var(&aggsig[32 * i], sigs[i], 32) == 0);
+        }
+        CHECK(secp256k1_memcmp_var(&aggsig[32 * n], expected_s[n], 32) == 0);
+        CHECK(secp256k1_schnorrsig_aggverify(ctx, NULL, pk_ptrs, msg_ptrs, n, aggsig, aggsig_len) == 1);
+
+        /* Adding the signatures one at a time gives the same aggregate. */
+        if (n > 0) {
+            aggsig_inc_len = sizeof(aggsig_inc);
+            CHECK(secp256k1_schnorrsig_inc_aggregate(ctx, aggsig_inc, &aggsig_inc_len, pk_ptrs, msg_ptrs, &sig_ptrs[n - 1], n - 1, 1) == 1);
+        }
+        CHECK(aggsig_inc_len == aggsig_len);
+        CHECK(secp256k1_memcmp_var(aggsig_inc, aggsig, aggsig_len) == 0);
+    }
+}
+
+void test_schnorrsig_aggregate_api(void) {
+    secp256k1_xonly_pubkey pubkeys[2];
+    unsigned char msgs[2][32];
+    unsigned char sigs[2][64];
+    const secp256k1_xonly_pubkey *pk_ptrs[2];
+    const unsigned char *msg_ptrs[2];
+    const unsigned char *sig_ptrs[2];
+    const unsigned char *invalid_ptrs[2];
+    unsigned char aggsig[SECP256K1_SCHNORRSIG_AGGSIG_LEN(2)];
+    unsigned char aggsig_copy[SECP256K1_SCHNORRSIG_AGGSIG_LEN(2)];
+    unsigned char invalid_sig[64];
+    size_t aggsig_len;
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    int ecount;
+
+    secp256k1_context_set_error_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_error_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+
+    test_schnorrsig_halfagg_setup(2, pubkeys, msgs, sigs, pk_ptrs, msg_ptrs, sig_ptrs);
+
+    /* aggregate */
+    ecount = 0;
+    aggsig_len = sizeof(aggsig);
+    CHECK(secp256k1_schnorrsig_aggregate(none, NULL, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, 2) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, NULL, pk_ptrs, msg_ptrs, sig_ptrs, 2) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, NULL, msg_ptrs, sig_ptrs, 2) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, pk_ptrs, NULL, sig_ptrs, 2) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, NULL, 2) == 0);
+    CHECK(ecount == 5);
+    invalid_ptrs[0] = sigs[0];
+    invalid_ptrs[1] = NULL;
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, invalid_ptrs, 2) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, NULL, NULL, NULL, 0) == 1);
+    CHECK(aggsig_len == 32);
+    aggsig_len = sizeof(aggsig) - 1;
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, 2) == 0);
+    aggsig_len = sizeof(aggsig);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, 2) == 1);
+    CHECK(ecount == 6);
+
+    /* inc_aggregate */
+    aggsig_len = sizeof(aggsig);
+    CHECK(secp256k1_schnorrsig_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, sig_ptrs, 1) == 1);
+    memcpy(aggsig_copy, aggsig, sizeof(aggsig));
+    aggsig_len = sizeof(aggsig);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, NULL, &aggsig_len, pk_ptrs, msg_ptrs, &sig_ptrs[1], 1, 1) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, NULL, pk_ptrs, msg_ptrs, &sig_ptrs[1], 1, 1) == 0);
+    CHECK(ecount == 8);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, NULL, msg_ptrs, &sig_ptrs[1], 1, 1) == 0);
+    CHECK(ecount == 9);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, NULL, &sig_ptrs[1], 1, 1) == 0);
+    CHECK(ecount == 10);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, NULL, 1, 1) == 0);
+    CHECK(ecount == 11);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, &sig_ptrs[1], SIZE_MAX / 32, 0) == 0);
+    CHECK(ecount == 12);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, &sig_ptrs[1], 1, SIZE_MAX / 32 - 1) == 0);
+    CHECK(ecount == 13);
+    /* An S value that is not smaller than the group order */
+    memcpy(invalid_sig, sigs[1], 32);
+    memset(&invalid_sig[32], 0xFF, 32);
+    invalid_ptrs[0] = invalid_sig;
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, invalid_ptrs, 1, 1) == 0);
+    CHECK(secp256k1_memcmp_var(aggsig, aggsig_copy, sizeof(aggsig)) == 0);
+    CHECK(aggsig_len == sizeof(aggsig));
+    /* A malformed aggregate */
+    memset(&aggsig[32], 0xFF, 32);
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, &sig_ptrs[1], 1, 1) == 0);
+    memcpy(aggsig, aggsig_copy, sizeof(aggsig));
+    CHECK(secp256k1_schnorrsig_inc_aggregate(none, aggsig, &aggsig_len, pk_ptrs, msg_ptrs, &sig_ptrs[1], 1, 1) == 1);
+    CHECK(ecount == 13);
+
+    /* aggverify */
+    ecount = 0;
+    CHECK(secp256k1_schnorrsig_aggverify(none, NULL, pk_ptrs, msg_ptrs, 2, aggsig, aggsig_len) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_schnorrsig_aggverify(vrfy, NULL, NULL, msg_ptrs, 2, aggsig, aggsig_len) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_schnorrsig_aggverify(vrfy, NULL, pk_ptrs, NULL, 2, aggsig, aggsig_len) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_schnorrsig_aggverify(vrfy, NULL, pk_ptrs, msg_ptrs, 2, NULL, aggsig_len) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_schnorrsig_aggverify(vrfy, NULL, pk_ptrs, msg_ptrs, 2, aggsig, aggsig_len) == 1);
+    CHECK(ecount == 4);
+    /* The empty aggregate */
+    memset(aggsig, 0, 32);
+    CHECK(secp256k1_schnorrsig_aggverify(vrfy, NULL, NULL, NULL, 0, aggsig, 32) == 1);
+    aggsig[31] = 1;
+    CHECK(secp256k1_schnorrsig_aggverify(vrfy, NULL, NULL, NULL, 0, aggsig, 32) == 0);
+    CHECK(ecount == 4);
+
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(vrfy);
+}
+
+void run_schnorrsig_halfagg_tests(void) {
+    int i;
+
+    test_schnorrsig_halfagg_sha256_tagged();
+    test_schnorrsig_aggregate_vectors();
+    test_schnorrsig_aggregate_api();
+    for (i = 0; i < count; i++) {
+        test_schnorrsig_aggregate(secp256k1_testrand_int(10));
+    }
+    /* Large enough for Pippenger's algorithm. */
+    test_schnorrsig_aggregate(100);
+}
+
+#endif
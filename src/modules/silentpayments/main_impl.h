@@ -0,0 +1,369 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_SILENTPAYMENTS_MAIN_H
+#define SECP256K1_MODULE_SILENTPAYMENTS_MAIN_H
+
+#include "../../../include/secp256k1.h"
+#include "../../../include/secp256k1_extrakeys.h"
+#include "../../../include/secp256k1_silentpayments.h"
+#include "../../ecmult_const_impl.h"
+#include "../../hash.h"
+
+static const unsigned char secp256k1_silentpayments_public_data_magic[4] = { 0xa7, 0x1d, 0x3c, 0x5e };
+
+/* Number of transactions whose points share one field inversion in
+ * secp256k1_silentpayments_recipient_scan_block. */
+#define SECP256K1_SILENTPAYMENTS_SCAN_CHUNK 32
+
+/* Number of slots of the output hash table. Transactions with more than half
+ * as many outputs are searched linearly. */
+#define SECP256K1_SILENTPAYMENTS_TABLE_SIZE 1024
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("BIP0352/Inputs")||SHA256("BIP0352/Inputs"). */
+static void secp256k1_silentpayments_sha256_tagged_inputs(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0xd4143ffcul;
+    sha->s[1] = 0x012ea4b5ul;
+    sha->s[2] = 0x36e21c8ful;
+    sha->s[3] = 0xf7ec7b54ul;
+    sha->s[4] = 0x4dd4e2acul;
+    sha->s[5] = 0x9bcaa0a4ul;
+    sha->s[6] = 0xe244899bul;
+    sha->s[7] = 0xcd06903eul;
+
+    sha->bytes = 64;
+}
+
+/* Initializes SHA256 with fixed midstate. This midstate was computed by applying
+ * SHA256 to SHA256("BIP0352/SharedSecret")||SHA256("BIP0352/SharedSecret"). */
+static void secp256k1_silentpayments_sha256_tagged_shared_secret(secp256k1_sha256 *sha) {
+    secp256k1_sha256_initialize(sha);
+    sha->s[0] = 0x88831537ul;
+    sha->s[1] = 0x5127079bul;
+    sha->s[2] = 0x69c2137bul;
+    sha->s[3] = 0xab0303e6ul;
+    sha->s[4] = 0x98fa21faul;
+    sha->s[5] = 0x4a888523ul;
+    sha->s[6] = 0xbd99daabul;
+    sha->s[7] = 0xf25e5e0aul;
+
+    sha->bytes = 64;
+}
+
+/* Writes the 33-byte compressed serialization of ge, which must not be
+ * infinity, in constant time. */
+static void secp256k1_silentpayments_ge_serialize33(unsigned char *out33, secp256k1_ge *ge) {
+    secp256k1_fe_normalize(&ge->x);
+    secp256k1_fe_normalize(&ge->y);
+    out33[0] = SECP256K1_TAG_PUBKEY_EVEN | secp256k1_fe_is_odd(&ge->y);
+    secp256k1_fe_get_b32(&out33[1], &ge->x);
+}
+
+/* The public data is stored as: magic || A || input_hash, which takes
+ * 4 + 64 + 32 = 100 bytes. */
+static void secp256k1_silentpayments_public_data_save(secp256k1_silentpayments_public_data *public_data, secp256k1_ge *a, const unsigned char *input_hash32) {
+    memcpy(&public_data->data[0], secp256k1_silentpayments_public_data_magic, 4);
+    secp256k1_pubkey_save((secp256k1_pubkey *) &public_data->data[4], a);
+    memcpy(&public_data->data[68], input_hash32, 32);
+}
+
+/* The magic must have been checked by the caller. */
+static void secp256k1_silentpayments_public_data_load(const secp256k1_context *ctx, secp256k1_ge *a, secp256k1_scalar *input_hash, const secp256k1_silentpayments_public_data *public_data) {
+    int ret = secp256k1_pubkey_load(ctx, a, (const secp256k1_pubkey *) &public_data->data[4]);
+    VERIFY_CHECK(ret);
+    (void)ret;
+    secp256k1_scalar_set_b32(input_hash, &public_data->data[68], NULL);
+}
+
+int secp256k1_silentpayments_recipient_public_data_create(const secp256k1_context* ctx, secp256k1_silentpayments_public_data *public_data, const unsigned char *outpoint_smallest36, const secp256k1_xonly_pubkey * const *xonly_pubkeys, size_t n_xonly, const secp256k1_pubkey * const *plain_pubkeys, size_t n_plain) {
+    secp256k1_sha256 sha;
+    secp256k1_gej aj;
+    secp256k1_ge a;
+    secp256k1_ge pk;
+    secp256k1_scalar input_hash;
+    unsigned char a33[33];
+    unsigned char input_hash32[32];
+    int overflow;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(public_data != NULL);
+    memset(public_data, 0, sizeof(*public_data));
+    ARG_CHECK(outpoint_smallest36 != NULL);
+    ARG_CHECK(n_xonly == 0 || xonly_pubkeys != NULL);
+    ARG_CHECK(n_plain == 0 || plain_pubkeys != NULL);
+
+    /* The public keys of the inputs are public, so they can be summed in
+     * variable time. */
+    secp256k1_gej_set_infinity(&aj);
+    for (i = 0; i < n_xonly; i++) {
+        ARG_CHECK(xonly_pubkeys[i] != NULL);
+        if (!secp256k1_xonly_pubkey_load(ctx, &pk, xonly_pubkeys[i])) {
+            return 0;
+        }
+        secp256k1_gej_add_ge_var(&aj, &aj, &pk, NULL);
+    }
+    for (i = 0; i < n_plain; i++) {
+        ARG_CHECK(plain_pubkeys[i] != NULL);
+        if (!secp256k1_pubkey_load(ctx, &pk, plain_pubkeys[i])) {
+            return 0;
+        }
+        secp256k1_gej_add_ge_var(&aj, &aj, &pk, NULL);
+    }
+    if (secp256k1_gej_is_infinity(&aj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej_var(&a, &aj);
+
+    secp256k1_silentpayments_ge_serialize33(a33, &a);
+    secp256k1_silentpayments_sha256_tagged_inputs(&sha);
+    secp256k1_sha256_write(&sha, outpoint_smallest36, 36);
+    secp256k1_sha256_write(&sha, a33, sizeof(a33));
+    secp256k1_sha256_finalize(&sha, input_hash32);
+    secp256k1_scalar_set_b32(&input_hash, input_hash32, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&input_hash)) {
+        return 0;
+    }
+
+    secp256k1_silentpayments_public_data_save(public_data, &a, input_hash32);
+    return 1;
+}
+
+/* Sets tweak32 to t_k = hash_BIP0352/SharedSecret(ser(S) || ser32(k)) and
+ * declassifies it. Unlike S, t_k reveals nothing about the scan key, and
+ * secp256k1_ec_pubkey_tweak_add handles tweaks in variable time as well.
+ * Returns 0 if t_k is not a valid scalar. */
+static int secp256k1_silentpayments_tweak(const secp256k1_context *ctx, unsigned char *tweak32, const unsigned char *shared_secret33, uint32_t k) {
+    secp256k1_sha256 sha;
+    secp256k1_scalar t;
+    unsigned char k_be[4];
+    int overflow;
+
+    k_be[0] = k >> 24;
+    k_be[1] = k >> 16;
+    k_be[2] = k >> 8;
+    k_be[3] = k;
+    secp256k1_silentpayments_sha256_tagged_shared_secret(&sha);
+    secp256k1_sha256_write(&sha, shared_secret33, 33);
+    secp256k1_sha256_write(&sha, k_be, sizeof(k_be));
+    secp256k1_sha256_finalize(&sha, tweak32);
+    secp256k1_declassify(ctx, tweak32, 32);
+    secp256k1_scalar_set_b32(&t, tweak32, &overflow);
+    return !overflow;
+}
+
+/* Sets p to the candidate output B_spend + t_k*G. */
+static void secp256k1_silentpayments_output(const secp256k1_context *ctx, secp256k1_gej *p, const unsigned char *tweak32, const secp256k1_ge *spend_pk) {
+    secp256k1_scalar t;
+
+    secp256k1_scalar_set_b32(&t, tweak32, NULL);
+    secp256k1_ecmult_gen_var(&ctx->ecmult_ctx, p, &t);
+    secp256k1_gej_add_ge_var(p, p, spend_pk, NULL);
+}
+
+/* The outputs of a transaction, indexed by the first bytes of the storage
+ * representation of their X coordinate. A slot holds the index of an output
+ * plus one, or 0 if it is empty; the X coordinates are not copied but loaded
+ * from the outputs when a slot is probed, which keeps the table at 2kB. If
+ * mask is 0, the transaction has too many outputs for the table and they are
+ * searched linearly. */
+typedef struct {
+    uint16_t slots[SECP256K1_SILENTPAYMENTS_TABLE_SIZE];
+    size_t mask;
+} secp256k1_silentpayments_output_table;
+
+static size_t secp256k1_silentpayments_x_hash(const secp256k1_fe_storage *x) {
+    uint32_t h;
+    memcpy(&h, x, sizeof(h));
+    return h;
+}
+
+/* Returns whether output i of tx is valid and has the X coordinate x. */
+static int secp256k1_silentpayments_output_x_eq(const secp256k1_context *ctx, const secp256k1_silentpayments_recipient_tx *tx, size_t i, const secp256k1_fe_storage *x) {
+    secp256k1_ge ge;
+    secp256k1_fe_storage xi;
+
+    if (!secp256k1_xonly_pubkey_load(ctx, &ge, tx->outputs[i])) {
+        return 0;
+    }
+    secp256k1_fe_to_storage(&xi, &ge.x);
+    return secp256k1_memcmp_var(&xi, x, sizeof(*x)) == 0;
+}
+
+static void secp256k1_silentpayments_output_table_init(const secp256k1_context *ctx, secp256k1_silentpayments_output_table *table, const secp256k1_silentpayments_recipient_tx *tx) {
+    size_t size = 16;
+    size_t i;
+
+    table->mask = 0;
+    if (tx->n_outputs > SECP256K1_SILENTPAYMENTS_TABLE_SIZE / 2) {
+        return;
+    }
+    /* Keep the table at most half full. */
+    while (size < 2 * tx->n_outputs) {
+        size *= 2;
+    }
+    table->mask = size - 1;
+    memset(table->slots, 0, size * sizeof(table->slots[0]));
+    for (i = 0; i < tx->n_outputs; i++) {
+        secp256k1_ge ge;
+        secp256k1_fe_storage x;
+        size_t h;
+
+        if (!secp256k1_xonly_pubkey_load(ctx, &ge, tx->outputs[i])) {
+            continue;
+        }
+        secp256k1_fe_to_storage(&x, &ge.x);
+        h = secp256k1_silentpayments_x_hash(&x) & table->mask;
+        while (table->slots[h] != 0) {
+            h = (h + 1) & table->mask;
+        }
+        table->slots[h] = i + 1;
+    }
+}
+
+/* Looks up an output with the X coordinate of p and sets idx to its index. */
+static int secp256k1_silentpayments_output_table_find(const secp256k1_context *ctx, size_t *idx, const secp256k1_silentpayments_output_table *table, const secp256k1_silentpayments_recipient_tx *tx, secp256k1_ge *p) {
+    secp256k1_fe_storage x;
+    size_t h;
+
+    secp256k1_fe_normalize_var(&p->x);
+    secp256k1_fe_to_storage(&x, &p->x);
+    if (table->mask == 0) {
+        size_t i;
+        for (i = 0; i < tx->n_outputs; i++) {
+            if (secp256k1_silentpayments_output_x_eq(ctx, tx, i, &x)) {
+                *idx = i;
+                return 1;
+            }
+        }
+        return 0;
+    }
+    h = secp256k1_silentpayments_x_hash(&x) & table->mask;
+    while (table->slots[h] != 0) {
+        size_t i = table->slots[h] - 1;
+        if (secp256k1_silentpayments_output_x_eq(ctx, tx, i, &x)) {
+            *idx = i;
+            return 1;
+        }
+        h = (h + 1) & table->mask;
+    }
+    return 0;
+}
+
+int secp256k1_silentpayments_recipient_scan_block(const secp256k1_context* ctx, secp256k1_silentpayments_found_output *found_outputs, size_t *n_found_outputs, const secp256k1_silentpayments_recipient_tx * const *txs, size_t n_txs, const unsigned char *scan_key32, const secp256k1_pubkey *spend_pubkey) {
+    secp256k1_silentpayments_output_table table;
+    secp256k1_gej pj[SECP256K1_SILENTPAYMENTS_SCAN_CHUNK];
+    secp256k1_ge p[SECP256K1_SILENTPAYMENTS_SCAN_CHUNK];
+    unsigned char shared_secrets[SECP256K1_SILENTPAYMENTS_SCAN_CHUNK][33];
+    unsigned char tweaks[SECP256K1_SILENTPAYMENTS_SCAN_CHUNK][32];
+    secp256k1_ge spend_pk;
+    secp256k1_scalar scan_key;
+    size_t n_found = 0;
+    size_t i, j, n;
+    int ret = 1;
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n_found_outputs != NULL);
+    ARG_CHECK(*n_found_outputs == 0 || found_outputs != NULL);
+    ARG_CHECK(n_txs == 0 || txs != NULL);
+    ARG_CHECK(scan_key32 != NULL);
+    ARG_CHECK(spend_pubkey != NULL);
+    for (i = 0; i < n_txs; i++) {
+        ARG_CHECK(txs[i] != NULL);
+        ARG_CHECK(txs[i]->public_data != NULL);
+        ARG_CHECK(secp256k1_memcmp_var(&txs[i]->public_data->data[0], secp256k1_silentpayments_public_data_magic, 4) == 0);
+        ARG_CHECK(txs[i]->n_outputs == 0 || txs[i]->outputs != NULL);
+        for (j = 0; j < txs[i]->n_outputs; j++) {
+            ARG_CHECK(txs[i]->outputs[j] != NULL);
+        }
+    }
+    if (!secp256k1_pubkey_load(ctx, &spend_pk, spend_pubkey)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&scan_key, scan_key32, &overflow);
+    overflow |= secp256k1_scalar_is_zero(&scan_key);
+    secp256k1_declassify(ctx, &overflow, sizeof(overflow));
+    if (overflow) {
+        secp256k1_scalar_clear(&scan_key);
+        return 0;
+    }
+
+    for (i = 0; ret && i < n_txs; i += n) {
+        n = n_txs - i < SECP256K1_SILENTPAYMENTS_SCAN_CHUNK ? n_txs - i : SECP256K1_SILENTPAYMENTS_SCAN_CHUNK;
+
+        /* Compute the shared secrets input_hash*b_scan*A of the chunk. Since
+         * input_hash and b_scan are not 0, they are never infinity. */
+        for (j = 0; j < n; j++) {
+            secp256k1_ge a;
+            secp256k1_scalar d;
+
+            secp256k1_silentpayments_public_data_load(ctx, &a, &d, txs[i + j]->public_data);
+            secp256k1_scalar_mul(&d, &d, &scan_key);
+            secp256k1_ecmult_const(&pj[j], &a, &d, 256);
+            secp256k1_scalar_clear(&d);
+        }
+        secp256k1_ge_set_all_gej(p, pj, n);
+
+        /* Compute the first candidate output P_0 of every transaction. */
+        for (j = 0; j < n; j++) {
+            secp256k1_silentpayments_ge_serialize33(shared_secrets[j], &p[j]);
+            if (secp256k1_silentpayments_tweak(ctx, tweaks[j], shared_secrets[j], 0)) {
+                secp256k1_silentpayments_output(ctx, &pj[j], tweaks[j], &spend_pk);
+            } else {
+                secp256k1_gej_set_infinity(&pj[j]);
+            }
+        }
+        secp256k1_ge_set_all_gej_var(p, pj, n);
+
+        for (j = 0; ret && j < n; j++) {
+            const secp256k1_silentpayments_recipient_tx *tx = txs[i + j];
+            uint32_t k = 0;
+            size_t idx;
+
+            if (secp256k1_ge_is_infinity(&p[j]) || tx->n_outputs == 0) {
+                continue;
+            }
+            secp256k1_silentpayments_output_table_init(ctx, &table, tx);
+            while (secp256k1_silentpayments_output_table_find(ctx, &idx, &table, tx, &p[j])) {
+                secp256k1_silentpayments_found_output *found;
+
+                if (n_found == *n_found_outputs) {
+                    ret = 0;
+                    break;
+                }
+                found = &found_outputs[n_found++];
+                found->output = *tx->outputs[idx];
+                memcpy(found->tweak, tweaks[j], 32);
+                found->tx_index = i + j;
+                found->output_index = idx;
+
+                /* Another output to the recipient in the same transaction is
+                 * rare, so the following candidates are not batched. */
+                k++;
+                if (!secp256k1_silentpayments_tweak(ctx, tweaks[j], shared_secrets[j], k)) {
+                    break;
+                }
+                secp256k1_silentpayments_output(ctx, &pj[j], tweaks[j], &spend_pk);
+                secp256k1_ge_set_gej_var(&p[j], &pj[j]);
+                if (secp256k1_ge_is_infinity(&p[j])) {
+                    break;
+                }
+            }
+        }
+    }
+    *n_found_outputs = n_found;
+
+    memset(pj, 0, sizeof(pj));
+    memset(shared_secrets, 0, sizeof(shared_secrets));
+    memset(tweaks, 0, sizeof(tweaks));
+    secp256k1_scalar_clear(&scan_key);
+    return ret;
+}
+
+#endif
@@ -0,0 +1,682 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_MODULE_SILENTPAYMENTS_TESTS_H
+#define SECP256K1_MODULE_SILENTPAYMENTS_TESTS_H
+
+#include "../../../include/secp256k1_extrakeys.h"
+#include "../../../include/secp256k1_silentpayments.h"
+
+#define TEST_SILENTPAYMENTS_MAX_TXS 40
+#define TEST_SILENTPAYMENTS_MAX_INPUTS 4
+#define TEST_SILENTPAYMENTS_MAX_OUTPUTS 8
+
+/* Checks that the hashes initialized with a fixed midstate have the expected
+ * state. */
+void test_silentpayments_sha256_tagged(void) {
+    static const unsigned char tag_inputs[14] = "BIP0352/Inputs";
+    static const unsigned char tag_shared_secret[20] = "BIP0352/SharedSecret";
+    secp256k1_sha256 sha;
+    secp256k1_sha256 sha_optimized;
+
+    secp256k1_sha256_initialize_tagged(&sha, tag_inputs, sizeof(tag_inputs));
+    secp256k1_silentpayments_sha256_tagged_inputs(&sha_optimized);
+    test_sha256_eq(&sha, &sha_optimized);
+
+    secp256k1_sha256_initialize_tagged(&sha, tag_shared_secret, sizeof(tag_shared_secret));
+    secp256k1_silentpayments_sha256_tagged_shared_secret(&sha_optimized);
+    test_sha256_eq(&sha, &sha_optimized);
+}
+
+void test_silentpayments_random_seckey(unsigned char *sk32) {
+    secp256k1_scalar s;
+
+    random_scalar_order_test(&s);
+    secp256k1_scalar_get_b32(sk32, &s);
+}
+
+void test_silentpayments_random_xonly(secp256k1_xonly_pubkey *pk) {
+    unsigned char x32[32];
+
+    do {
+        secp256k1_testrand256(x32);
+    } while (!secp256k1_xonly_pubkey_parse(ctx, pk, x32));
+}
+
+/* The sender's side of a transaction to the recipient (scan_pk, spend_pk),
+ * built from the public API only. The inputs are n_xonly taproot inputs and
+ * n_plain other inputs with random secret keys. Sets the public data of the
+ * transaction, and the first n_outputs outputs to the recipient with their
+ * tweaks. */
+void test_silentpayments_send(secp256k1_silentpayments_public_data *public_data, secp256k1_xonly_pubkey *outputs, unsigned char (*tweaks)[32], size_t n_outputs, size_t n_xonly, size_t n_plain, const secp256k1_pubkey *scan_pk, const secp256k1_pubkey *spend_pk) {
+    static const unsigned char tag_inputs[14] = "BIP0352/Inputs";
+    static const unsigned char tag_shared_secret[20] = "BIP0352/SharedSecret";
+    secp256k1_xonly_pubkey xonly_pks[TEST_SILENTPAYMENTS_MAX_INPUTS];
+    secp256k1_pubkey plain_pks[TEST_SILENTPAYMENTS_MAX_INPUTS];
+    const secp256k1_xonly_pubkey *xonly_ptrs[TEST_SILENTPAYMENTS_MAX_INPUTS];
+    const secp256k1_pubkey *plain_ptrs[TEST_SILENTPAYMENTS_MAX_INPUTS];
+    secp256k1_pubkey a_pk, shared_secret, p;
+    unsigned char a[32];
+    unsigned char sk[32];
+    unsigned char buf[69];
+    unsigned char input_hash[32];
+    size_t len;
+    size_t i;
+    int first = 1;
+
+    CHECK(n_xonly <= TEST_SILENTPAYMENTS_MAX_INPUTS && n_plain <= TEST_SILENTPAYMENTS_MAX_INPUTS);
+    CHECK(n_xonly + n_plain > 0);
+    for (i = 0; i < n_xonly + n_plain; i++) {
+        test_silentpayments_random_seckey(sk);
+        if (i < n_xonly) {
+            secp256k1_keypair keypair;
+            int parity;
+
+            CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+            CHECK(secp256k1_keypair_xonly_pub(ctx, &xonly_pks[i], &parity, &keypair) == 1);
+            xonly_ptrs[i] = &xonly_pks[i];
+            if (parity) {
+                CHECK(secp256k1_ec_seckey_negate(ctx, sk) == 1);
+            }
+        } else {
+            CHECK(secp256k1_ec_pubkey_create(ctx, &plain_pks[i - n_xonly], sk) == 1);
+            plain_ptrs[i - n_xonly] = &plain_pks[i - n_xonly];
+        }
+        if (first) {
+            memcpy(a, sk, 32);
+            first = 0;
+        } else {
+            CHECK(secp256k1_ec_seckey_tweak_add(ctx, a, sk) == 1);
+        }
+    }
+
+    /* buf = outpoint || ser(A) */
+    secp256k1_testrand_bytes_test(buf, 36);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(ctx, public_data, buf, xonly_ptrs, n_xonly, plain_ptrs, n_plain) == 1);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &a_pk, a) == 1);
+    len = 33;
+    CHECK(secp256k1_ec_pubkey_serialize(ctx, &buf[36], &len, &a_pk, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(secp256k1_tagged_sha256(ctx, input_hash, tag_inputs, sizeof(tag_inputs), buf, 69) == 1);
+
+    /* shared_secret = input_hash*a*B_scan */
+    shared_secret = *scan_pk;
+    CHECK(secp256k1_ec_pubkey_tweak_mul(ctx, &shared_secret, input_hash) == 1);
+    CHECK(secp256k1_ec_pubkey_tweak_mul(ctx, &shared_secret, a) == 1);
+    len = 33;
+    CHECK(secp256k1_ec_pubkey_serialize(ctx, buf, &len, &shared_secret, SECP256K1_EC_COMPRESSED) == 1);
+    for (i = 0; i < n_outputs; i++) {
+        buf[33] = i >> 24;
+        buf[34] = i >> 16;
+        buf[35] = i >> 8;
+        buf[36] = i;
+        CHECK(secp256k1_tagged_sha256(ctx, tweaks[i], tag_shared_secret, sizeof(tag_shared_secret), buf, 37) == 1);
+        p = *spend_pk;
+        CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &p, tweaks[i]) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &outputs[i], NULL, &p) == 1);
+    }
+}
+
+/* Checks that the found output can be spent with the spend key and the tweak. */
+void test_silentpayments_check_spend(const secp256k1_silentpayments_found_output *found, const unsigned char *spend_sk) {
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    unsigned char sk[32];
+
+    memcpy(sk, spend_sk, 32);
+    CHECK(secp256k1_ec_seckey_tweak_add(ctx, sk, found->tweak) == 1);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair) == 1);
+    CHECK(secp256k1_xonly_pubkey_cmp(ctx, &pk, &found->output) == 0);
+}
+
+/* Test vectors without labels, on the receiving side. The first five are the
+ * ones of BIP352 (send_and_receive_test_vectors.json) with the same names. The
+ * others reuse their keys and outpoints for the cases of two outputs to the
+ * recipient (k = 0 and 1), a taproot input whose key has an odd Y coordinate
+ * and a script-path input with the NUMS internal key, which is not eligible but
+ * still provides the smallest outpoint. Their expected values were computed
+ * with an independent implementation of BIP352. Transaction ids are given as
+ * displayed, that is byte-reversed with respect to their serialization in
+ * outpoints. */
+void test_silentpayments_bip352_vectors(void) {
+    static const unsigned char txids[2][32] = {
+        {
+            0xF4, 0x18, 0x4F, 0xC5, 0x96, 0x40, 0x3B, 0x9D, 0x63, 0x87, 0x83, 0xCF, 0x57, 0xAD, 0xFE, 0x4C,
+            0x75, 0xC6, 0x05, 0xF6, 0x35, 0x6F, 0xBC, 0x91, 0x33, 0x85, 0x30, 0xE9, 0x83, 0x1E, 0x9E, 0x16
+        },
+        {
+            0xA1, 0x07, 0x5D, 0xB5, 0x5D, 0x41, 0x6D, 0x3C, 0xA1, 0x99, 0xF5, 0x5B, 0x60, 0x84, 0xE2, 0x11,
+            0x5B, 0x93, 0x45, 0xE1, 0x6C, 0x5C, 0xF3, 0x02, 0xFC, 0x80, 0xE9, 0xD5, 0xFB, 0xF5, 0xD4, 0x8D
+        }
+    };
+    static const unsigned char plain_pks[2][33] = {
+        {
+            0x02, 0x5A, 0x1E, 0x61, 0xF8, 0x98, 0x17, 0x30, 0x40, 0xE2, 0x06, 0x16, 0xD4, 0x3E, 0x9F, 0x49,
+            0x6F, 0xBA, 0x90, 0x33, 0x8A, 0x39, 0xFA, 0xA1, 0xED, 0x98, 0xFC, 0xBA, 0xEE, 0xE4, 0xDD, 0x9B,
+            0xE5
+        },
+        {
+            0x03, 0xBD, 0x85, 0x68, 0x5D, 0x03, 0xD1, 0x11, 0x69, 0x9B, 0x15, 0xD0, 0x46, 0x31, 0x9F, 0xEB,
+            0xE7, 0x7F, 0x8D, 0xE5, 0x28, 0x6E, 0x9E, 0x51, 0x27, 0x03, 0xCD, 0xEE, 0x1B, 0xF3, 0xBE, 0x37,
+            0x92
+        }
+    };
+    static const unsigned char xonly_pks[3][32] = {
+        {
+            0x5A, 0x1E, 0x61, 0xF8, 0x98, 0x17, 0x30, 0x40, 0xE2, 0x06, 0x16, 0xD4, 0x3E, 0x9F, 0x49, 0x6F,
+            0xBA, 0x90, 0x33, 0x8A, 0x39, 0xFA, 0xA1, 0xED, 0x98, 0xFC, 0xBA, 0xEE, 0xE4, 0xDD, 0x9B, 0xE5
+        },
+        {
+            0x78, 0x2E, 0xEB, 0x91, 0x34, 0x31, 0xCA, 0x6E, 0x9B, 0x8C, 0x2F, 0xD8, 0x0A, 0x5F, 0x72, 0xED,
+            0x20, 0x24, 0xEF, 0x72, 0xA3, 0xC6, 0xFB, 0x10, 0x26, 0x3C, 0x37, 0x99, 0x37, 0x32, 0x33, 0x38
+        },
+        {
+            0xBD, 0x85, 0x68, 0x5D, 0x03, 0xD1, 0x11, 0x69, 0x9B, 0x15, 0xD0, 0x46, 0x31, 0x9F, 0xEB, 0xE7,
+            0x7F, 0x8D, 0xE5, 0x28, 0x6E, 0x9E, 0x51, 0x27, 0x03, 0xCD, 0xEE, 0x1B, 0xF3, 0xBE, 0x37, 0x92
+        }
+    };
+    static const unsigned char scan_sk[32] = {
+        0x0F, 0x69, 0x4E, 0x06, 0x80, 0x28, 0xA7, 0x17, 0xF8, 0xAF, 0x6B, 0x94, 0x11, 0xF9, 0xA1, 0x33,
+        0xDD, 0x35, 0x65, 0x25, 0x87, 0x14, 0xCC, 0x22, 0x65, 0x94, 0xB3, 0x4D, 0xB9, 0x0C, 0x1F, 0x2C
+    };
+    static const unsigned char spend_sk[32] = {
+        0x9D, 0x6A, 0xD8, 0x55, 0xCE, 0x34, 0x17, 0xEF, 0x84, 0xE8, 0x36, 0x89, 0x2E, 0x5A, 0x56, 0x39,
+        0x2B, 0xFB, 0xA0, 0x5F, 0xA5, 0xD9, 0x7C, 0xCE, 0xA3, 0x0E, 0x26, 0x6F, 0x54, 0x0E, 0x08, 0xB3
+    };
+    /* Per vector: the inputs as (txid index, vout), the indices of the public
+     * keys of the eligible inputs in plain_pks and xonly_pks, and the number of
+     * outputs to the recipient. */
+    static const struct {
+        size_t outpoints[2][2];
+        size_t plain[2];
+        size_t n_plain;
+        size_t xonly[2];
+        size_t n_xonly;
+        size_t n_outputs;
+    } vectors[8] = {
+        /* Simple send: two inputs */
+        { { { 0, 0 }, { 1, 0 } }, { 0, 1 }, 2, { 0 }, 0, 1 },
+        /* Simple send: two inputs, order reversed */
+        { { { 1, 0 }, { 0, 0 } }, { 1, 0 }, 2, { 0 }, 0, 1 },
+        /* Simple send: two inputs from the same transaction */
+        { { { 0, 3 }, { 0, 7 } }, { 0, 1 }, 2, { 0 }, 0, 1 },
+        /* Single recipient: multiple UTXOs from the same public key */
+        { { { 0, 0 }, { 1, 0 } }, { 0, 0 }, 2, { 0 }, 0, 1 },
+        /* Single recipient: taproot only inputs with even y-values */
+        { { { 0, 0 }, { 1, 0 } }, { 0 }, 0, { 0, 1 }, 2, 1 },
+        /* Multiple outputs to the same recipient */
+        { { { 0, 0 }, { 1, 0 } }, { 0, 1 }, 2, { 0 }, 0, 2 },
+        /* Taproot input with an odd y-value (the key of plain_pks[1]) and a
+         * non-taproot input */
+        { { { 0, 0 }, { 1, 0 } }, { 0 }, 1, { 2 }, 1, 1 },
+        /* Script-path spend with the NUMS internal key at the smallest
+         * outpoint, which only contributes to the input hash */
+        { { { 0, 0 }, { 1, 0 } }, { 1 }, 1, { 0 }, 0, 1 }
+    };
+    static const unsigned char expected_outputs[8][2][32] = {
+        {
+            {
+                0x3E, 0x9F, 0xCE, 0x73, 0xD4, 0xE7, 0x7A, 0x48, 0x09, 0x90, 0x8E, 0x3C, 0x3A, 0x2E, 0x54, 0xEE,
+                0x14, 0x7B, 0x93, 0x12, 0xDC, 0x50, 0x44, 0xA1, 0x93, 0xD1, 0xFC, 0x85, 0xDE, 0x46, 0xE3, 0xC1
+            }
+        },
+        {
+            {
+                0x3E, 0x9F, 0xCE, 0x73, 0xD4, 0xE7, 0x7A, 0x48, 0x09, 0x90, 0x8E, 0x3C, 0x3A, 0x2E, 0x54, 0xEE,
+                0x14, 0x7B, 0x93, 0x12, 0xDC, 0x50, 0x44, 0xA1, 0x93, 0xD1, 0xFC, 0x85, 0xDE, 0x46, 0xE3, 0xC1
+            }
+        },
+        {
+            {
+                0x79, 0xE7, 0x1B, 0xAA, 0x2B, 0xA3, 0xFC, 0x66, 0x39, 0x6D, 0xE3, 0xA0, 0x4F, 0x16, 0x8C, 0x7B,
+                0xF2, 0x4D, 0x68, 0x70, 0xEC, 0x88, 0xCA, 0x87, 0x77, 0x54, 0x79, 0x0C, 0x1D, 0xB3, 0x57, 0xB6
+            }
+        },
+        {
+            {
+                0x54, 0x8A, 0xE5, 0x5C, 0x8E, 0xEC, 0x1E, 0x73, 0x6E, 0x8D, 0x3E, 0x52, 0x0F, 0x01, 0x1F, 0x1F,
+                0x42, 0xA5, 0x6D, 0x16, 0x61, 0x16, 0xAD, 0x21, 0x0B, 0x39, 0x37, 0x59, 0x9F, 0x87, 0xF5, 0x66
+            }
+        },
+        {
+            {
+                0xDE, 0x88, 0xBE, 0xA8, 0xE7, 0xFF, 0xC9, 0xCE, 0x1A, 0xF3, 0x0D, 0x11, 0x32, 0xF9, 0x10, 0x32,
+                0x3C, 0x50, 0x51, 0x85, 0xAE, 0xC8, 0xEA, 0xE3, 0x61, 0x67, 0x04, 0x21, 0xE7, 0x49, 0xA1, 0xFB
+            }
+        },
+        {
+            {
+                0x3E, 0x9F, 0xCE, 0x73, 0xD4, 0xE7, 0x7A, 0x48, 0x09, 0x90, 0x8E, 0x3C, 0x3A, 0x2E, 0x54, 0xEE,
+                0x14, 0x7B, 0x93, 0x12, 0xDC, 0x50, 0x44, 0xA1, 0x93, 0xD1, 0xFC, 0x85, 0xDE, 0x46, 0xE3, 0xC1
+            },
+            {
+                0x0F, 0xFE, 0x0B, 0x3D, 0x72, 0xD6, 0x6B, 0x78, 0x5E, 0x1A, 0x7A, 0xD4, 0x16, 0xED, 0xCC, 0x22,
+                0xB9, 0x51, 0x29, 0x3B, 0x15, 0x07, 0xAA, 0x04, 0x85, 0x0E, 0x89, 0x0B, 0x00, 0x2C, 0x60, 0xF1
+            }
+        },
+        {
+            {
+                0x30, 0xBC, 0xA3, 0xA8, 0xFC, 0xCD, 0x75, 0xEB, 0xEB, 0x42, 0xA4, 0x0F, 0x26, 0xF7, 0xF8, 0x3F,
+                0xAA, 0xBF, 0x4A, 0x1F, 0x8E, 0x8C, 0xBC, 0xB6, 0x2F, 0xE3, 0xC0, 0x5B, 0xB4, 0xFC, 0xFB, 0x35
+            }
+        },
+        {
+            {
+                0x34, 0xD3, 0xDF, 0xFD, 0x8D, 0x4A, 0x50, 0x90, 0xD0, 0x7B, 0x75, 0x8F, 0x3B, 0xA0, 0xDE, 0xA8,
+                0x92, 0x37, 0xC9, 0x67, 0xEE, 0x0A, 0x7A, 0x58, 0x00, 0x69, 0xBA, 0x92, 0x3E, 0x68, 0x54, 0xF3
+            }
+        }
+    };
+    static const unsigned char expected_tweaks[8][2][32] = {
+        {
+            {
+                0xF4, 0x38, 0xB4, 0x01, 0x79, 0xA3, 0xC4, 0x26, 0x2D, 0xE1, 0x29, 0x86, 0xC0, 0xE6, 0xCC, 0xE0,
+                0x63, 0x40, 0x07, 0xCD, 0xC7, 0x9C, 0x1D, 0xCD, 0x3E, 0x20, 0xB9, 0xEB, 0xC2, 0xE7, 0xEE, 0xF6
+            }
+        },
+        {
+            {
+                0xF4, 0x38, 0xB4, 0x01, 0x79, 0xA3, 0xC4, 0x26, 0x2D, 0xE1, 0x29, 0x86, 0xC0, 0xE6, 0xCC, 0xE0,
+                0x63, 0x40, 0x07, 0xCD, 0xC7, 0x9C, 0x1D, 0xCD, 0x3E, 0x20, 0xB9, 0xEB, 0xC2, 0xE7, 0xEE, 0xF6
+            }
+        },
+        {
+            {
+                0x48, 0x51, 0x45, 0x5B, 0xFB, 0xE1, 0xAB, 0x4F, 0x80, 0x15, 0x65, 0x70, 0xAA, 0x45, 0x06, 0x32,
+                0x01, 0xAA, 0x5C, 0x9E, 0x1B, 0x1D, 0xCD, 0x29, 0xF0, 0xF8, 0xC3, 0x3D, 0x10, 0xBF, 0x77, 0xAE
+            }
+        },
+        {
+            {
+                0xF0, 0x32, 0x69, 0x5E, 0x26, 0x36, 0x61, 0x9E, 0xFA, 0x52, 0x3F, 0xFF, 0xAA, 0x9E, 0xF9, 0x3C,
+                0x88, 0x02, 0x29, 0x91, 0x81, 0xFD, 0x04, 0x61, 0x91, 0x3C, 0x1B, 0x8D, 0xAF, 0x97, 0x84, 0xCD
+            }
+        },
+        {
+            {
+                0x3F, 0xB9, 0xCE, 0x5C, 0xE1, 0x74, 0x6C, 0xED, 0x10, 0x3C, 0x8E, 0xD2, 0x54, 0xE8, 0x1F, 0x66,
+                0x90, 0x76, 0x46, 0x37, 0xDD, 0xBC, 0x87, 0x6E, 0xC1, 0xF9, 0xB3, 0xDD, 0xAB, 0x77, 0x6B, 0x03
+            }
+        },
+        {
+            {
+                0xF4, 0x38, 0xB4, 0x01, 0x79, 0xA3, 0xC4, 0x26, 0x2D, 0xE1, 0x29, 0x86, 0xC0, 0xE6, 0xCC, 0xE0,
+                0x63, 0x40, 0x07, 0xCD, 0xC7, 0x9C, 0x1D, 0xCD, 0x3E, 0x20, 0xB9, 0xEB, 0xC2, 0xE7, 0xEE, 0xF6
+            },
+            {
+                0xE6, 0x06, 0xAB, 0x11, 0xD4, 0xC6, 0xC8, 0xAA, 0xA2, 0xD2, 0xAD, 0x07, 0x5D, 0x4E, 0xE1, 0xC9,
+                0x15, 0x10, 0x5C, 0x04, 0xA6, 0x4E, 0xE6, 0xF6, 0xDC, 0x4E, 0x23, 0xFF, 0xF0, 0x45, 0x31, 0xF8
+            }
+        },
+        {
+            {
+                0xBF, 0xD5, 0x40, 0xEB, 0x7C, 0xEA, 0x95, 0x03, 0x1D, 0x9C, 0xD4, 0x72, 0xB2, 0x91, 0x45, 0x0E,
+                0xF0, 0xBF, 0x1D, 0xBB, 0xC4, 0x8D, 0xA2, 0x4F, 0xAB, 0x6B, 0xC3, 0xFD, 0x66, 0x2C, 0x12, 0x8F
+            }
+        },
+        {
+            {
+                0xCA, 0x03, 0x30, 0xB0, 0x28, 0x39, 0xFB, 0x2B, 0xCE, 0xE2, 0x7F, 0x47, 0xE9, 0x5A, 0xFA, 0xC9,
+                0x22, 0x6E, 0xB2, 0x95, 0xD2, 0x3A, 0xDA, 0xE0, 0x7C, 0x4E, 0xC0, 0x68, 0x8E, 0xA8, 0xC0, 0x93
+            }
+        }
+    };
+    secp256k1_silentpayments_public_data public_data[8];
+    secp256k1_xonly_pubkey outputs[8][3];
+    const secp256k1_xonly_pubkey *output_ptrs[8][3];
+    secp256k1_silentpayments_recipient_tx txs[8];
+    const secp256k1_silentpayments_recipient_tx *tx_ptrs[8];
+    secp256k1_silentpayments_found_output found[10];
+    size_t n_found;
+    secp256k1_pubkey spend_pk;
+    size_t i, j, k;
+
+    CHECK(secp256k1_ec_pubkey_create(ctx, &spend_pk, spend_sk) == 1);
+    for (i = 0; i < 8; i++) {
+        secp256k1_pubkey plain[2];
+        secp256k1_xonly_pubkey xonly[2];
+        const secp256k1_pubkey *plain_ptrs[2];
+        const secp256k1_xonly_pubkey *xonly_ptrs[2];
+        unsigned char outpoint_smallest[36];
+
+        /* The smallest outpoint is taken by its serialization, in which both
+         * the txid and the vout are little-endian. */
+        for (j = 0; j < 2; j++) {
+            unsigned char outpoint[36];
+
+            for (k = 0; k < 32; k++) {
+                outpoint[k] = txids[vectors[i].outpoints[j][0]][31 - k];
+            }
+            for (k = 0; k < 4; k++) {
+                outpoint[32 + k] = (vectors[i].outpoints[j][1] >> (8 * k)) & 0xff;
+            }
+            if (j == 0 || secp256k1_memcmp_var(outpoint, outpoint_smallest, 36) < 0) {
+                memcpy(outpoint_smallest, outpoint, 36);
+            }
+        }
+        for (j = 0; j < vectors[i].n_plain; j++) {
+            CHECK(secp256k1_ec_pubkey_parse(ctx, &plain[j], plain_pks[vectors[i].plain[j]], 33) == 1);
+            plain_ptrs[j] = &plain[j];
+        }
+        for (j = 0; j < vectors[i].n_xonly; j++) {
+            CHECK(secp256k1_xonly_pubkey_parse(ctx, &xonly[j], xonly_pks[vectors[i].xonly[j]]) == 1);
+            xonly_ptrs[j] = &xonly[j];
+        }
+        CHECK(secp256k1_silentpayments_recipient_public_data_create(ctx, &public_data[i], outpoint_smallest, xonly_ptrs, vectors[i].n_xonly, plain_ptrs, vectors[i].n_plain) == 1);
+
+        /* The outputs to the recipient in reverse order of k, followed by an
+         * unrelated output. */
+        for (j = 0; j < vectors[i].n_outputs; j++) {
+            CHECK(secp256k1_xonly_pubkey_parse(ctx, &outputs[i][j], expected_outputs[i][vectors[i].n_outputs - 1 - j]) == 1);
+            output_ptrs[i][j] = &outputs[i][j];
+        }
+        test_silentpayments_random_xonly(&outputs[i][j]);
+        output_ptrs[i][j] = &outputs[i][j];
+        txs[i].public_data = &public_data[i];
+        txs[i].outputs = output_ptrs[i];
+        txs[i].n_outputs = vectors[i].n_outputs + 1;
+        tx_ptrs[i] = &txs[i];
+
+        n_found = 10;
+        CHECK(secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, &tx_ptrs[i], 1, scan_sk, &spend_pk) == 1);
+        CHECK(n_found == vectors[i].n_outputs);
+        for (j = 0; j < n_found; j++) {
+            CHECK(found[j].tx_index == 0);
+            CHECK(found[j].output_index == vectors[i].n_outputs - 1 - j);
+            CHECK(secp256k1_xonly_pubkey_cmp(ctx, &found[j].output, output_ptrs[i][found[j].output_index]) == 0);
+            CHECK(secp256k1_memcmp_var(found[j].tweak, expected_tweaks[i][j], 32) == 0);
+            test_silentpayments_check_spend(&found[j], spend_sk);
+        }
+    }
+
+    /* All transactions in one block */
+    n_found = 10;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, tx_ptrs, 8, scan_sk, &spend_pk) == 1);
+    CHECK(n_found == 9);
+    for (i = 0, j = 0; i < 8; i++) {
+        for (k = 0; k < vectors[i].n_outputs; k++, j++) {
+            CHECK(found[j].tx_index == i);
+            CHECK(secp256k1_memcmp_var(found[j].tweak, expected_tweaks[i][k], 32) == 0);
+        }
+    }
+}
+
+/* Scans n_txs random transactions, each paying up to three outputs to the
+ * recipient among random other outputs. */
+void test_silentpayments_scan(size_t n_txs) {
+    secp256k1_silentpayments_public_data public_data[TEST_SILENTPAYMENTS_MAX_TXS];
+    secp256k1_xonly_pubkey outputs[TEST_SILENTPAYMENTS_MAX_TXS][TEST_SILENTPAYMENTS_MAX_OUTPUTS];
+    const secp256k1_xonly_pubkey *output_ptrs[TEST_SILENTPAYMENTS_MAX_TXS][TEST_SILENTPAYMENTS_MAX_OUTPUTS];
+    secp256k1_silentpayments_recipient_tx txs[TEST_SILENTPAYMENTS_MAX_TXS];
+    const secp256k1_silentpayments_recipient_tx *tx_ptrs[TEST_SILENTPAYMENTS_MAX_TXS];
+    secp256k1_silentpayments_found_output found[3 * TEST_SILENTPAYMENTS_MAX_TXS];
+    secp256k1_silentpayments_found_output expected[3 * TEST_SILENTPAYMENTS_MAX_TXS];
+    secp256k1_pubkey scan_pk, spend_pk;
+    unsigned char scan_sk[32], spend_sk[32];
+    unsigned char other_sk[32];
+    size_t n_expected = 0;
+    size_t n_found;
+    size_t i, j;
+
+    CHECK(n_txs <= TEST_SILENTPAYMENTS_MAX_TXS);
+    test_silentpayments_random_seckey(scan_sk);
+    test_silentpayments_random_seckey(spend_sk);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &scan_pk, scan_sk) == 1);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &spend_pk, spend_sk) == 1);
+
+    for (i = 0; i < n_txs; i++) {
+        secp256k1_xonly_pubkey payments[3];
+        unsigned char tweaks[3][32];
+        size_t n_payments = secp256k1_testrand_int(4);
+        size_t n_outputs = n_payments + secp256k1_testrand_int(TEST_SILENTPAYMENTS_MAX_OUTPUTS - n_payments + 1);
+        size_t n_xonly = secp256k1_testrand_int(TEST_SILENTPAYMENTS_MAX_INPUTS + 1);
+        size_t n_plain = n_xonly == 0 ? 1 + secp256k1_testrand_int(TEST_SILENTPAYMENTS_MAX_INPUTS) : secp256k1_testrand_int(TEST_SILENTPAYMENTS_MAX_INPUTS + 1);
+        size_t k = 0;
+
+        test_silentpayments_send(&public_data[i], payments, tweaks, n_payments, n_xonly, n_plain, &scan_pk, &spend_pk);
+        /* Put the payments at random positions, in order of k */
+        for (j = 0; j < n_outputs; j++) {
+            if (k < n_payments && secp256k1_testrand_int(n_outputs - j) < n_payments - k) {
+                outputs[i][j] = payments[k];
+                expected[n_expected].output = payments[k];
+                memcpy(expected[n_expected].tweak, tweaks[k], 32);
+                expected[n_expected].tx_index = i;
+                expected[n_expected].output_index = j;
+                n_expected++;
+                k++;
+            } else {
+                test_silentpayments_random_xonly(&outputs[i][j]);
+            }
+            output_ptrs[i][j] = &outputs[i][j];
+        }
+        CHECK(k == n_payments);
+        txs[i].public_data = &public_data[i];
+        txs[i].outputs = output_ptrs[i];
+        txs[i].n_outputs = n_outputs;
+        tx_ptrs[i] = &txs[i];
+    }
+
+    n_found = sizeof(found) / sizeof(found[0]);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, tx_ptrs, n_txs, scan_sk, &spend_pk) == 1);
+    CHECK(n_found == n_expected);
+    for (i = 0; i < n_found; i++) {
+        CHECK(secp256k1_xonly_pubkey_cmp(ctx, &found[i].output, &expected[i].output) == 0);
+        CHECK(secp256k1_memcmp_var(found[i].tweak, expected[i].tweak, 32) == 0);
+        CHECK(found[i].tx_index == expected[i].tx_index);
+        CHECK(found[i].output_index == expected[i].output_index);
+        test_silentpayments_check_spend(&found[i], spend_sk);
+    }
+
+    /* Too little space for the found outputs */
+    if (n_expected > 0) {
+        n_found = n_expected - 1;
+        CHECK(secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, tx_ptrs, n_txs, scan_sk, &spend_pk) == 0);
+        CHECK(n_found == n_expected - 1);
+        for (i = 0; i < n_found; i++) {
+            CHECK(found[i].output_index == expected[i].output_index);
+        }
+    }
+
+    /* Nothing is found with another scan key */
+    test_silentpayments_random_seckey(other_sk);
+    n_found = sizeof(found) / sizeof(found[0]);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, tx_ptrs, n_txs, other_sk, &spend_pk) == 1);
+    CHECK(n_found == 0);
+}
+
+/* Scans a transaction with n_outputs outputs, of which the first three
+ * payments to the recipient are at random positions. */
+void test_silentpayments_scan_large(size_t n_outputs) {
+    secp256k1_silentpayments_public_data public_data;
+    secp256k1_xonly_pubkey *outputs = (secp256k1_xonly_pubkey *) checked_malloc(&ctx->error_callback, n_outputs * sizeof(*outputs));
+    const secp256k1_xonly_pubkey **output_ptrs = (const secp256k1_xonly_pubkey **) checked_malloc(&ctx->error_callback, n_outputs * sizeof(*output_ptrs));
+    secp256k1_silentpayments_recipient_tx tx;
+    const secp256k1_silentpayments_recipient_tx *tx_ptr = &tx;
+    secp256k1_silentpayments_found_output found[4];
+    secp256k1_xonly_pubkey payments[3];
+    unsigned char tweaks[3][32];
+    size_t positions[3];
+    secp256k1_pubkey scan_pk, spend_pk;
+    unsigned char scan_sk[32], spend_sk[32];
+    size_t n_found;
+    size_t i;
+
+    test_silentpayments_random_seckey(scan_sk);
+    test_silentpayments_random_seckey(spend_sk);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &scan_pk, scan_sk) == 1);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &spend_pk, spend_sk) == 1);
+    test_silentpayments_send(&public_data, payments, tweaks, 3, 1, 1, &scan_pk, &spend_pk);
+    for (i = 0; i < n_outputs; i++) {
+        test_silentpayments_random_xonly(&outputs[i]);
+        output_ptrs[i] = &outputs[i];
+    }
+    /* The last payment comes first, so that the outputs are not in order of k. */
+    positions[2] = 0;
+    positions[0] = 1 + secp256k1_testrand_int(n_outputs - 2);
+    positions[1] = n_outputs - 1;
+    for (i = 0; i < 3; i++) {
+        outputs[positions[i]] = payments[i];
+    }
+    tx.public_data = &public_data;
+    tx.outputs = output_ptrs;
+    tx.n_outputs = n_outputs;
+
+    n_found = 4;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, &tx_ptr, 1, scan_sk, &spend_pk) == 1);
+    CHECK(n_found == 3);
+    for (i = 0; i < 3; i++) {
+        CHECK(secp256k1_memcmp_var(found[i].tweak, tweaks[i], 32) == 0);
+        CHECK(found[i].tx_index == 0);
+        CHECK(found[i].output_index == positions[i]);
+        test_silentpayments_check_spend(&found[i], spend_sk);
+    }
+
+    free(output_ptrs);
+    free(outputs);
+}
+
+void test_silentpayments_api(void) {
+    secp256k1_silentpayments_public_data public_data;
+    secp256k1_silentpayments_public_data invalid_public_data;
+    secp256k1_xonly_pubkey xonly_pk;
+    secp256k1_pubkey pk, pk_neg, invalid_pk;
+    secp256k1_keypair keypair;
+    const secp256k1_xonly_pubkey *xonly_ptrs[2];
+    const secp256k1_pubkey *plain_ptrs[2];
+    const secp256k1_xonly_pubkey *output_ptrs[1];
+    secp256k1_silentpayments_recipient_tx tx;
+    const secp256k1_silentpayments_recipient_tx *tx_ptrs[1];
+    secp256k1_silentpayments_found_output found[1];
+    unsigned char outpoint[36];
+    unsigned char sk[32];
+    unsigned char buf[33];
+    unsigned char zeros32[32] = { 0 };
+    unsigned char overflow32[32];
+    size_t n_found;
+    int ecount = 0;
+    secp256k1_context *none = api_test_context(SECP256K1_CONTEXT_NONE, &ecount);
+    secp256k1_context *vrfy = api_test_context(SECP256K1_CONTEXT_VERIFY, &ecount);
+
+    secp256k1_testrand256(outpoint);
+    memset(overflow32, 0xFF, sizeof(overflow32));
+    test_silentpayments_random_seckey(sk);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk) == 1);
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &xonly_pk, NULL, &keypair) == 1);
+    /* pk is the point of xonly_pk and pk_neg its negation */
+    CHECK(secp256k1_xonly_pubkey_serialize(ctx, &buf[1], &xonly_pk) == 1);
+    buf[0] = SECP256K1_TAG_PUBKEY_EVEN;
+    CHECK(secp256k1_ec_pubkey_parse(ctx, &pk, buf, sizeof(buf)) == 1);
+    buf[0] = SECP256K1_TAG_PUBKEY_ODD;
+    CHECK(secp256k1_ec_pubkey_parse(ctx, &pk_neg, buf, sizeof(buf)) == 1);
+    memset(&invalid_pk, 0, sizeof(invalid_pk));
+    xonly_ptrs[0] = &xonly_pk;
+    xonly_ptrs[1] = NULL;
+    plain_ptrs[0] = &pk;
+    plain_ptrs[1] = NULL;
+
+    /* public_data_create */
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &public_data, outpoint, xonly_ptrs, 1, plain_ptrs, 1) == 1);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, NULL, outpoint, xonly_ptrs, 1, plain_ptrs, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, NULL, xonly_ptrs, 1, plain_ptrs, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_memcmp_var(&invalid_public_data, zeros32, 32) == 0);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, NULL, 1, plain_ptrs, 1) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, xonly_ptrs, 1, NULL, 1) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, xonly_ptrs, 2, plain_ptrs, 1) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, xonly_ptrs, 1, plain_ptrs, 2) == 0);
+    CHECK(ecount == 6);
+    plain_ptrs[1] = &invalid_pk;
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, xonly_ptrs, 1, plain_ptrs, 2) == 0);
+    CHECK(ecount == 7);
+    /* No inputs, or inputs that sum to infinity */
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, NULL, 0, NULL, 0) == 0);
+    plain_ptrs[1] = &pk_neg;
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, xonly_ptrs, 1, &plain_ptrs[1], 1) == 0);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, NULL, 0, plain_ptrs, 2) == 0);
+    CHECK(secp256k1_silentpayments_recipient_public_data_create(none, &invalid_public_data, outpoint, xonly_ptrs, 1, NULL, 0) == 1);
+    CHECK(ecount == 7);
+    memset(&invalid_public_data, 0, sizeof(invalid_public_data));
+
+    /* scan_block */
+    output_ptrs[0] = &xonly_pk;
+    tx.public_data = &public_data;
+    tx.outputs = output_ptrs;
+    tx.n_outputs = 1;
+    tx_ptrs[0] = &tx;
+    ecount = 0;
+    n_found = 1;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 1);
+    CHECK(n_found == 0);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(none, found, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, NULL, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 2);
+    n_found = 1;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, NULL, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 3);
+    n_found = 0;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, NULL, &n_found, tx_ptrs, 1, sk, &pk) == 1);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, NULL, 1, sk, &pk) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, NULL, 0, sk, &pk) == 1);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, NULL, &pk) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &invalid_pk) == 0);
+    CHECK(ecount == 7);
+    tx.public_data = &invalid_public_data;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 8);
+    tx.public_data = NULL;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 9);
+    tx.public_data = &public_data;
+    tx.outputs = NULL;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 10);
+    tx.n_outputs = 0;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 1);
+    tx.outputs = output_ptrs;
+    tx.n_outputs = 1;
+    output_ptrs[0] = NULL;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 11);
+    output_ptrs[0] = &xonly_pk;
+    tx_ptrs[0] = NULL;
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, sk, &pk) == 0);
+    CHECK(ecount == 12);
+    tx_ptrs[0] = &tx;
+    /* Invalid scan keys */
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, zeros32, &pk) == 0);
+    CHECK(secp256k1_silentpayments_recipient_scan_block(vrfy, found, &n_found, tx_ptrs, 1, overflow32, &pk) == 0);
+    CHECK(ecount == 12);
+
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(vrfy);
+}
+
+void run_silentpayments_tests(void) {
+    int i;
+
+    test_silentpayments_sha256_tagged();
+    test_silentpayments_bip352_vectors();
+    test_silentpayments_api();
+    for (i = 0; i < count; i++) {
+        test_silentpayments_scan(secp256k1_testrand_int(10));
+    }
+    /* More than one chunk */
+    test_silentpayments_scan(TEST_SILENTPAYMENTS_MAX_TXS);
+    /* The largest transaction that fits in the hash table, and the smallest
+     * one that is searched linearly. */
+    test_silentpayments_scan_large(SECP256K1_SILENTPAYMENTS_TABLE_SIZE / 2);
+    test_silentpayments_scan_large(SECP256K1_SILENTPAYMENTS_TABLE_SIZE / 2 + 1);
+}
+
+#endif
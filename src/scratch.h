@@ -7,21 +7,55 @@
 #ifndef SECP256K1_SCRATCH_H
 #define SECP256K1_SCRATCH_H
 
+/** A contiguous block of memory from which scratch allocations are carved. */
+typedef struct secp256k1_scratch_chunk_struct {
+    /** actual allocated data */
+    void *data;
+    /** size of data */
+    size_t size;
+    /** logical offset (see alloc_size below) corresponding to data[0] */
+    size_t base;
+    /** number of bytes allocated in earlier chunks when this one became current */
+    size_t live_before;
+    /** the chunk to move to when this one is full (NULL if none was allocated yet) */
+    struct secp256k1_scratch_chunk_struct *next;
+} secp256k1_scratch_chunk;
+
 /* The typedef is used internally; the struct name is used in the public API
  * (where it is exposed as a different typedef) */
 typedef struct secp256k1_scratch_space_struct {
     /** guard against interpreting this object as other types */
     unsigned char magic[8];
-    /** actual allocated data */
-    void *data;
-    /** amount that has been allocated (i.e. `data + offset` is the next
-     *  available pointer)  */
+    /** the chunk that is allocated together with this object */
+    secp256k1_scratch_chunk first;
+    /** the chunk allocations are currently taken from */
+    secp256k1_scratch_chunk *current;
+    /** logical offset of the next allocation. It only increases until a
+     *  checkpoint is applied, and it is what checkpoints consist of. Unused
+     *  space at the end of a chunk that had to be left is counted too. */
     size_t alloc_size;
-    /** maximum size available to allocate */
+    /** number of bytes currently allocated (alloc_size without unused space
+     *  at the end of chunks) */
+    size_t live_size;
+    /** maximum number of bytes that can be allocated at the same time */
     size_t max_size;
+    /** whether further chunks are allocated when the current one is full */
+    int growable;
+    /** highest value live_size ever had */
+    size_t peak_size;
+    /** number of batches the last ecmult_multi call using this scratch space
+     *  was split into (0 if it did not use the scratch space) */
+    size_t last_n_batches;
+    /** functions that allocated this object (alloc == NULL means malloc) */
+    secp256k1_allocator allocator;
 } secp256k1_scratch;
 
-static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, size_t max_size);
+/** Creates a scratch space in memory obtained from allocator (or from malloc if allocator is NULL). */
+static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, const secp256k1_allocator* allocator, size_t max_size);
+
+/** Creates a scratch space that initially holds initial_size bytes and allocates further
+ *  chunks on demand, as long as no more than max_size bytes are allocated at the same time. */
+static secp256k1_scratch* secp256k1_scratch_create_growable(const secp256k1_callback* error_callback, const secp256k1_allocator* allocator, size_t initial_size, size_t max_size);
 
 static void secp256k1_scratch_destroy(const secp256k1_callback* error_callback, secp256k1_scratch* scratch);
 
@@ -36,6 +70,9 @@ static void secp256k1_scratch_apply_checkpoint(const secp256k1_callback* error_c
 /** Returns the maximum allocation the scratch space will allow */
 static size_t secp256k1_scratch_max_allocation(const secp256k1_callback* error_callback, const secp256k1_scratch* scratch, size_t n_objects);
 
+/** Returns the total size of the chunks held by a scratch space */
+static size_t secp256k1_scratch_capacity(const secp256k1_scratch* scratch);
+
 /** Returns a pointer into the most recently allocated frame, or NULL if there is insufficient available space */
 static void *secp256k1_scratch_alloc(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, size_t n);
 
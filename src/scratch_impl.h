@@ -10,28 +10,60 @@
 #include "util.h"
 #include "scratch.h"
 
-static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, size_t size) {
+static secp256k1_scratch* secp256k1_scratch_create_growable(const secp256k1_callback* error_callback, const secp256k1_allocator* allocator, size_t initial_size, size_t max_size) {
     const size_t base_alloc = ROUND_TO_ALIGN(sizeof(secp256k1_scratch));
-    void *alloc = checked_malloc(error_callback, base_alloc + size);
-    secp256k1_scratch* ret = (secp256k1_scratch *)alloc;
+    void *alloc;
+    secp256k1_scratch* ret;
+    if (initial_size > SIZE_MAX - base_alloc) {
+        return NULL;
+    }
+    alloc = checked_alloc(allocator, error_callback, base_alloc + initial_size);
+    ret = (secp256k1_scratch *)alloc;
     if (ret != NULL) {
         memset(ret, 0, sizeof(*ret));
         memcpy(ret->magic, "scratch", 8);
-        ret->data = (void *) ((char *) alloc + base_alloc);
-        ret->max_size = size;
+        ret->first.data = (void *) ((char *) alloc + base_alloc);
+        ret->first.size = initial_size;
+        ret->current = &ret->first;
+        ret->max_size = max_size;
+        ret->growable = 1;
+        if (allocator != NULL) {
+            ret->allocator = *allocator;
+        }
     }
     return ret;
 }
 
+static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, const secp256k1_allocator* allocator, size_t size) {
+    secp256k1_scratch* ret = secp256k1_scratch_create_growable(error_callback, allocator, size, size);
+    if (ret != NULL) {
+        ret->growable = 0;
+    }
+    return ret;
+}
+
+/* Releases chunk and all chunks following it. */
+static void secp256k1_scratch_free_chunks(secp256k1_scratch* scratch, secp256k1_scratch_chunk *chunk) {
+    while (chunk != NULL) {
+        secp256k1_scratch_chunk *next = chunk->next;
+        secp256k1_dealloc(&scratch->allocator, chunk);
+        chunk = next;
+    }
+}
+
 static void secp256k1_scratch_destroy(const secp256k1_callback* error_callback, secp256k1_scratch* scratch) {
     if (scratch != NULL) {
+        secp256k1_allocator allocator;
         VERIFY_CHECK(scratch->alloc_size == 0); /* all checkpoints should be applied */
         if (secp256k1_memcmp_var(scratch->magic, "scratch", 8) != 0) {
             secp256k1_callback_call(error_callback, "invalid scratch space");
             return;
         }
+        secp256k1_scratch_free_chunks(scratch, scratch->first.next);
         memset(scratch->magic, 0, sizeof(scratch->magic));
-        free(scratch);
+        /* The allocator lives in the memory being released. */
+        allocator = scratch->allocator;
+        secp256k1_dealloc(&allocator, scratch);
     }
 }
 
@@ -44,6 +76,7 @@ static size_t secp256k1_scratch_checkpoint(const secp256k1_callback* error_callb
 }
 
 static void secp256k1_scratch_apply_checkpoint(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, size_t checkpoint) {
+    secp256k1_scratch_chunk *chunk;
     if (secp256k1_memcmp_var(scratch->magic, "scratch", 8) != 0) {
         secp256k1_callback_call(error_callback, "invalid scratch space");
         return;
@@ -52,7 +85,15 @@ static void secp256k1_scratch_apply_checkpoint(const secp256k1_callback* error_c
         secp256k1_callback_call(error_callback, "invalid checkpoint");
         return;
     }
+    /* Find the chunk the checkpoint was taken in. Chunks after the current one
+     * are kept, to be reused by later allocations. */
+    chunk = &scratch->first;
+    while (chunk != scratch->current && checkpoint > chunk->base + chunk->size) {
+        chunk = chunk->next;
+    }
+    scratch->current = chunk;
     scratch->alloc_size = checkpoint;
+    scratch->live_size = chunk->live_before + (checkpoint - chunk->base);
 }
 
 static size_t secp256k1_scratch_max_allocation(const secp256k1_callback* error_callback, const secp256k1_scratch* scratch, size_t objects) {
@@ -64,15 +105,56 @@ static size_t secp256k1_scratch_max_allocation(const secp256k1_callback* error_c
     if (ALIGNMENT > 1 && objects > SIZE_MAX/(ALIGNMENT - 1)) {
         return 0;
     }
-    if (scratch->max_size - scratch->alloc_size <= objects * (ALIGNMENT - 1)) {
+    /* A growable scratch space sizes new chunks to fit the allocation that
+     * needs them, so the space at the end of the current chunk is never
+     * needed to satisfy an allocation that fits the limit. */
+    if (scratch->max_size - scratch->live_size <= objects * (ALIGNMENT - 1)) {
         return 0;
     }
-    return scratch->max_size - scratch->alloc_size - objects * (ALIGNMENT - 1);
+    return scratch->max_size - scratch->live_size - objects * (ALIGNMENT - 1);
+}
+
+/* Makes a chunk with at least size bytes the current one, reusing the chunk
+ * after the current one if it is large enough. Returns 0 on allocation failure. */
+static int secp256k1_scratch_grow(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, size_t size) {
+    const size_t base_alloc = ROUND_TO_ALIGN(sizeof(secp256k1_scratch_chunk));
+    secp256k1_scratch_chunk *cur = scratch->current;
+    secp256k1_scratch_chunk *next = cur->next;
+    if (next == NULL || next->size < size) {
+        /* Double the chunk size each time, but do not exceed what the limit can
+         * still make use of. */
+        size_t chunk_size = cur->size > SIZE_MAX / 2 ? SIZE_MAX : 2 * cur->size;
+        if (chunk_size > scratch->max_size - scratch->live_size) {
+            chunk_size = scratch->max_size - scratch->live_size;
+        }
+        if (chunk_size < size) {
+            chunk_size = size;
+        }
+        if (chunk_size > SIZE_MAX - base_alloc) {
+            return 0;
+        }
+        secp256k1_scratch_free_chunks(scratch, next);
+        cur->next = NULL;
+        next = (secp256k1_scratch_chunk *)checked_alloc(&scratch->allocator, error_callback, base_alloc + chunk_size);
+        if (next == NULL) {
+            return 0;
+        }
+        memset(next, 0, sizeof(*next));
+        next->data = (void *) ((char *) next + base_alloc);
+        next->size = chunk_size;
+        cur->next = next;
+    }
+    next->base = cur->base + cur->size;
+    next->live_before = scratch->live_size;
+    scratch->current = next;
+    scratch->alloc_size = next->base;
+    return 1;
 }
 
 static void *secp256k1_scratch_alloc(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, size_t size) {
     void *ret;
     size_t rounded_size;
+    size_t offset;
 
     rounded_size = ROUND_TO_ALIGN(size);
     /* Check that rounding did not wrap around */
@@ -86,13 +168,34 @@ static void *secp256k1_scratch_alloc(const secp256k1_callback* error_callback, s
         return NULL;
     }
 
-    if (size > scratch->max_size - scratch->alloc_size) {
+    if (size > scratch->max_size - scratch->live_size) {
         return NULL;
     }
-    ret = (void *) ((char *) scratch->data + scratch->alloc_size);
+    offset = scratch->alloc_size - scratch->current->base;
+    if (size > scratch->current->size - offset) {
+        if (!scratch->growable || !secp256k1_scratch_grow(error_callback, scratch, size)) {
+            return NULL;
+        }
+        offset = 0;
+    }
+    ret = (void *) ((char *) scratch->current->data + offset);
     memset(ret, 0, size);
     scratch->alloc_size += size;
+    scratch->live_size += size;
+    if (scratch->live_size > scratch->peak_size) {
+        scratch->peak_size = scratch->live_size;
+    }
+
+    return ret;
+}
 
+static size_t secp256k1_scratch_capacity(const secp256k1_scratch* scratch) {
+    const secp256k1_scratch_chunk *chunk = &scratch->first;
+    size_t ret = 0;
+    while (chunk != NULL) {
+        ret += chunk->size;
+        chunk = chunk->next;
+    }
     return ret;
 }
 
@@ -21,7 +21,9 @@
 #include "eckey_impl.h"
 #include "hash_impl.h"
 #include "scratch_impl.h"
+#include "sigcache_impl.h"
 #include "selftest.h"
+#include "hsort_impl.h"
 
 #ifdef SECP256K1_NO_BUILD
 # error "secp256k1.h processed without SECP256K1_BUILD defined while building secp256k1.c"
@@ -77,14 +79,23 @@ struct secp256k1_context_struct {
     secp256k1_ecmult_gen_context ecmult_gen_ctx;
     secp256k1_callback illegal_callback;
     secp256k1_callback error_callback;
+    secp256k1_allocator allocator;
     int declassify;
 };
 
+struct secp256k1_signing_session_struct {
+    const secp256k1_context *ctx;
+    secp256k1_ecmult_gen_blinding blinding;
+    secp256k1_callback illegal_callback;
+    secp256k1_callback error_callback;
+};
+
 static const secp256k1_context secp256k1_context_no_precomp_ = {
     { 0 },
     { 0 },
     { secp256k1_default_illegal_callback_fn, 0 },
     { secp256k1_default_error_callback_fn, 0 },
+    { 0, 0, 0 },
     0
 };
 const secp256k1_context *secp256k1_context_no_precomp = &secp256k1_context_no_precomp_;
@@ -115,7 +126,7 @@ size_t secp256k1_context_preallocated_clone_size(const secp256k1_context* ctx) {
     if (secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx)) {
         ret += SECP256K1_ECMULT_GEN_CONTEXT_PREALLOCATED_SIZE;
     }
-    if (secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx)) {
+    if (secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx) && !secp256k1_ecmult_context_is_external(&ctx->ecmult_ctx)) {
         ret += SECP256K1_ECMULT_CONTEXT_PREALLOCATED_SIZE;
     }
     return ret;
@@ -138,6 +149,7 @@ secp256k1_context* secp256k1_context_preallocated_create(void* prealloc, unsigne
     ret = (secp256k1_context*)manual_alloc(&prealloc, sizeof(secp256k1_context), base, prealloc_size);
     ret->illegal_callback = default_illegal_callback;
     ret->error_callback = default_error_callback;
+    memset(&ret->allocator, 0, sizeof(ret->allocator));
 
     secp256k1_ecmult_context_init(&ret->ecmult_ctx);
     secp256k1_ecmult_gen_context_init(&ret->ecmult_gen_ctx);
@@ -155,17 +167,57 @@ secp256k1_context* secp256k1_context_preallocated_create(void* prealloc, unsigne
     return (secp256k1_context*) ret;
 }
 
-secp256k1_context* secp256k1_context_create(unsigned int flags) {
+static secp256k1_context* secp256k1_context_create_helper(unsigned int flags, const secp256k1_allocator *allocator) {
     size_t const prealloc_size = secp256k1_context_preallocated_size(flags);
-    secp256k1_context* ctx = (secp256k1_context*)checked_malloc(&default_error_callback, prealloc_size);
+    secp256k1_context* ctx;
+    if (prealloc_size == 0) {
+        return NULL;
+    }
+    ctx = (secp256k1_context*)checked_alloc(allocator, &default_error_callback, prealloc_size);
+    if (EXPECT(ctx == NULL, 0)) {
+        return NULL;
+    }
     if (EXPECT(secp256k1_context_preallocated_create(ctx, flags) == NULL, 0)) {
-        free(ctx);
+        secp256k1_dealloc(allocator, ctx);
         return NULL;
     }
+    if (allocator != NULL) {
+        ctx->allocator = *allocator;
+    }
 
     return ctx;
 }
 
+secp256k1_context* secp256k1_context_create(unsigned int flags) {
+    return secp256k1_context_create_helper(flags, NULL);
+}
+
+secp256k1_context* secp256k1_context_create_with_allocator(unsigned int flags, const secp256k1_allocator *allocator) {
+    if (EXPECT(allocator == NULL || allocator->alloc == NULL || allocator->free == NULL, 0)) {
+        secp256k1_callback_call(&default_illegal_callback, "allocator != NULL && allocator->alloc != NULL && allocator->free != NULL");
+        return NULL;
+    }
+    return secp256k1_context_create_helper(flags, allocator);
+}
+
+secp256k1_context* secp256k1_context_create_with_ecmult_table(unsigned int flags, const void *table, size_t tablelen) {
+    secp256k1_context* ctx;
+    if (EXPECT(table == NULL, 0)) {
+        secp256k1_callback_call(&default_illegal_callback, "table != NULL");
+        return NULL;
+    }
+    /* The verification tables are not computed but taken from the table image. */
+    ctx = secp256k1_context_create(flags & ~SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+    if (ctx == NULL) {
+        return NULL;
+    }
+    if (!secp256k1_ecmult_context_set_table(&ctx->ecmult_ctx, (const unsigned char*)table, tablelen)) {
+        secp256k1_context_destroy(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
 secp256k1_context* secp256k1_context_preallocated_clone(const secp256k1_context* ctx, void* prealloc) {
     size_t prealloc_size;
     secp256k1_context* ret;
@@ -186,7 +238,10 @@ secp256k1_context* secp256k1_context_clone(const secp256k1_context* ctx) {
 
     VERIFY_CHECK(ctx != NULL);
     prealloc_size = secp256k1_context_preallocated_clone_size(ctx);
-    ret = (secp256k1_context*)checked_malloc(&ctx->error_callback, prealloc_size);
+    ret = (secp256k1_context*)checked_alloc(&ctx->allocator, &ctx->error_callback, prealloc_size);
+    if (EXPECT(ret == NULL, 0)) {
+        return NULL;
+    }
     ret = secp256k1_context_preallocated_clone(ctx, ret);
     return ret;
 }
@@ -201,8 +256,10 @@ void secp256k1_context_preallocated_destroy(secp256k1_context* ctx) {
 
 void secp256k1_context_destroy(secp256k1_context* ctx) {
     if (ctx != NULL) {
+        /* The allocator lives in the memory being released. */
+        secp256k1_allocator allocator = ctx->allocator;
         secp256k1_context_preallocated_destroy(ctx);
-        free(ctx);
+        secp256k1_dealloc(&allocator, ctx);
     }
 }
 
@@ -226,7 +283,27 @@ void secp256k1_context_set_error_callback(secp256k1_context* ctx, void (*fun)(co
 
 secp256k1_scratch_space* secp256k1_scratch_space_create(const secp256k1_context* ctx, size_t max_size) {
     VERIFY_CHECK(ctx != NULL);
-    return secp256k1_scratch_create(&ctx->error_callback, max_size);
+    return secp256k1_scratch_create(&ctx->error_callback, &ctx->allocator, max_size);
+}
+
+secp256k1_scratch_space* secp256k1_scratch_space_create_growable(const secp256k1_context* ctx, size_t initial_size, size_t max_size) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(initial_size <= max_size);
+    return secp256k1_scratch_create_growable(&ctx->error_callback, &ctx->allocator, initial_size, max_size);
+}
+
+int secp256k1_scratch_space_get_stats(const secp256k1_context* ctx, const secp256k1_scratch_space* scratch, secp256k1_scratch_space_stats *stats) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(stats != NULL);
+    if (secp256k1_memcmp_var(scratch->magic, "scratch", 8) != 0) {
+        secp256k1_callback_call(&ctx->error_callback, "invalid scratch space");
+        return 0;
+    }
+    stats->peak_usage = scratch->peak_size;
+    stats->capacity = secp256k1_scratch_capacity(scratch);
+    stats->last_n_batches = scratch->last_n_batches;
+    return 1;
 }
 
 void secp256k1_scratch_space_destroy(const secp256k1_context *ctx, secp256k1_scratch_space* scratch) {
@@ -299,6 +376,189 @@ int secp256k1_ec_pubkey_parse(const secp256k1_context* ctx, secp256k1_pubkey* pu
     return 1;
 }
 
+int secp256k1_ec_pubkey_parse_batch(const secp256k1_context* ctx, secp256k1_pubkey* pubkeys, int *results, const unsigned char *input, size_t inputlen, size_t n_pubkeys) {
+    secp256k1_ge Q[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe x[SECP256K1_FE_SQRT_LANES];
+    int odd[SECP256K1_FE_SQRT_LANES];
+    int valid[SECP256K1_FE_SQRT_LANES];
+    int ret = 1;
+    size_t i;
+    int k;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_pubkeys == 0 || pubkeys != NULL);
+    ARG_CHECK(n_pubkeys == 0 || input != NULL);
+
+    for (i = 0; i < n_pubkeys; i += SECP256K1_FE_SQRT_LANES) {
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            const unsigned char *pub;
+            valid[k] = 0;
+            odd[k] = 0;
+            x[k] = secp256k1_fe_one;
+            if (i + k >= n_pubkeys) {
+                continue;
+            }
+            pub = input + (i + k) * inputlen;
+            memset(&pubkeys[i + k], 0, sizeof(pubkeys[i + k]));
+            if (inputlen == 33) {
+                /* Only check the header and X coordinate here, and decompress the
+                 * keys of all lanes below. */
+                if ((pub[0] == SECP256K1_TAG_PUBKEY_EVEN || pub[0] == SECP256K1_TAG_PUBKEY_ODD) && secp256k1_fe_set_b32(&x[k], pub + 1)) {
+                    valid[k] = 1;
+                    odd[k] = pub[0] == SECP256K1_TAG_PUBKEY_ODD;
+                } else {
+                    x[k] = secp256k1_fe_one;
+                }
+            } else {
+                valid[k] = secp256k1_eckey_pubkey_parse(&Q[k], pub, inputlen);
+            }
+        }
+        if (inputlen == 33) {
+            int sqrt_ok[SECP256K1_FE_SQRT_LANES];
+            secp256k1_ge_set_xo_var_lanes(sqrt_ok, Q, x, odd);
+            for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+                valid[k] &= sqrt_ok[k];
+            }
+        }
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES && i + k < n_pubkeys; k++) {
+            if (valid[k] && !secp256k1_ge_is_in_correct_subgroup(&Q[k])) {
+                valid[k] = 0;
+            }
+            if (valid[k]) {
+                secp256k1_pubkey_save(&pubkeys[i + k], &Q[k]);
+            }
+            if (results != NULL) {
+                results[i + k] = valid[k];
+            }
+            ret &= valid[k];
+        }
+    }
+    memset(Q, 0, sizeof(Q));
+    return ret;
+}
+
+/* A compressed pubkey object holds the 33-byte compressed encoding of the key. */
+static int secp256k1_compressed_pubkey_load(const secp256k1_context* ctx, secp256k1_ge* ge, const secp256k1_compressed_pubkey* pubkey) {
+    int ret = secp256k1_eckey_pubkey_parse(ge, pubkey->data, sizeof(pubkey->data));
+    ARG_CHECK(ret);
+    return 1;
+}
+
+static void secp256k1_compressed_pubkey_save(secp256k1_compressed_pubkey* pubkey, secp256k1_ge* ge) {
+    size_t len = sizeof(pubkey->data);
+    int ret = secp256k1_eckey_pubkey_serialize(ge, pubkey->data, &len, 1);
+    VERIFY_CHECK(ret && len == sizeof(pubkey->data));
+    (void)ret;
+}
+
+int secp256k1_compressed_pubkey_parse(const secp256k1_context* ctx, secp256k1_compressed_pubkey* pubkey, const unsigned char *input, size_t inputlen) {
+    secp256k1_ge Q;
+    secp256k1_fe x;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ARG_CHECK(input != NULL);
+    if (inputlen == 33 && (input[0] == SECP256K1_TAG_PUBKEY_EVEN || input[0] == SECP256K1_TAG_PUBKEY_ODD)) {
+        /* The encoding is stored as is, so it suffices to check that X is valid. */
+        if (!secp256k1_fe_set_b32(&x, input + 1) || !secp256k1_ge_x_on_curve_var(&x)) {
+            return 0;
+        }
+        memcpy(pubkey->data, input, 33);
+        return 1;
+    }
+    if (!secp256k1_eckey_pubkey_parse(&Q, input, inputlen)) {
+        return 0;
+    }
+    if (!secp256k1_ge_is_in_correct_subgroup(&Q)) {
+        return 0;
+    }
+    secp256k1_compressed_pubkey_save(pubkey, &Q);
+    secp256k1_ge_clear(&Q);
+    return 1;
+}
+
+int secp256k1_compressed_pubkey_serialize(const secp256k1_context* ctx, unsigned char *output33, const secp256k1_compressed_pubkey* pubkey) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(output33 != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    memcpy(output33, pubkey->data, 33);
+    return 1;
+}
+
+int secp256k1_compressed_pubkey_from_pubkey(const secp256k1_context* ctx, secp256k1_compressed_pubkey *compressed, const secp256k1_pubkey *pubkey) {
+    secp256k1_ge Q;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(compressed != NULL);
+    memset(compressed, 0, sizeof(*compressed));
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_pubkey_load(ctx, &Q, pubkey)) {
+        return 0;
+    }
+    secp256k1_compressed_pubkey_save(compressed, &Q);
+    return 1;
+}
+
+int secp256k1_compressed_pubkey_decompress(const secp256k1_context* ctx, secp256k1_pubkey *pubkey, const secp256k1_compressed_pubkey *compressed) {
+    secp256k1_ge Q;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ARG_CHECK(compressed != NULL);
+
+    if (!secp256k1_compressed_pubkey_load(ctx, &Q, compressed)) {
+        return 0;
+    }
+    secp256k1_pubkey_save(pubkey, &Q);
+    return 1;
+}
+
+int secp256k1_compressed_pubkey_decompress_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, const secp256k1_compressed_pubkey *compressed, size_t n_pubkeys) {
+    secp256k1_ge Q[SECP256K1_FE_SQRT_LANES];
+    secp256k1_fe x[SECP256K1_FE_SQRT_LANES];
+    int odd[SECP256K1_FE_SQRT_LANES];
+    int valid[SECP256K1_FE_SQRT_LANES];
+    int ret = 1;
+    size_t i;
+    int k;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_pubkeys == 0 || pubkeys != NULL);
+    ARG_CHECK(n_pubkeys == 0 || compressed != NULL);
+
+    for (i = 0; i < n_pubkeys; i += SECP256K1_FE_SQRT_LANES) {
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            const unsigned char *data;
+            odd[k] = 0;
+            x[k] = secp256k1_fe_one;
+            if (i + k >= n_pubkeys) {
+                continue;
+            }
+            data = compressed[i + k].data;
+            memset(&pubkeys[i + k], 0, sizeof(pubkeys[i + k]));
+            odd[k] = data[0] == SECP256K1_TAG_PUBKEY_ODD;
+            if (!(data[0] == SECP256K1_TAG_PUBKEY_EVEN || odd[k]) || !secp256k1_fe_set_b32(&x[k], data + 1)) {
+                x[k] = secp256k1_fe_one;
+                ret = 0;
+            }
+        }
+        secp256k1_ge_set_xo_var_lanes(valid, Q, x, odd);
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES && i + k < n_pubkeys; k++) {
+            if (valid[k]) {
+                secp256k1_pubkey_save(&pubkeys[i + k], &Q[k]);
+            }
+            ret &= valid[k];
+        }
+    }
+    /* Compressed pubkey objects are valid unless they were not initialized. */
+    ARG_CHECK(ret);
+    return 1;
+}
+
 int secp256k1_ec_pubkey_serialize(const secp256k1_context* ctx, unsigned char *output, size_t *outputlen, const secp256k1_pubkey* pubkey, unsigned int flags) {
     secp256k1_ge Q;
     size_t len;
@@ -322,30 +582,117 @@ int secp256k1_ec_pubkey_serialize(const secp256k1_context* ctx, unsigned char *o
     return ret;
 }
 
+/* Loads a public key to be compared. Returns 0 (after calling the illegal_callback)
+ * if the public key is NULL or invalid. */
+static int secp256k1_pubkey_load_cmp(const secp256k1_context* ctx, secp256k1_ge* ge, const secp256k1_pubkey* pubkey) {
+    ARG_CHECK(pubkey != NULL);
+    return secp256k1_pubkey_load(ctx, ge, pubkey);
+}
+
 int secp256k1_ec_pubkey_cmp(const secp256k1_context* ctx, const secp256k1_pubkey* pubkey0, const secp256k1_pubkey* pubkey1) {
-    unsigned char out[2][33];
+    secp256k1_ge ge[2];
     const secp256k1_pubkey* pk[2];
+    int valid[2];
     int i;
 
     VERIFY_CHECK(ctx != NULL);
     pk[0] = pubkey0; pk[1] = pubkey1;
     for (i = 0; i < 2; i++) {
-        size_t out_size = sizeof(out[i]);
-        /* If the public key is NULL or invalid, ec_pubkey_serialize will call
-         * the illegal_callback and return 0. In that case we will serialize the
-         * key as all zeros which is less than any valid public key. This
-         * results in consistent comparisons even if NULL or invalid pubkeys are
-         * involved and prevents edge cases such as sorting algorithms that use
-         * this function and do not terminate as a result. */
-        if (!secp256k1_ec_pubkey_serialize(ctx, out[i], &out_size, pk[i], SECP256K1_EC_COMPRESSED)) {
-            /* Note that ec_pubkey_serialize should already set the output to
-             * zero in that case, but it's not guaranteed by the API, we can't
-             * test it and writing a VERIFY_CHECK is more complex than
-             * explicitly memsetting (again). */
-            memset(out[i], 0, sizeof(out[i]));
+        /* If the public key is NULL or invalid, the illegal_callback is called
+         * and the key is compared as if it was serialized as all zeros, which
+         * is less than any valid public key. This results in consistent
+         * comparisons even if NULL or invalid pubkeys are involved and prevents
+         * edge cases such as sorting algorithms that use this function and do
+         * not terminate as a result. */
+        valid[i] = secp256k1_pubkey_load_cmp(ctx, &ge[i], pk[i]);
+    }
+    if (!valid[0] || !valid[1]) {
+        return valid[0] - valid[1];
+    }
+    /* Compare in the order of the compressed serializations, i.e. first by the
+     * header byte, which encodes the parity of Y, and then by X, without
+     * serializing the keys. The coordinates of loaded public keys are already
+     * normalized. */
+    i = secp256k1_fe_is_odd(&ge[0].y) - secp256k1_fe_is_odd(&ge[1].y);
+    if (i != 0) {
+        return i;
+    }
+    return secp256k1_fe_cmp_var(&ge[0].x, &ge[1].x);
+}
+
+/* Up to this many public keys are sorted by comparing them directly, without
+ * allocating. Larger arrays are faster to sort after serializing every key
+ * once: sorting 16 to 4096 keys takes 1.1 to 1.5 times longer when every
+ * comparison loads both keys, while for 8 or fewer keys the allocation costs
+ * more than the loads it saves. */
+#define SECP256K1_EC_PUBKEY_SORT_INPLACE_MAX 8
+
+static int secp256k1_ec_pubkey_sort_cmp_inplace(const void* a, const void* b, void *cmp_data) {
+    return secp256k1_ec_pubkey_cmp((const secp256k1_context *)cmp_data,
+                                   *(const secp256k1_pubkey * const *)a,
+                                   *(const secp256k1_pubkey * const *)b);
+}
+
+/* The compressed serialization of a public key (or all zeros for NULL or invalid
+ * keys, as in secp256k1_ec_pubkey_cmp), computed once for sorting. */
+typedef struct {
+    unsigned char ser[33];
+    const secp256k1_pubkey *pubkey;
+} secp256k1_ec_pubkey_sort_entry;
+
+static int secp256k1_ec_pubkey_sort_cmp(const void* a, const void* b, void *cmp_data) {
+    (void)cmp_data;
+    return secp256k1_memcmp_var(((const secp256k1_ec_pubkey_sort_entry*)a)->ser,
+                                ((const secp256k1_ec_pubkey_sort_entry*)b)->ser, 33);
+}
+
+int secp256k1_ec_pubkey_sort(const secp256k1_context* ctx, const secp256k1_pubkey **pubkeys, size_t n_pubkeys) {
+    secp256k1_ec_pubkey_sort_entry *entries;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkeys != NULL);
+    if (n_pubkeys < 2) {
+        return 1;
+    }
+
+    if (n_pubkeys <= SECP256K1_EC_PUBKEY_SORT_INPLACE_MAX) {
+        /* Move NULL and invalid keys to the front, so that the illegal_callback
+         * is called once for each of them rather than in every comparison. */
+        size_t n_invalid = 0;
+        for (i = 0; i < n_pubkeys; i++) {
+            secp256k1_ge ge;
+            if (!secp256k1_pubkey_load_cmp(ctx, &ge, pubkeys[i])) {
+                const secp256k1_pubkey *tmp = pubkeys[n_invalid];
+                pubkeys[n_invalid] = pubkeys[i];
+                pubkeys[i] = tmp;
+                n_invalid++;
+            }
+        }
+        secp256k1_hsort(pubkeys + n_invalid, n_pubkeys - n_invalid, sizeof(*pubkeys), secp256k1_ec_pubkey_sort_cmp_inplace, (void *)ctx);
+        return 1;
+    }
+
+    ARG_CHECK(n_pubkeys <= SIZE_MAX / sizeof(*entries));
+    entries = (secp256k1_ec_pubkey_sort_entry *)checked_alloc(&ctx->allocator, &ctx->error_callback, n_pubkeys * sizeof(*entries));
+    if (entries == NULL) {
+        return 0;
+    }
+    for (i = 0; i < n_pubkeys; i++) {
+        secp256k1_ge ge;
+        size_t len = sizeof(entries[i].ser);
+        entries[i].pubkey = pubkeys[i];
+        if (!secp256k1_pubkey_load_cmp(ctx, &ge, pubkeys[i]) ||
+            !secp256k1_eckey_pubkey_serialize(&ge, entries[i].ser, &len, 1)) {
+            memset(entries[i].ser, 0, sizeof(entries[i].ser));
         }
     }
-    return secp256k1_memcmp_var(out[0], out[1], sizeof(out[0]));
+    secp256k1_hsort(entries, n_pubkeys, sizeof(*entries), secp256k1_ec_pubkey_sort_cmp, NULL);
+    for (i = 0; i < n_pubkeys; i++) {
+        pubkeys[i] = entries[i].pubkey;
+    }
+    secp256k1_dealloc(&ctx->allocator, entries);
+    return 1;
 }
 
 static void secp256k1_ecdsa_signature_load(const secp256k1_context* ctx, secp256k1_scalar* r, secp256k1_scalar* s, const secp256k1_ecdsa_signature* sig) {
@@ -470,12 +817,142 @@ int secp256k1_ecdsa_verify(const secp256k1_context* ctx, const secp256k1_ecdsa_s
             secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m));
 }
 
+int secp256k1_ecdsa_verify_compressed(const secp256k1_context* ctx, const secp256k1_ecdsa_signature *sig, const unsigned char *msghash32, const secp256k1_compressed_pubkey *pubkey) {
+    secp256k1_ge q;
+    secp256k1_scalar r, s;
+    secp256k1_scalar m;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(msghash32 != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    secp256k1_scalar_set_b32(&m, msghash32, NULL);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
+    /* Check the cheap conditions before decompressing the public key. */
+    return (!secp256k1_scalar_is_high(&s) &&
+            !secp256k1_scalar_is_zero(&r) && !secp256k1_scalar_is_zero(&s) &&
+            secp256k1_compressed_pubkey_load(ctx, &q, pubkey) &&
+            secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m));
+}
+
+int secp256k1_ecdsa_verify_multi(const secp256k1_context* ctx, int *results, const secp256k1_ecdsa_signature * const *sigs, const unsigned char * const *msghash32s, const secp256k1_pubkey * const *pubkeys, size_t n) {
+    secp256k1_ge q[ECMULT_INTERLEAVE_MAX];
+    secp256k1_scalar r[ECMULT_INTERLEAVE_MAX], s[ECMULT_INTERLEAVE_MAX];
+    secp256k1_scalar m[ECMULT_INTERLEAVE_MAX];
+    int res[ECMULT_INTERLEAVE_MAX];
+    int ret = 1;
+    size_t i, j, num;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(sigs != NULL);
+    ARG_CHECK(msghash32s != NULL);
+    ARG_CHECK(pubkeys != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(sigs[i] != NULL);
+        ARG_CHECK(msghash32s[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    for (i = 0; i < n; i += num) {
+        num = n - i < ECMULT_INTERLEAVE_MAX ? n - i : ECMULT_INTERLEAVE_MAX;
+        for (j = 0; j < num; j++) {
+            secp256k1_scalar_set_b32(&m[j], msghash32s[i + j], NULL);
+            secp256k1_ecdsa_signature_load(ctx, &r[j], &s[j], sigs[i + j]);
+            if (secp256k1_scalar_is_high(&s[j]) || !secp256k1_pubkey_load(ctx, &q[j], pubkeys[i + j])) {
+                /* A zero r makes secp256k1_ecdsa_sig_verify_multi reject this entry. */
+                secp256k1_scalar_clear(&r[j]);
+                q[j] = secp256k1_ge_const_g;
+            }
+        }
+        secp256k1_ecdsa_sig_verify_multi(&ctx->ecmult_ctx, res, r, s, q, m, num);
+        for (j = 0; j < num; j++) {
+            if (results != NULL) {
+                results[i + j] = res[j];
+            }
+            ret &= res[j];
+        }
+    }
+    return ret;
+}
+
+secp256k1_signature_cache* secp256k1_signature_cache_create(const secp256k1_context* ctx, size_t n_entries, const unsigned char *salt32, unsigned int flags) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_sigcache_n_buckets(n_entries) != 0);
+    ARG_CHECK(salt32 != NULL);
+    ARG_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_SIGNATURE_CACHE);
+    ARG_CHECK((flags & ~(SECP256K1_FLAGS_TYPE_MASK | SECP256K1_FLAGS_BIT_SIGNATURE_CACHE_COUNT)) == 0);
+
+    return secp256k1_sigcache_create(&ctx->error_callback, &ctx->allocator, n_entries, salt32, !!(flags & SECP256K1_FLAGS_BIT_SIGNATURE_CACHE_COUNT));
+}
+
+void secp256k1_signature_cache_destroy(const secp256k1_context* ctx, secp256k1_signature_cache *cache) {
+    VERIFY_CHECK(ctx != NULL);
+    secp256k1_sigcache_destroy(cache);
+}
+
+int secp256k1_signature_cache_get_stats(const secp256k1_context* ctx, const secp256k1_signature_cache *cache, secp256k1_signature_cache_stats *stats) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(cache != NULL);
+    ARG_CHECK(stats != NULL);
+
+    stats->n_entries = cache->n_buckets * SECP256K1_SIGCACHE_BUCKET_SIZE;
+    stats->hits = secp256k1_atomic_size_load_relaxed(&cache->hits);
+    stats->misses = secp256k1_atomic_size_load_relaxed(&cache->misses);
+    return 1;
+}
+
+int secp256k1_ecdsa_verify_cached(const secp256k1_context* ctx, secp256k1_signature_cache *cache, const secp256k1_ecdsa_signature *sig, const unsigned char *msghash32, const secp256k1_pubkey *pubkey, int erase) {
+    static const unsigned char type = 0;
+    secp256k1_sha256 sha;
+    secp256k1_ge q;
+    secp256k1_scalar r, s;
+    unsigned char buf[33];
+    unsigned char digest[32];
+    size_t buflen = sizeof(buf);
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(cache != NULL);
+    ARG_CHECK(msghash32 != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_pubkey_load(ctx, &q, pubkey)) {
+        return 0;
+    }
+    /* The digest commits to the signature type, the public key, the message
+     * and the signature. */
+    sha = cache->hasher;
+    secp256k1_sha256_write(&sha, &type, 1);
+    secp256k1_eckey_pubkey_serialize(&q, buf, &buflen, 1);
+    secp256k1_sha256_write(&sha, buf, buflen);
+    secp256k1_sha256_write(&sha, msghash32, 32);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
+    secp256k1_scalar_get_b32(buf, &r);
+    secp256k1_sha256_write(&sha, buf, 32);
+    secp256k1_scalar_get_b32(buf, &s);
+    secp256k1_sha256_write(&sha, buf, 32);
+    secp256k1_sha256_finalize(&sha, digest);
+
+    if (secp256k1_sigcache_lookup(cache, digest, erase)) {
+        return 1;
+    }
+    ret = secp256k1_ecdsa_verify(ctx, sig, msghash32, pubkey);
+    if (ret && !erase) {
+        secp256k1_sigcache_insert(cache, digest);
+    }
+    return ret;
+}
+
 static SECP256K1_INLINE void buffer_append(unsigned char *buf, unsigned int *offset, const void *data, unsigned int len) {
     memcpy(buf + *offset, data, len);
     *offset += len;
 }
 
-static int nonce_function_rfc6979(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
+/* Generates the RFC6979 nonce. If midstate8 is not NULL, it was computed by
+ * secp256k1_rfc6979_hmac_sha256_midstate from the first 31 bytes of key32. */
+static int nonce_function_rfc6979_helper(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, const void *data, unsigned int counter, const uint32_t *midstate8) {
    unsigned char keydata[112];
    unsigned int offset = 0;
    secp256k1_rfc6979_hmac_sha256 rng;
@@ -496,7 +973,11 @@ static int nonce_function_rfc6979(unsigned char *nonce32, const unsigned char *m
    if (algo16 != NULL) {
        buffer_append(keydata, &offset, algo16, 16);
    }
-   secp256k1_rfc6979_hmac_sha256_initialize(&rng, keydata, offset);
+   if (midstate8 != NULL) {
+       secp256k1_rfc6979_hmac_sha256_initialize_midstate(&rng, midstate8, keydata, offset);
+   } else {
+       secp256k1_rfc6979_hmac_sha256_initialize(&rng, keydata, offset);
+   }
    memset(keydata, 0, sizeof(keydata));
    for (i = 0; i <= counter; i++) {
        secp256k1_rfc6979_hmac_sha256_generate(&rng, nonce32, 32);
@@ -505,6 +986,21 @@ static int nonce_function_rfc6979(unsigned char *nonce32, const unsigned char *m
    return 1;
 }
 
+static int nonce_function_rfc6979(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
+   return nonce_function_rfc6979_helper(nonce32, msg32, key32, algo16, data, counter, NULL);
+}
+
+/* Data for nonce_function_rfc6979_midstate. */
+typedef struct {
+    uint32_t midstate[8];
+    const unsigned char *ndata32;
+} secp256k1_nonce_function_rfc6979_midstate_data;
+
+static int nonce_function_rfc6979_midstate(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
+   const secp256k1_nonce_function_rfc6979_midstate_data *d = (const secp256k1_nonce_function_rfc6979_midstate_data *)data;
+   return nonce_function_rfc6979_helper(nonce32, msg32, key32, algo16, d->ndata32, counter, d->midstate);
+}
+
 const secp256k1_nonce_function secp256k1_nonce_function_rfc6979 = nonce_function_rfc6979;
 const secp256k1_nonce_function secp256k1_nonce_function_default = nonce_function_rfc6979;
 
@@ -578,6 +1074,43 @@ int secp256k1_ecdsa_sign(const secp256k1_context* ctx, secp256k1_ecdsa_signature
     return ret;
 }
 
+int secp256k1_ecdsa_signing_key_create(const secp256k1_context* ctx, secp256k1_ecdsa_signing_key *signing_key, const unsigned char *seckey) {
+    secp256k1_scalar sec;
+    uint32_t midstate[8];
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(signing_key != NULL);
+    memset(signing_key, 0, sizeof(*signing_key));
+    ARG_CHECK(seckey != NULL);
+
+    ret = secp256k1_scalar_set_b32_seckey(&sec, seckey);
+    secp256k1_rfc6979_hmac_sha256_midstate(midstate, seckey);
+    memcpy(&signing_key->data[0], seckey, 32);
+    memcpy(&signing_key->data[32], midstate, 32);
+    secp256k1_memczero(signing_key, sizeof(*signing_key), !ret);
+    secp256k1_scalar_clear(&sec);
+    memset(midstate, 0, sizeof(midstate));
+    return ret;
+}
+
+int secp256k1_ecdsa_sign_with_signing_key(const secp256k1_context* ctx, secp256k1_ecdsa_signature *signature, const unsigned char *msghash32, const secp256k1_ecdsa_signing_key *signing_key, const unsigned char *ndata32) {
+    secp256k1_nonce_function_rfc6979_midstate_data noncedata;
+    secp256k1_scalar r, s;
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(msghash32 != NULL);
+    ARG_CHECK(signature != NULL);
+    ARG_CHECK(signing_key != NULL);
+
+    memcpy(noncedata.midstate, &signing_key->data[32], 32);
+    noncedata.ndata32 = ndata32;
+    ret = secp256k1_ecdsa_sign_inner(ctx, &r, &s, NULL, msghash32, &signing_key->data[0], nonce_function_rfc6979_midstate, &noncedata);
+    memset(&noncedata, 0, sizeof(noncedata));
+    secp256k1_ecdsa_signature_save(signature, &r, &s);
+    return ret;
+}
+
 int secp256k1_ec_seckey_verify(const secp256k1_context* ctx, const unsigned char *seckey) {
     secp256k1_scalar sec;
     int ret;
@@ -710,6 +1243,146 @@ int secp256k1_ec_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey
     return ret;
 }
 
+/* The number of tweaked keys that share a field inversion. */
+#define SECP256K1_TWEAK_ADD_BATCH 32
+
+/* Sets p[i] to p[i] + tweak32s[i]*G for the n <= SECP256K1_TWEAK_ADD_BATCH points
+ * with valid[i] set. The sums are computed in Jacobian coordinates and converted
+ * to affine coordinates together. Clears valid[i] if the tweak overflows or the
+ * sum is the point at infinity. */
+static void secp256k1_ec_pubkey_tweak_add_batch_helper(const secp256k1_ecmult_context* ecmult_ctx, secp256k1_ge *p, int *valid, const unsigned char * const *tweak32s, size_t n) {
+    secp256k1_gej sums[SECP256K1_TWEAK_ADD_BATCH];
+    size_t i;
+
+    VERIFY_CHECK(n <= SECP256K1_TWEAK_ADD_BATCH);
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar term;
+        int overflow = 0;
+        secp256k1_gej_set_infinity(&sums[i]);
+        if (!valid[i]) {
+            continue;
+        }
+        secp256k1_scalar_set_b32(&term, tweak32s[i], &overflow);
+        if (overflow) {
+            valid[i] = 0;
+            continue;
+        }
+        secp256k1_ecmult_gen_var(ecmult_ctx, &sums[i], &term);
+        secp256k1_gej_add_ge_var(&sums[i], &sums[i], &p[i], NULL);
+        valid[i] = !secp256k1_gej_is_infinity(&sums[i]);
+    }
+    secp256k1_ge_set_all_gej_var(p, sums, n);
+}
+
+int secp256k1_ec_pubkey_tweak_add_batch(const secp256k1_context* ctx, secp256k1_pubkey *output_pubkeys, int *results, const secp256k1_pubkey * const *pubkeys, const unsigned char * const *tweak32s, size_t n_pubkeys) {
+    secp256k1_ge p[SECP256K1_TWEAK_ADD_BATCH];
+    int valid[SECP256K1_TWEAK_ADD_BATCH];
+    int ret = 1;
+    size_t i, j, n;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n_pubkeys == 0 || output_pubkeys != NULL);
+    ARG_CHECK(n_pubkeys == 0 || pubkeys != NULL);
+    ARG_CHECK(n_pubkeys == 0 || tweak32s != NULL);
+    for (i = 0; i < n_pubkeys; i++) {
+        ARG_CHECK(pubkeys[i] != NULL);
+        ARG_CHECK(tweak32s[i] != NULL);
+    }
+
+    for (i = 0; i < n_pubkeys; i += n) {
+        n = n_pubkeys - i < SECP256K1_TWEAK_ADD_BATCH ? n_pubkeys - i : SECP256K1_TWEAK_ADD_BATCH;
+        for (j = 0; j < n; j++) {
+            valid[j] = secp256k1_pubkey_load(ctx, &p[j], pubkeys[i + j]);
+        }
+        secp256k1_ec_pubkey_tweak_add_batch_helper(&ctx->ecmult_ctx, p, valid, &tweak32s[i], n);
+        for (j = 0; j < n; j++) {
+            memset(&output_pubkeys[i + j], 0, sizeof(output_pubkeys[i + j]));
+            if (valid[j]) {
+                secp256k1_pubkey_save(&output_pubkeys[i + j], &p[j]);
+            }
+            if (results != NULL) {
+                results[i + j] = valid[j];
+            }
+            ret &= valid[j];
+        }
+    }
+    return ret;
+}
+
+int secp256k1_compressed_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_compressed_pubkey *pubkey, const unsigned char *tweak32) {
+    secp256k1_ge p;
+    int ret = 0;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(pubkey != NULL);
+    ARG_CHECK(tweak32 != NULL);
+
+    ret = secp256k1_compressed_pubkey_load(ctx, &p, pubkey);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ret = ret && secp256k1_ec_pubkey_tweak_add_helper(&ctx->ecmult_ctx, &p, tweak32);
+    if (ret) {
+        secp256k1_compressed_pubkey_save(pubkey, &p);
+    }
+
+    return ret;
+}
+
+/* The number of consecutive keys that share a field inversion when scanning. */
+#define SECP256K1_PUBKEY_SCAN_BATCH 64
+
+/* Sets r[i] to p + i*G for the n <= SECP256K1_PUBKEY_SCAN_BATCH keys, and p to
+ * p + n*G. Each key costs one point addition, and the keys are converted to
+ * affine coordinates together. */
+static void secp256k1_pubkey_scan_helper(secp256k1_ge *r, secp256k1_gej *p, size_t n) {
+    secp256k1_gej pj[SECP256K1_PUBKEY_SCAN_BATCH];
+    size_t i;
+
+    VERIFY_CHECK(n <= SECP256K1_PUBKEY_SCAN_BATCH);
+    for (i = 0; i < n; i++) {
+        pj[i] = *p;
+        secp256k1_gej_add_ge_var(p, p, &secp256k1_ge_const_g, NULL);
+    }
+    secp256k1_ge_set_all_gej_var(r, pj, n);
+}
+
+int secp256k1_ec_pubkey_scan(const secp256k1_context* ctx, unsigned char *output, const secp256k1_pubkey *pubkey, size_t n_pubkeys, unsigned int flags) {
+    secp256k1_ge r[SECP256K1_PUBKEY_SCAN_BATCH];
+    secp256k1_gej pj;
+    secp256k1_ge p;
+    size_t len;
+    int ret = 1;
+    size_t i, j, n;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_pubkeys == 0 || output != NULL);
+    ARG_CHECK(pubkey != NULL);
+    ARG_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_COMPRESSION);
+    len = (flags & SECP256K1_FLAGS_BIT_COMPRESSION) ? 33 : 65;
+    ARG_CHECK(n_pubkeys <= SIZE_MAX / len);
+
+    if (!secp256k1_pubkey_load(ctx, &p, pubkey)) {
+        if (n_pubkeys > 0) {
+            memset(output, 0, n_pubkeys * len);
+        }
+        return 0;
+    }
+    secp256k1_gej_set_ge(&pj, &p);
+    for (i = 0; i < n_pubkeys; i += n) {
+        n = n_pubkeys - i < SECP256K1_PUBKEY_SCAN_BATCH ? n_pubkeys - i : SECP256K1_PUBKEY_SCAN_BATCH;
+        secp256k1_pubkey_scan_helper(r, &pj, n);
+        for (j = 0; j < n; j++) {
+            unsigned char *out = &output[(i + j) * len];
+            size_t outlen;
+            if (!secp256k1_eckey_pubkey_serialize(&r[j], out, &outlen, len == 33)) {
+                memset(out, 0, len);
+                ret = 0;
+            }
+        }
+    }
+    return ret;
+}
+
 int secp256k1_ec_seckey_tweak_mul(const secp256k1_context* ctx, unsigned char *seckey, const unsigned char *tweak32) {
     secp256k1_scalar factor;
     secp256k1_scalar sec;
@@ -766,6 +1439,106 @@ int secp256k1_context_randomize(secp256k1_context* ctx, const unsigned char *see
     return 1;
 }
 
+int secp256k1_atomics_available(void) {
+#ifdef SECP256K1_HAVE_ATOMICS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+secp256k1_signing_session* secp256k1_signing_session_create(const secp256k1_context* ctx) {
+    secp256k1_signing_session *ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+
+    ret = (secp256k1_signing_session*)checked_alloc(&ctx->allocator, &ctx->error_callback, sizeof(*ret));
+    if (EXPECT(ret == NULL, 0)) {
+        return NULL;
+    }
+    ret->ctx = ctx;
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &ret->blinding);
+    ret->illegal_callback = ctx->illegal_callback;
+    ret->error_callback = ctx->error_callback;
+    return ret;
+}
+
+void secp256k1_signing_session_destroy(secp256k1_signing_session* session) {
+    if (session != NULL) {
+        const secp256k1_context *ctx = session->ctx;
+        secp256k1_scalar_clear(&session->blinding.blind);
+        secp256k1_gej_clear(&session->blinding.initial);
+        secp256k1_dealloc(&ctx->allocator, session);
+    }
+}
+
+void secp256k1_signing_session_set_illegal_callback(secp256k1_signing_session* session, void (*fun)(const char* message, void* data), const void* data) {
+    VERIFY_CHECK(session != NULL);
+    if (fun == NULL) {
+        fun = secp256k1_default_illegal_callback_fn;
+    }
+    session->illegal_callback.fn = fun;
+    session->illegal_callback.data = data;
+}
+
+void secp256k1_signing_session_set_error_callback(secp256k1_signing_session* session, void (*fun)(const char* message, void* data), const void* data) {
+    VERIFY_CHECK(session != NULL);
+    if (fun == NULL) {
+        fun = secp256k1_default_error_callback_fn;
+    }
+    session->error_callback.fn = fun;
+    session->error_callback.data = data;
+}
+
+int secp256k1_signing_session_randomize(secp256k1_signing_session* session, const unsigned char *seed32) {
+    VERIFY_CHECK(session != NULL);
+    secp256k1_ecmult_gen_blinding_update(&session->ctx->ecmult_gen_ctx, &session->blinding, seed32);
+    return 1;
+}
+
+/* Set up a context on the stack that combines the tables of the context of a
+ * signing session with the state of the session, so that the API functions
+ * can be called with it. It must be released with
+ * secp256k1_signing_session_context_clear, which wipes the blinding value. */
+static void secp256k1_signing_session_context_load(secp256k1_context *view, const secp256k1_signing_session* session) {
+    const secp256k1_context *ctx = session->ctx;
+    view->ecmult_ctx = ctx->ecmult_ctx;
+    view->ecmult_gen_ctx.prec = ctx->ecmult_gen_ctx.prec;
+    view->ecmult_gen_ctx.blinding[0] = session->blinding;
+    view->ecmult_gen_ctx.blinding[1] = session->blinding;
+    view->ecmult_gen_ctx.seq = 0;
+    view->illegal_callback = session->illegal_callback;
+    view->error_callback = session->error_callback;
+    view->allocator = ctx->allocator;
+    view->declassify = ctx->declassify;
+}
+
+static void secp256k1_signing_session_context_clear(secp256k1_context *view) {
+    secp256k1_ecmult_gen_context_clear(&view->ecmult_gen_ctx);
+}
+
+int secp256k1_ecdsa_sign_with_session(const secp256k1_signing_session* session, secp256k1_ecdsa_signature *signature, const unsigned char *msghash32, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata) {
+    secp256k1_context view;
+    int ret;
+    VERIFY_CHECK(session != NULL);
+
+    secp256k1_signing_session_context_load(&view, session);
+    ret = secp256k1_ecdsa_sign(&view, signature, msghash32, seckey, noncefp, noncedata);
+    secp256k1_signing_session_context_clear(&view);
+    return ret;
+}
+
+int secp256k1_ec_pubkey_create_with_session(const secp256k1_signing_session* session, secp256k1_pubkey *pubkey, const unsigned char *seckey) {
+    secp256k1_context view;
+    int ret;
+    VERIFY_CHECK(session != NULL);
+
+    secp256k1_signing_session_context_load(&view, session);
+    ret = secp256k1_ec_pubkey_create(&view, pubkey, seckey);
+    secp256k1_signing_session_context_clear(&view);
+    return ret;
+}
+
 int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *pubnonce, const secp256k1_pubkey * const *pubnonces, size_t n) {
     size_t i;
     secp256k1_gej Qj;
@@ -818,3 +1591,23 @@ int secp256k1_tagged_sha256(const secp256k1_context* ctx, unsigned char *hash32,
 #ifdef ENABLE_MODULE_SCHNORRSIG
 # include "modules/schnorrsig/main_impl.h"
 #endif
+
+#ifdef ENABLE_MODULE_MUSIG
+# include "modules/musig/main_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+# include "modules/schnorrsig_halfagg/main_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_BATCH
+# include "modules/batch/main_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_SILENTPAYMENTS
+# include "modules/silentpayments/main_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_PEDERSEN
+# include "modules/pedersen/main_impl.h"
+#endif
@@ -0,0 +1,69 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_SIGCACHE_H
+#define SECP256K1_SIGCACHE_H
+
+#include <stddef.h>
+
+#include "hash.h"
+#include "util.h"
+
+/* A set of digests of valid signatures, without locks.
+ *
+ * Every entry is a 127-bit fingerprint (the first 16 bytes of the digest,
+ * with the lowest bit set so that 0 marks an empty entry), stored as four
+ * words that are read and written with relaxed atomic operations. The entries
+ * are grouped in buckets of SECP256K1_SIGCACHE_BUCKET_SIZE and each
+ * fingerprint can live in two buckets, which are computed from the
+ * fingerprint itself so that an entry can be moved to its other bucket when
+ * its place is taken (cuckoo hashing).
+ *
+ * Threads that update the same entry at the same time can leave it holding
+ * words of different fingerprints. Such an entry does not match any
+ * fingerprint except by chance (as every entry does with probability 2^-127),
+ * so races only lose entries. The digests are salted with a secret, so the
+ * fingerprints cannot be chosen to collide. */
+#define SECP256K1_SIGCACHE_BUCKET_SIZE 4
+
+/* The number of times an insertion moves an entry to its other bucket before
+ * the last moved entry is dropped. */
+#define SECP256K1_SIGCACHE_MAX_KICKS 8
+
+typedef struct secp256k1_sigcache_struct {
+    /** SHA256 tagged with "secp256k1/sigcache" that has already been fed the salt */
+    secp256k1_sha256 hasher;
+    /** n_buckets * SECP256K1_SIGCACHE_BUCKET_SIZE entries */
+    unsigned int (*entries)[4];
+    size_t n_buckets;
+    /** whether lookups update hits and misses */
+    int count;
+    /** counts of lookups that found or did not find the digest */
+    size_t hits;
+    size_t misses;
+    /** functions that allocated this object (alloc == NULL means malloc) */
+    secp256k1_allocator allocator;
+} secp256k1_sigcache;
+
+/** Returns the number of buckets for n_entries entries, or 0 if n_entries is 0
+ *  or too large. */
+static size_t secp256k1_sigcache_n_buckets(size_t n_entries);
+
+/** Creates an empty cache for n_entries entries (rounded up to a multiple of
+ *  SECP256K1_SIGCACHE_BUCKET_SIZE), which must be valid for
+ *  secp256k1_sigcache_n_buckets. Lookups are counted only if count is set, as
+ *  the counters are a single cache line written by every thread. */
+static secp256k1_sigcache* secp256k1_sigcache_create(const secp256k1_callback* error_callback, const secp256k1_allocator* allocator, size_t n_entries, const unsigned char *salt32, int count);
+
+static void secp256k1_sigcache_destroy(secp256k1_sigcache *cache);
+
+/** Returns whether the digest is in the cache and removes it if erase is set.
+ *  Counts the lookup as a hit or a miss if the cache counts lookups. */
+static int secp256k1_sigcache_lookup(secp256k1_sigcache *cache, const unsigned char *digest32, int erase);
+
+/** Adds a digest to the cache, which may drop another one. */
+static void secp256k1_sigcache_insert(secp256k1_sigcache *cache, const unsigned char *digest32);
+
+#endif /* SECP256K1_SIGCACHE_H */
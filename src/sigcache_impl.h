@@ -0,0 +1,181 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_SIGCACHE_IMPL_H
+#define SECP256K1_SIGCACHE_IMPL_H
+
+#include <string.h>
+
+#include "sigcache.h"
+
+static size_t secp256k1_sigcache_n_buckets(size_t n_entries) {
+    size_t n_buckets = n_entries / SECP256K1_SIGCACHE_BUCKET_SIZE + (n_entries % SECP256K1_SIGCACHE_BUCKET_SIZE != 0);
+    /* Bucket indices are computed from 32-bit words (see
+     * secp256k1_sigcache_buckets), and the size in bytes must not overflow. */
+    if (n_buckets == 0 || n_buckets - 1 > 0xFFFFFFFFUL ||
+        n_buckets > (((size_t)-1) - ROUND_TO_ALIGN(sizeof(secp256k1_sigcache))) / (SECP256K1_SIGCACHE_BUCKET_SIZE * sizeof(unsigned int[4]))) {
+        return 0;
+    }
+    return n_buckets;
+}
+
+static secp256k1_sigcache* secp256k1_sigcache_create(const secp256k1_callback* error_callback, const secp256k1_allocator* allocator, size_t n_entries, const unsigned char *salt32, int count) {
+    static const unsigned char tag[18] = "secp256k1/sigcache";
+    size_t n_buckets = secp256k1_sigcache_n_buckets(n_entries);
+    size_t entries_size = n_buckets * SECP256K1_SIGCACHE_BUCKET_SIZE * sizeof(unsigned int[4]);
+    secp256k1_sigcache *ret;
+    VERIFY_CHECK(n_buckets != 0);
+
+    ret = (secp256k1_sigcache*)checked_alloc(allocator, error_callback, ROUND_TO_ALIGN(sizeof(*ret)) + entries_size);
+    if (EXPECT(ret == NULL, 0)) {
+        return NULL;
+    }
+    secp256k1_sha256_initialize_tagged(&ret->hasher, tag, sizeof(tag));
+    secp256k1_sha256_write(&ret->hasher, salt32, 32);
+    /* We cast to void* first to suppress a -Wcast-align warning. */
+    ret->entries = (unsigned int (*)[4])(void*)((unsigned char*)ret + ROUND_TO_ALIGN(sizeof(*ret)));
+    memset(ret->entries, 0, entries_size);
+    ret->n_buckets = n_buckets;
+    ret->count = count;
+    ret->hits = 0;
+    ret->misses = 0;
+    if (allocator != NULL) {
+        ret->allocator = *allocator;
+    } else {
+        memset(&ret->allocator, 0, sizeof(ret->allocator));
+    }
+    return ret;
+}
+
+static void secp256k1_sigcache_destroy(secp256k1_sigcache *cache) {
+    if (cache != NULL) {
+        /* The allocator lives in the memory being released. */
+        secp256k1_allocator allocator = cache->allocator;
+        secp256k1_dealloc(&allocator, cache);
+    }
+}
+
+static void secp256k1_sigcache_fingerprint(unsigned int *fp, const unsigned char *digest32) {
+    int i;
+    for (i = 0; i < 4; i++) {
+        fp[i] = (unsigned int)digest32[4*i] << 24 | (unsigned int)digest32[4*i + 1] << 16 |
+                (unsigned int)digest32[4*i + 2] << 8 | (unsigned int)digest32[4*i + 3];
+    }
+    fp[0] |= 1;
+}
+
+/* The two buckets of a fingerprint. Words 1 and 2 are mapped to
+ * [0, n_buckets) by multiplication, which avoids a division. */
+static void secp256k1_sigcache_buckets(const secp256k1_sigcache *cache, size_t *b, const unsigned int *fp) {
+    b[0] = (size_t)(((uint64_t)fp[1] * cache->n_buckets) >> 32);
+    b[1] = (size_t)(((uint64_t)fp[2] * cache->n_buckets) >> 32);
+    if (b[1] == b[0]) {
+        b[1] = (b[0] + 1) % cache->n_buckets;
+    }
+}
+
+static int secp256k1_sigcache_entry_eq(const unsigned int *entry, const unsigned int *fp) {
+    int i;
+    for (i = 0; i < 4; i++) {
+        if (secp256k1_atomic_load_relaxed(&entry[i]) != fp[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void secp256k1_sigcache_entry_store(unsigned int *entry, const unsigned int *fp) {
+    int i;
+    for (i = 0; i < 4; i++) {
+        secp256k1_atomic_store_relaxed(&entry[i], fp[i]);
+    }
+}
+
+static int secp256k1_sigcache_lookup(secp256k1_sigcache *cache, const unsigned char *digest32, int erase) {
+    static const unsigned int empty[4] = {0};
+    unsigned int fp[4];
+    size_t b[2];
+    int i, j;
+
+    secp256k1_sigcache_fingerprint(fp, digest32);
+    secp256k1_sigcache_buckets(cache, b, fp);
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < SECP256K1_SIGCACHE_BUCKET_SIZE; j++) {
+            unsigned int *entry = cache->entries[b[i] * SECP256K1_SIGCACHE_BUCKET_SIZE + j];
+            if (secp256k1_sigcache_entry_eq(entry, fp)) {
+                if (erase) {
+                    secp256k1_sigcache_entry_store(entry, empty);
+                }
+                if (cache->count) {
+                    secp256k1_atomic_size_increment_relaxed(&cache->hits);
+                }
+                return 1;
+            }
+        }
+    }
+    if (cache->count) {
+        secp256k1_atomic_size_increment_relaxed(&cache->misses);
+    }
+    return 0;
+}
+
+static void secp256k1_sigcache_insert(secp256k1_sigcache *cache, const unsigned char *digest32) {
+    unsigned int fp[4];
+    size_t b[2];
+    size_t from;
+    size_t slot;
+    size_t inserted = (size_t)-1;
+    int kick, i, j;
+
+    secp256k1_sigcache_fingerprint(fp, digest32);
+    secp256k1_sigcache_buckets(cache, b, fp);
+    from = b[(fp[3] >> 2) & 1];
+    for (kick = 0; ; kick++) {
+        unsigned int *entry;
+        unsigned int moved[4];
+        if (kick > 0) {
+            secp256k1_sigcache_buckets(cache, b, fp);
+        }
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < SECP256K1_SIGCACHE_BUCKET_SIZE; j++) {
+                entry = cache->entries[b[i] * SECP256K1_SIGCACHE_BUCKET_SIZE + j];
+                if (secp256k1_atomic_load_relaxed(&entry[0]) == 0 || secp256k1_sigcache_entry_eq(entry, fp)) {
+                    secp256k1_sigcache_entry_store(entry, fp);
+                    return;
+                }
+            }
+        }
+        if (kick == SECP256K1_SIGCACHE_MAX_KICKS) {
+            /* Both buckets are still full; the fingerprint is dropped. */
+            return;
+        }
+        /* Take the place of an entry in the bucket the fingerprint was not
+         * just moved out of, and move that entry on. The new fingerprint is
+         * never moved again, so that it is kept even if the chain of moves
+         * comes back to its bucket. */
+        if (kick > 0) {
+            from = b[0] == from ? b[1] : b[0];
+        }
+        slot = from * SECP256K1_SIGCACHE_BUCKET_SIZE + (fp[3] & (SECP256K1_SIGCACHE_BUCKET_SIZE - 1));
+        if (slot == inserted) {
+            slot = from * SECP256K1_SIGCACHE_BUCKET_SIZE + ((slot + 1) & (SECP256K1_SIGCACHE_BUCKET_SIZE - 1));
+        }
+        if (kick == 0) {
+            inserted = slot;
+        }
+        entry = cache->entries[slot];
+        for (i = 0; i < 4; i++) {
+            moved[i] = secp256k1_atomic_load_relaxed(&entry[i]);
+        }
+        secp256k1_sigcache_entry_store(entry, fp);
+        memcpy(fp, moved, sizeof(fp));
+        if (fp[0] == 0) {
+            /* Another thread emptied the entry meanwhile. */
+            return;
+        }
+    }
+}
+
+#endif /* SECP256K1_SIGCACHE_IMPL_H */
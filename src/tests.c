@@ -301,6 +301,11 @@ void run_context_tests(int use_prealloc) {
     CHECK(ecount2 == 14);
     CHECK(secp256k1_context_randomize(sign, NULL) == 1);
     CHECK(ecount2 == 14);
+#ifdef SECP256K1_HAVE_ATOMICS
+    CHECK(secp256k1_atomics_available() == 1);
+#else
+    CHECK(secp256k1_atomics_available() == 0);
+#endif
     secp256k1_context_set_illegal_callback(vrfy, NULL, NULL);
     secp256k1_context_set_illegal_callback(sign, NULL, NULL);
 
@@ -339,6 +344,130 @@ void run_context_tests(int use_prealloc) {
 
 }
 
+void test_ecmult_table_context(int window) {
+    size_t size = secp256k1_ecmult_table_size(window);
+    unsigned char *table = (unsigned char*)checked_malloc(&ctx->error_callback, size);
+    secp256k1_context *tctx, *clone;
+    secp256k1_scalar sigr, sigs, key, msg, nonce;
+    secp256k1_gej pubj, res1, res2;
+    secp256k1_ge pub;
+    int i;
+
+    secp256k1_ecmult_table_create(table, window);
+    tctx = secp256k1_context_create_with_ecmult_table(SECP256K1_CONTEXT_NONE, table, size);
+    CHECK(tctx != NULL);
+    CHECK(secp256k1_ecmult_context_is_built(&tctx->ecmult_ctx));
+    CHECK(tctx->ecmult_ctx.window_g == window);
+    clone = secp256k1_context_clone(tctx);
+    CHECK(secp256k1_context_preallocated_clone_size(clone) == secp256k1_context_preallocated_size(SECP256K1_CONTEXT_NONE));
+    secp256k1_context_destroy(tctx);
+
+    /* The clone references the same tables and computes the same results. */
+    CHECK(clone->ecmult_ctx.pre_g == (void*)(table + SECP256K1_ECMULT_TABLE_HEADER_SIZE));
+    for (i = 0; i < count; i++) {
+        random_scalar_order_test(&key);
+        random_scalar_order_test(&msg);
+        random_scalar_order_test(&nonce);
+        secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pubj, &key);
+        secp256k1_ge_set_gej(&pub, &pubj);
+        secp256k1_ecmult(&clone->ecmult_ctx, &res1, &pubj, &key, &msg);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &res2, &pubj, &key, &msg);
+        secp256k1_gej_neg(&res2, &res2);
+        secp256k1_gej_add_var(&res1, &res1, &res2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&res1));
+        /* Without its own table, ecmult_gen_var falls back to ecmult. */
+        CHECK(clone->ecmult_ctx.pre_gen == NULL);
+        secp256k1_ecmult_gen_var(&clone->ecmult_ctx, &res1, &key);
+        secp256k1_gej_neg(&res2, &pubj);
+        secp256k1_gej_add_var(&res1, &res1, &res2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&res1));
+        if (secp256k1_ecdsa_sig_sign(&ctx->ecmult_gen_ctx, &sigr, &sigs, &key, &msg, &nonce, NULL)) {
+            CHECK(secp256k1_ecdsa_sig_verify(&clone->ecmult_ctx, &sigr, &sigs, &pub, &msg));
+        }
+    }
+    secp256k1_context_destroy(clone);
+
+    /* Malformed and corrupted images are rejected. */
+    CHECK(secp256k1_context_create_with_ecmult_table(SECP256K1_CONTEXT_NONE, table, size - 1) == NULL);
+    CHECK(secp256k1_context_create_with_ecmult_table(SECP256K1_CONTEXT_NONE, table, 10) == NULL);
+    i = secp256k1_testrand_int(size);
+    table[i] ^= 1 << secp256k1_testrand_int(8);
+    CHECK(secp256k1_context_create_with_ecmult_table(SECP256K1_CONTEXT_NONE, table, size) == NULL);
+    free(table);
+}
+
+void run_ecmult_table_tests(void) {
+    test_ecmult_table_context(2);
+    test_ecmult_table_context(WINDOW_G);
+    test_ecmult_table_context(WINDOW_G < 12 ? WINDOW_G + 1 : 12);
+}
+
+typedef struct {
+    int allocs;
+    int frees;
+} counting_allocator_data;
+
+static void *counting_alloc(size_t size, void *data) {
+    counting_allocator_data *d = (counting_allocator_data *)data;
+    d->allocs++;
+    return malloc(size);
+}
+
+static void counting_free(void *ptr, void *data) {
+    counting_allocator_data *d = (counting_allocator_data *)data;
+    CHECK(ptr != NULL);
+    d->frees++;
+    free(ptr);
+}
+
+void run_allocator_tests(void) {
+    counting_allocator_data data = {0, 0};
+    secp256k1_allocator allocator;
+    secp256k1_context *actx;
+    secp256k1_context *clone;
+    secp256k1_scratch_space *scratch;
+    secp256k1_pubkey pubkey;
+    unsigned char seckey[32];
+
+    allocator.alloc = counting_alloc;
+    allocator.free = counting_free;
+    allocator.data = &data;
+
+    actx = secp256k1_context_create_with_allocator(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY, &allocator);
+    CHECK(actx != NULL);
+    CHECK(data.allocs == 1 && data.frees == 0);
+    /* The allocator is copied into the context. */
+    memset(&allocator, 0, sizeof(allocator));
+
+    /* Clones and scratch spaces inherit the allocator. */
+    clone = secp256k1_context_clone(actx);
+    CHECK(clone != NULL);
+    CHECK(data.allocs == 2 && data.frees == 0);
+    scratch = secp256k1_scratch_space_create(clone, 1000);
+    CHECK(scratch != NULL);
+    CHECK(data.allocs == 3);
+    CHECK(secp256k1_scratch_alloc(&clone->error_callback, scratch, 500) != NULL);
+
+    random_scalar_order_b32(seckey);
+    CHECK(secp256k1_ec_pubkey_create(clone, &pubkey, seckey) == 1);
+    secp256k1_context_destroy(actx);
+    CHECK(data.frees == 1);
+
+    /* A scratch space is released with its own allocator, whichever context is passed. */
+    secp256k1_scratch_apply_checkpoint(&clone->error_callback, scratch, 0);
+    secp256k1_scratch_space_destroy(secp256k1_context_no_precomp, scratch);
+    CHECK(data.frees == 2);
+    secp256k1_context_destroy(clone);
+    CHECK(data.allocs == 3 && data.frees == 3);
+
+    /* Contexts created without an allocator do not call it. */
+    actx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    scratch = secp256k1_scratch_space_create(actx, 100);
+    secp256k1_scratch_space_destroy(actx, scratch);
+    secp256k1_context_destroy(actx);
+    CHECK(data.allocs == 3 && data.frees == 3);
+}
+
 void run_scratch_tests(void) {
     const size_t adj_alloc = ((500 + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
 
@@ -348,6 +477,7 @@ void run_scratch_tests(void) {
     secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
     secp256k1_scratch_space *scratch;
     secp256k1_scratch_space local_scratch;
+    secp256k1_scratch_space_stats stats;
 
     /* Test public API */
     secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
@@ -417,6 +547,44 @@ void run_scratch_tests(void) {
     CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, SIZE_MAX) == NULL);
     secp256k1_scratch_space_destroy(none, scratch);
 
+    /* Test growable scratch spaces (with a limit that is a multiple of ALIGNMENT) */
+    CHECK(secp256k1_scratch_space_create_growable(none, 1001, 1000) == NULL);
+    CHECK(ecount == 6);
+    scratch = secp256k1_scratch_space_create_growable(none, 100, 1024);
+    CHECK(scratch != NULL);
+    CHECK(secp256k1_scratch_space_get_stats(none, scratch, &stats) == 1);
+    CHECK(stats.peak_usage == 0 && stats.capacity == 100 && stats.last_n_batches == 0);
+    CHECK(secp256k1_scratch_max_allocation(&none->error_callback, scratch, 0) == 1024);
+    CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, 64) != NULL);
+    checkpoint = secp256k1_scratch_checkpoint(&none->error_callback, scratch);
+    /* Does not fit the first chunk, so a second one is allocated */
+    CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, 500) != NULL);
+    CHECK(secp256k1_scratch_max_allocation(&none->error_callback, scratch, 0) == 1024 - ROUND_TO_ALIGN(64) - adj_alloc);
+    CHECK(secp256k1_scratch_space_get_stats(none, scratch, &stats) == 1);
+    CHECK(stats.capacity == 100 + adj_alloc);
+    /* The limit still applies */
+    CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, 1024 - ROUND_TO_ALIGN(64) - adj_alloc + 1) == NULL);
+    CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, 1024 - ROUND_TO_ALIGN(64) - adj_alloc) != NULL);
+    CHECK(secp256k1_scratch_max_allocation(&none->error_callback, scratch, 0) == 0);
+    CHECK(secp256k1_scratch_space_get_stats(none, scratch, &stats) == 1);
+    CHECK(stats.peak_usage == 1024);
+    CHECK(stats.capacity == 100 + 1024 - ROUND_TO_ALIGN(64));
+    /* Applying a checkpoint keeps the chunks, and later allocations reuse them */
+    secp256k1_scratch_apply_checkpoint(&none->error_callback, scratch, checkpoint);
+    CHECK(secp256k1_scratch_max_allocation(&none->error_callback, scratch, 0) == 1024 - ROUND_TO_ALIGN(64));
+    CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, 500) != NULL);
+    CHECK(secp256k1_scratch_space_get_stats(none, scratch, &stats) == 1);
+    CHECK(stats.capacity == 100 + 1024 - ROUND_TO_ALIGN(64));
+    /* Chunks that are too small for an allocation are replaced */
+    secp256k1_scratch_apply_checkpoint(&none->error_callback, scratch, 0);
+    CHECK(secp256k1_scratch_alloc(&none->error_callback, scratch, 900) != NULL);
+    CHECK(secp256k1_scratch_space_get_stats(none, scratch, &stats) == 1);
+    CHECK(stats.capacity == 100 + ROUND_TO_ALIGN(900));
+    CHECK(stats.peak_usage == 1024);
+    secp256k1_scratch_apply_checkpoint(&none->error_callback, scratch, 0);
+    secp256k1_scratch_space_destroy(none, scratch);
+    CHECK(ecount == 6);
+
     /* cleanup */
     secp256k1_scratch_space_destroy(none, NULL); /* no-op */
     secp256k1_context_destroy(none);
@@ -540,6 +708,7 @@ void run_rfc6979_hmac_sha256_tests(void) {
 
     secp256k1_rfc6979_hmac_sha256 rng;
     unsigned char out[32];
+    uint32_t midstate[8];
     int i;
 
     secp256k1_rfc6979_hmac_sha256_initialize(&rng, key1, 64);
@@ -562,6 +731,27 @@ void run_rfc6979_hmac_sha256_tests(void) {
         CHECK(secp256k1_memcmp_var(out, out2[i], 32) == 0);
     }
     secp256k1_rfc6979_hmac_sha256_finalize(&rng);
+
+    /* Starting from the midstate of the first 31 bytes gives the same output. */
+    for (i = 31; i <= 65; i++) {
+        secp256k1_rfc6979_hmac_sha256 rng2;
+        unsigned char key[65];
+        unsigned char out_midstate[32];
+        int j;
+        secp256k1_testrand_bytes_test(key, i);
+        secp256k1_rfc6979_hmac_sha256_midstate(midstate, key);
+        secp256k1_rfc6979_hmac_sha256_initialize(&rng, key, i);
+        secp256k1_rfc6979_hmac_sha256_initialize_midstate(&rng2, midstate, key, i);
+        for (j = 0; j < 2; j++) {
+            secp256k1_rfc6979_hmac_sha256_generate(&rng, out, 32);
+            secp256k1_rfc6979_hmac_sha256_generate(&rng2, out_midstate, 32);
+            CHECK(secp256k1_memcmp_var(out, out_midstate, 32) == 0);
+        }
+    }
+    secp256k1_rfc6979_hmac_sha256_midstate(midstate, key1);
+    secp256k1_rfc6979_hmac_sha256_initialize_midstate(&rng, midstate, key1, 64);
+    secp256k1_rfc6979_hmac_sha256_generate(&rng, out, 32);
+    CHECK(secp256k1_memcmp_var(out, out1[0], 32) == 0);
 }
 
 void run_tagged_sha256_tests(void) {
@@ -2624,6 +2814,7 @@ void test_sqrt(const secp256k1_fe *a, const secp256k1_fe *k) {
     secp256k1_fe r1, r2;
     int v = secp256k1_fe_sqrt(&r1, a);
     CHECK((v == 0) == (k == NULL));
+    CHECK(secp256k1_fe_is_square_var(a) == v);
 
     if (k != NULL) {
         /* Check that the returned root is +/- the given known answer */
@@ -2666,6 +2857,23 @@ void run_sqrt(void) {
             test_sqrt(&t, NULL);
         }
     }
+
+    /* Check that secp256k1_fe_sqrt_lanes agrees with secp256k1_fe_sqrt */
+    for (i = 0; i < count; i++) {
+        secp256k1_fe a[SECP256K1_FE_SQRT_LANES], r[SECP256K1_FE_SQRT_LANES];
+        int ret[SECP256K1_FE_SQRT_LANES];
+        int k;
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            random_fe_test(&a[k]);
+        }
+        secp256k1_fe_sqrt_lanes(ret, r, a);
+        for (k = 0; k < SECP256K1_FE_SQRT_LANES; k++) {
+            CHECK(ret[k] == secp256k1_fe_sqrt(&s, &a[k]));
+            if (ret[k]) {
+                CHECK(secp256k1_fe_equal_var(&r[k], &s));
+            }
+        }
+    }
 }
 
 /***** FIELD/SCALAR INVERSE TESTS *****/
@@ -3195,6 +3403,20 @@ void test_ge(void) {
         free(ge_set_all);
     }
 
+    /* Test constant-time batch gej -> ge conversion of points that are not infinity. */
+    {
+        secp256k1_ge *ge_set_all = (secp256k1_ge *)checked_malloc(&ctx->error_callback, (4 * runs + 1) * sizeof(secp256k1_ge));
+        for (i = 0; i < 4 * runs + 1; i++) {
+            random_group_element_test(&ge[i]);
+            random_group_element_jacobian_test(&gej[i], &ge[i]);
+        }
+        secp256k1_ge_set_all_gej(ge_set_all, gej, 4 * runs + 1);
+        for (i = 0; i < 4 * runs + 1; i++) {
+            ge_equals_ge(&ge_set_all[i], &ge[i]);
+        }
+        free(ge_set_all);
+    }
+
     /* Test batch gej -> ge conversion with many infinities. */
     for (i = 0; i < 4 * runs + 1; i++) {
         int odd;
@@ -3712,13 +3934,80 @@ void ecmult_const_chain_multiply(void) {
     ge_equals_gej(&res, &expected_point);
 }
 
+void ecmult_const_prec_mul(void) {
+    secp256k1_ecmult_const_prec prec;
+    secp256k1_scalar one = SECP256K1_SCALAR_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+    secp256k1_scalar q;
+    secp256k1_gej res1, res2;
+    secp256k1_ge point;
+    int i;
+
+    random_group_element_test(&point);
+    secp256k1_ecmult_const_prec_init(&prec, &point);
+    for (i = 0; i < 4 + 2 * count; i++) {
+        if (i == 0) {
+            q = one;
+        } else if (i == 1) {
+            secp256k1_scalar_negate(&q, &one);
+        } else if (i == 2) {
+            secp256k1_scalar_set_int(&q, 2);
+        } else if (i == 3) {
+            secp256k1_scalar_clear(&q);
+        } else {
+            random_scalar_order_test(&q);
+        }
+        secp256k1_ecmult_const(&res1, &point, &q, 256);
+        secp256k1_ecmult_const_prec_mul(&res2, &prec, &q);
+        secp256k1_gej_neg(&res1, &res1);
+        secp256k1_gej_add_var(&res1, &res1, &res2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&res1));
+    }
+}
+
 void run_ecmult_const_tests(void) {
+    ecmult_const_prec_mul();
     ecmult_const_mult_zero_one();
     ecmult_const_random_mult();
     ecmult_const_commutativity();
     ecmult_const_chain_multiply();
 }
 
+void test_ecmult_interleaved(void) {
+    secp256k1_gej a[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej r[ECMULT_INTERLEAVE_MAX];
+    secp256k1_scalar na[ECMULT_INTERLEAVE_MAX], ng[ECMULT_INTERLEAVE_MAX];
+    size_t num = secp256k1_testrand_int(ECMULT_INTERLEAVE_MAX + 1);
+    size_t i;
+
+    for (i = 0; i < ECMULT_INTERLEAVE_MAX; i++) {
+        random_group_element_jacobian_test(&a[i], &secp256k1_ge_const_g);
+        random_scalar_order_test(&na[i]);
+        random_scalar_order_test(&ng[i]);
+        switch (secp256k1_testrand_int(6)) {
+            case 0: secp256k1_scalar_clear(&na[i]); break;
+            case 1: secp256k1_scalar_clear(&ng[i]); break;
+            case 2: secp256k1_gej_set_infinity(&a[i]); break;
+            case 3: secp256k1_scalar_negate(&ng[i], &na[i]); a[i].x = secp256k1_ge_const_g.x; a[i].y = secp256k1_ge_const_g.y; secp256k1_fe_set_int(&a[i].z, 1); break;
+            default: break;
+        }
+    }
+    secp256k1_ecmult_interleaved(&ctx->ecmult_ctx, r, a, na, ng, num);
+    for (i = 0; i < num; i++) {
+        secp256k1_gej expected;
+        secp256k1_ecmult(&ctx->ecmult_ctx, &expected, &a[i], &na[i], &ng[i]);
+        secp256k1_gej_neg(&expected, &expected);
+        secp256k1_gej_add_var(&expected, &expected, &r[i], NULL);
+        CHECK(secp256k1_gej_is_infinity(&expected));
+    }
+}
+
+void run_ecmult_interleaved_tests(void) {
+    int i;
+    for (i = 0; i < 16*count; i++) {
+        test_ecmult_interleaved();
+    }
+}
+
 typedef struct {
     secp256k1_scalar *sc;
     secp256k1_ge *pt;
@@ -3993,7 +4282,7 @@ void test_ecmult_multi_batch_single(secp256k1_ecmult_multi_func ecmult_multi) {
     secp256k1_scalar_set_int(&szero, 0);
 
     /* Try to multiply 1 point, but scratch space is empty.*/
-    scratch_empty = secp256k1_scratch_create(&ctx->error_callback, 0);
+    scratch_empty = secp256k1_scratch_create(&ctx->error_callback, NULL, 0);
     CHECK(!ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch_empty, &r, &szero, ecmult_multi_callback, &data, 1));
     secp256k1_scratch_destroy(&ctx->error_callback, scratch_empty);
 }
@@ -4029,7 +4318,7 @@ void test_ecmult_multi_pippenger_max_points(void) {
         size_t i;
         size_t total_alloc;
         size_t checkpoint;
-        scratch = secp256k1_scratch_create(&ctx->error_callback, scratch_size);
+        scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, scratch_size);
         CHECK(scratch != NULL);
         checkpoint = secp256k1_scratch_checkpoint(&ctx->error_callback, scratch);
         n_points_supported = secp256k1_pippenger_max_points(&ctx->error_callback, scratch);
@@ -4133,16 +4422,17 @@ void test_ecmult_multi_batching(void) {
 
     /* Test with empty scratch space. It should compute the correct result using
      * ecmult_mult_simple algorithm which doesn't require a scratch space. */
-    scratch = secp256k1_scratch_create(&ctx->error_callback, 0);
+    scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, 0);
     CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
     secp256k1_gej_add_var(&r, &r, &r2, NULL);
     CHECK(secp256k1_gej_is_infinity(&r));
+    CHECK(scratch->last_n_batches == 0);
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
 
     /* Test with space for 1 point in pippenger. That's not enough because
      * ecmult_multi selects strauss which requires more memory. It should
      * therefore select the simple algorithm. */
-    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_pippenger_scratch_size(1, 1) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+    scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, secp256k1_pippenger_scratch_size(1, 1) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
     CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
     secp256k1_gej_add_var(&r, &r, &r2, NULL);
     CHECK(secp256k1_gej_is_infinity(&r));
@@ -4152,14 +4442,38 @@ void test_ecmult_multi_batching(void) {
         if (i > ECMULT_PIPPENGER_THRESHOLD) {
             int bucket_window = secp256k1_pippenger_bucket_window(i);
             size_t scratch_size = secp256k1_pippenger_scratch_size(i, bucket_window);
-            scratch = secp256k1_scratch_create(&ctx->error_callback, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+            scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
         } else {
             size_t scratch_size = secp256k1_strauss_scratch_size(i);
-            scratch = secp256k1_scratch_create(&ctx->error_callback, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+            scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
         }
         CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
+        CHECK(scratch->last_n_batches >= 1 && scratch->last_n_batches <= (size_t)(n_points + i - 1) / i);
+        secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    }
+
+    /* A growable scratch space which starts out empty is grown to process all
+     * points in a single batch, and keeps its memory for the next call. */
+    {
+        size_t max_size = secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points)) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
+        size_t capacity;
+        scratch = secp256k1_scratch_create_growable(&ctx->error_callback, NULL, 0, max_size);
+        for (i = 0; i < 2; i++) {
+            CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
+            secp256k1_gej_add_var(&r, &r, &r2, NULL);
+            CHECK(secp256k1_gej_is_infinity(&r));
+            CHECK(scratch->last_n_batches == 1);
+            CHECK(scratch->alloc_size == 0);
+            CHECK(scratch->peak_size > 0 && scratch->peak_size <= max_size);
+            if (i == 0) {
+                capacity = secp256k1_scratch_capacity(scratch);
+                CHECK(capacity >= scratch->peak_size);
+            } else {
+                CHECK(secp256k1_scratch_capacity(scratch) == capacity);
+            }
+        }
         secp256k1_scratch_destroy(&ctx->error_callback, scratch);
     }
     free(sc);
@@ -4171,7 +4485,7 @@ void run_ecmult_multi_tests(void) {
 
     test_secp256k1_pippenger_bucket_window_inv();
     test_ecmult_multi_pippenger_max_points();
-    scratch = secp256k1_scratch_create(&ctx->error_callback, 819200);
+    scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, 819200);
     test_ecmult_multi(scratch, secp256k1_ecmult_multi_var);
     test_ecmult_multi(NULL, secp256k1_ecmult_multi_var);
     test_ecmult_multi(scratch, secp256k1_ecmult_pippenger_batch_single);
@@ -4181,7 +4495,7 @@ void run_ecmult_multi_tests(void) {
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
 
     /* Run test_ecmult_multi with space for exactly one point */
-    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_strauss_scratch_size(1) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+    scratch = secp256k1_scratch_create(&ctx->error_callback, NULL, secp256k1_strauss_scratch_size(1) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
     test_ecmult_multi(scratch, secp256k1_ecmult_multi_var);
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
 
@@ -4465,36 +4779,66 @@ void run_ecmult_constants(void) {
 void test_ecmult_gen_blind(void) {
     /* Test ecmult_gen() blinding and confirm that the blinding changes, the affine points match, and the z's don't match. */
     secp256k1_scalar key;
-    secp256k1_scalar b;
     unsigned char seed32[32];
     secp256k1_gej pgej;
     secp256k1_gej pgej2;
-    secp256k1_gej i;
+    secp256k1_ecmult_gen_blinding old, cur;
     secp256k1_ge pge;
+    unsigned int seq = ctx->ecmult_gen_ctx.seq;
     random_scalar_order_test(&key);
     secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pgej, &key);
     secp256k1_testrand256(seed32);
-    b = ctx->ecmult_gen_ctx.blind;
-    i = ctx->ecmult_gen_ctx.initial;
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &old);
     secp256k1_ecmult_gen_blind(&ctx->ecmult_gen_ctx, seed32);
-    CHECK(!secp256k1_scalar_eq(&b, &ctx->ecmult_gen_ctx.blind));
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &cur);
+    CHECK(!secp256k1_scalar_eq(&old.blind, &cur.blind));
     secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pgej2, &key);
     CHECK(!gej_xyz_equals_gej(&pgej, &pgej2));
-    CHECK(!gej_xyz_equals_gej(&i, &ctx->ecmult_gen_ctx.initial));
+    CHECK(!gej_xyz_equals_gej(&old.initial, &cur.initial));
     secp256k1_ge_set_gej(&pge, &pgej);
     ge_equals_gej(&pge, &pgej2);
+    /* After the update both copies of the blinding are equal again. */
+    CHECK(ctx->ecmult_gen_ctx.seq == seq + 2);
+    CHECK(secp256k1_scalar_eq(&ctx->ecmult_gen_ctx.blinding[0].blind, &ctx->ecmult_gen_ctx.blinding[1].blind));
+    CHECK(gej_xyz_equals_gej(&ctx->ecmult_gen_ctx.blinding[0].initial, &ctx->ecmult_gen_ctx.blinding[1].initial));
+}
+
+void test_ecmult_gen_blind_in_progress(void) {
+    /* A multiplication that runs while the blinding is updated uses the copy
+     * that is not being written. */
+    secp256k1_ecmult_gen_context gctx = ctx->ecmult_gen_ctx;
+    secp256k1_scalar key;
+    secp256k1_gej pgej;
+    secp256k1_gej pgej2;
+    secp256k1_ge pge;
+    random_scalar_order_test(&key);
+    secp256k1_ecmult_gen(&gctx, &pgej, &key);
+    gctx.seq++;
+    random_scalar_order_test(&gctx.blinding[0].blind);
+    secp256k1_ecmult_gen(&gctx, &pgej2, &key);
+    secp256k1_ge_set_gej(&pge, &pgej);
+    ge_equals_gej(&pge, &pgej2);
+    /* Once seq is even again, blinding[0] is used, which now holds an
+     * inconsistent pair. */
+    gctx.seq++;
+    gctx.blinding[1] = gctx.blinding[0];
+    random_scalar_order_test(&gctx.blinding[1].blind);
+    secp256k1_ecmult_gen(&gctx, &pgej2, &key);
+    CHECK(!secp256k1_gej_is_infinity(&pgej2));
+    secp256k1_gej_neg(&pgej2, &pgej2);
+    secp256k1_gej_add_ge_var(&pgej2, &pgej2, &pge, NULL);
+    CHECK(!secp256k1_gej_is_infinity(&pgej2));
 }
 
 void test_ecmult_gen_blind_reset(void) {
     /* Test ecmult_gen() blinding reset and confirm that the blinding is consistent. */
-    secp256k1_scalar b;
-    secp256k1_gej initial;
+    secp256k1_ecmult_gen_blinding b, b2;
     secp256k1_ecmult_gen_blind(&ctx->ecmult_gen_ctx, 0);
-    b = ctx->ecmult_gen_ctx.blind;
-    initial = ctx->ecmult_gen_ctx.initial;
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &b);
     secp256k1_ecmult_gen_blind(&ctx->ecmult_gen_ctx, 0);
-    CHECK(secp256k1_scalar_eq(&b, &ctx->ecmult_gen_ctx.blind));
-    CHECK(gej_xyz_equals_gej(&initial, &ctx->ecmult_gen_ctx.initial));
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &b2);
+    CHECK(secp256k1_scalar_eq(&b.blind, &b2.blind));
+    CHECK(gej_xyz_equals_gej(&b.initial, &b2.initial));
 }
 
 void run_ecmult_gen_blind(void) {
@@ -4502,6 +4846,47 @@ void run_ecmult_gen_blind(void) {
     test_ecmult_gen_blind_reset();
     for (i = 0; i < 10; i++) {
         test_ecmult_gen_blind();
+        test_ecmult_gen_blind_in_progress();
+    }
+}
+
+void test_ecmult_gen_var(const secp256k1_scalar *x) {
+    secp256k1_gej r, expected;
+    secp256k1_ecmult_gen_var(&ctx->ecmult_ctx, &r, x);
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &expected, x);
+    secp256k1_gej_neg(&expected, &expected);
+    secp256k1_gej_add_var(&r, &r, &expected, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r));
+}
+
+void run_ecmult_gen_var_tests(void) {
+    /* Block values around the boundary where digits start to carry. */
+    static const int digits[6] = {0, 1, 31, 32, 33, 63};
+    secp256k1_scalar x, sixtyfour;
+    int i, j;
+
+    for (i = 0; i < 36; i++) {
+        secp256k1_scalar_set_int(&x, i);
+        test_ecmult_gen_var(&x);
+        secp256k1_scalar_negate(&x, &x);
+        test_ecmult_gen_var(&x);
+    }
+    secp256k1_scalar_set_int(&sixtyfour, 64);
+    for (i = 0; i < 6 * count; i++) {
+        /* Horner's rule over the blocks; the result wraps around the group order
+         * for large top blocks, which is fine for this test. */
+        secp256k1_scalar_set_int(&x, 0);
+        for (j = 0; j < ECMULT_GEN_VAR_BLOCKS; j++) {
+            secp256k1_scalar d;
+            secp256k1_scalar_set_int(&d, digits[i < 6 ? (uint32_t)i : secp256k1_testrand_int(6)]);
+            secp256k1_scalar_mul(&x, &x, &sixtyfour);
+            secp256k1_scalar_add(&x, &x, &d);
+        }
+        test_ecmult_gen_var(&x);
+    }
+    for (i = 0; i < 16 * count; i++) {
+        random_scalar_order_test(&x);
+        test_ecmult_gen_var(&x);
     }
 }
 
@@ -4957,6 +5342,171 @@ void run_ec_pubkey_parse_test(void) {
     }
 }
 
+void run_compressed_pubkey_tests(void) {
+    enum { N = 2 * SECP256K1_FE_SQRT_LANES + 1 };
+    secp256k1_compressed_pubkey compressed[N];
+    secp256k1_pubkey pubkeys[N];
+    secp256k1_pubkey pubkey;
+    secp256k1_compressed_pubkey cpk;
+    unsigned char ser[65];
+    unsigned char ser33[33];
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    unsigned char tweak[32];
+    secp256k1_ecdsa_signature sig;
+    secp256k1_scalar s;
+    secp256k1_fe x;
+    size_t len;
+    int i;
+    int32_t ecount = 0;
+
+    for (i = 0; i < N; i++) {
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(seckey, &s);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkeys[i], seckey) == 1);
+
+        /* Parsing both encodings and converting a pubkey agree */
+        len = 33;
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkeys[i], SECP256K1_EC_COMPRESSED) == 1);
+        CHECK(secp256k1_compressed_pubkey_parse(ctx, &compressed[i], ser, 33) == 1);
+        CHECK(secp256k1_compressed_pubkey_serialize(ctx, ser33, &compressed[i]) == 1);
+        CHECK(secp256k1_memcmp_var(ser33, ser, 33) == 0);
+        len = 65;
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkeys[i], SECP256K1_EC_UNCOMPRESSED) == 1);
+        CHECK(secp256k1_compressed_pubkey_parse(ctx, &cpk, ser, 65) == 1);
+        CHECK(secp256k1_memcmp_var(&cpk, &compressed[i], sizeof(cpk)) == 0);
+        CHECK(secp256k1_compressed_pubkey_from_pubkey(ctx, &cpk, &pubkeys[i]) == 1);
+        CHECK(secp256k1_memcmp_var(&cpk, &compressed[i], sizeof(cpk)) == 0);
+        CHECK(secp256k1_compressed_pubkey_decompress(ctx, &pubkey, &compressed[i]) == 1);
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+
+        /* Verification agrees with secp256k1_ecdsa_verify */
+        secp256k1_testrand256_test(msg);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_verify_compressed(ctx, &sig, msg, &compressed[i]) == 1);
+        msg[0] ^= 1;
+        CHECK(secp256k1_ecdsa_verify_compressed(ctx, &sig, msg, &compressed[i]) == 0);
+        CHECK(secp256k1_ecdsa_verify(ctx, &sig, msg, &pubkeys[i]) == 0);
+
+        /* Tweaking agrees with secp256k1_ec_pubkey_tweak_add */
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(tweak, &s);
+        cpk = compressed[i];
+        pubkey = pubkeys[i];
+        CHECK(secp256k1_compressed_pubkey_tweak_add(ctx, &cpk, tweak) == 1);
+        CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &pubkey, tweak) == 1);
+        CHECK(secp256k1_compressed_pubkey_decompress(ctx, &pubkeys[i], &cpk) == 1);
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        compressed[i] = cpk;
+    }
+
+    /* Batch decompression agrees with decompressing one at a time */
+    CHECK(secp256k1_compressed_pubkey_decompress_batch(ctx, pubkeys, compressed, N) == 1);
+    for (i = 0; i < N; i++) {
+        CHECK(secp256k1_compressed_pubkey_decompress(ctx, &pubkey, &compressed[i]) == 1);
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+    }
+    CHECK(secp256k1_compressed_pubkey_decompress_batch(ctx, NULL, NULL, 0) == 1);
+
+    /* Invalid encodings */
+    CHECK(secp256k1_compressed_pubkey_parse(ctx, &cpk, ser33, 32) == 0);
+    ser33[0] = 0x04;
+    CHECK(secp256k1_compressed_pubkey_parse(ctx, &cpk, ser33, 33) == 0);
+    ser33[0] = 0x02;
+    memset(ser33 + 1, 0xff, 32);
+    CHECK(secp256k1_compressed_pubkey_parse(ctx, &cpk, ser33, 33) == 0);
+    do {
+        random_fe_test(&x);
+        secp256k1_fe_normalize(&x);
+        secp256k1_fe_get_b32(ser33 + 1, &x);
+    } while (secp256k1_ec_pubkey_parse(ctx, &pubkey, ser33, 33));
+    CHECK(secp256k1_compressed_pubkey_parse(ctx, &cpk, ser33, 33) == 0);
+
+    /* Uninitialized objects are illegal arguments */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    memset(&cpk, 0, sizeof(cpk));
+    CHECK(secp256k1_compressed_pubkey_decompress(ctx, &pubkey, &cpk) == 0);
+    CHECK(ecount == 1);
+    compressed[N - 1] = cpk;
+    CHECK(secp256k1_compressed_pubkey_decompress_batch(ctx, pubkeys, compressed, N) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_verify_compressed(ctx, &sig, msg, &cpk) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_compressed_pubkey_tweak_add(ctx, &cpk, tweak) == 0);
+    CHECK(ecount == 4);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void run_ec_pubkey_parse_batch_test(void) {
+    /* Not a multiple of SECP256K1_FE_SQRT_LANES, to have a partially filled last group. */
+    enum { N = 4 * SECP256K1_FE_SQRT_LANES + 3 };
+    unsigned char input[N * 65];
+    secp256k1_pubkey pubkeys[N];
+    int results[N];
+    size_t inputlen;
+    size_t i, n_valid;
+    int32_t ecount = 0;
+
+    for (inputlen = 33; inputlen <= 65; inputlen += 32) {
+        int all_valid = 1;
+        for (i = 0; i < N; i++) {
+            unsigned char *pub = input + i * inputlen;
+            secp256k1_ge ge;
+            size_t len = inputlen;
+            random_group_element_test(&ge);
+            CHECK(secp256k1_eckey_pubkey_serialize(&ge, pub, &len, inputlen == 33));
+            CHECK(len == inputlen);
+            switch (secp256k1_testrand_int(5)) {
+            case 0:
+                /* Likely not on the curve anymore */
+                pub[inputlen - 1] ^= 1;
+                break;
+            case 1:
+                /* Bad header byte */
+                pub[0] = 0x05;
+                break;
+            case 2:
+                /* Overflowing X coordinate */
+                memset(pub + 1, 0xff, 32);
+                break;
+            case 3:
+                /* Hybrid encoding, with a random parity */
+                if (inputlen == 65) {
+                    pub[0] = 0x06 | secp256k1_testrand_bits(1);
+                }
+                break;
+            }
+        }
+        /* The results match secp256k1_ec_pubkey_parse */
+        for (i = 0; i < N; i++) {
+            all_valid &= secp256k1_ec_pubkey_parse(ctx, &pubkeys[i], input + i * inputlen, inputlen);
+        }
+        CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, results, input, inputlen, N) == all_valid);
+        n_valid = 0;
+        for (i = 0; i < N; i++) {
+            secp256k1_pubkey expected;
+            int ret = secp256k1_ec_pubkey_parse(ctx, &expected, input + i * inputlen, inputlen);
+            CHECK(results[i] == ret);
+            if (ret) {
+                CHECK(secp256k1_memcmp_var(&pubkeys[i], &expected, sizeof(expected)) == 0);
+                /* Keep only the valid keys, for the test below */
+                memmove(input + n_valid * inputlen, input + i * inputlen, inputlen);
+                n_valid++;
+            }
+        }
+        CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, NULL, input, inputlen, n_valid) == 1);
+    }
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, NULL, NULL, NULL, 33, 0) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, NULL, NULL, input, 33, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, NULL, NULL, 33, 1) == 0);
+    CHECK(ecount == 2);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
 void run_eckey_edge_case_test(void) {
     const unsigned char orderc[32] = {
         0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
@@ -5213,6 +5763,168 @@ void run_eckey_edge_case_test(void) {
     secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
 }
 
+void run_ec_pubkey_tweak_add_batch_test(void) {
+    /* Not a multiple of the batch size, and with a few parent keys shared by
+     * many children, as in BIP32 derivation. */
+    enum { N = 2 * 32 + 5, N_PARENTS = 3 };
+    unsigned char seckeys[N_PARENTS][32];
+    unsigned char tweaks[N][32];
+    secp256k1_pubkey parents[N_PARENTS];
+    secp256k1_pubkey outputs[N];
+    secp256k1_pubkey expected[N];
+    const secp256k1_pubkey *pubkeys[N];
+    const unsigned char *tweak_ptrs[N];
+    int results[N];
+    int all_valid = 1;
+    int32_t ecount = 0;
+    size_t i;
+
+    for (i = 0; i < N_PARENTS; i++) {
+        secp256k1_scalar s;
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(seckeys[i], &s);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &parents[i], seckeys[i]) == 1);
+    }
+    for (i = 0; i < N; i++) {
+        size_t parent = secp256k1_testrand_int(N_PARENTS);
+        secp256k1_scalar t;
+        pubkeys[i] = &parents[parent];
+        tweak_ptrs[i] = tweaks[i];
+        switch (secp256k1_testrand_int(8)) {
+        case 0:
+            /* Overflowing tweak */
+            memset(tweaks[i], 0xff, 32);
+            break;
+        case 1:
+            /* Zero tweak */
+            memset(tweaks[i], 0, 32);
+            break;
+        case 2:
+            /* Negated secret key, the result is infinity */
+            secp256k1_scalar_set_b32(&t, seckeys[parent], NULL);
+            secp256k1_scalar_negate(&t, &t);
+            secp256k1_scalar_get_b32(tweaks[i], &t);
+            break;
+        default:
+            random_scalar_order_test(&t);
+            secp256k1_scalar_get_b32(tweaks[i], &t);
+        }
+    }
+
+    /* The results match secp256k1_ec_pubkey_tweak_add */
+    for (i = 0; i < N; i++) {
+        secp256k1_pubkey tmp = *pubkeys[i];
+        all_valid &= secp256k1_ec_pubkey_tweak_add(ctx, &tmp, tweaks[i]);
+    }
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, outputs, results, pubkeys, tweak_ptrs, N) == all_valid);
+    for (i = 0; i < N; i++) {
+        expected[i] = *pubkeys[i];
+        CHECK(results[i] == secp256k1_ec_pubkey_tweak_add(ctx, &expected[i], tweaks[i]));
+        CHECK(secp256k1_memcmp_var(&outputs[i], &expected[i], sizeof(expected[i])) == 0);
+    }
+    /* Without results, and in place */
+    for (i = 0; i < N; i++) {
+        outputs[i] = *pubkeys[i];
+        pubkeys[i] = &outputs[i];
+    }
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, outputs, NULL, pubkeys, tweak_ptrs, N) == all_valid);
+    CHECK(secp256k1_memcmp_var(outputs, expected, sizeof(outputs)) == 0);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, NULL, NULL, pubkeys, tweak_ptrs, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, outputs, NULL, NULL, tweak_ptrs, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, outputs, NULL, pubkeys, NULL, 1) == 0);
+    CHECK(ecount == 3);
+    /* A NULL element in the last batch is detected before any output is
+     * written. */
+    for (i = 0; i < N; i++) {
+        pubkeys[i] = &parents[0];
+    }
+    memset(outputs, 0xaa, sizeof(outputs));
+    memset(results, 0xaa, sizeof(results));
+    tweak_ptrs[N - 1] = NULL;
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, outputs, results, pubkeys, tweak_ptrs, N) == 0);
+    CHECK(ecount == 4);
+    pubkeys[N - 1] = NULL;
+    tweak_ptrs[N - 1] = tweaks[N - 1];
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, outputs, results, pubkeys, tweak_ptrs, N) == 0);
+    CHECK(ecount == 5);
+    for (i = 0; i < sizeof(outputs); i++) {
+        CHECK(((unsigned char *)outputs)[i] == 0xaa);
+    }
+    for (i = 0; i < sizeof(results); i++) {
+        CHECK(((unsigned char *)results)[i] == 0xaa);
+    }
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void run_ec_pubkey_scan_test(void) {
+    /* Not a multiple of the batch size */
+    enum { N = 2 * 64 + 7 };
+    unsigned char compressed[N][33];
+    unsigned char uncompressed[N][65];
+    unsigned char ser[65];
+    unsigned char seckey[32];
+    secp256k1_pubkey start;
+    secp256k1_scalar k;
+    secp256k1_scalar one;
+    int32_t ecount = 0;
+    size_t i;
+
+    /* The keys of k, k+1, ... */
+    random_scalar_order_test(&k);
+    secp256k1_scalar_get_b32(seckey, &k);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &start, seckey) == 1);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], &start, N, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(secp256k1_ec_pubkey_scan(secp256k1_context_no_precomp, &uncompressed[0][0], &start, N, SECP256K1_EC_UNCOMPRESSED) == 1);
+    secp256k1_scalar_set_int(&one, 1);
+    for (i = 0; i < N; i++) {
+        secp256k1_pubkey pubkey;
+        size_t len = 33;
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkey, SECP256K1_EC_COMPRESSED) == 1);
+        CHECK(secp256k1_memcmp_var(compressed[i], ser, 33) == 0);
+        len = 65;
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkey, SECP256K1_EC_UNCOMPRESSED) == 1);
+        CHECK(secp256k1_memcmp_var(uncompressed[i], ser, 65) == 0);
+        secp256k1_scalar_add(&k, &k, &one);
+        secp256k1_scalar_get_b32(seckey, &k);
+    }
+
+    /* The key of -3 is followed by infinity and then G. */
+    secp256k1_scalar_set_int(&k, 3);
+    secp256k1_scalar_negate(&k, &k);
+    secp256k1_scalar_get_b32(seckey, &k);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &start, seckey) == 1);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], &start, 5, SECP256K1_EC_COMPRESSED) == 0);
+    memset(ser, 0, 33);
+    CHECK(secp256k1_memcmp_var(compressed[3], ser, 33) == 0);
+    CHECK(secp256k1_memcmp_var(&compressed[2][1], &compressed[4][1], 32) == 0);
+    CHECK(compressed[2][0] != compressed[4][0]);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], &start, 3, SECP256K1_EC_COMPRESSED) == 1);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, NULL, &start, 0, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, NULL, &start, 1, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], NULL, 1, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], &start, 1, SECP256K1_CONTEXT_SIGN) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], &start, SIZE_MAX / 32, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 4);
+    memset(&start, 0, sizeof(start));
+    CHECK(secp256k1_ec_pubkey_scan(ctx, &compressed[0][0], &start, 1, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_memcmp_var(compressed[0], ser, 33) == 0);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
 void run_eckey_negate_test(void) {
     unsigned char seckey[32];
     unsigned char seckey_tmp[32];
@@ -5593,6 +6305,138 @@ void run_pubkey_comparison(void) {
     CHECK(secp256k1_ec_pubkey_cmp(ctx, &pk2, &pk1) > 0);
 }
 
+static int test_hsort_cmp(const void *a, const void *b, void *data) {
+    const unsigned char *a8 = (const unsigned char *)a;
+    const unsigned char *b8 = (const unsigned char *)b;
+    size_t *counter = (size_t *)data;
+    (*counter)++;
+    return a8[0] < b8[0] ? -1 :
+           a8[0] > b8[0] ? 1 : 0;
+}
+
+/* Sorts n elements of the given size, where only the first byte of an element is
+ * compared, and checks the result. */
+void test_hsort(size_t n, size_t size) {
+    unsigned char elements[31 * 65];
+    size_t counter = 0;
+    size_t i;
+
+    CHECK(n * size <= sizeof(elements));
+    secp256k1_testrand_bytes_test(elements, n * size);
+    for (i = 0; i < n; i++) {
+        /* Make the other bytes depend on the first, to check that elements are
+         * moved as a whole. */
+        memset(elements + i * size + 1, elements[i * size] ^ 0x5a, size - 1);
+    }
+    secp256k1_hsort(elements, n, size, test_hsort_cmp, &counter);
+    for (i = 0; i < n; i++) {
+        size_t j;
+        if (i > 0) {
+            CHECK(elements[(i - 1) * size] <= elements[i * size]);
+        }
+        for (j = 1; j < size; j++) {
+            CHECK(elements[i * size + j] == (elements[i * size] ^ 0x5a));
+        }
+    }
+    /* Heapsort does at most 2 comparisons per level for each of the 1.5n sifts. */
+    CHECK(counter <= 2 * n * 6);
+}
+
+void run_hsort_tests(void) {
+    static const size_t sizes[] = { 1, 2, 63, 64, 65 };
+    size_t i, n;
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (n = 0; n <= 31; n++) {
+            test_hsort(n, sizes[i]);
+        }
+    }
+}
+
+static void test_pubkey_shuffle(const secp256k1_pubkey **pk, size_t n) {
+    size_t i;
+    for (i = n; i > 1; i--) {
+        size_t j = secp256k1_testrand_int(i);
+        const secp256k1_pubkey *tmp = pk[i - 1];
+        pk[i - 1] = pk[j];
+        pk[j] = tmp;
+    }
+}
+
+void run_pubkey_sort(void) {
+    secp256k1_pubkey pk[17];
+    const secp256k1_pubkey *pk_ptr[17];
+    unsigned char ser[2][33];
+    size_t len;
+    int i, j;
+    int32_t ecount = 0;
+
+    for (i = 0; i < 17; i++) {
+        secp256k1_ge ge;
+        random_group_element_test(&ge);
+        if (i % 4 == 1) {
+            /* Same X coordinate as the previous key, but opposite parity */
+            CHECK(secp256k1_pubkey_load(ctx, &ge, &pk[i - 1]));
+            secp256k1_ge_neg(&ge, &ge);
+        } else if (i % 4 == 2) {
+            /* Duplicate */
+            CHECK(secp256k1_pubkey_load(ctx, &ge, &pk[i - 1]));
+        }
+        secp256k1_pubkey_save(&pk[i], &ge);
+        pk_ptr[i] = &pk[i];
+    }
+    /* secp256k1_ec_pubkey_cmp agrees with comparing serializations */
+    for (i = 0; i < 17; i++) {
+        for (j = 0; j < 17; j++) {
+            int c1, c2;
+            len = 33;
+            CHECK(secp256k1_ec_pubkey_serialize(ctx, ser[0], &len, &pk[i], SECP256K1_EC_COMPRESSED) == 1);
+            len = 33;
+            CHECK(secp256k1_ec_pubkey_serialize(ctx, ser[1], &len, &pk[j], SECP256K1_EC_COMPRESSED) == 1);
+            c1 = secp256k1_ec_pubkey_cmp(ctx, &pk[i], &pk[j]);
+            c2 = secp256k1_memcmp_var(ser[0], ser[1], 33);
+            CHECK((c1 < 0) == (c2 < 0) && (c1 > 0) == (c2 > 0));
+        }
+    }
+
+    for (i = 0; i <= 17; i++) {
+        test_pubkey_shuffle(pk_ptr, 17);
+        CHECK(secp256k1_ec_pubkey_sort(ctx, pk_ptr, i) == 1);
+        for (j = 1; j < i; j++) {
+            CHECK(secp256k1_ec_pubkey_cmp(ctx, pk_ptr[j - 1], pk_ptr[j]) <= 0);
+        }
+    }
+
+    /* Invalid and NULL keys sort first */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    for (i = 0; i < 17; i++) {
+        pk_ptr[i] = &pk[i];
+    }
+    memset(&pk[5], 0, sizeof(pk[5]));
+    pk_ptr[3] = NULL;
+    test_pubkey_shuffle(pk_ptr, 17);
+    CHECK(secp256k1_ec_pubkey_sort(ctx, pk_ptr, 17) == 1);
+    CHECK(ecount == 2);
+    CHECK((pk_ptr[0] == NULL && pk_ptr[1] == &pk[5]) || (pk_ptr[0] == &pk[5] && pk_ptr[1] == NULL));
+    for (j = 3; j < 17; j++) {
+        CHECK(secp256k1_ec_pubkey_cmp(ctx, pk_ptr[j - 1], pk_ptr[j]) <= 0);
+    }
+    /* Also when few enough keys are sorted without allocating */
+    for (i = 0; i < 8; i++) {
+        pk_ptr[i] = &pk[i];
+    }
+    pk_ptr[6] = NULL;
+    test_pubkey_shuffle(pk_ptr, 8);
+    CHECK(secp256k1_ec_pubkey_sort(ctx, pk_ptr, 8) == 1);
+    CHECK(ecount == 4);
+    CHECK((pk_ptr[0] == NULL && pk_ptr[1] == &pk[5]) || (pk_ptr[0] == &pk[5] && pk_ptr[1] == NULL));
+    for (j = 3; j < 8; j++) {
+        CHECK(secp256k1_ec_pubkey_cmp(ctx, pk_ptr[j - 1], pk_ptr[j]) <= 0);
+    }
+    CHECK(secp256k1_ec_pubkey_sort(ctx, NULL, 0) == 0);
+    CHECK(ecount == 5);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
 void run_random_pubkeys(void) {
     int i;
     for (i = 0; i < 10*count; i++) {
@@ -5607,6 +6451,381 @@ void run_ecdsa_end_to_end(void) {
     }
 }
 
+void test_ecdsa_signing_key(void) {
+    secp256k1_ecdsa_signing_key signing_key;
+    secp256k1_ecdsa_signature sig, sig2;
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    unsigned char ndata[32];
+    int i;
+
+    random_scalar_order_b32(seckey);
+    CHECK(secp256k1_ecdsa_signing_key_create(ctx, &signing_key, seckey) == 1);
+    for (i = 0; i < 4; i++) {
+        const unsigned char *extra = i % 2 ? ndata : NULL;
+        secp256k1_testrand256_test(msg);
+        secp256k1_testrand256_test(ndata);
+        CHECK(secp256k1_ecdsa_sign_with_signing_key(ctx, &sig, msg, &signing_key, extra) == 1);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig2, msg, seckey, NULL, extra) == 1);
+        CHECK(secp256k1_memcmp_var(&sig, &sig2, sizeof(sig)) == 0);
+    }
+}
+
+void run_ecdsa_signing_key(void) {
+    secp256k1_ecdsa_signing_key signing_key;
+    secp256k1_ecdsa_signing_key zero_signing_key;
+    secp256k1_ecdsa_signature sig;
+    unsigned char seckey[32];
+    unsigned char msg[32] = { 0 };
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    int ecount = 0;
+    int i;
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    memset(&zero_signing_key, 0, sizeof(zero_signing_key));
+    random_scalar_order_b32(seckey);
+    CHECK(secp256k1_ecdsa_signing_key_create(ctx, NULL, seckey) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_signing_key_create(ctx, &signing_key, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_memcmp_var(&signing_key, &zero_signing_key, sizeof(signing_key)) == 0);
+    CHECK(secp256k1_ecdsa_signing_key_create(ctx, &signing_key, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign_with_signing_key(vrfy, &sig, msg, &signing_key, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdsa_sign_with_signing_key(ctx, NULL, msg, &signing_key, NULL) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecdsa_sign_with_signing_key(ctx, &sig, NULL, &signing_key, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_ecdsa_sign_with_signing_key(ctx, &sig, msg, NULL, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_ecdsa_sign_with_signing_key(ctx, &sig, msg, &signing_key, NULL) == 1);
+    CHECK(ecount == 6);
+
+    /* Invalid secret keys give an invalid signing key, which cannot sign. */
+    memset(seckey, 0, 32);
+    CHECK(secp256k1_ecdsa_signing_key_create(ctx, &signing_key, seckey) == 0);
+    CHECK(secp256k1_memcmp_var(&signing_key, &zero_signing_key, sizeof(signing_key)) == 0);
+    memset(seckey, 0xFF, 32);
+    CHECK(secp256k1_ecdsa_signing_key_create(ctx, &signing_key, seckey) == 0);
+    CHECK(secp256k1_memcmp_var(&signing_key, &zero_signing_key, sizeof(signing_key)) == 0);
+    CHECK(secp256k1_ecdsa_sign_with_signing_key(ctx, &sig, msg, &signing_key, NULL) == 0);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_destroy(vrfy);
+
+    for (i = 0; i < count; i++) {
+        test_ecdsa_signing_key();
+    }
+}
+
+void run_signing_session_tests(void) {
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    secp256k1_signing_session *session;
+    secp256k1_ecmult_gen_blinding before, after;
+    secp256k1_ecdsa_signature sig, sig2;
+    secp256k1_pubkey pubkey, pubkey2;
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    unsigned char seed32[32];
+    int ecount = 0;
+    int ecount2 = 0;
+    int i;
+
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_signing_session_create(vrfy) == NULL);
+    CHECK(ecount == 1);
+    secp256k1_signing_session_destroy(NULL);
+
+    session = secp256k1_signing_session_create(ctx);
+    CHECK(session != NULL);
+    CHECK(session->ctx == ctx);
+
+    /* Randomizing the session does not change the context. */
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &before);
+    CHECK(secp256k1_scalar_eq(&session->blinding.blind, &before.blind));
+    secp256k1_testrand256(seed32);
+    CHECK(secp256k1_signing_session_randomize(session, seed32) == 1);
+    secp256k1_ecmult_gen_blinding_load(&ctx->ecmult_gen_ctx, &after);
+    CHECK(secp256k1_scalar_eq(&before.blind, &after.blind));
+    CHECK(!secp256k1_scalar_eq(&session->blinding.blind, &before.blind));
+
+    /* The blinding does not affect the results. */
+    for (i = 0; i < count; i++) {
+        random_scalar_order_b32(seckey);
+        secp256k1_testrand256_test(msg);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_sign_with_session(session, &sig2, msg, seckey, NULL, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(&sig, &sig2, sizeof(sig)) == 0);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+        CHECK(secp256k1_ec_pubkey_create_with_session(session, &pubkey2, seckey) == 1);
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkey2, sizeof(pubkey)) == 0);
+        secp256k1_testrand256(seed32);
+        CHECK(secp256k1_signing_session_randomize(session, secp256k1_testrand_bits(2) ? seed32 : NULL) == 1);
+    }
+    memset(seckey, 0, 32);
+    CHECK(secp256k1_ecdsa_sign_with_session(session, &sig, msg, seckey, NULL, NULL) == 0);
+    CHECK(secp256k1_ec_pubkey_create_with_session(session, &pubkey, seckey) == 0);
+
+    /* A NULL seed resets the blinding. */
+    CHECK(secp256k1_signing_session_randomize(session, NULL) == 1);
+    secp256k1_ecmult_gen_blinding_update(&ctx->ecmult_gen_ctx, &before, NULL);
+    CHECK(secp256k1_scalar_eq(&session->blinding.blind, &before.blind));
+    CHECK(gej_xyz_equals_gej(&session->blinding.initial, &before.initial));
+
+    /* Illegal arguments are reported to the callback of the session. */
+    secp256k1_signing_session_set_illegal_callback(session, counting_illegal_callback_fn, &ecount2);
+    CHECK(secp256k1_ecdsa_sign_with_session(session, NULL, msg, seckey, NULL, NULL) == 0);
+    CHECK(secp256k1_ec_pubkey_create_with_session(session, &pubkey, NULL) == 0);
+    CHECK(ecount2 == 2);
+    CHECK(ecount == 1);
+    secp256k1_signing_session_set_illegal_callback(session, NULL, NULL);
+    CHECK(session->illegal_callback.fn == secp256k1_default_illegal_callback_fn);
+    secp256k1_signing_session_set_error_callback(session, counting_illegal_callback_fn, &ecount2);
+    CHECK(session->error_callback.fn == counting_illegal_callback_fn);
+    secp256k1_signing_session_set_error_callback(session, NULL, NULL);
+    CHECK(session->error_callback.fn == secp256k1_default_error_callback_fn);
+
+    secp256k1_signing_session_destroy(session);
+    secp256k1_context_destroy(vrfy);
+}
+
+void test_ecdsa_verify_multi(void) {
+    enum { N_SIGS = 11 };
+    unsigned char seckeys[N_SIGS][32];
+    unsigned char msgs[N_SIGS][32];
+    unsigned char zero64[64] = {0};
+    secp256k1_pubkey pubkeys[N_SIGS];
+    secp256k1_ecdsa_signature sigs[N_SIGS];
+    const secp256k1_pubkey *pubkey_ptrs[N_SIGS];
+    const secp256k1_ecdsa_signature *sig_ptrs[N_SIGS];
+    const unsigned char *msg_ptrs[N_SIGS];
+    int results[N_SIGS];
+    size_t n = secp256k1_testrand_int(N_SIGS + 1);
+    size_t i;
+    int expected = 1;
+
+    for (i = 0; i < N_SIGS; i++) {
+        pubkey_ptrs[i] = &pubkeys[i];
+        sig_ptrs[i] = &sigs[i];
+        msg_ptrs[i] = msgs[i];
+    }
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(seckeys[i], &key);
+        secp256k1_testrand256_test(msgs[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkeys[i], seckeys[i]) == 1);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sigs[i], msgs[i], seckeys[i], NULL, NULL) == 1);
+        switch (secp256k1_testrand_int(8)) {
+            case 0:
+                /* Wrong message */
+                msgs[i][secp256k1_testrand_int(32)] ^= 1 << secp256k1_testrand_int(8);
+                break;
+            case 1:
+                /* Wrong public key */
+                if (i > 0) {
+                    pubkeys[i] = pubkeys[i - 1];
+                }
+                break;
+            case 2:
+                /* Zero signature */
+                CHECK(secp256k1_ecdsa_signature_parse_compact(ctx, &sigs[i], zero64) == 1);
+                break;
+            default:
+                break;
+        }
+    }
+
+    CHECK(secp256k1_ecdsa_verify_multi(ctx, NULL, sig_ptrs, msg_ptrs, pubkey_ptrs, 0) == 1);
+    memset(results, 0xff, sizeof(results));
+    for (i = 0; i < n; i++) {
+        expected &= secp256k1_ecdsa_verify(ctx, sig_ptrs[i], msg_ptrs[i], pubkey_ptrs[i]);
+    }
+    CHECK(secp256k1_ecdsa_verify_multi(ctx, results, sig_ptrs, msg_ptrs, pubkey_ptrs, n) == expected);
+    CHECK(secp256k1_ecdsa_verify_multi(ctx, NULL, sig_ptrs, msg_ptrs, pubkey_ptrs, n) == expected);
+    for (i = 0; i < n; i++) {
+        CHECK(results[i] == secp256k1_ecdsa_verify(ctx, sig_ptrs[i], msg_ptrs[i], pubkey_ptrs[i]));
+    }
+}
+
+void run_ecdsa_verify_multi(void) {
+    int i;
+    for (i = 0; i < 4*count; i++) {
+        test_ecdsa_verify_multi();
+    }
+}
+
+void test_sigcache_table(void) {
+    secp256k1_sigcache *cache;
+    unsigned char salt[32];
+    unsigned char digests[64][32];
+    unsigned int fp[4], fp2[4];
+    size_t b[2];
+    size_t i;
+    int j, k;
+
+    CHECK(secp256k1_sigcache_n_buckets(0) == 0);
+    CHECK(secp256k1_sigcache_n_buckets(1) == 1);
+    CHECK(secp256k1_sigcache_n_buckets(4) == 1);
+    CHECK(secp256k1_sigcache_n_buckets(5) == 2);
+    CHECK(secp256k1_sigcache_n_buckets((size_t)-1) == 0);
+
+    secp256k1_testrand256(salt);
+    cache = secp256k1_sigcache_create(&ctx->error_callback, NULL, 16, salt, 1);
+    CHECK(cache->n_buckets == 4);
+
+    /* A digest can be found right after it was added, and is gone after it
+     * was found with erase set. */
+    for (i = 0; i < 64; i++) {
+        secp256k1_testrand256(digests[i]);
+        CHECK(secp256k1_sigcache_lookup(cache, digests[i], 0) == 0);
+        secp256k1_sigcache_insert(cache, digests[i]);
+        CHECK(secp256k1_sigcache_lookup(cache, digests[i], 0) == 1);
+    }
+    CHECK(secp256k1_sigcache_lookup(cache, digests[63], 1) == 1);
+    CHECK(secp256k1_sigcache_lookup(cache, digests[63], 0) == 0);
+    CHECK(cache->hits == 65);
+    CHECK(cache->misses == 65);
+
+    /* Every entry is in one of the buckets of its fingerprint. */
+    for (i = 0; i < cache->n_buckets * SECP256K1_SIGCACHE_BUCKET_SIZE; i++) {
+        if (cache->entries[i][0] != 0) {
+            secp256k1_sigcache_buckets(cache, b, cache->entries[i]);
+            CHECK(i / SECP256K1_SIGCACHE_BUCKET_SIZE == b[0] || i / SECP256K1_SIGCACHE_BUCKET_SIZE == b[1]);
+        }
+    }
+    secp256k1_sigcache_destroy(cache);
+
+    /* A cache with plenty of space keeps everything. */
+    cache = secp256k1_sigcache_create(&ctx->error_callback, NULL, 1024, salt, 0);
+    for (i = 0; i < 64; i++) {
+        secp256k1_sigcache_insert(cache, digests[i]);
+    }
+    for (i = 0; i < 64; i++) {
+        CHECK(secp256k1_sigcache_lookup(cache, digests[i], 0) == 1);
+    }
+
+    /* An entry that holds words of two fingerprints (after concurrent writes)
+     * matches neither. */
+    secp256k1_sigcache_fingerprint(fp, digests[0]);
+    secp256k1_sigcache_fingerprint(fp2, digests[1]);
+    secp256k1_sigcache_buckets(cache, b, fp);
+    for (j = 0; j < 2; j++) {
+        for (k = 0; k < SECP256K1_SIGCACHE_BUCKET_SIZE; k++) {
+            unsigned int *entry = cache->entries[b[j] * SECP256K1_SIGCACHE_BUCKET_SIZE + k];
+            if (secp256k1_sigcache_entry_eq(entry, fp)) {
+                entry[2] = fp2[2];
+                entry[3] = fp2[3];
+            }
+        }
+    }
+    CHECK(secp256k1_sigcache_lookup(cache, digests[0], 0) == 0);
+    CHECK(secp256k1_sigcache_lookup(cache, digests[1], 0) == 1);
+    secp256k1_sigcache_destroy(cache);
+}
+
+void test_ecdsa_verify_cached(void) {
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_signature_cache *cache;
+    secp256k1_signature_cache_stats stats;
+    secp256k1_ecdsa_signature sig, sig_high;
+    secp256k1_pubkey pubkey;
+    secp256k1_scalar r, s;
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    unsigned char salt[32];
+    int ecount = 0;
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_testrand256(salt);
+    CHECK(secp256k1_signature_cache_create(ctx, 0, salt, SECP256K1_SIGNATURE_CACHE_COUNT) == NULL);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_signature_cache_create(ctx, 100, NULL, SECP256K1_SIGNATURE_CACHE_COUNT) == NULL);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_signature_cache_create(ctx, 100, salt, SECP256K1_EC_COMPRESSED) == NULL);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_signature_cache_create(ctx, 100, salt, SECP256K1_SIGNATURE_CACHE_COUNT | (1 << 9)) == NULL);
+    CHECK(ecount == 4);
+    cache = secp256k1_signature_cache_create(ctx, 100, salt, SECP256K1_SIGNATURE_CACHE_COUNT);
+    CHECK(cache != NULL);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.n_entries == 100);
+    CHECK(stats.hits == 0 && stats.misses == 0);
+
+    random_scalar_order_b32(seckey);
+    secp256k1_testrand256_test(msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+
+    CHECK(secp256k1_ecdsa_verify_cached(sign, cache, &sig, msg, &pubkey, 0) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, NULL, msg, &pubkey, 0) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, NULL, &pubkey, 0) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, NULL, 0) == 0);
+    CHECK(ecount == 8);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, NULL, &sig, msg, &pubkey, 0) == 0);
+    CHECK(ecount == 9);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, NULL) == 0);
+    CHECK(ecount == 10);
+
+    /* A valid signature is added on the first verification and found on the
+     * second. */
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 0) == 1);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 0) == 1);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.hits == 1 && stats.misses == 1);
+
+    /* With erase, it is found once and then gone, and is not added back. */
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 1) == 1);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 1) == 1);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 1) == 1);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.hits == 2 && stats.misses == 3);
+
+    /* Invalid signatures are never added, including the high-S form of a
+     * valid one. */
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, &sig);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecdsa_signature_save(&sig_high, &r, &s);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig_high, msg, &pubkey, 0) == 0);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig_high, msg, &pubkey, 0) == 0);
+    msg[0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 0) == 0);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 0) == 0);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.hits == 2 && stats.misses == 7);
+    CHECK(ecount == 10);
+    secp256k1_signature_cache_destroy(ctx, cache);
+
+    /* Without counting, lookups still find the signature but are not
+     * reported. */
+    cache = secp256k1_signature_cache_create(ctx, 100, salt, SECP256K1_SIGNATURE_CACHE_NONE);
+    CHECK(cache != NULL);
+    msg[0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 0) == 1);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 1) == 1);
+    CHECK(secp256k1_ecdsa_verify_cached(ctx, cache, &sig, msg, &pubkey, 1) == 1);
+    CHECK(secp256k1_signature_cache_get_stats(ctx, cache, &stats) == 1);
+    CHECK(stats.n_entries == 100);
+    CHECK(stats.hits == 0 && stats.misses == 0);
+    CHECK(!cache->count);
+
+    secp256k1_signature_cache_destroy(ctx, NULL);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_destroy(sign);
+}
+
+void run_sigcache_tests(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_sigcache_table();
+        test_ecdsa_verify_cached();
+    }
+}
+
 int test_ecdsa_der_parse(const unsigned char *sig, size_t siglen, int certainly_der, int certainly_not_der) {
     static const unsigned char zeroes[32] = {0};
 #ifdef ENABLE_OPENSSL_TESTS
@@ -6383,6 +7602,26 @@ void run_ecdsa_openssl(void) {
 # include "modules/schnorrsig/tests_impl.h"
 #endif
 
+#ifdef ENABLE_MODULE_MUSIG
+# include "modules/musig/tests_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+# include "modules/schnorrsig_halfagg/tests_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_BATCH
+# include "modules/batch/tests_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_SILENTPAYMENTS
+# include "modules/silentpayments/tests_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_PEDERSEN
+# include "modules/pedersen/tests_impl.h"
+#endif
+
 void run_secp256k1_memczero_test(void) {
     unsigned char buf1[6] = {1, 2, 3, 4, 5, 6};
     unsigned char buf2[sizeof(buf1)];
@@ -6545,12 +7784,40 @@ void ge_storage_cmov_test(void) {
     CHECK(secp256k1_memcmp_var(&r, &one, sizeof(r)) == 0);
 }
 
+void ge_storage_table_select_test(void) {
+    secp256k1_ge_storage table[16];
+    secp256k1_ge_storage r, expected;
+    secp256k1_ge ge;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        random_group_element_test(&ge);
+        secp256k1_ge_to_storage(&table[i], &ge);
+    }
+    for (i = 0; i < 16; i++) {
+        /* Must agree with a cmov scan over the same table. */
+        int j;
+        expected = table[(i + 1) % 16];
+        for (j = 0; j < 16; j++) {
+            secp256k1_ge_storage_cmov(&expected, &table[j], j == i);
+        }
+        secp256k1_ge_storage_table_select(&r, table, 16, i);
+        CHECK(secp256k1_memcmp_var(&r, &expected, sizeof(r)) == 0);
+        CHECK(secp256k1_memcmp_var(&r, &table[i], sizeof(r)) == 0);
+        /* Only the first i entries are scanned, so index i selects nothing. */
+        secp256k1_ge_storage_table_select(&r, table, i, i);
+        memset(&expected, 0, sizeof(expected));
+        CHECK(secp256k1_memcmp_var(&r, &expected, sizeof(r)) == 0);
+    }
+}
+
 void run_cmov_tests(void) {
     int_cmov_test();
     fe_cmov_test();
     fe_storage_cmov_test();
     scalar_cmov_test();
     ge_storage_cmov_test();
+    ge_storage_table_select_test();
 }
 
 int main(int argc, char **argv) {
@@ -6583,6 +7850,7 @@ int main(int argc, char **argv) {
     /* initialize */
     run_context_tests(0);
     run_context_tests(1);
+    run_allocator_tests();
     run_scratch_tests();
     ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
     if (secp256k1_testrand_bits(1)) {
@@ -6624,7 +7892,10 @@ int main(int argc, char **argv) {
     run_ecmult_chain();
     run_ecmult_constants();
     run_ecmult_gen_blind();
+    run_ecmult_gen_var_tests();
     run_ecmult_const_tests();
+    run_ecmult_interleaved_tests();
+    run_ecmult_table_tests();
     run_ecmult_multi_tests();
     run_ec_combine();
 
@@ -6633,12 +7904,16 @@ int main(int argc, char **argv) {
 
     /* EC point parser test */
     run_ec_pubkey_parse_test();
+    run_ec_pubkey_parse_batch_test();
+    run_compressed_pubkey_tests();
 
     /* EC key edge cases */
     run_eckey_edge_case_test();
 
     /* EC key arithmetic test */
     run_eckey_negate_test();
+    run_ec_pubkey_tweak_add_batch_test();
+    run_ec_pubkey_scan_test();
 
 #ifdef ENABLE_MODULE_ECDH
     /* ecdh tests */
@@ -6647,10 +7922,16 @@ int main(int argc, char **argv) {
 
     /* ecdsa tests */
     run_pubkey_comparison();
+    run_pubkey_sort();
+    run_hsort_tests();
     run_random_pubkeys();
     run_ecdsa_der_parse();
     run_ecdsa_sign_verify();
     run_ecdsa_end_to_end();
+    run_ecdsa_signing_key();
+    run_signing_session_tests();
+    run_ecdsa_verify_multi();
+    run_sigcache_tests();
     run_ecdsa_edge_cases();
 #ifdef ENABLE_OPENSSL_TESTS
     run_ecdsa_openssl();
@@ -6669,6 +7950,26 @@ int main(int argc, char **argv) {
     run_schnorrsig_tests();
 #endif
 
+#ifdef ENABLE_MODULE_MUSIG
+    run_musig_tests();
+#endif
+
+#ifdef ENABLE_MODULE_SCHNORRSIG_HALFAGG
+    run_schnorrsig_halfagg_tests();
+#endif
+
+#ifdef ENABLE_MODULE_BATCH
+    run_batch_tests();
+#endif
+
+#ifdef ENABLE_MODULE_SILENTPAYMENTS
+    run_silentpayments_tests();
+#endif
+
+#ifdef ENABLE_MODULE_PEDERSEN
+    run_pedersen_tests();
+#endif
+
     /* util tests */
     run_secp256k1_memczero_test();
 
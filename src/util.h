@@ -43,6 +43,13 @@ static SECP256K1_INLINE void secp256k1_callback_call(const secp256k1_callback *
 #define EXPECT(x,c) (x)
 #endif
 
+/* Hint that the cache line containing *p is about to be read. */
+#if SECP256K1_GNUC_PREREQ(3, 1)
+#define SECP256K1_PREFETCH(p) __builtin_prefetch((p), 0, 3)
+#else
+#define SECP256K1_PREFETCH(p) ((void)(p))
+#endif
+
 #ifdef DETERMINISTIC
 #define CHECK(cond) do { \
     if (EXPECT(!(cond), 0)) { \
@@ -96,6 +103,32 @@ static SECP256K1_INLINE void *checked_malloc(const secp256k1_callback* cb, size_
     return ret;
 }
 
+/* Like checked_malloc, but uses allocator if it is non-NULL and has an alloc function. */
+static SECP256K1_INLINE void *checked_alloc(const secp256k1_allocator* allocator, const secp256k1_callback* cb, size_t size) {
+    void *ret;
+    if (allocator != NULL && allocator->alloc != NULL) {
+        ret = allocator->alloc(size, allocator->data);
+    } else {
+        ret = malloc(size);
+    }
+    if (ret == NULL) {
+        secp256k1_callback_call(cb, "Out of memory");
+    }
+    return ret;
+}
+
+/* Releases memory obtained from checked_alloc with the same allocator. */
+static SECP256K1_INLINE void secp256k1_dealloc(const secp256k1_allocator* allocator, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (allocator != NULL && allocator->free != NULL) {
+        allocator->free(ptr, allocator->data);
+    } else {
+        free(ptr);
+    }
+}
+
 static SECP256K1_INLINE void *checked_realloc(const secp256k1_callback* cb, void *ptr, size_t size) {
     void *ret = realloc(ptr, size);
     if (ret == NULL) {
@@ -341,4 +374,116 @@ static SECP256K1_INLINE int secp256k1_ctz64_var(uint64_t x) {
 #endif
 }
 
+/* Atomic accesses to an unsigned int or a size_t, and memory fences. They are
+ * used by secp256k1_ecmult_gen_context to publish the blinding while other
+ * threads read it, and by the signature cache. They use the __atomic builtins
+ * (GCC 4.7+, Clang) or C11 <stdatomic.h>. Without either they are plain
+ * accesses, which is only correct if there is no concurrent writer; then
+ * SECP256K1_HAVE_ATOMICS is not defined and secp256k1_atomics_available
+ * returns 0. */
+#if !defined(__ATOMIC_ACQUIRE) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#endif
+
+#if defined(__ATOMIC_ACQUIRE) && defined(__ATOMIC_RELEASE) && defined(__ATOMIC_RELAXED)
+#define SECP256K1_HAVE_ATOMICS 1
+static SECP256K1_INLINE unsigned int secp256k1_atomic_load_relaxed(const unsigned int *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static SECP256K1_INLINE unsigned int secp256k1_atomic_load_acquire(const unsigned int *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_store_relaxed(unsigned int *p, unsigned int v) {
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_store_release(unsigned int *p, unsigned int v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_fence_acquire(void) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_fence_release(void) {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static SECP256K1_INLINE size_t secp256k1_atomic_size_load_relaxed(const size_t *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_size_increment_relaxed(size_t *p) {
+    __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+}
+#elif defined(ATOMIC_INT_LOCK_FREE) && ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_POINTER_LOCK_FREE == 2
+/* The objects are not declared _Atomic, so this relies on the atomic types
+ * having the same representation as the plain ones, which holds where they are
+ * always lock-free. */
+#define SECP256K1_HAVE_ATOMICS 1
+static SECP256K1_INLINE unsigned int secp256k1_atomic_load_relaxed(const unsigned int *p) {
+    return atomic_load_explicit((const volatile _Atomic unsigned int *)p, memory_order_relaxed);
+}
+
+static SECP256K1_INLINE unsigned int secp256k1_atomic_load_acquire(const unsigned int *p) {
+    return atomic_load_explicit((const volatile _Atomic unsigned int *)p, memory_order_acquire);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_store_relaxed(unsigned int *p, unsigned int v) {
+    atomic_store_explicit((volatile _Atomic unsigned int *)p, v, memory_order_relaxed);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_store_release(unsigned int *p, unsigned int v) {
+    atomic_store_explicit((volatile _Atomic unsigned int *)p, v, memory_order_release);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_fence_acquire(void) {
+    atomic_thread_fence(memory_order_acquire);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_fence_release(void) {
+    atomic_thread_fence(memory_order_release);
+}
+
+static SECP256K1_INLINE size_t secp256k1_atomic_size_load_relaxed(const size_t *p) {
+    return atomic_load_explicit((const volatile _Atomic size_t *)p, memory_order_relaxed);
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_size_increment_relaxed(size_t *p) {
+    atomic_fetch_add_explicit((volatile _Atomic size_t *)p, 1, memory_order_relaxed);
+}
+#else
+static SECP256K1_INLINE unsigned int secp256k1_atomic_load_relaxed(const unsigned int *p) {
+    return *p;
+}
+
+static SECP256K1_INLINE unsigned int secp256k1_atomic_load_acquire(const unsigned int *p) {
+    return *p;
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_store_relaxed(unsigned int *p, unsigned int v) {
+    *p = v;
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_store_release(unsigned int *p, unsigned int v) {
+    *p = v;
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_fence_acquire(void) {
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_fence_release(void) {
+}
+
+static SECP256K1_INLINE size_t secp256k1_atomic_size_load_relaxed(const size_t *p) {
+    return *p;
+}
+
+static SECP256K1_INLINE void secp256k1_atomic_size_increment_relaxed(size_t *p) {
+    (*p)++;
+}
+#endif
+
 #endif /* SECP256K1_UTIL_H */
@@ -27,6 +27,18 @@
 #include "../include/secp256k1_schnorrsig.h"
 #endif
 
+#ifdef ENABLE_MODULE_MUSIG
+#include "../include/secp256k1_musig.h"
+#endif
+
+#ifdef ENABLE_MODULE_SILENTPAYMENTS
+#include "../include/secp256k1_silentpayments.h"
+#endif
+
+#ifdef ENABLE_MODULE_PEDERSEN
+#include "../include/secp256k1_pedersen.h"
+#endif
+
 void run_tests(secp256k1_context *ctx, unsigned char *key);
 
 int main(void) {
@@ -64,6 +76,8 @@ int main(void) {
 
 void run_tests(secp256k1_context *ctx, unsigned char *key) {
     secp256k1_ecdsa_signature signature;
+    secp256k1_ecdsa_signing_key signing_key;
+    secp256k1_signing_session *session;
     secp256k1_pubkey pubkey;
     size_t siglen = 74;
     size_t outputlen = 33;
@@ -100,12 +114,51 @@ void run_tests(secp256k1_context *ctx, unsigned char *key) {
     CHECK(ret);
     CHECK(secp256k1_ecdsa_signature_serialize_der(ctx, sig, &siglen, &signature));
 
+    /* Test signing with a signing key. */
+    VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+    ret = secp256k1_ecdsa_signing_key_create(ctx, &signing_key, key);
+    VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+    CHECK(ret);
+    ret = secp256k1_ecdsa_sign_with_signing_key(ctx, &signature, msg, &signing_key, NULL);
+    VALGRIND_MAKE_MEM_DEFINED(&signature, sizeof(secp256k1_ecdsa_signature));
+    VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+    CHECK(ret);
+
+    /* Test signing with a signing session. */
+    session = secp256k1_signing_session_create(ctx);
+    CHECK(session != NULL);
+    CHECK(secp256k1_signing_session_randomize(session, msg));
+    VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+    ret = secp256k1_ecdsa_sign_with_session(session, &signature, msg, key, NULL, NULL);
+    VALGRIND_MAKE_MEM_DEFINED(&signature, sizeof(secp256k1_ecdsa_signature));
+    VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+    CHECK(ret);
+    secp256k1_signing_session_destroy(session);
+
 #ifdef ENABLE_MODULE_ECDH
     /* Test ECDH. */
     VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
     ret = secp256k1_ecdh(ctx, msg, &pubkey, key, NULL, NULL);
     VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
     CHECK(ret == 1);
+    {
+        unsigned char *outputs[1];
+        const secp256k1_pubkey *pubkeys[1];
+        secp256k1_ecdh_precomputed_pubkey *prec;
+        outputs[0] = msg;
+        pubkeys[0] = &pubkey;
+        VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+        ret = secp256k1_ecdh_batch(ctx, outputs, pubkeys, 1, key, NULL, NULL);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        prec = secp256k1_ecdh_precomputed_pubkey_create(ctx, &pubkey);
+        CHECK(prec != NULL);
+        VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+        ret = secp256k1_ecdh_precomputed(ctx, msg, prec, key, NULL, NULL);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        secp256k1_ecdh_precomputed_pubkey_destroy(ctx, prec);
+    }
 #endif
 
 #ifdef ENABLE_MODULE_RECOVERY
@@ -169,5 +222,120 @@ void run_tests(secp256k1_context *ctx, unsigned char *key) {
     ret = secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, NULL);
     VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
     CHECK(ret == 1);
+    {
+        unsigned char sigs[2][64];
+        unsigned char *sig_ptrs[2];
+        const unsigned char *msg_ptrs[2];
+        unsigned char *aux_rand_ptrs[2];
+        sig_ptrs[0] = sigs[0];
+        sig_ptrs[1] = sigs[1];
+        msg_ptrs[0] = msg;
+        msg_ptrs[1] = msg;
+        aux_rand_ptrs[0] = NULL;
+        aux_rand_ptrs[1] = key;
+        ret = secp256k1_schnorrsig_sign_batch(ctx, sig_ptrs, msg_ptrs, &keypair, aux_rand_ptrs, 2);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+    }
+#endif
+
+#ifdef ENABLE_MODULE_MUSIG
+    {
+        secp256k1_pubkey pk;
+        const secp256k1_pubkey *pk_ptrs[1];
+        secp256k1_musig_keyagg_cache cache;
+        secp256k1_musig_secnonce secnonces[2];
+        secp256k1_musig_pubnonce pubnonces[2];
+        const secp256k1_musig_pubnonce *pubnonce_ptrs[1];
+        secp256k1_musig_aggnonce aggnonce;
+        secp256k1_musig_session session;
+        secp256k1_musig_partial_sig partial_sig;
+        unsigned char session_secrand[2][32];
+        unsigned char *session_secrand_ptrs[2];
+        int j;
+
+        ret = secp256k1_keypair_pub(ctx, &pk, &keypair);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        VALGRIND_MAKE_MEM_DEFINED(&pk, sizeof(pk));
+        pk_ptrs[0] = &pk;
+        CHECK(secp256k1_musig_pubkey_agg(ctx, NULL, NULL, &cache, pk_ptrs, 1) == 1);
+
+        for (j = 0; j < 32; j++) {
+            session_secrand[0][j] = session_secrand[1][j] = j + 1;
+        }
+        session_secrand_ptrs[0] = session_secrand[0];
+        session_secrand_ptrs[1] = session_secrand[1];
+        VALGRIND_MAKE_MEM_UNDEFINED(session_secrand, sizeof(session_secrand));
+        ret = secp256k1_musig_nonce_gen_batch(ctx, secnonces, pubnonces, session_secrand_ptrs, key, &pk, &cache, NULL, 2);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        for (j = 0; j < 32; j++) {
+            session_secrand[0][j] = j + 1;
+        }
+        VALGRIND_MAKE_MEM_UNDEFINED(session_secrand[0], 32);
+        ret = secp256k1_musig_nonce_gen(ctx, &secnonces[0], &pubnonces[0], session_secrand[0], key, &pk, msg, &cache, NULL);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+
+        pubnonce_ptrs[0] = &pubnonces[0];
+        CHECK(secp256k1_musig_nonce_agg(ctx, &aggnonce, pubnonce_ptrs, 1) == 1);
+        CHECK(secp256k1_musig_nonce_process(ctx, &session, &aggnonce, msg, &cache) == 1);
+        ret = secp256k1_musig_partial_sign(ctx, &partial_sig, &secnonces[0], &keypair, &cache, &session);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+    }
+#endif
+
+#ifdef ENABLE_MODULE_SILENTPAYMENTS
+    {
+        secp256k1_xonly_pubkey xonly_pk;
+        const secp256k1_xonly_pubkey *xonly_ptrs[1];
+        secp256k1_silentpayments_public_data public_data;
+        secp256k1_silentpayments_recipient_tx tx;
+        const secp256k1_silentpayments_recipient_tx *tx_ptrs[1];
+        secp256k1_silentpayments_found_output found[1];
+        unsigned char outpoint[36] = { 0 };
+        size_t n_found = 1;
+
+        VALGRIND_MAKE_MEM_DEFINED(key, 32);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(ctx, &xonly_pk, NULL, &pubkey) == 1);
+        xonly_ptrs[0] = &xonly_pk;
+        CHECK(secp256k1_silentpayments_recipient_public_data_create(ctx, &public_data, outpoint, xonly_ptrs, 1, NULL, 0) == 1);
+        tx.public_data = &public_data;
+        tx.outputs = xonly_ptrs;
+        tx.n_outputs = 1;
+        tx_ptrs[0] = &tx;
+        VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+        ret = secp256k1_silentpayments_recipient_scan_block(ctx, found, &n_found, tx_ptrs, 1, key, &pubkey);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+    }
+#endif
+
+#ifdef ENABLE_MODULE_PEDERSEN
+    {
+        secp256k1_pedersen_h_table *table = secp256k1_pedersen_h_table_create(ctx);
+        secp256k1_pedersen_commitment commit;
+        const unsigned char *blinds[2];
+        unsigned char blind_sum[32];
+        uint64_t value = 0x0123456789abcdefULL;
+
+        VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+        VALGRIND_MAKE_MEM_UNDEFINED(&value, sizeof(value));
+        ret = secp256k1_pedersen_commit(ctx, &commit, table, key, value);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        ret = secp256k1_pedersen_commit(ctx, &commit, NULL, key, value);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        blinds[0] = key;
+        blinds[1] = msg;
+        ret = secp256k1_pedersen_blind_sum(ctx, blind_sum, blinds, 2, 1);
+        VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        secp256k1_pedersen_h_table_destroy(ctx, table);
+    }
 #endif
 }